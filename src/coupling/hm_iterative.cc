@@ -49,6 +49,9 @@ const it::Record & HM_Iterative::get_input_type() {
                 "Absolute tolerance for difference in HM iteration." )
         .declare_key( "r_tol", it::Double(0), it::Default("1e-7"),
                 "Relative tolerance for difference in HM iteration." )
+        .declare_key( "anderson_depth", it::Integer(0), it::Default("5"),
+                "Number of previous HM iterations used by the Anderson acceleration. "
+                "Zero turns the acceleration off." )
 		.close();
 }
 
@@ -91,6 +94,7 @@ HM_Iterative::HM_Iterative(Mesh &mesh, Input::Record in_record)
     max_it_ = in_record.val<unsigned int>("max_it");
     a_tol_ = in_record.val<double>("a_tol");
     r_tol_ = in_record.val<double>("r_tol");
+    acceleration_ = std::make_shared<AndersonAcceleration>(in_record.val<unsigned int>("anderson_depth"));
 
     this->eq_data_ = &data_;
     
@@ -113,27 +117,48 @@ void HM_Iterative::zero_time_step()
 {
     flow_->zero_time_step();
     mechanics_->zero_time_step();
+
+    Vec flow_solution;
+    flow_->get_parallel_solution_vector(flow_solution);
+    acceleration_->add_block(flow_solution);
+    acceleration_->add_block(mechanics_->get_solution());
 }
 
 
 void HM_Iterative::update_solution()
 {
+    time_->next_time();
+    time_->view("HM");
+    mechanics_->time().next_time();
+
     unsigned it = 0;
     double difference = 0;
     double init_difference = 1;
     
-    while (it < min_it_ || 
-           (it < max_it_ && difference > a_tol_ && difference/init_difference > r_tol_)
-          )
+    acceleration_->start_iterations();
+    while (true)
     {
+        START_TIMER("HM iteration");
         it++;
         
-        flow_->update_solution();
+        flow_->solve_time_step(false);
         // TODO: pass pressure to mechanics
-        mechanics_->update_solution();
+        mechanics_->solve_time_step(false);
         // TODO: pass displacement (divergence) to flow
-        // TODO: compute difference of iterates
+
+        difference = acceleration_->update_residual();
+        if (it == 1 && difference > 0) init_difference = difference;
+        MessageOut().fmt("HM Iteration {} abs. difference: {}  rel. difference: {}\n",
+                it, difference, difference/init_difference);
+
+        if (it >= min_it_ &&
+            (it >= max_it_ || difference <= a_tol_ || difference/init_difference <= r_tol_))
+            break;
+        acceleration_->accelerate();
     }
+
+    flow_->output_time_step();
+    mechanics_->output_data();
 }
 
 
@@ -144,9 +169,7 @@ const MH_DofHandler & HM_Iterative::get_mh_dofhandler()
 
 
 HM_Iterative::~HM_Iterative() {
+    acceleration_.reset();
 	flow_.reset();
     mechanics_.reset();
 }
-
-
-
@@ -21,12 +21,12 @@
 
 #include <memory>
 #include <string>
-#include <vector>
 #include "input/input_type_forward.hh"
 #include "input/accessors_forward.hh"
 #include "coupling/equation.hh"
 #include "flow/darcy_flow_interface.hh"
 #include "mechanics/elasticity.hh"
+#include "la/anderson_acceleration.hh"
 
 class Mesh;
 class FieldCommon;
@@ -40,6 +40,11 @@ class RichardsLMH;
  * Here we use the fixed-stress splitting [see Mikelic&Wheeler, Comput. Geosci. 17(3), 2013] which uses
  * a tuning parameter "beta" to speed up the convergence.
  * 
+ * The iterations are accelerated by the Anderson method: the new iterate is a combination of the last
+ * results of flow and mechanics that minimizes the linearized residual of the fixed-point map
+ * [see Walker&Ni, SIAM J. Numer. Anal. 49(4), 2011]. The convergence is checked by the norm of the difference
+ * between the solutions and the iterate they were computed from.
+ * 
  * TODO: The class is currently inherited from DarcyFlowInterface in order to provide MH_DofHandler for
  * transport processes. This should be changed as soon as we replace MH_DofHandler by fields for velocity
  * and pressure.
@@ -91,6 +96,9 @@ private:
     /// Relative tolerance for difference between two succeeding iterations.
     double r_tol_;
 
+    /// Anderson acceleration of the iterations, the iterate consists of the solutions of flow and mechanics.
+    std::shared_ptr<AndersonAcceleration> acceleration_;
+
 };
 
 #endif /* HC_EXPLICIT_SEQUENTIAL_HH_ */
@@ -36,12 +36,14 @@ using namespace std;
 
 
 
-FEInternalData::FEInternalData(unsigned int np, unsigned int nd)
+FEInternalData::FEInternalData(unsigned int np, unsigned int nd, unsigned int n_comp, unsigned int dim)
     : n_points(np),
-      n_dofs(nd)
+      n_dofs(nd),
+      n_components(n_comp),
+      dim(dim)
 {
-    ref_shape_values.resize(np, vector<arma::vec>(nd));
-    ref_shape_grads.resize(np, vector<arma::mat>(nd));
+    ref_shape_values.resize(np*nd*n_comp, 0);
+    ref_shape_grads.resize(np*nd*n_comp*dim, 0);
 }
 
 
@@ -50,6 +52,7 @@ template<unsigned int dim, unsigned int spacedim>
 void FEValuesData<dim,spacedim>::allocate(unsigned int size, UpdateFlags flags, unsigned int n_comp)
 {
     update_flags = flags;
+    n_shape_values = n_comp;
 
     // resize the arrays of computed quantities
     if (update_flags & update_jacobians)
@@ -67,12 +70,12 @@ void FEValuesData<dim,spacedim>::allocate(unsigned int size, UpdateFlags flags,
 
     if (update_flags & update_values)
     {
-        shape_values.resize(size, vector<double>(n_comp));
+        shape_values.resize(size*n_comp);
     }
 
     if (update_flags & update_gradients)
     {
-        shape_gradients.resize(size, vector<arma::vec::fixed<spacedim> >(n_comp));
+        shape_gradients.resize(size*spacedim*n_comp);
     }
 
     if (update_flags & update_quadrature_points)
@@ -184,30 +187,28 @@ template<unsigned int dim, unsigned int spacedim>
 FEInternalData *FEValuesBase<dim,spacedim>::init_fe_data(const Quadrature *q)
 {
     ASSERT_DBG( q->dim() == dim );
-    FEInternalData *data = new FEInternalData(q->size(), fe->n_dofs());
+    unsigned int n_comp = fe->n_components();
+    FEInternalData *data = new FEInternalData(q->size(), fe->n_dofs(), n_comp, dim);
 
-    arma::mat shape_values(fe->n_dofs(), fe->n_components());
     for (unsigned int i=0; i<q->size(); i++)
     {
         for (unsigned int j=0; j<fe->n_dofs(); j++)
         {
-            for (unsigned int c=0; c<fe->n_components(); c++)
-                shape_values(j,c) = fe->shape_value(j, q->point<dim>(i).arma(), c);
-            
-            data->ref_shape_values[i][j] = trans(shape_values.row(j));
+            for (unsigned int c=0; c<n_comp; c++)
+                data->ref_shape_values[(i*fe->n_dofs()+j)*n_comp+c] = fe->shape_value(j, q->point<dim>(i).arma(), c);
         }
     }
 
-    arma::mat grad(dim, fe->n_components());
     for (unsigned int i=0; i<q->size(); i++)
     {
         for (unsigned int j=0; j<fe->n_dofs(); j++)
         {
-            grad.zeros();
-            for (unsigned int c=0; c<fe->n_components(); c++)
-                grad.col(c) += fe->shape_grad(j, q->point<dim>(i).arma(), c);
-            
-            data->ref_shape_grads[i][j] = grad;
+            for (unsigned int c=0; c<n_comp; c++)
+            {
+                arma::vec grad = fe->shape_grad(j, q->point<dim>(i).arma(), c);
+                for (unsigned int d=0; d<dim; d++)
+                    data->ref_shape_grads[((i*fe->n_dofs()+j)*n_comp+c)*dim+d] = grad(d);
+            }
         }
     }
     
@@ -230,7 +231,7 @@ double FEValuesBase<dim,spacedim>::shape_value(const unsigned int function_no, c
 {
   ASSERT_LT_DBG(function_no, fe->n_dofs());
   ASSERT_LT_DBG(point_no, n_points_);
-  return data.shape_values[point_no][function_no];
+  return data.shape_value(point_no, function_no);
 }
 
 
@@ -239,7 +240,7 @@ arma::vec::fixed<spacedim> FEValuesBase<dim,spacedim>::shape_grad(const unsigned
 {
   ASSERT_LT_DBG(function_no, fe->n_dofs());
   ASSERT_LT_DBG(point_no, n_points_);
-  return data.shape_gradients[point_no][function_no];
+  return data.shape_gradient(point_no, function_no);
 }
 
 
@@ -251,7 +252,7 @@ double FEValuesBase<dim,spacedim>::shape_value_component(const unsigned int func
   ASSERT_LT_DBG(function_no, fe->n_dofs());
   ASSERT_LT_DBG(point_no, n_points_);
   ASSERT_LT_DBG(comp, n_components_);
-  return data.shape_values[point_no][function_no*n_components_+comp];
+  return data.shape_value(point_no, function_no*n_components_+comp);
 }
 
 
@@ -263,7 +264,7 @@ arma::vec::fixed<spacedim> FEValuesBase<dim,spacedim>::shape_grad_component(cons
   ASSERT_LT_DBG(function_no, fe->n_dofs());
   ASSERT_LT_DBG(point_no, n_points_);
   ASSERT_LT_DBG(comp, n_components_);
-  return data.shape_gradients[point_no][function_no*n_components_+comp];
+  return data.shape_gradient(point_no, function_no*n_components_+comp);
 }
 
 
@@ -276,13 +277,22 @@ void FEValuesBase<dim,spacedim>::fill_scalar_data(const FEInternalData &fe_data)
     if (data.update_flags & update_values)
         for (unsigned int i = 0; i < fe_data.n_points; i++)
             for (unsigned int j = 0; j < fe_data.n_dofs; j++)
-                data.shape_values[i][j] = fe_data.ref_shape_values[i][j][0];
+                data.shape_value(i,j) = fe_data.ref_shape_value(i,j,0);
 
-    // shape gradients
+    // shape gradients, computed by coordinates to get contiguous loops over shape functions
     if (data.update_flags & update_gradients)
         for (unsigned int i = 0; i < fe_data.n_points; i++)
-            for (unsigned int j = 0; j < fe_data.n_dofs; j++)
-                data.shape_gradients[i][j] = trans(data.inverse_jacobians[i]) * fe_data.ref_shape_grads[i][j];
+            for (unsigned int c = 0; c < spacedim; c++)
+            {
+                double *grad_c = &data.shape_gradients[(i*spacedim + c)*data.n_shape_values];
+                for (unsigned int j = 0; j < fe_data.n_dofs; j++)
+                {
+                    double g = 0;
+                    for (unsigned int d = 0; d < dim; d++)
+                        g += data.inverse_jacobians[i](d,c) * fe_data.ref_shape_grad(i,j,d);
+                    grad_c[j] = g;
+                }
+            }
 }
 
 
@@ -297,9 +307,8 @@ void FEValuesBase<dim,spacedim>::fill_vec_data(const FEInternalData &fe_data)
         for (unsigned int i = 0; i < fe_data.n_points; i++)
             for (unsigned int j = 0; j < fe_data.n_dofs; j++)
             {
-                arma::vec fv_vec = fe_data.ref_shape_values[i][j];
                 for (unsigned int c=0; c<spacedim; c++)
-                    data.shape_values[i][j*spacedim+c] = fv_vec[c];
+                    data.shape_value(i,j*spacedim+c) = fe_data.ref_shape_value(i,j,c);
             }
     }
 
@@ -309,9 +318,9 @@ void FEValuesBase<dim,spacedim>::fill_vec_data(const FEInternalData &fe_data)
         for (unsigned int i = 0; i < fe_data.n_points; i++)
             for (unsigned int j = 0; j < fe_data.n_dofs; j++)
             {
-                arma::mat grads = trans(data.inverse_jacobians[i]) * fe_data.ref_shape_grads[i][j];
+                arma::mat::fixed<spacedim,spacedim> grads = trans(data.inverse_jacobians[i]) * fe_data.ref_shape_grad(i,j);
                 for (unsigned int c=0; c<spacedim; c++)
-                    data.shape_gradients[i][j*spacedim+c] = grads.col(c);
+                    data.set_shape_gradient(i, j*spacedim+c, grads.col(c));
             }
     }
 }
@@ -328,9 +337,9 @@ void FEValuesBase<dim,spacedim>::fill_vec_contravariant_data(const FEInternalDat
         for (unsigned int i = 0; i < fe_data.n_points; i++)
             for (unsigned int j = 0; j < fe_data.n_dofs; j++)
             {
-                arma::vec fv_vec = data.jacobians[i] * fe_data.ref_shape_values[i][j];
+                arma::vec::fixed<spacedim> fv_vec = data.jacobians[i] * fe_data.ref_shape_value(i,j);
                 for (unsigned int c=0; c<spacedim; c++)
-                    data.shape_values[i][j*spacedim+c] = fv_vec[c];
+                    data.shape_value(i,j*spacedim+c) = fv_vec[c];
             }
     }
 
@@ -340,9 +349,9 @@ void FEValuesBase<dim,spacedim>::fill_vec_contravariant_data(const FEInternalDat
         for (unsigned int i = 0; i < fe_data.n_points; i++)
             for (unsigned int j = 0; j < fe_data.n_dofs; j++)
             {
-                arma::mat grads = trans(data.inverse_jacobians[i]) * fe_data.ref_shape_grads[i][j] * trans(data.jacobians[i]);
+                arma::mat::fixed<spacedim,spacedim> grads = trans(data.inverse_jacobians[i]) * fe_data.ref_shape_grad(i,j) * trans(data.jacobians[i]);
                 for (unsigned int c=0; c<spacedim; c++)
-                    data.shape_gradients[i][j*spacedim+c] = grads.col(c);
+                    data.set_shape_gradient(i, j*spacedim+c, grads.col(c));
             }
     }
 }
@@ -359,9 +368,9 @@ void FEValuesBase<dim,spacedim>::fill_vec_piola_data(const FEInternalData &fe_da
         for (unsigned int i = 0; i < fe_data.n_points; i++)
             for (unsigned int j = 0; j < fe_data.n_dofs; j++)
             {
-                arma::vec fv_vec = data.jacobians[i]*fe_data.ref_shape_values[i][j]/data.determinants[i];
+                arma::vec::fixed<spacedim> fv_vec = data.jacobians[i]*fe_data.ref_shape_value(i,j)/data.determinants[i];
                 for (unsigned int c=0; c<spacedim; c++)
-                    data.shape_values[i][j*spacedim+c] = fv_vec(c);
+                    data.shape_value(i,j*spacedim+c) = fv_vec(c);
             }
     }
 
@@ -371,10 +380,10 @@ void FEValuesBase<dim,spacedim>::fill_vec_piola_data(const FEInternalData &fe_da
         for (unsigned int i = 0; i < fe_data.n_points; i++)
             for (unsigned int j = 0; j < fe_data.n_dofs; j++)
             {
-                arma::mat grads = trans(data.inverse_jacobians[i]) * fe_data.ref_shape_grads[i][j] * trans(data.jacobians[i])
+                arma::mat::fixed<spacedim,spacedim> grads = trans(data.inverse_jacobians[i]) * fe_data.ref_shape_grad(i,j) * trans(data.jacobians[i])
                         / data.determinants[i];
                 for (unsigned int c=0; c<spacedim; c++)
-                    data.shape_gradients[i][j*spacedim+c] = grads.col(c);
+                    data.set_shape_gradient(i, j*spacedim+c, grads.col(c));
             }   
     }
 }
@@ -391,9 +400,8 @@ void FEValuesBase<dim,spacedim>::fill_tensor_data(const FEInternalData &fe_data)
         for (unsigned int i = 0; i < fe_data.n_points; i++)
             for (unsigned int j = 0; j < fe_data.n_dofs; j++)
             {
-                arma::vec fv_vec = fe_data.ref_shape_values[i][j];
                 for (unsigned int c=0; c<spacedim*spacedim; c++)
-                    data.shape_values[i][j*spacedim*spacedim+c] = fv_vec[c];
+                    data.shape_value(i,j*spacedim*spacedim+c) = fe_data.ref_shape_value(i,j,c);
             }
     }
 
@@ -403,9 +411,9 @@ void FEValuesBase<dim,spacedim>::fill_tensor_data(const FEInternalData &fe_data)
         for (unsigned int i = 0; i < fe_data.n_points; i++)
             for (unsigned int j = 0; j < fe_data.n_dofs; j++)
             {
-                arma::mat grads = trans(data.inverse_jacobians[i]) * fe_data.ref_shape_grads[i][j];
+                arma::mat::fixed<spacedim,spacedim*spacedim> grads = trans(data.inverse_jacobians[i]) * fe_data.ref_shape_grad(i,j);
                 for (unsigned int c=0; c<spacedim*spacedim; c++)
-                    data.shape_gradients[i][j*spacedim*spacedim+c] = grads.col(c);
+                    data.set_shape_gradient(i, j*spacedim*spacedim+c, grads.col(c));
             }
     }
 }
@@ -433,7 +441,6 @@ void FEValuesBase<dim,spacedim>::fill_system_data(const FEInternalData &fe_data)
     // shape values
     if (data.update_flags & update_values)
     {
-        arma::vec fv_vec;
         unsigned int comp_offset = 0;
         unsigned int shape_offset = 0;
         for (unsigned int f=0; f<fe_sys->fe().size(); f++)
@@ -444,7 +451,7 @@ void FEValuesBase<dim,spacedim>::fill_system_data(const FEInternalData &fe_data)
             for (unsigned int i=0; i<fe_data.n_points; i++)
                 for (unsigned int n=0; n<fe_sys->fe()[f]->n_dofs(); n++)
                     for (unsigned int c=0; c<n_sub_space_components; c++)
-                        data.shape_values[i][shape_offset+n_space_components*n+comp_offset+c] = fe_values_vec[f]->data.shape_values[i][n*n_sub_space_components+c];
+                        data.shape_value(i, shape_offset+n_space_components*n+comp_offset+c) = fe_values_vec[f]->data.shape_value(i, n*n_sub_space_components+c);
             
             comp_offset += n_sub_space_components;
             shape_offset += fe_sys->fe()[f]->n_dofs()*n_space_components;
@@ -454,7 +461,6 @@ void FEValuesBase<dim,spacedim>::fill_system_data(const FEInternalData &fe_data)
     // shape gradients
     if (data.update_flags & update_gradients)
     {
-        arma::mat grads;
         unsigned int comp_offset = 0;
         unsigned int shape_offset = 0;
         for (unsigned int f=0; f<fe_sys->fe().size(); f++)
@@ -465,7 +471,8 @@ void FEValuesBase<dim,spacedim>::fill_system_data(const FEInternalData &fe_data)
             for (unsigned int i=0; i<fe_data.n_points; i++)
                 for (unsigned int n=0; n<fe_sys->fe()[f]->n_dofs(); n++)
                     for (unsigned int c=0; c<n_sub_space_components; c++)
-                        data.shape_gradients[i][shape_offset+n_space_components*n+comp_offset+c] = fe_values_vec[f]->data.shape_gradients[i][n*n_sub_space_components+c];
+                        data.set_shape_gradient(i, shape_offset+n_space_components*n+comp_offset+c,
+                                fe_values_vec[f]->data.shape_gradient(i, n*n_sub_space_components+c));
             
             comp_offset += n_sub_space_components;
             shape_offset += fe_sys->fe()[f]->n_dofs()*n_space_components;
@@ -554,6 +561,73 @@ void FEValues<dim,spacedim>::reinit(ElementAccessor<3> & cell)
 
 
 
+template<unsigned int dim,unsigned int spacedim>
+void FEValues<dim,spacedim>::reinit_batch(const ElementAccessor<3> *cells, unsigned int n_cells)
+{
+    ASSERT_LE_DBG(n_cells, batch_.max_size);
+    batch_.n_cells = n_cells;
+    for (unsigned int k=0; k<n_cells; k++)
+    {
+        ASSERT_EQ_DBG(dim, cells[k]->dim());
+        batch_.cells[k] = cells[k];
+    }
+
+    this->mapping->fill_fe_values_batch(batch_);
+}
+
+
+
+template<unsigned int dim,unsigned int spacedim>
+void FEValues<dim,spacedim>::reinit_batch_cell(unsigned int k)
+{
+    ASSERT_LT_DBG(k, batch_.n_cells);
+    FEValuesData<dim,spacedim> &data = this->data;
+    data.present_cell = &batch_.cells[k];
+
+    // the mapping is affine, hence the Jacobian dependent data are constant on the cell
+    if (data.update_flags & update_jacobians)
+    {
+        arma::mat::fixed<spacedim,dim> jac;
+        for (unsigned int r=0; r<spacedim; r++)
+            for (unsigned int c=0; c<dim; c++)
+                jac(r,c) = batch_.jacobians[r][c][k];
+        for (unsigned int i=0; i<quadrature->size(); i++)
+            data.jacobians[i] = jac;
+    }
+
+    if (data.update_flags & update_volume_elements)
+        for (unsigned int i=0; i<quadrature->size(); i++)
+            data.determinants[i] = batch_.determinants[k];
+
+    if (data.update_flags & update_JxW_values)
+        for (unsigned int i=0; i<quadrature->size(); i++)
+            data.JxW_values[i] = batch_.determinants[k]*quadrature->weight(i);
+
+    if (data.update_flags & update_inverse_jacobians)
+    {
+        arma::mat::fixed<dim,spacedim> ijac;
+        for (unsigned int r=0; r<dim; r++)
+            for (unsigned int c=0; c<spacedim; c++)
+                ijac(r,c) = batch_.inverse_jacobians[r][c][k];
+        for (unsigned int i=0; i<quadrature->size(); i++)
+            data.inverse_jacobians[i] = ijac;
+    }
+
+    if (data.update_flags & update_quadrature_points)
+        for (unsigned int i=0; i<quadrature->size(); i++)
+            for (unsigned int c=0; c<spacedim; c++)
+            {
+                double x = 0;
+                for (unsigned int n=0; n<dim+1; n++)
+                    x += batch_.coords[n][c][k] * this->mapping_data->bar_coords[i](n);
+                data.points[i](c) = x;
+            }
+
+    this->fill_data(*this->fe_data);
+}
+
+
+
 
 
 
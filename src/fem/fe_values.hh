@@ -43,13 +43,32 @@ struct MappingInternalData;
 
 /**
  * @brief Structure for storing the precomputed finite element data.
+ *
+ * Values and gradients are stored in contiguous arrays ordered by quadrature points,
+ * then by basis functions and components.
  */
 class FEInternalData
 {
 public:
     
-    FEInternalData(unsigned int np, unsigned int nd);
+    FEInternalData(unsigned int np, unsigned int nd, unsigned int n_comp, unsigned int dim);
     
+    /// Precomputed value of component @p c of the @p j-th basis function at the @p i-th quadrature point.
+    inline double ref_shape_value(unsigned int i, unsigned int j, unsigned int c) const
+    { return ref_shape_values[(i*n_dofs + j)*n_components + c]; }
+
+    /// Precomputed values of all components of the @p j-th basis function at the @p i-th quadrature point.
+    inline arma::vec ref_shape_value(unsigned int i, unsigned int j) const
+    { return arma::vec(const_cast<double *>(&ref_shape_values[(i*n_dofs + j)*n_components]), n_components, false, true); }
+
+    /// Precomputed derivative along reference axis @p d of the @p j-th scalar basis function at the @p i-th quadrature point.
+    inline double ref_shape_grad(unsigned int i, unsigned int j, unsigned int d) const
+    { return ref_shape_grads[(i*n_dofs + j)*n_components*dim + d]; }
+
+    /// Precomputed gradients (matrix dim x n_components) of the @p j-th basis function at the @p i-th quadrature point.
+    inline arma::mat ref_shape_grad(unsigned int i, unsigned int j) const
+    { return arma::mat(const_cast<double *>(&ref_shape_grads[(i*n_dofs + j)*n_components*dim]), dim, n_components, false, true); }
+
     /**
      * @brief Precomputed values of basis functions at the quadrature points.
      *
@@ -57,22 +76,29 @@ public:
      *             x (no. of dofs)
      *             x (no. of components in ref. cell)
      */
-    std::vector<std::vector<arma::vec> > ref_shape_values;
+    std::vector<double> ref_shape_values;
 
     /**
      * @brief Precomputed gradients of basis functions at the quadrature points.
      *
      * Dimensions:   (no. of quadrature points)
      *             x (no. of dofs)
-     *             x ((dim of. ref. cell)x(no. of components in ref. cell))
+     *             x (no. of components in ref. cell)
+     *             x (dim of. ref. cell)
      */
-    std::vector<std::vector<arma::mat> > ref_shape_grads;
+    std::vector<double> ref_shape_grads;
     
     /// Number of quadrature points.
     unsigned int n_points;
     
     /// Number of dofs (shape functions).
     unsigned int n_dofs;
+
+    /// Number of components of shape functions.
+    unsigned int n_components;
+
+    /// Dimension of the reference cell.
+    unsigned int dim;
 };
 
 
@@ -128,15 +154,44 @@ public:
 
     /**
      * @brief Shape functions evaluated at the quadrature points.
+     *
+     * Value of the @p j-th shape function (component) at the @p i-th point is at i*n_shape_values + j.
      */
-    std::vector<std::vector<double> > shape_values;
+    std::vector<double> shape_values;
 
     /**
      * @brief Gradients of shape functions evaluated at the quadrature points.
      *
-     * Each row of the matrix contains the gradient of one shape function.
+     * Stored by coordinates: coordinate @p c of the gradient of the @p j-th shape function
+     * at the @p i-th point is at (i*spacedim + c)*n_shape_values + j.
      */
-    std::vector<std::vector<arma::vec::fixed<spacedim> > > shape_gradients;
+    std::vector<double> shape_gradients;
+
+    /// Number of shape functions (times number of their components) at one point.
+    unsigned int n_shape_values;
+
+    /// Value of the @p j-th shape function at the @p i-th point.
+    inline double &shape_value(unsigned int i, unsigned int j)
+    { return shape_values[i*n_shape_values + j]; }
+
+    /// Value of the @p j-th shape function at the @p i-th point.
+    inline double shape_value(unsigned int i, unsigned int j) const
+    { return shape_values[i*n_shape_values + j]; }
+
+    /// Gradient of the @p j-th shape function at the @p i-th point.
+    inline arma::vec::fixed<spacedim> shape_gradient(unsigned int i, unsigned int j) const
+    {
+        arma::vec::fixed<spacedim> grad;
+        for (unsigned int c=0; c<spacedim; c++) grad(c) = shape_gradients[(i*spacedim + c)*n_shape_values + j];
+        return grad;
+    }
+
+    /// Set gradient of the @p j-th shape function at the @p i-th point.
+    template<class Vec>
+    inline void set_shape_gradient(unsigned int i, unsigned int j, const Vec &grad)
+    {
+        for (unsigned int c=0; c<spacedim; c++) shape_gradients[(i*spacedim + c)*n_shape_values + j] = grad(c);
+    }
 
 //     /**
 //      * @brief Shape functions (for vectorial finite elements) evaluated at
@@ -168,6 +223,42 @@ public:
 };
 
 
+/**
+ * @brief Geometry of a batch of cells of the same dimension computed at once by Mapping::fill_fe_values_batch.
+ *
+ * Every quantity is stored by components: the array of a component holds its values on all cells
+ * of the batch (structure of arrays), so that loops over the cells are vectorized by the compiler.
+ */
+template<unsigned int dim, unsigned int spacedim>
+class FEValuesBatchData
+{
+public:
+    /// Maximal number of cells in the batch.
+    static const unsigned int max_size = 16;
+
+    /// Number of columns of Jacobian (at least one to avoid empty arrays for dim=0).
+    static const unsigned int n_cols = (dim > 0 ? dim : 1);
+
+    /// Number of cells in the batch.
+    unsigned int n_cells;
+
+    /// Cells of the batch.
+    ElementAccessor<3> cells[max_size];
+
+    /// Coordinates of nodes, coordinate @p c of node @p n of the i-th cell is coords[n][c][i].
+    double coords[dim+1][spacedim][max_size];
+
+    /// Jacobians of the mapping, entry (r,c) of the i-th cell is jacobians[r][c][i].
+    double jacobians[spacedim][n_cols][max_size];
+
+    /// Inverse (pseudoinverse for dim < spacedim) Jacobians, entry (r,c) of the i-th cell is inverse_jacobians[r][c][i].
+    double inverse_jacobians[n_cols][spacedim][max_size];
+
+    /// Absolute values of Jacobian determinants.
+    double determinants[max_size];
+};
+
+
 /**
  * @brief Abstract base class with certain methods independent of the template parameter @p dim.
  */
@@ -548,6 +639,21 @@ public:
      * @param cell The actual cell.
      */
     void reinit(ElementAccessor<3> &cell);
+
+    /**
+     * @brief Compute geometry of a batch of cells at once.
+     *
+     * Jacobians, their inverses and determinants of all cells are computed by the mapping
+     * in vectorized loops over the cells. Then the data of the i-th cell of the batch are computed
+     * by @p reinit_batch_cell(i), which gives the same result as @p reinit of the cell.
+     *
+     * @param cells Array of cells of dimension @p dim.
+     * @param n_cells Number of cells, at most FEValuesBatchData::max_size.
+     */
+    void reinit_batch(const ElementAccessor<3> *cells, unsigned int n_cells);
+
+    /// Update cell-dependent data of the @p i_cell-th cell of the last batch.
+    void reinit_batch_cell(unsigned int i_cell);
     
     const Quadrature *get_quadrature() const override
     { return quadrature; }
@@ -561,6 +667,9 @@ private:
      */
     Quadrature *quadrature;
 
+    /// Geometry of the last batch of cells.
+    FEValuesBatchData<dim,spacedim> batch_;
+
 
 };
 
@@ -0,0 +1,64 @@
+/*!
+ *
+﻿ * Copyright (C) 2015 Technical University of Liberec.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License version 3 as published by the
+ * Free Software Foundation. (http://www.gnu.org/licenses/gpl-3.0.en.html)
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *
+ * @file    fe_values_batch.hh
+ * @brief   Assembly over cells with geometry computed in batches.
+ */
+
+#ifndef FE_VALUES_BATCH_HH_
+#define FE_VALUES_BATCH_HH_
+
+#include <initializer_list>
+#include "fem/fe_values.hh"
+#include "fem/dh_cell_accessor.hh"
+
+
+/**
+ * @brief Call @p cell_func(cell, elm) for all own cells of dimension @p dim of the DOF handler @p dh.
+ *
+ * Cells are processed in batches of at most FEValuesBatchData::max_size cells, geometry of a batch
+ * is computed at once by FEValues::reinit_batch of all objects @p fe_values. Before @p cell_func
+ * is called, the objects are set to the cell by FEValues::reinit_batch_cell.
+ */
+template <unsigned int dim, class CellFunc>
+void for_each_cell_batched(const DOFHandlerMultiDim &dh, std::initializer_list<FEValues<dim,3> *> fe_values,
+        CellFunc cell_func)
+{
+    const unsigned int max_batch = FEValuesBatchData<dim,3>::max_size;
+    DHCellAccessor batch_cells[max_batch];
+    ElementAccessor<3> batch_elms[max_batch];
+    auto range = dh.own_range();
+    auto cell_it = range.begin();
+    while (cell_it != range.end())
+    {
+        unsigned int n_batch = 0;
+        for (; cell_it != range.end() && n_batch < max_batch; ++cell_it)
+            if (cell_it->dim() == dim)
+            {
+                batch_cells[n_batch] = *cell_it;
+                batch_elms[n_batch++] = cell_it->elm();
+            }
+        for (FEValues<dim,3> *fv : fe_values)
+            fv->reinit_batch(batch_elms, n_batch);
+
+        for (unsigned int i_batch=0; i_batch<n_batch; i_batch++)
+        {
+            for (FEValues<dim,3> *fv : fe_values)
+                fv->reinit_batch_cell(i_batch);
+            cell_func(batch_cells[i_batch], batch_elms[i_batch]);
+        }
+    }
+}
+
+
+#endif /* FE_VALUES_BATCH_HH_ */
@@ -32,6 +32,7 @@
 
 class Quadrature;
 template<unsigned int dim, unsigned int spacedim> class FEValuesData;
+template<unsigned int dim, unsigned int spacedim> class FEValuesBatchData;
 
 
 
@@ -150,6 +151,13 @@ public:
                         MappingInternalData &data,
                         FEValuesData<dim,spacedim> &fv_data) = 0;
 
+    /**
+     * @brief Calculates Jacobians, their inverses and determinants on a batch of cells.
+     *
+     * @param batch_data Batch with filled cells, the geometric data are computed.
+     */
+    virtual void fill_fe_values_batch(FEValuesBatchData<dim,spacedim> &batch_data) = 0;
+
     /**
      * @brief Calculates the mapping data related to a given side, namely the
      * jacobian determinants and the normal vectors.
@@ -20,6 +20,7 @@
 #include "fem/mapping_p1.hh"
 #include "quadrature/quadrature.hh"
 #include "fem/fe_values.hh"
+#include "mesh/element_geometry_cache.hh"
 
 
 
@@ -95,12 +96,14 @@ void MappingP1<dim,spacedim>::fill_fe_values(const ElementAccessor<3> &cell,
     ASSERT_DBG( q.dim() == dim );
     ElementMap coords;
     arma::mat::fixed<spacedim,dim> jac;
-
-    if ((fv_data.update_flags & update_jacobians) |
-        (fv_data.update_flags & update_volume_elements) |
-        (fv_data.update_flags & update_JxW_values) |
-        (fv_data.update_flags & update_inverse_jacobians) |
-        (fv_data.update_flags & update_quadrature_points))
+    const ElementGeometryCache *geometry = cell.mesh()->geometry_cache();
+
+    if ((fv_data.update_flags & update_quadrature_points) ||
+        (geometry == nullptr &&
+            ((fv_data.update_flags & update_jacobians) |
+             (fv_data.update_flags & update_volume_elements) |
+             (fv_data.update_flags & update_JxW_values) |
+             (fv_data.update_flags & update_inverse_jacobians))))
     {
         coords = element_map(cell);
     }
@@ -111,7 +114,10 @@ void MappingP1<dim,spacedim>::fill_fe_values(const ElementAccessor<3> &cell,
         (fv_data.update_flags & update_JxW_values) |
         (fv_data.update_flags & update_inverse_jacobians))
     {
-        jac = coords*grad;
+        if (geometry)
+            jac = geometry->jacobian<dim>(cell.mesh_idx());
+        else
+            jac = coords*grad;
 
         // update Jacobians
         if (fv_data.update_flags & update_jacobians)
@@ -121,7 +127,7 @@ void MappingP1<dim,spacedim>::fill_fe_values(const ElementAccessor<3> &cell,
         // calculation of determinant dependent data
         if ((fv_data.update_flags & update_volume_elements) | (fv_data.update_flags & update_JxW_values))
         {
-            double det = fabs(determinant(jac));
+            double det = (geometry ? geometry->determinant(cell.mesh_idx()) : fabs(determinant(jac)));
 
             // update determinants
             if (fv_data.update_flags & update_volume_elements)
@@ -138,7 +144,11 @@ void MappingP1<dim,spacedim>::fill_fe_values(const ElementAccessor<3> &cell,
         if (fv_data.update_flags & update_inverse_jacobians)
         {
             arma::mat::fixed<dim,spacedim> ijac;
-            if (dim==spacedim)
+            if (geometry)
+            {
+                ijac = geometry->inverse_jacobian<dim>(cell.mesh_idx());
+            }
+            else if (dim==spacedim)
             {
                 ijac = inv(jac);
             }
@@ -169,12 +179,14 @@ void MappingP1<dim,spacedim>::fill_fe_side_values(const ElementAccessor<3> &cell
 {
     ASSERT_DBG( q.dim() == dim );
     ElementMap coords;
-
-    if ((fv_data.update_flags & update_jacobians) |
-        (fv_data.update_flags & update_volume_elements) |
-        (fv_data.update_flags & update_inverse_jacobians) |
-        (fv_data.update_flags & update_normal_vectors) |
-        (fv_data.update_flags & update_quadrature_points))
+    const ElementGeometryCache *geometry = cell.mesh()->geometry_cache();
+
+    if ((fv_data.update_flags & update_quadrature_points) ||
+        (geometry == nullptr &&
+            ((fv_data.update_flags & update_jacobians) |
+             (fv_data.update_flags & update_volume_elements) |
+             (fv_data.update_flags & update_inverse_jacobians) |
+             (fv_data.update_flags & update_normal_vectors))))
     {
         coords = element_map(cell);
     }
@@ -185,7 +197,11 @@ void MappingP1<dim,spacedim>::fill_fe_side_values(const ElementAccessor<3> &cell
         (fv_data.update_flags & update_inverse_jacobians) |
         (fv_data.update_flags & update_normal_vectors))
     {
-        arma::mat::fixed<spacedim,dim> jac = coords*grad;
+        arma::mat::fixed<spacedim,dim> jac;
+        if (geometry)
+            jac = geometry->jacobian<dim>(cell.mesh_idx());
+        else
+            jac = coords*grad;
 
         // update cell Jacobians
         if (fv_data.update_flags & update_jacobians)
@@ -195,7 +211,7 @@ void MappingP1<dim,spacedim>::fill_fe_side_values(const ElementAccessor<3> &cell
         // update determinants of Jacobians
         if (fv_data.update_flags & update_volume_elements)
         {
-            double det = fabs(determinant(jac));
+            double det = (geometry ? geometry->determinant(cell.mesh_idx()) : fabs(determinant(jac)));
             for (unsigned int i=0; i<q.size(); i++)
                 fv_data.determinants[i] = det;
         }
@@ -204,7 +220,11 @@ void MappingP1<dim,spacedim>::fill_fe_side_values(const ElementAccessor<3> &cell
         if (fv_data.update_flags & update_inverse_jacobians)
         {
             arma::mat::fixed<dim,spacedim> ijac;
-            if (dim==spacedim)
+            if (geometry)
+            {
+                ijac = geometry->inverse_jacobian<dim>(cell.mesh_idx());
+            }
+            else if (dim==spacedim)
             {
                 ijac = inv(jac);
             }
@@ -220,8 +240,13 @@ void MappingP1<dim,spacedim>::fill_fe_side_values(const ElementAccessor<3> &cell
             if ((fv_data.update_flags & update_normal_vectors))
             {
                 arma::vec::fixed<spacedim> n_cell;
-                n_cell = trans(ijac)*RefElement<dim>::normal_vector(sid);
-                n_cell = n_cell/norm(n_cell,2);
+                if (geometry)
+                    n_cell = geometry->normal_vector(cell.mesh_idx(), sid);
+                else
+                {
+                    n_cell = trans(ijac)*RefElement<dim>::normal_vector(sid);
+                    n_cell = n_cell/norm(n_cell,2);
+                }
                 for (unsigned int i=0; i<q.size(); i++)
                     fv_data.normal_vectors[i] = n_cell;
             }
@@ -243,6 +268,10 @@ void MappingP1<dim,spacedim>::fill_fe_side_values(const ElementAccessor<3> &cell
         {
             side_det = 1;
         }
+        else if (geometry)
+        {
+            side_det = geometry->side_determinant(cell.mesh_idx(), sid);
+        }
         else
         {
             arma::mat::fixed<spacedim,dim> side_coords;
@@ -264,6 +293,116 @@ void MappingP1<dim,spacedim>::fill_fe_side_values(const ElementAccessor<3> &cell
 }
 
 
+namespace {
+
+/// Inverse of 1D Jacobians embedded in 3D: J^+ = J^T / (J^T J).
+inline void fill_batch_inverse(FEValuesBatchData<1,3> &bd)
+{
+    for (unsigned int k=0; k<bd.n_cells; k++)
+    {
+        double g = bd.jacobians[0][0][k]*bd.jacobians[0][0][k]
+                 + bd.jacobians[1][0][k]*bd.jacobians[1][0][k]
+                 + bd.jacobians[2][0][k]*bd.jacobians[2][0][k];
+        bd.determinants[k] = sqrt(g);
+        for (unsigned int r=0; r<3; r++)
+            bd.inverse_jacobians[0][r][k] = bd.jacobians[r][0][k] / g;
+    }
+}
+
+/// Inverse of 2D Jacobians embedded in 3D: J^+ = (J^T J)^{-1} J^T.
+inline void fill_batch_inverse(FEValuesBatchData<2,3> &bd)
+{
+    for (unsigned int k=0; k<bd.n_cells; k++)
+    {
+        double g00 = 0, g01 = 0, g11 = 0;
+        for (unsigned int r=0; r<3; r++)
+        {
+            g00 += bd.jacobians[r][0][k]*bd.jacobians[r][0][k];
+            g01 += bd.jacobians[r][0][k]*bd.jacobians[r][1][k];
+            g11 += bd.jacobians[r][1][k]*bd.jacobians[r][1][k];
+        }
+        double det_g = g00*g11 - g01*g01;
+        bd.determinants[k] = sqrt(det_g);
+        for (unsigned int r=0; r<3; r++)
+        {
+            bd.inverse_jacobians[0][r][k] = ( g11*bd.jacobians[r][0][k] - g01*bd.jacobians[r][1][k]) / det_g;
+            bd.inverse_jacobians[1][r][k] = (-g01*bd.jacobians[r][0][k] + g00*bd.jacobians[r][1][k]) / det_g;
+        }
+    }
+}
+
+/// Inverse of 3D Jacobians by cofactors.
+inline void fill_batch_inverse(FEValuesBatchData<3,3> &bd)
+{
+    auto &J = bd.jacobians;
+    auto &I = bd.inverse_jacobians;
+    for (unsigned int k=0; k<bd.n_cells; k++)
+    {
+        double c00 = J[1][1][k]*J[2][2][k] - J[1][2][k]*J[2][1][k];
+        double c01 = J[1][2][k]*J[2][0][k] - J[1][0][k]*J[2][2][k];
+        double c02 = J[1][0][k]*J[2][1][k] - J[1][1][k]*J[2][0][k];
+        double det = J[0][0][k]*c00 + J[0][1][k]*c01 + J[0][2][k]*c02;
+        double inv_det = 1.0 / det;
+        bd.determinants[k] = fabs(det);
+        I[0][0][k] = c00*inv_det;
+        I[1][0][k] = c01*inv_det;
+        I[2][0][k] = c02*inv_det;
+        I[0][1][k] = (J[0][2][k]*J[2][1][k] - J[0][1][k]*J[2][2][k])*inv_det;
+        I[1][1][k] = (J[0][0][k]*J[2][2][k] - J[0][2][k]*J[2][0][k])*inv_det;
+        I[2][1][k] = (J[0][1][k]*J[2][0][k] - J[0][0][k]*J[2][1][k])*inv_det;
+        I[0][2][k] = (J[0][1][k]*J[1][2][k] - J[0][2][k]*J[1][1][k])*inv_det;
+        I[1][2][k] = (J[0][2][k]*J[1][0][k] - J[0][0][k]*J[1][2][k])*inv_det;
+        I[2][2][k] = (J[0][0][k]*J[1][1][k] - J[0][1][k]*J[1][0][k])*inv_det;
+    }
+}
+
+} // namespace
+
+
+template<unsigned int dim, unsigned int spacedim>
+void MappingP1<dim,spacedim>::fill_fe_values_batch(FEValuesBatchData<dim,spacedim> &bd)
+{
+    ASSERT_LE_DBG(bd.n_cells, bd.max_size);
+
+    // gather node coordinates of all cells
+    for (unsigned int k=0; k<bd.n_cells; k++)
+        for (unsigned int n=0; n<dim+1; n++)
+        {
+            const arma::vec3 &p = bd.cells[k].node(n)->point();
+            for (unsigned int c=0; c<spacedim; c++)
+                bd.coords[n][c][k] = p(c);
+        }
+
+    // take precomputed data of the mesh if available
+    const ElementGeometryCache *geometry = (bd.n_cells > 0 ? bd.cells[0].mesh()->geometry_cache() : nullptr);
+    if (geometry)
+    {
+        for (unsigned int k=0; k<bd.n_cells; k++)
+        {
+            unsigned int idx = bd.cells[k].mesh_idx();
+            arma::mat::fixed<spacedim,dim> jac = geometry->jacobian<dim>(idx);
+            arma::mat::fixed<dim,spacedim> ijac = geometry->inverse_jacobian<dim>(idx);
+            for (unsigned int r=0; r<spacedim; r++)
+                for (unsigned int c=0; c<dim; c++)
+                {
+                    bd.jacobians[r][c][k] = jac(r,c);
+                    bd.inverse_jacobians[c][r][k] = ijac(c,r);
+                }
+            bd.determinants[k] = geometry->determinant(idx);
+        }
+        return;
+    }
+
+    // Jacobian columns are the edges from the first node
+    for (unsigned int r=0; r<spacedim; r++)
+        for (unsigned int c=0; c<dim; c++)
+            for (unsigned int k=0; k<bd.n_cells; k++)
+                bd.jacobians[r][c][k] = bd.coords[c+1][r][k] - bd.coords[0][r][k];
+
+    fill_batch_inverse(bd);
+}
+
+
 template<unsigned int dim, unsigned int spacedim>
 auto MappingP1<dim,spacedim>::element_map(ElementAccessor<3> elm) const -> ElementMap
 {
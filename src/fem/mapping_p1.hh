@@ -32,6 +32,7 @@
 #include "mesh/elements.h"                     // for Element::side
 #include "mesh/side_impl.hh"                   // for Side::node
 template <unsigned int dim, unsigned int spacedim> class FEValuesData;
+template <unsigned int dim, unsigned int spacedim> class FEValuesBatchData;
 class Quadrature;
 
 
@@ -105,6 +106,16 @@ public:
                             MappingInternalData &data,
                             FEValuesData<dim,spacedim> &fv_data);
 
+    /**
+     * @brief Calculates Jacobians, their inverses and determinants on a batch of cells.
+     *
+     * The data are computed by explicit formulas in loops over the cells of the batch:
+     * cofactor inverse for dim=spacedim, pseudoinverse via the Gram matrix otherwise.
+     *
+     * @param batch_data Batch with filled cells.
+     */
+    void fill_fe_values_batch(FEValuesBatchData<dim,spacedim> &batch_data);
+
     /**
      * @brief Calculates the mapping data on a side of a cell.
      *
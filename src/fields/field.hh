@@ -33,6 +33,7 @@
 #include "fields/field_algo_base.impl.hh"              // for FieldAlgorithm...
 #include "fields/field_common.hh"                      // for FieldCommon::T...
 #include "fields/field_values.hh"                      // for FieldValue<>::...
+#include "fields/field_value_cache.hh"                 // for FieldValueCache
 #include "input/accessors.hh"                          // for ExcTypeMismatch
 #include "input/accessors_impl.hh"                     // for Record::opt_val
 #include "input/factory_impl.hh"                       // for Factory::create
@@ -303,6 +304,20 @@ public:
      */
     void add_factory(std::shared_ptr<FactoryBase> factory);
 
+    /**
+     * Switch on (or off) caching of values returned by @p value and @p value_list.
+     *
+     * Values evaluated in points of an element are stored and reused by following calls with the same points
+     * on the same element until the field is changed on the region of the element (see set_time).
+     * Useful for fields evaluated repeatedly in the same quadrature points, e.g. in every assembly of an unsteady problem,
+     * while the field itself is constant in time. The cache assumes that the mesh does not move.
+     * Regions with a constant field algorithm (FieldConstant) bypass the cache, reading their value directly is faster.
+     * References returned by @p value stay valid while further values are cached.
+     * Do not use it for fields which values are modified out of set_time (e.g. FieldFE with data vector
+     * updated by an equation).
+     */
+    void enable_value_cache(bool enable = true);
+
     void set_input_list(const Input::Array &list, const TimeGovernor &tg) override;
 
     /**
@@ -368,6 +383,8 @@ protected:
 
     std::vector<std::shared_ptr<FactoryBase> >  factories_;
 
+    /// Cache of field values, set only if enabled by @p enable_value_cache. Not shared among copies.
+    mutable std::shared_ptr< FieldValueCache<spacedim, Value> > value_cache_;
 
 
     template<int dim, class Val>
@@ -394,7 +411,17 @@ inline typename Value::return_type const & Field<spacedim,Value>::value(const Po
            elm.region_idx().idx(), (unsigned long int) region_fields_.size(), name().c_str());
 	OLD_ASSERT( region_fields_[elm.region_idx().idx()] ,
     		"Null field ptr on region id: %d, idx: %d, field: %s\n", elm.region().id(), elm.region_idx().idx(), name().c_str());
-    return region_fields_[elm.region_idx().idx()]->value(p,elm);
+
+    const FieldBasePtr &region_field = region_fields_[elm.region_idx().idx()];
+    // values of constant fields are cheaper to read directly
+    if (value_cache_ && region_field->field_result() < result_constant) {
+        const typename Value::return_type *cached = value_cache_->get_value(p, elm);
+        if (cached) return *cached;
+        typename Value::return_type const &val = region_field->value(p,elm);
+        value_cache_->store(p, elm, val);
+        return val;
+    }
+    return region_field->value(p,elm);
 }
 
 
@@ -409,6 +436,12 @@ inline void Field<spacedim,Value>::value_list(const std::vector< Point >  &point
 	OLD_ASSERT( region_fields_[elm.region_idx().idx()] ,
     		"Null field ptr on region id: %d, field: %s\n", elm.region().id(), name().c_str());
 
+    if (value_cache_ && region_fields_[elm.region_idx().idx()]->field_result() < result_constant) {
+        if ( value_cache_->get_values(point_list, elm, value_list) ) return;
+        region_fields_[elm.region_idx().idx()]->value_list(point_list,elm, value_list);
+        value_cache_->store(point_list, elm, value_list);
+        return;
+    }
     region_fields_[elm.region_idx().idx()]->value_list(point_list,elm, value_list);
 }
 
@@ -87,6 +87,9 @@ Field<spacedim,Value>::Field(const Field &other)
   region_fields_(other.region_fields_),
   factories_(other.factories_)
 {
+	if (other.value_cache_)
+		value_cache_ = std::make_shared< FieldValueCache<spacedim, Value> >();
+
 	if (other.no_check_control_field_)
 		no_check_control_field_ =  make_shared<ControlField>(*other.no_check_control_field_);
 
@@ -118,6 +121,9 @@ Field<spacedim,Value> &Field<spacedim,Value>::operator=(const Field<spacedim,Val
 	data_ = other.data_;
 	factories_ = other.factories_;
 	region_fields_ = other.region_fields_;
+	// keep own cache setting, values of other field can not be reused
+	if (value_cache_)
+		value_cache_ = std::make_shared< FieldValueCache<spacedim, Value> >();
 
 	if (other.no_check_control_field_) {
 		no_check_control_field_ =  make_shared<ControlField>(*other.no_check_control_field_);
@@ -299,12 +305,18 @@ bool Field<spacedim, Value>::set_time(const TimeStep &time_step, LimitSide limit
         // possibly update field pointer
 
         auto new_ptr = rh.at(i_history).second;
+        bool region_changed = false;
         if (new_ptr != region_fields_[reg.idx()]) {
             region_fields_[reg.idx()]=new_ptr;
-            set_time_result_ = TimeStatus::changed;
+            region_changed = true;
         }
         // let FieldBase implementation set the time
-        if ( new_ptr->set_time(time_step) )  set_time_result_ = TimeStatus::changed;
+        if ( new_ptr->set_time(time_step) )  region_changed = true;
+
+        if (region_changed) {
+            set_time_result_ = TimeStatus::changed;
+            if (value_cache_) value_cache_->invalidate_region(reg.idx());
+        }
 
     }
 
@@ -537,6 +549,16 @@ void Field<spacedim,Value>::add_factory(const std::shared_ptr<FactoryBase> facto
 }
 
 
+template<int spacedim, class Value>
+void Field<spacedim,Value>::enable_value_cache(bool enable) {
+	if (enable) {
+		if (!value_cache_) value_cache_ = std::make_shared< FieldValueCache<spacedim, Value> >();
+	} else {
+		value_cache_.reset();
+	}
+}
+
+
 template<int spacedim, class Value>
 typename Field<spacedim,Value>::FieldBasePtr Field<spacedim,Value>::FactoryBase::create_field(Input::Record rec, const FieldCommon &field) {
 	Input::AbstractRecord field_record;
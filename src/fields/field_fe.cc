@@ -534,6 +534,15 @@ void FieldFE<spacedim, Value>::interpolate_intersection(ElementDataCache<double>
 	Mesh *mesh;
 	if (this->boundary_domain_) mesh = dh_->mesh()->get_bc_mesh();
 	else mesh = dh_->mesh();
+
+	// nodes of zero dimensional elements are located in 3D elements of the source mesh at once
+	std::vector<arma::vec3> node_points;
+	std::vector<Mesh::PointLocation> node_locations;
+	for (auto elm : mesh->elements_range())
+		if (elm.dim() == 0) node_points.push_back( elm.node(0)->point() );
+	source_mesh->find_points(node_points, node_locations, 3);
+	unsigned int i_node_point = 0;
+
 	for (auto elm : mesh->elements_range()) {
 		if (elm.dim() == 3) {
 			xprintf(Err, "Dimension of element in target mesh must be 0, 1 or 2! elm.idx() = %d\n", elm.idx());
@@ -542,12 +551,12 @@ void FieldFE<spacedim, Value>::interpolate_intersection(ElementDataCache<double>
 		double epsilon = 4* numeric_limits<double>::epsilon() * elm.measure();
 
 		// gets suspect elements
+		searched_elements.clear();
 		if (elm.dim() == 0) {
-			searched_elements.clear();
-			source_mesh->get_bih_tree().find_point(elm.node(0)->point(), searched_elements);
+			unsigned int i_source = node_locations[i_node_point++].elem_idx;
+			if (i_source != Mesh::undef_idx) searched_elements.push_back(i_source);
 		} else {
 			BoundingBox bb = elm.bounding_box();
-			searched_elements.clear();
 			source_mesh->get_bih_tree().find_bounding_box(bb, searched_elements);
 		}
 
@@ -558,9 +567,6 @@ void FieldFE<spacedim, Value>::interpolate_intersection(ElementDataCache<double>
 		START_TIMER("compute_pressure");
 		ADD_CALLS(searched_elements.size());
 
-
-        MappingP1<3,3> mapping;
-
         for (std::vector<unsigned int>::iterator it = searched_elements.begin(); it!=searched_elements.end(); it++)
         {
             ElementAccessor<3> ele = source_mesh->element_accessor(*it);
@@ -568,13 +574,9 @@ void FieldFE<spacedim, Value>::interpolate_intersection(ElementDataCache<double>
                 // get intersection (set measure = 0 if intersection doesn't exist)
                 switch (elm.dim()) {
                     case 0: {
-                        arma::vec::fixed<3> real_point = elm.node(0)->point();
-                        arma::mat::fixed<3, 4> elm_map = mapping.element_map(ele);
-                        arma::vec::fixed<4> unit_point = mapping.project_real_to_unit(real_point, elm_map);
-
-                        measure = (std::fabs(arma::sum( unit_point )-1) <= 1e-14
-                                        && arma::min( unit_point ) >= 0)
-                                            ? 1.0 : 0.0;
+                        // the element contains the node, found by Mesh::find_points;
+                        // the node on a common face of more elements takes the value of the element with the lowest index
+                        measure = 1.0;
                         break;
                     }
                     case 1: {
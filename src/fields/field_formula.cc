@@ -19,9 +19,11 @@
 #include "fields/field_formula.hh"
 #include "fields/field_instances.hh"	// for instantiation macros
 #include "fields/surface_depth.hh"
+#include "fields/function_parser_batch.hh"
 #include "fparser.hh"
 #include "input/input_type.hh"
 #include <boost/foreach.hpp>
+#include <algorithm>
 
 /// Implementation.
 
@@ -170,6 +172,7 @@ bool FieldFormula<spacedim, Value>::set_time(const TimeStep &time) {
                 }
 
                 parser_matrix_[row][col].Optimize();
+                parser_matrix_[row][col].prepare_block_eval();
                 any_parser_changed = true;
             }
 
@@ -220,11 +223,39 @@ void FieldFormula<spacedim, Value>::value_list (const std::vector< Point >  &poi
         Value envelope(value_list[i]);
         ASSERT_EQ( envelope.n_rows(), this->value_.n_rows() )(i)(envelope.n_rows())(this->value_.n_rows())
         		.error("value_list['i'] has wrong number of rows\n");
-        auto p_depth = this->eval_depth_var(point_list[i]);
+    }
+
+    const unsigned int block_size = FunctionParserBatch::block_size;
+    const unsigned int n_vars = (has_depth_var_ ? spacedim+1 : spacedim);
+    batch_vars_.resize(n_vars * block_size);
+    batch_result_.resize(block_size);
+    double point_vars[spacedim+1];
+
+    for(unsigned int begin=0; begin < point_list.size(); begin += block_size) {
+        unsigned int n_points = std::min( block_size, (unsigned int)(point_list.size() - begin) );
+
+        // store coordinates (and depth) variable by variable
+        for(unsigned int i=0; i<n_points; i++) {
+            const Point &p = point_list[begin+i];
+            for(unsigned int j=0; j<spacedim; j++) batch_vars_[j*block_size + i] = p(j);
+            if (has_depth_var_) batch_vars_[spacedim*block_size + i] = this->eval_depth(p);
+        }
 
         for(unsigned int row=0; row < this->value_.n_rows(); row++)
             for(unsigned int col=0; col < this->value_.n_cols(); col++) {
-                envelope(row,col) = this->unit_conversion_coefficient_ * parser_matrix_[row][col].Eval(p_depth.memptr());
+                if ( parser_matrix_[row][col].eval_block(batch_vars_.data(), n_points, batch_result_.data()) ) {
+                    for(unsigned int i=0; i<n_points; i++) {
+                        Value envelope(value_list[begin+i]);
+                        envelope(row,col) = this->unit_conversion_coefficient_ * batch_result_[i];
+                    }
+                } else {
+                    // formula with conditions or evaluation error in the block, evaluate point by point
+                    for(unsigned int i=0; i<n_points; i++) {
+                        for(unsigned int j=0; j<n_vars; j++) point_vars[j] = batch_vars_[j*block_size + i];
+                        Value envelope(value_list[begin+i]);
+                        envelope(row,col) = this->unit_conversion_coefficient_ * parser_matrix_[row][col].Eval(point_vars);
+                    }
+                }
             }
     }
 }
@@ -237,13 +268,7 @@ inline arma::vec FieldFormula<spacedim, Value>::eval_depth_var(const Point &p)
 		// add value of depth
 		arma::vec p_depth(spacedim+1);
 		p_depth.subvec(0,spacedim-1) = p;
-		try {
-			p_depth(spacedim) = surface_depth_->compute_distance(p);
-		} catch (SurfaceDepth::ExcTooLargeSnapDistance &e) {
-			e << SurfaceDepth::EI_FieldTime(this->time_.end());
-			e << in_rec_.ei_address();
-			throw;
-		}
+		p_depth(spacedim) = this->eval_depth(p);
 		return p_depth;
 	} else {
 		return p;
@@ -251,6 +276,19 @@ inline arma::vec FieldFormula<spacedim, Value>::eval_depth_var(const Point &p)
 }
 
 
+template <int spacedim, class Value>
+inline double FieldFormula<spacedim, Value>::eval_depth(const Point &p)
+{
+	try {
+		return surface_depth_->compute_distance(p);
+	} catch (SurfaceDepth::ExcTooLargeSnapDistance &e) {
+		e << SurfaceDepth::EI_FieldTime(this->time_.end());
+		e << in_rec_.ei_address();
+		throw;
+	}
+}
+
+
 template <int spacedim, class Value>
 FieldFormula<spacedim, Value>::~FieldFormula() {
 }
@@ -34,7 +34,7 @@
 #include "system/exceptions.hh"         // for ExcAssertMsg::~ExcAssertMsg
 #include "tools/time_governor.hh"       // for TimeStep
 
-class FunctionParser;
+class FunctionParserBatch;
 template <int spacedim> class ElementAccessor;
 class SurfaceDepth;
 
@@ -83,6 +83,9 @@ public:
 
     /**
      * Returns std::vector of scalar values in several points at once.
+     *
+     * Points are processed in blocks of FunctionParserBatch::block_size, every formula is evaluated
+     * for the whole block at once. Formulas not supported by the block evaluation are evaluated point by point.
      */
     virtual void value_list (const std::vector< Point >  &point_list, const ElementAccessor<spacedim> &elm,
                        std::vector<typename Value::return_type>  &value_list);
@@ -100,11 +103,24 @@ private:
      */
     inline arma::vec eval_depth_var(const Point &p);
 
+    /**
+     * Compute value of depth variable in given point.
+     *
+     * Exceptions thrown by SurfaceDepth are extended by time and input address.
+     */
+    inline double eval_depth(const Point &p);
+
     // StringValue::return_type == StringTensor, which behaves like arma::mat<string>
     StringTensor formula_matrix_;
 
     // Matrix of parsers corresponding to the formula matrix returned by formula_matrix_helper_
-    std::vector< std::vector<FunctionParser> > parser_matrix_;
+    std::vector< std::vector<FunctionParserBatch> > parser_matrix_;
+
+    /// Values of variables of a block of points evaluated in value_list, variable by variable (see FunctionParserBatch::eval_block).
+    std::vector<double> batch_vars_;
+
+    /// Values of one formula in a block of points evaluated in value_list.
+    std::vector<double> batch_result_;
 
     /// Accessor to Input::Record
     Input::Record in_rec_;
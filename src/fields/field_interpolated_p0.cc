@@ -16,6 +16,8 @@
  */
 
 
+#include <exception>
+
 #include "field_interpolated_p0.hh"
 #include "fields/field_instances.hh"	// for instantiation macros
 #include "system/system.hh"
@@ -31,6 +33,10 @@
 #include "intersection/intersection_local.hh"
 #include "intersection/compute_intersection.hh"
 
+#ifdef FLOW123D_HAVE_OPENMP
+#include <omp.h>
+#endif
+
 namespace it = Input::Type;
 
 FLOW123D_FORCE_LINK_IN_CHILD(field_interpolated)
@@ -139,6 +145,172 @@ bool FieldInterpolatedP0<spacedim, Value>::set_time(const TimeStep &time) {
 
 
 
+template <int spacedim, class Value>
+void FieldInterpolatedP0<spacedim, Value>::set_mesh(const Mesh *mesh, bool boundary_domain) {
+	target_mesh_ = mesh;
+}
+
+
+
+template <int spacedim, class Value>
+void FieldInterpolatedP0<spacedim, Value>::compute_region_rows(const ElementAccessor<spacedim> &elm) {
+	START_TIMER("compute_remapping");
+	bool boundary_domain = elm.is_boundary();
+	std::vector<RemapRow> &rows = remap_rows_[boundary_domain];
+	unsigned int n_elements = target_mesh_->n_elements(boundary_domain);
+	rows.resize( std::max(n_elements, (unsigned int)rows.size()) );
+	// offset of the boundary part in the mesh element vector
+	unsigned int idx_offset = (boundary_domain ? target_mesh_->n_elements() : 0);
+
+	// elements of the region without computed rows, 3D elements are reported in value()
+	std::vector<unsigned int> region_elements;
+	for (unsigned int i_elm = 0; i_elm < n_elements; i_elm++) {
+		ElementAccessor<spacedim> ele = target_mesh_->element_accessor(idx_offset + i_elm);
+		if (ele.region_idx().idx() == elm.region_idx().idx() && ele.dim() != 3 && !rows[i_elm].computed)
+			region_elements.push_back(i_elm);
+	}
+	unsigned int n_region_elements = region_elements.size();
+	unsigned int n_threads = 1;
+#ifdef FLOW123D_HAVE_OPENMP
+	n_threads = std::max(1u, std::min(n_region_elements, target_mesh_->get_intersection_threads()));
+#endif
+
+	// every thread computes rows of a contiguous part of the elements to its own arrays, rows are relative to them
+	std::vector< std::vector<unsigned int> > thread_source(n_threads);
+	std::vector< std::vector<double> > thread_measure(n_threads);
+	std::exception_ptr thread_exception;
+#ifdef FLOW123D_HAVE_OPENMP
+	#pragma omp parallel for schedule(static) num_threads(n_threads)
+#endif
+	for (int i_thread = 0; i_thread < (int)n_threads; i_thread++) {
+		try {
+			std::vector<unsigned int> searched_elements;
+			unsigned int begin = (std::size_t)n_region_elements * i_thread / n_threads;
+			unsigned int end = (std::size_t)n_region_elements * (i_thread+1) / n_threads;
+			for (unsigned int i = begin; i < end; i++) {
+				RemapRow &row = rows[ region_elements[i] ];
+				row.begin = thread_source[i_thread].size();
+				compute_remap_row(target_mesh_->element_accessor(idx_offset + region_elements[i]),
+						thread_source[i_thread], thread_measure[i_thread], searched_elements);
+				row.end = thread_source[i_thread].size();
+			}
+		} catch (...) {
+#ifdef FLOW123D_HAVE_OPENMP
+			#pragma omp critical (remapping_exception)
+#endif
+			thread_exception = std::current_exception();
+		}
+	}
+	if (thread_exception) std::rethrow_exception(thread_exception);
+
+	// move rows to the common arrays
+	for (unsigned int i_thread = 0; i_thread < n_threads; i_thread++) {
+		unsigned int offset = remap_source_.size();
+		remap_source_.insert(remap_source_.end(), thread_source[i_thread].begin(), thread_source[i_thread].end());
+		remap_measure_.insert(remap_measure_.end(), thread_measure[i_thread].begin(), thread_measure[i_thread].end());
+		unsigned int begin = (std::size_t)n_region_elements * i_thread / n_threads;
+		unsigned int end = (std::size_t)n_region_elements * (i_thread+1) / n_threads;
+		for (unsigned int i = begin; i < end; i++) {
+			RemapRow &row = rows[ region_elements[i] ];
+			row.begin += offset;
+			row.end += offset;
+			row.computed = true;
+		}
+	}
+	END_TIMER("compute_remapping");
+}
+
+
+
+template <int spacedim, class Value>
+void FieldInterpolatedP0<spacedim, Value>::compute_remap_row(const ElementAccessor<spacedim> &elm,
+		std::vector<unsigned int> &source, std::vector<double> &measure, std::vector<unsigned int> &searched_elements) const
+{
+	double epsilon = 4* numeric_limits<double>::epsilon() * elm.measure();
+
+	// gets suspect elements
+	searched_elements.clear();
+	if (elm.dim() == 0) {
+		bih_tree_->find_point(elm.node(0)->point(), searched_elements);
+	} else {
+		BoundingBox bb = elm.bounding_box();
+		bih_tree_->find_bounding_box(bb, searched_elements);
+	}
+
+	MappingP1<3,3> mapping;
+
+	for (std::vector<unsigned int>::iterator it = searched_elements.begin(); it!=searched_elements.end(); it++)
+	{
+		ElementAccessor<3> ele = source_mesh_->element_accessor(*it);
+		if (ele->dim() == 3) {
+			double ele_measure = 0.0;
+			// get intersection (set measure = 0 if intersection doesn't exist)
+			switch (elm.dim()) {
+				case 0: {
+					arma::vec::fixed<3> real_point = elm.node(0)->point();
+					arma::mat::fixed<3, 4> elm_map = mapping.element_map(ele);
+					arma::vec::fixed<4> unit_point = mapping.project_real_to_unit(real_point, elm_map);
+
+					ele_measure = (std::fabs(arma::sum( unit_point )-1) <= 1e-14
+									&& arma::min( unit_point ) >= 0)
+										? 1.0 : 0.0;
+					break;
+				}
+				case 1: {
+					IntersectionAux<1,3> is;
+					ComputeIntersection<1,3> CI(elm, ele, source_mesh_.get());
+					CI.init();
+					CI.compute(is);
+
+					IntersectionLocal<1,3> ilc(is);
+					ele_measure = ilc.compute_measure() * elm.measure();
+					break;
+				}
+				case 2: {
+					IntersectionAux<2,3> is;
+					ComputeIntersection<2,3> CI(elm, ele, source_mesh_.get());
+					CI.init();
+					CI.compute(is);
+
+					IntersectionLocal<2,3> ilc(is);
+					ele_measure = 2 * ilc.compute_measure() * elm.measure();
+					break;
+				}
+			}
+
+			// stores only existing intersections
+			if (ele_measure > epsilon) {
+				source.push_back(*it);
+				measure.push_back(ele_measure);
+			}
+		}
+	}
+}
+
+
+
+template <int spacedim, class Value>
+auto FieldInterpolatedP0<spacedim, Value>::remap_row(const ElementAccessor<spacedim> &elm) -> const RemapRow &
+{
+	std::vector<RemapRow> &rows = remap_rows_[elm.is_boundary()];
+	if (target_mesh_ != nullptr && (rows.size() <= elm.idx() || ! rows[elm.idx()].computed))
+		compute_region_rows(elm);
+	if (rows.size() <= elm.idx()) rows.resize(elm.idx() + 1);
+	RemapRow &row = rows[elm.idx()];
+	if (! row.computed) {
+		START_TIMER("compute_pressure");
+		row.begin = remap_source_.size();
+		compute_remap_row(elm, remap_source_, remap_measure_, searched_elements_);
+		row.end = remap_source_.size();
+		row.computed = true;
+		ADD_CALLS(searched_elements_.size());
+		END_TIMER("compute_pressure");
+	}
+	return row;
+}
+
+
+
 template <int spacedim, class Value>
 typename Value::return_type const &FieldInterpolatedP0<spacedim, Value>::value(const Point &p, const ElementAccessor<spacedim> &elm)
 {
@@ -151,17 +323,7 @@ typename Value::return_type const &FieldInterpolatedP0<spacedim, Value>::value(c
 			xprintf(Err, "Dimension of element in target mesh must be 0, 1 or 2! elm.idx() = %d\n", elm.idx());
 		}
 
-		double epsilon = 4* numeric_limits<double>::epsilon() * elm.measure();
-
-		// gets suspect elements
-		if (elm.dim() == 0) {
-			searched_elements_.clear();
-			((BIHTree *)bih_tree_)->find_point(elm.node(0)->point(), searched_elements_);
-		} else {
-			BoundingBox bb = elm.bounding_box();
-			searched_elements_.clear();
-			((BIHTree *)bih_tree_)->find_bounding_box(bb, searched_elements_);
-		}
+		const RemapRow &row = remap_row(elm);
 
 		// set zero values of value_ object
 		for (unsigned int i=0; i < this->value_.n_rows(); i++) {
@@ -170,71 +332,26 @@ typename Value::return_type const &FieldInterpolatedP0<spacedim, Value>::value(c
 			}
 		}
 
-		double total_measure=0.0, measure;
+		// applies the row of the remapping matrix to the data of actual time frame
+		double total_measure=0.0;
+		std::vector<typename Value::element_type> &vec = *( data_.get() );
+		for (unsigned int i_entry = row.begin; i_entry < row.end; i_entry++)
+		{
+			double measure = remap_measure_[i_entry];
+			unsigned int index = this->value_.n_rows() * this->value_.n_cols() * remap_source_[i_entry];
+			typename Value::return_type & ret_type_value = const_cast<typename Value::return_type &>( Value::from_raw(this->r_value_,  (typename Value::element_type *)(&vec[index])) );
+			Value tmp_value = Value( ret_type_value );
 
-		START_TIMER("compute_pressure");
-		ADD_CALLS(searched_elements_.size());
-                
-                
-        MappingP1<3,3> mapping;
-                
-        for (std::vector<unsigned int>::iterator it = searched_elements_.begin(); it!=searched_elements_.end(); it++)
-        {
-            ElementAccessor<3> ele = source_mesh_->element_accessor(*it);
-            if (ele->dim() == 3) {
-                // get intersection (set measure = 0 if intersection doesn't exist)
-                switch (elm.dim()) {
-                    case 0: {
-                        arma::vec::fixed<3> real_point = elm.node(0)->point();
-                        arma::mat::fixed<3, 4> elm_map = mapping.element_map(ele);
-                        arma::vec::fixed<4> unit_point = mapping.project_real_to_unit(real_point, elm_map);
-
-                        measure = (std::fabs(arma::sum( unit_point )-1) <= 1e-14
-                                        && arma::min( unit_point ) >= 0)
-                                            ? 1.0 : 0.0;
-                        break;
-                    }
-                    case 1: {
-                        IntersectionAux<1,3> is;
-                        ComputeIntersection<1,3> CI(elm, ele, source_mesh_.get());
-                        CI.init();
-                        CI.compute(is);
-
-                        IntersectionLocal<1,3> ilc(is);
-                        measure = ilc.compute_measure() * elm.measure();
-                        break;
-                    }
-                    case 2: {
-                        IntersectionAux<2,3> is;
-                        ComputeIntersection<2,3> CI(elm, ele, source_mesh_.get());
-                        CI.init();
-                        CI.compute(is);
-
-                        IntersectionLocal<2,3> ilc(is);
-                        measure = 2 * ilc.compute_measure() * elm.measure();
-                        break;
-                    }
-                }
-
-				//adds values to value_ object if intersection exists
-				if (measure > epsilon) {
-					unsigned int index = this->value_.n_rows() * this->value_.n_cols() * (*it);
-			        std::vector<typename Value::element_type> &vec = *( data_.get() );
-			        typename Value::return_type & ret_type_value = const_cast<typename Value::return_type &>( Value::from_raw(this->r_value_,  (typename Value::element_type *)(&vec[index])) );
-					Value tmp_value = Value( ret_type_value );
-
-					for (unsigned int i=0; i < this->value_.n_rows(); i++) {
-						for (unsigned int j=0; j < this->value_.n_cols(); j++) {
-							this->value_(i,j) += tmp_value(i,j) * measure;
-						}
-					}
-					total_measure += measure;
+			for (unsigned int i=0; i < this->value_.n_rows(); i++) {
+				for (unsigned int j=0; j < this->value_.n_cols(); j++) {
+					this->value_(i,j) += tmp_value(i,j) * measure;
 				}
 			}
+			total_measure += measure;
 		}
-                
+
 		// computes weighted average
-		if (total_measure > epsilon) {
+		if (row.end > row.begin) {
 			for (unsigned int i=0; i < this->value_.n_rows(); i++) {
 				for (unsigned int j=0; j < this->value_.n_cols(); j++) {
 					this->value_(i,j) /= total_measure;
@@ -243,7 +360,6 @@ typename Value::return_type const &FieldInterpolatedP0<spacedim, Value>::value(c
 		} else {
 			WarningOut().fmt("Processed element with idx {} is out of source mesh!\n", elm.idx());
 		}
-		END_TIMER("compute_pressure");
 
 	}
     return this->r_value_;
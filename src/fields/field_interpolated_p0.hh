@@ -67,6 +67,12 @@ public:
      */
     bool set_time(const TimeStep &time) override;
 
+    /**
+     * Set the target mesh. Rows of the remapping matrix are then computed for all elements of a region
+     * at once, at the first evaluation of an element of the region.
+     */
+    void set_mesh(const Mesh *mesh, bool boundary_domain) override;
+
     /**
      * Returns one value in one given point. ResultType can be used to avoid some costly calculation if the result is trivial.
      */
@@ -79,9 +85,43 @@ public:
                        std::vector<typename Value::return_type>  &value_list);
 
 protected:
+    /**
+     * Row of the remapping matrix: measures of intersections of a target element with the source elements.
+     * Value on the target element is the average of source values weighted by the measures.
+     */
+    struct RemapRow {
+        /// Range of the row in @p remap_source_ and @p remap_measure_.
+        unsigned int begin = 0, end = 0;
+        /// False until the row is computed.
+        bool computed = false;
+    };
+
+    /**
+     * Computes the row of the remapping matrix for the target element @p elm, appends source elements
+     * and measures of their intersections with @p elm to @p source and @p measure.
+     * Method does not change the object, so rows can be computed by more threads at once.
+     */
+    void compute_remap_row(const ElementAccessor<spacedim> &elm, std::vector<unsigned int> &source,
+            std::vector<double> &measure, std::vector<unsigned int> &searched_elements) const;
+
+    /**
+     * Computes rows of the remapping matrix of all elements of the target mesh in the region of @p elm,
+     * possibly by more threads (given by the key 'intersection_threads' of the mesh).
+     */
+    void compute_region_rows(const ElementAccessor<spacedim> &elm);
+
+    /**
+     * Returns row of the remapping matrix of target element @p elm, computes it at first call
+     * (together with rows of its region if the target mesh is set).
+     */
+    const RemapRow &remap_row(const ElementAccessor<spacedim> &elm);
+
     /// mesh, which is interpolated
 	std::shared_ptr<Mesh> source_mesh_;
 
+	/// target mesh given by set_mesh, rows of the remapping matrix are computed by regions if set
+	const Mesh *target_mesh_ = nullptr;
+
 	/// mesh reader file
 	FilePath reader_file_;
 
@@ -97,6 +137,18 @@ protected:
 	/// tree of mesh elements
 	BIHTree* bih_tree_;
 
+	/**
+	 * Rows of the remapping matrix of bulk (0) and boundary (1) target elements indexed by ElementAccessor::idx().
+	 * The geometry does not change in time, so the matrix is computed once and applied to the data of every time frame.
+	 */
+	std::vector<RemapRow> remap_rows_[2];
+
+	/// Source elements of all rows of the remapping matrix.
+	std::vector<unsigned int> remap_source_;
+
+	/// Measures of intersections of all rows of the remapping matrix.
+	std::vector<double> remap_measure_;
+
 	/// stored index to last computed element
 	unsigned int computed_elm_idx_ = numeric_limits<unsigned int>::max();
 
@@ -0,0 +1,201 @@
+/*!
+ *
+﻿ * Copyright (C) 2015 Technical University of Liberec.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License version 3 as published by the
+ * Free Software Foundation. (http://www.gnu.org/licenses/gpl-3.0.en.html)
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *
+ * @file    field_value_cache.hh
+ * @brief   Cache of field values in element points, valid until the field is changed.
+ */
+
+#ifndef FIELD_VALUE_CACHE_HH_
+#define FIELD_VALUE_CACHE_HH_
+
+#include <vector>
+#include <deque>
+#include "fields/field_values.hh"
+#include "mesh/accessors.hh"
+#include "mesh/point.hh"
+
+
+/**
+ * @brief Cache of field values evaluated in points of elements.
+ *
+ * The cache is used by Field<spacedim,Value> (see Field::enable_value_cache) to avoid repeated evaluation
+ * of region fields, that do not change between calls of set_time (FieldConstant, FieldFE, time independent FieldFormula, ...).
+ *
+ * Every element can store up to @p max_point_sets sets of points (e.g. quadrature points of the element and of its sides).
+ * Stored values of a point set are used only if the set of points is exactly same as the stored one, so caller
+ * need not to identify the point set (quadrature) explicitly. Values and points of all elements are stored in
+ * deques, so new point sets do not move the stored values and references returned by Field::value stay valid.
+ * Stale values are overwritten in place.
+ *
+ * Values are invalidated per region by @p invalidate_region, Field calls it from set_time for every region
+ * where the field algorithm was replaced or reports a change.
+ */
+template <int spacedim, class Value>
+class FieldValueCache {
+public:
+    typedef typename Space<spacedim>::Point Point;
+    typedef typename Value::return_type ReturnType;
+
+    /// Maximal number of point sets cached for one element.
+    static const unsigned int max_point_sets = 8;
+
+    FieldValueCache()
+    {}
+
+    /// Invalidate values of all elements in the region with index @p region_idx.
+    inline void invalidate_region(unsigned int region_idx) {
+        if (region_idx >= region_generation_.size()) region_generation_.resize(region_idx+1, 0);
+        region_generation_[region_idx]++;
+    }
+
+    /// Invalidate all values, keep allocated memory.
+    void invalidate() {
+        for (auto &gen : region_generation_) gen++;
+    }
+
+    /// Release all stored values.
+    void clear() {
+        element_sets_.clear();
+        points_.clear();
+        values_.clear();
+        region_generation_.clear();
+    }
+
+    /**
+     * Find point set @p point_list of element @p elm. Return index of its first value in @p values_
+     * or -1 if the values of the point set are not stored or are invalidated.
+     */
+    inline int find(const std::vector<Point> &point_list, const ElementAccessor<spacedim> &elm) const {
+        if (elm.is_regional() || elm.mesh_idx() >= element_sets_.size()) return -1;
+        unsigned int generation = this->region_generation(elm.region_idx().idx());
+        for (const PointSet &set : element_sets_[elm.mesh_idx()]) {
+            if (set.generation == generation && same_points(set, point_list)) return set.begin;
+        }
+        return -1;
+    }
+
+    /**
+     * Fill @p value_list by cached values of point set @p point_list on element @p elm.
+     * Return false if values are not cached.
+     */
+    inline bool get_values(const std::vector<Point> &point_list, const ElementAccessor<spacedim> &elm,
+            std::vector<ReturnType> &value_list) const {
+        int begin = this->find(point_list, elm);
+        if (begin < 0) return false;
+        for (unsigned int i=0; i<point_list.size(); i++) value_list[i] = values_[begin+i];
+        return true;
+    }
+
+    /**
+     * Return pointer to cached value in single point @p p on element @p elm or NULL.
+     * Pointer is valid until @p clear, the value is overwritten only if the region is invalidated.
+     */
+    inline const ReturnType *get_value(const Point &p, const ElementAccessor<spacedim> &elm) const {
+        if (elm.is_regional() || elm.mesh_idx() >= element_sets_.size()) return nullptr;
+        unsigned int generation = this->region_generation(elm.region_idx().idx());
+        for (const PointSet &set : element_sets_[elm.mesh_idx()]) {
+            if (set.generation == generation && set.n_points == 1 && same_point(points_[set.begin], p))
+                return &(values_[set.begin]);
+        }
+        return nullptr;
+    }
+
+    /**
+     * Store values @p value_list of point set @p point_list on element @p elm.
+     * Stale values of the same point set are overwritten. If the element has already @p max_point_sets
+     * point sets, the values are not stored.
+     */
+    void store(const std::vector<Point> &point_list, const ElementAccessor<spacedim> &elm,
+            const std::vector<ReturnType> &value_list) {
+        if (elm.is_regional()) return;
+        if (elm.mesh_idx() >= element_sets_.size()) element_sets_.resize(elm.mesh_idx()+1);
+        PointSet *set = this->find_or_append(point_list, elm);
+        if (set == nullptr) return;
+        for (unsigned int i=0; i<point_list.size(); i++) values_[set->begin+i] = value_list[i];
+    }
+
+    /// Same as previous, stores value @p value in single point @p p.
+    void store(const Point &p, const ElementAccessor<spacedim> &elm, const ReturnType &value) {
+        single_point_[0] = p;
+        single_value_[0] = value;
+        this->store(single_point_, elm, single_value_);
+    }
+
+private:
+    /// Point set of one element.
+    struct PointSet {
+        /// Index of the first point (and value) in @p points_ and @p values_.
+        unsigned int begin;
+        /// Number of points.
+        unsigned int n_points;
+        /// Generation of the region at time of storing the values.
+        unsigned int generation;
+    };
+
+    inline unsigned int region_generation(unsigned int region_idx) const {
+        return (region_idx < region_generation_.size()) ? region_generation_[region_idx] : 0;
+    }
+
+    inline static bool same_point(const Point &a, const Point &b) {
+        for (unsigned int j=0; j<spacedim; j++)
+            if (a[j] != b[j]) return false;
+        return true;
+    }
+
+    inline bool same_points(const PointSet &set, const std::vector<Point> &point_list) const {
+        if (set.n_points != point_list.size()) return false;
+        for (unsigned int i=0; i<set.n_points; i++)
+            if (! same_point(points_[set.begin+i], point_list[i])) return false;
+        return true;
+    }
+
+    /// Return point set with same points (possibly stale) or append a new one.
+    PointSet *find_or_append(const std::vector<Point> &point_list, const ElementAccessor<spacedim> &elm) {
+        std::vector<PointSet> &sets = element_sets_[elm.mesh_idx()];
+        unsigned int generation = this->region_generation(elm.region_idx().idx());
+        for (PointSet &set : sets)
+            if (same_points(set, point_list)) {
+                set.generation = generation;
+                return &set;
+            }
+        if (sets.size() >= max_point_sets) return nullptr;
+
+        PointSet set;
+        set.begin = points_.size();
+        set.n_points = point_list.size();
+        set.generation = generation;
+        points_.insert(points_.end(), point_list.begin(), point_list.end());
+        values_.resize(points_.size());
+        sets.push_back(set);
+        return &(sets.back());
+    }
+
+    /// Point sets of individual elements, indexed by mesh_idx of the element.
+    std::vector< std::vector<PointSet> > element_sets_;
+
+    /// Points of all point sets.
+    std::deque<Point> points_;
+
+    /// Values in points @p points_. Appending does not invalidate references to stored values.
+    std::deque<ReturnType> values_;
+
+    /// Generation of values of individual regions, incremented by invalidation.
+    std::vector<unsigned int> region_generation_;
+
+    /// Helper vectors for single point values.
+    std::vector<Point> single_point_ = std::vector<Point>(1);
+    std::vector<ReturnType> single_value_ = std::vector<ReturnType>(1);
+};
+
+
+#endif /* FIELD_VALUE_CACHE_HH_ */
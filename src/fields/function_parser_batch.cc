@@ -0,0 +1,296 @@
+/*!
+ *
+﻿ * Copyright (C) 2015 Technical University of Liberec.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License version 3 as published by the
+ * Free Software Foundation. (http://www.gnu.org/licenses/gpl-3.0.en.html)
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *
+ * @file    function_parser_batch.cc
+ * @brief   Evaluation of FunctionParser bytecode in blocks of points.
+ */
+
+#include <algorithm>
+#include "fields/function_parser_batch.hh"
+#include "system/asserts.hh"
+
+// internal types of the parser: parser data, opcodes and elementary functions used by Eval
+#include "extrasrc/fptypes.hh"
+#include "extrasrc/fpaux.hh"
+
+using namespace FUNCTIONPARSERTYPES;
+
+/// Apply unary operation @p op on the block @p a of size @p n in place.
+template <class Op>
+inline static void block_unary(double *a, unsigned int n, Op op)
+{
+    for (unsigned int i=0; i<n; ++i) a[i] = op(a[i]);
+}
+
+/// Apply binary operation @p op on blocks @p a, @p b of size @p n, result is stored into @p a.
+template <class Op>
+inline static void block_binary(double *a, const double *b, unsigned int n, Op op)
+{
+    for (unsigned int i=0; i<n; ++i) a[i] = op(a[i], b[i]);
+}
+
+/// Return true if @p cond is true for any value of block @p a of size @p n.
+template <class Cond>
+inline static bool block_any(const double *a, unsigned int n, Cond cond)
+{
+    bool result = false;
+    for (unsigned int i=0; i<n; ++i) result = result || cond(a[i]);
+    return result;
+}
+
+
+
+FunctionParserBatch::FunctionParserBatch()
+: FunctionParser(),
+  block_eval_supported_(false)
+{}
+
+
+
+bool FunctionParserBatch::prepare_block_eval()
+{
+    Data *data = this->getParserData();
+    block_eval_supported_ = false;
+    if (data->mParseErrorType != FP_NO_ERROR) return false;
+
+    const std::vector<unsigned> &byte_code = data->mByteCode;
+    for (unsigned int ip=0; ip < byte_code.size(); ++ip) {
+        switch (byte_code[ip]) {
+            // conditional evaluation, function calls and complex functions are not supported
+            case cIf: case cAbsIf: case cJump:
+            case cFCall: case cPCall:
+            case cArg: case cConj: case cImag: case cReal: case cPolar:
+                return false;
+            // skip operands of instructions
+            case cFetch:
+                ip += 1;
+                break;
+#ifdef FP_SUPPORT_OPTIMIZER
+            case cPopNMov:
+                ip += 2;
+                break;
+#endif
+            default:
+                break;
+        }
+    }
+
+    stack_.resize( std::max(data->mStackSize, 1u) * block_size );
+    block_eval_supported_ = true;
+    return true;
+}
+
+
+
+bool FunctionParserBatch::eval_block(const double *vars, unsigned int n, double *result)
+{
+    ASSERT_LE_DBG(n, block_size);
+    if (!block_eval_supported_) return false;
+
+    Data *data = this->getParserData();
+    const unsigned* const byte_code = &(data->mByteCode[0]);
+    const double* const immed = data->mImmed.empty() ? 0 : &(data->mImmed[0]);
+    const unsigned byte_code_size = unsigned(data->mByteCode.size());
+    unsigned int dp = 0;
+    int sp = -1;
+
+    for (unsigned int ip=0; ip < byte_code_size; ++ip)
+    {
+        double *top = (sp >= 0) ? stack_entry(sp) : nullptr;
+        double *below = (sp >= 1) ? stack_entry(sp-1) : nullptr;
+
+        switch (byte_code[ip])
+        {
+// Functions:
+            case cAbs:   block_unary(top, n, [](double x) { return fp_abs(x); }); break;
+            case cAcos:
+                if (block_any(top, n, [](double x) { return x < -1.0 || x > 1.0; })) return false;
+                block_unary(top, n, [](double x) { return fp_acos(x); }); break;
+            case cAcosh:
+                if (block_any(top, n, [](double x) { return x < 1.0; })) return false;
+                block_unary(top, n, [](double x) { return fp_acosh(x); }); break;
+            case cAsin:
+                if (block_any(top, n, [](double x) { return x < -1.0 || x > 1.0; })) return false;
+                block_unary(top, n, [](double x) { return fp_asin(x); }); break;
+            case cAsinh: block_unary(top, n, [](double x) { return fp_asinh(x); }); break;
+            case cAtan:  block_unary(top, n, [](double x) { return fp_atan(x); }); break;
+            case cAtan2: block_binary(below, top, n, [](double x, double y) { return fp_atan2(x, y); }); --sp; break;
+            case cAtanh:
+                if (block_any(top, n, [](double x) { return x <= -1.0 || x >= 1.0; })) return false;
+                block_unary(top, n, [](double x) { return fp_atanh(x); }); break;
+            case cCbrt:  block_unary(top, n, [](double x) { return fp_cbrt(x); }); break;
+            case cCeil:  block_unary(top, n, [](double x) { return fp_ceil(x); }); break;
+            case cCos:   block_unary(top, n, [](double x) { return fp_cos(x); }); break;
+            case cCosh:  block_unary(top, n, [](double x) { return fp_cosh(x); }); break;
+            case cCot:
+                block_unary(top, n, [](double x) { return fp_tan(x); });
+                if (block_any(top, n, [](double x) { return x == 0.0; })) return false;
+                block_unary(top, n, [](double x) { return 1.0 / x; }); break;
+            case cCsc:
+                block_unary(top, n, [](double x) { return fp_sin(x); });
+                if (block_any(top, n, [](double x) { return x == 0.0; })) return false;
+                block_unary(top, n, [](double x) { return 1.0 / x; }); break;
+            case cExp:   block_unary(top, n, [](double x) { return fp_exp(x); }); break;
+            case cExp2:  block_unary(top, n, [](double x) { return fp_exp2(x); }); break;
+            case cFloor: block_unary(top, n, [](double x) { return fp_floor(x); }); break;
+            case cHypot: block_binary(below, top, n, [](double x, double y) { return fp_hypot(x, y); }); --sp; break;
+            case cInt:   block_unary(top, n, [](double x) { return fp_int(x); }); break;
+            case cLog:
+                if (block_any(top, n, [](double x) { return !(x > 0.0); })) return false;
+                block_unary(top, n, [](double x) { return fp_log(x); }); break;
+            case cLog10:
+                if (block_any(top, n, [](double x) { return !(x > 0.0); })) return false;
+                block_unary(top, n, [](double x) { return fp_log10(x); }); break;
+            case cLog2:
+                if (block_any(top, n, [](double x) { return !(x > 0.0); })) return false;
+                block_unary(top, n, [](double x) { return fp_log2(x); }); break;
+            case cMax:   block_binary(below, top, n, [](double x, double y) { return fp_max(x, y); }); --sp; break;
+            case cMin:   block_binary(below, top, n, [](double x, double y) { return fp_min(x, y); }); --sp; break;
+            case cPow:
+                for (unsigned int i=0; i<n; ++i)
+                    if (below[i] == 0.0 && top[i] < 0.0) return false;
+                block_binary(below, top, n, [](double x, double y) { return fp_pow(x, y); }); --sp; break;
+            case cTrunc: block_unary(top, n, [](double x) { return fp_trunc(x); }); break;
+            case cSec:
+                block_unary(top, n, [](double x) { return fp_cos(x); });
+                if (block_any(top, n, [](double x) { return x == 0.0; })) return false;
+                block_unary(top, n, [](double x) { return 1.0 / x; }); break;
+            case cSin:   block_unary(top, n, [](double x) { return fp_sin(x); }); break;
+            case cSinh:  block_unary(top, n, [](double x) { return fp_sinh(x); }); break;
+            case cSqrt:
+                if (block_any(top, n, [](double x) { return x < 0.0; })) return false;
+                block_unary(top, n, [](double x) { return fp_sqrt(x); }); break;
+            case cTan:   block_unary(top, n, [](double x) { return fp_tan(x); }); break;
+            case cTanh:  block_unary(top, n, [](double x) { return fp_tanh(x); }); break;
+
+// Misc:
+            case cImmed:
+            {
+                double *dest = stack_entry(++sp);
+                const double val = immed[dp++];
+                for (unsigned int i=0; i<n; ++i) dest[i] = val;
+                break;
+            }
+
+// Operators:
+            case cNeg:   block_unary(top, n, [](double x) { return -x; }); break;
+            case cAdd:   block_binary(below, top, n, [](double x, double y) { return x + y; }); --sp; break;
+            case cSub:   block_binary(below, top, n, [](double x, double y) { return x - y; }); --sp; break;
+            case cMul:   block_binary(below, top, n, [](double x, double y) { return x * y; }); --sp; break;
+            case cDiv:
+                if (block_any(top, n, [](double x) { return x == 0.0; })) return false;
+                block_binary(below, top, n, [](double x, double y) { return x / y; }); --sp; break;
+            case cMod:
+                if (block_any(top, n, [](double x) { return x == 0.0; })) return false;
+                block_binary(below, top, n, [](double x, double y) { return fp_mod(x, y); }); --sp; break;
+            case cEqual:
+                block_binary(below, top, n, [](double x, double y) { return double(fp_equal(x, y)); }); --sp; break;
+            case cNEqual:
+                block_binary(below, top, n, [](double x, double y) { return double(fp_nequal(x, y)); }); --sp; break;
+            case cLess:
+                block_binary(below, top, n, [](double x, double y) { return double(fp_less(x, y)); }); --sp; break;
+            case cLessOrEq:
+                block_binary(below, top, n, [](double x, double y) { return double(fp_lessOrEq(x, y)); }); --sp; break;
+            case cGreater:
+                block_binary(below, top, n, [](double x, double y) { return double(fp_less(y, x)); }); --sp; break;
+            case cGreaterOrEq:
+                block_binary(below, top, n, [](double x, double y) { return double(fp_lessOrEq(y, x)); }); --sp; break;
+            case cNot:    block_unary(top, n, [](double x) { return fp_not(x); }); break;
+            case cNotNot: block_unary(top, n, [](double x) { return fp_notNot(x); }); break;
+            case cAnd:   block_binary(below, top, n, [](double x, double y) { return fp_and(x, y); }); --sp; break;
+            case cOr:    block_binary(below, top, n, [](double x, double y) { return fp_or(x, y); }); --sp; break;
+
+// Degrees-radians conversion:
+            case cDeg:   block_unary(top, n, [](double x) { return RadiansToDegrees(x); }); break;
+            case cRad:   block_unary(top, n, [](double x) { return DegreesToRadians(x); }); break;
+
+            case cFetch:
+            {
+                const double *src = stack_entry(byte_code[++ip]);
+                double *dest = stack_entry(++sp);
+                for (unsigned int i=0; i<n; ++i) dest[i] = src[i];
+                break;
+            }
+#ifdef FP_SUPPORT_OPTIMIZER
+            case cPopNMov:
+            {
+                const unsigned target = byte_code[++ip];
+                const unsigned source = byte_code[++ip];
+                double *dest = stack_entry(target);
+                const double *src = stack_entry(source);
+                for (unsigned int i=0; i<n; ++i) dest[i] = src[i];
+                sp = target;
+                break;
+            }
+            case cLog2by:
+                if (block_any(below, n, [](double x) { return !(x > 0.0); })) return false;
+                block_binary(below, top, n, [](double x, double y) { return fp_log2(x) * y; }); --sp; break;
+            case cNop: break;
+#endif // FP_SUPPORT_OPTIMIZER
+
+            case cSinCos:
+            {
+                double *next = stack_entry(sp+1);
+                for (unsigned int i=0; i<n; ++i) fp_sinCos(top[i], next[i], top[i]);
+                ++sp;
+                break;
+            }
+            case cSinhCosh:
+            {
+                double *next = stack_entry(sp+1);
+                for (unsigned int i=0; i<n; ++i) fp_sinhCosh(top[i], next[i], top[i]);
+                ++sp;
+                break;
+            }
+
+            case cAbsNot:    block_unary(top, n, [](double x) { return fp_absNot(x); }); break;
+            case cAbsNotNot: block_unary(top, n, [](double x) { return fp_absNotNot(x); }); break;
+            case cAbsAnd: block_binary(below, top, n, [](double x, double y) { return fp_absAnd(x, y); }); --sp; break;
+            case cAbsOr:  block_binary(below, top, n, [](double x, double y) { return fp_absOr(x, y); }); --sp; break;
+
+            case cDup:
+            {
+                double *next = stack_entry(sp+1);
+                for (unsigned int i=0; i<n; ++i) next[i] = top[i];
+                ++sp;
+                break;
+            }
+            case cInv:
+                if (block_any(top, n, [](double x) { return x == 0.0; })) return false;
+                block_unary(top, n, [](double x) { return 1.0 / x; }); break;
+            case cSqr:   block_unary(top, n, [](double x) { return x * x; }); break;
+            case cRDiv:
+                if (block_any(below, n, [](double x) { return x == 0.0; })) return false;
+                block_binary(below, top, n, [](double x, double y) { return y / x; }); --sp; break;
+            case cRSub:  block_binary(below, top, n, [](double x, double y) { return y - x; }); --sp; break;
+            case cRSqrt:
+                if (block_any(top, n, [](double x) { return x == 0.0; })) return false;
+                block_unary(top, n, [](double x) { return 1.0 / fp_sqrt(x); }); break;
+
+// Variables:
+            default:
+            {
+                const unsigned int var = byte_code[ip] - VarBegin;
+                // unsupported instructions are rejected by prepare_block_eval
+                ASSERT_LT_DBG(var, data->mVariablesAmount);
+                const double *src = vars + var * block_size;
+                double *dest = stack_entry(++sp);
+                for (unsigned int i=0; i<n; ++i) dest[i] = src[i];
+            }
+        }
+    }
+
+    const double *top = stack_entry(sp);
+    for (unsigned int i=0; i<n; ++i) result[i] = top[i];
+    return true;
+}
@@ -0,0 +1,75 @@
+/*!
+ *
+﻿ * Copyright (C) 2015 Technical University of Liberec.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License version 3 as published by the
+ * Free Software Foundation. (http://www.gnu.org/licenses/gpl-3.0.en.html)
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *
+ * @file    function_parser_batch.hh
+ * @brief   Evaluation of FunctionParser bytecode in blocks of points.
+ */
+
+#ifndef FUNCTION_PARSER_BATCH_HH_
+#define FUNCTION_PARSER_BATCH_HH_
+
+#include <vector>
+#include "fparser.hh"
+
+
+/**
+ * FunctionParser extended by evaluation of the parsed function in a block of points at once.
+ *
+ * The bytecode produced by the parser (and its optimizer) is interpreted instruction by instruction,
+ * every instruction is applied to the whole block of points. Values of variables and the evaluation stack
+ * are stored in the structure-of-arrays form, so the inner loops are simple and can be vectorized by the compiler.
+ * The interpretation overhead (decoding of instructions) is paid once per block instead of once per point.
+ *
+ * Bytecode containing conditional jumps (if(), shortcut evaluation of logical operators) or user defined functions
+ * is not supported by the block evaluation. Such functions, as well as blocks where an evaluation error
+ * (e.g. division by zero) occurs in some point, have to be evaluated point by point using the Eval method.
+ * The block evaluation uses same elementary functions as Eval, so both give identical results.
+ */
+class FunctionParserBatch : public FunctionParser
+{
+public:
+    /// Maximal number of points evaluated at once.
+    static const unsigned int block_size = 64;
+
+    FunctionParserBatch();
+
+    /**
+     * Check the bytecode and prepare evaluation stack. Must be called after every call of Parse or Optimize.
+     * Returns true if the parsed function can be evaluated by @p eval_block.
+     */
+    bool prepare_block_eval();
+
+    /**
+     * Evaluate the function in @p n_points points (at most @p block_size).
+     *
+     * Values of variables are given in @p vars, value of i-th variable (in the order given to Parse)
+     * in j-th point is vars[i*block_size + j]. Function values are stored into @p result.
+     * Returns false if the function can not be evaluated in the block (see class description),
+     * then the content of @p result is undefined.
+     */
+    bool eval_block(const double *vars, unsigned int n_points, double *result);
+
+private:
+    /// Pointer to the stack entry @p sp (block of values).
+    inline double *stack_entry(int sp)
+    { return &(stack_[sp * block_size]); }
+
+    /// True if the bytecode contains only instructions supported by @p eval_block.
+    bool block_eval_supported_;
+
+    /// Evaluation stack, every entry is block of @p block_size values.
+    std::vector<double> stack_;
+};
+
+
+#endif /* FUNCTION_PARSER_BATCH_HH_ */
@@ -82,12 +82,8 @@ public:
             double water_content = 0;
             double phead = ad_->phead_edge_[ele.edge_local_idx(i)];
             if (genuchten_on) {
-
-                  fadbad::B<double> x_phead(phead);
-                  fadbad::B<double> evaluated( soil_model->water_content_diff(x_phead) );
-                  evaluated.diff(0,1);
-                  water_content = evaluated.val();
-                  capacity = x_phead.d(0);
+                  water_content = soil_model->water_content(phead);
+                  capacity = soil_model->water_content_derivative(phead);
             }
             ad_->capacity[ele.side_local_idx(i)] = capacity + storativity;
             ad_->water_content_previous_it[ele.side_local_idx(i)] = water_content + storativity * phead;
@@ -119,6 +115,60 @@ public:
 
         double scale = 1 / cross_section / conductivity;
         this->assemble_sides_scale(ele,scale);
+
+        if (genuchten_on && ad_->newton_jacobian) assemble_conductivity_jacobian(ele, conductivity);
+    }
+
+    /***
+     * Newton method: add derivative of the flux equations with respect to the edge pressure heads
+     * through the element conductivity (mean of conductivities in the edges).
+     * The term is added to the matrix as well as applied to the previous iterate on the RHS,
+     * so the residual of the system is the same as for the Picard linearization.
+     * Called from assemble_sides, assumes the sides block of the local matrix is assembled.
+     */
+    void assemble_conductivity_jacobian(LocalElementAccessorBase<3> ele, double conductivity)
+    {
+        unsigned int n_sides = ele.n_sides();
+        const arma::mat &local_matrix = this->loc_system_.get_matrix();
+        double * solution = ad_->lin_sys->get_solution_array();
+
+        arma::mat sides_matrix(n_sides, n_sides);
+        arma::vec flux(n_sides), phead(n_sides);
+        for (unsigned int i=0; i<n_sides; i++) {
+            flux[i] = solution[ele.side_local_row(i)];
+            phead[i] = ad_->phead_edge_[ele.edge_local_idx(i)];
+            for (unsigned int k=0; k<n_sides; k++)
+                sides_matrix(i,k) = local_matrix(this->loc_side_dofs[i], this->loc_side_dofs[k]);
+        }
+        arma::mat jacobian = conductivity_jacobian(sides_matrix, flux, phead, *soil_model, conductivity);
+
+        for (unsigned int j=0; j<n_sides; j++) {
+            // no dependence on the prescribed pressure
+            if (this->dirichlet_edge[j] == 1) continue;
+            for (unsigned int i=0; i<n_sides; i++) {
+                if (jacobian(i,j) == 0.0) continue;
+                this->loc_system_.add_value(this->loc_side_dofs[i], this->loc_edge_dofs[j],
+                                            jacobian(i,j), jacobian(i,j) * phead[j]);
+            }
+        }
+    }
+
+    /**
+     * Derivatives of the flux equations (@p sides_matrix times @p flux) with respect to the edge pressure heads @p phead.
+     * The sides matrix is scaled by the inverse of @p conductivity, the mean of the soil model conductivities in the edges,
+     * so d(scale)/d(phead_j) = - scale * K'(phead_j) / (n_sides * K).
+     */
+    static arma::mat conductivity_jacobian(const arma::mat &sides_matrix, const arma::vec &flux, const arma::vec &phead,
+            const SoilModelBase &soil_model, double conductivity)
+    {
+        unsigned int n_sides = flux.n_elem;
+        arma::vec m_flux = sides_matrix * flux;
+        arma::mat jacobian(n_sides, n_sides);
+        for (unsigned int j=0; j<n_sides; j++) {
+            double d_scale = - soil_model.conductivity_derivative(phead[j]) / (n_sides * conductivity);
+            jacobian.col(j) = d_scale * m_flux;
+        }
+        return jacobian;
     }
 
     /***
@@ -30,6 +30,177 @@
 #include "coupling/balance.hh"
 #include "flow/mortar_assembly.hh"
 
+#include <array>
+
+
+/**
+ * Output of the local assembly of a batch of elements performed by a single thread.
+ *
+ * In the threaded assembly (see DarcyMH::assembly_mh_matrix_threaded) the assemblers do not write
+ * into the global linear system and balance directly, they store local systems and boundary fluxes
+ * into the buffer instead. The buffers are passed to the global objects by @p flush
+ * in the element order, so the result is the same as for the serial assembly.
+ */
+class AssemblyBuffer
+{
+public:
+    AssemblyBuffer()
+    : n_local_systems_(0),
+      nonlinear_bc_(false)
+    {}
+
+    /// Forget all stored items, keep allocated local systems for reuse.
+    void clear()
+    {
+        n_local_systems_ = 0;
+        balance_sides_.clear();
+        balance_rows_.clear();
+        nonlinear_bc_ = false;
+    }
+
+    /// Store copy of the local system.
+    void add_local_system(const LocalSystem &loc_system)
+    {
+        if (n_local_systems_ == local_systems_.size())
+            local_systems_.push_back(loc_system);
+        else
+            local_systems_[n_local_systems_] = loc_system;
+        n_local_systems_++;
+    }
+
+    /// Store boundary flux of the side @p side given by the global row @p side_row.
+    void add_balance_flux(SideIter side, LongIdx side_row)
+    {
+        balance_sides_.push_back(side);
+        balance_rows_.push_back(side_row);
+    }
+
+    /// Mark that a nonlinear (seepage or river) boundary condition was assembled.
+    void set_nonlinear_bc()
+    { nonlinear_bc_ = true; }
+
+    /// True if a nonlinear boundary condition was assembled since the last @p clear.
+    bool nonlinear_bc() const
+    { return nonlinear_bc_; }
+
+    /// Pass all stored items into the linear system @p ls and balance @p balance (can be null).
+    void flush(LinSys *ls, std::shared_ptr<Balance> balance, unsigned int balance_idx)
+    {
+        for (unsigned int i=0; i<n_local_systems_; i++)
+            ls->set_local_system(local_systems_[i]);
+        if (balance != nullptr)
+            for (unsigned int i=0; i<balance_sides_.size(); i++)
+                balance->add_flux_matrix_values(balance_idx, balance_sides_[i], {balance_rows_[i]}, {1});
+        clear();
+    }
+
+private:
+    std::vector<LocalSystem> local_systems_;
+    unsigned int n_local_systems_;
+    std::vector<SideIter> balance_sides_;
+    std::vector<LongIdx> balance_rows_;
+    bool nonlinear_bc_;
+};
+
+
+
+/**
+ * Values of the input fields on a single element and its boundary used by AssemblyMH.
+ *
+ * Field algorithms keep the computed values in their internal storage, so a field can not be evaluated
+ * by several threads at once. The threaded assembly evaluates these values for a whole batch of elements
+ * in advance and the threads read only the copies. The serial assembly fills the same structure
+ * for every element just before its assembly, except the boundary conditions, which it evaluates
+ * on the boundary sides only when it assembles them.
+ */
+struct ElementFieldValues
+{
+    /// Data of a boundary condition prescribed on a side of the element.
+    struct SideBC {
+        /// Evaluate the fields of the boundary condition in the boundary element @p b_ele, only the fields used by its type.
+        void evaluate(const DarcyMH::EqData &data, ElementAccessor<3> b_ele)
+        {
+            arma::vec3 b_centre = b_ele.centre();
+            type = (DarcyMH::EqData::BC_Type)data.bc_type.value(b_centre, b_ele);
+            pressure = flux = robin_sigma = switch_pressure = 0.0;
+            switch (type) {
+            case DarcyMH::EqData::dirichlet:
+                pressure = data.bc_pressure.value(b_centre, b_ele);
+                break;
+            case DarcyMH::EqData::total_flux:
+                pressure = data.bc_pressure.value(b_centre, b_ele);
+                flux = data.bc_flux.value(b_centre, b_ele);
+                robin_sigma = data.bc_robin_sigma.value(b_centre, b_ele);
+                break;
+            case DarcyMH::EqData::seepage:
+                flux = data.bc_flux.value(b_centre, b_ele);
+                switch_pressure = data.bc_switch_pressure.value(b_centre, b_ele);
+                break;
+            case DarcyMH::EqData::river:
+                pressure = data.bc_pressure.value(b_centre, b_ele);
+                flux = data.bc_flux.value(b_centre, b_ele);
+                robin_sigma = data.bc_robin_sigma.value(b_centre, b_ele);
+                switch_pressure = data.bc_switch_pressure.value(b_centre, b_ele);
+                break;
+            default:
+                break;
+            }
+        }
+
+        DarcyMH::EqData::BC_Type type;
+        double pressure;
+        double flux;
+        double robin_sigma;
+        double switch_pressure;
+    };
+
+    /**
+     * Evaluate all values needed by the local assembly of the element @p ele_ac.
+     * Boundary conditions are evaluated only for @p with_bc, otherwise the assembly evaluates them
+     * on the boundary sides it processes.
+     */
+    void evaluate(const DarcyMH::EqData &data, LocalElementAccessorBase<3> ele_ac, bool with_bc = true)
+    {
+        ElementAccessor<3> ele = ele_ac.element_accessor();
+        arma::vec3 centre = ele_ac.centre();
+        cross_section = data.cross_section.value(centre, ele);
+        conductivity = data.conductivity.value(centre, ele);
+        anisotropy = data.anisotropy.value(centre, ele);
+
+        has_bc = with_bc;
+        if (with_bc)
+            for (unsigned int i = 0; i < ele_ac.n_sides(); i++) {
+                Boundary *bcd = ele_ac.side(i)->cond();
+                if (bcd) bc[i].evaluate(data, bcd->element_accessor());
+            }
+
+        // compatible connections with higher dimensional elements
+        unsigned int n_neighs = ele->n_neighs_vb();
+        sigma = (n_neighs > 0) ? data.sigma.value(centre, ele) : 0.0;
+        ngh_cross_section.resize(n_neighs);
+        for (unsigned int i = 0; i < n_neighs; i++) {
+            Neighbour *ngh = ele->neigh_vb[i];
+            ElementAccessor<3> ele_higher = data.mesh->element_accessor( ngh->side()->element().idx() );
+            ngh_cross_section[i] = data.cross_section.value(ngh->side()->centre(), ele_higher);
+        }
+    }
+
+    double cross_section;
+    double conductivity;
+    double sigma;
+    arma::mat33 anisotropy;
+
+    /// True if @p bc is evaluated.
+    bool has_bc;
+
+    /// Boundary data of the sides, valid only for the sides with a boundary condition and @p has_bc.
+    std::array<SideBC, RefElement<3>::n_sides> bc;
+
+    /// Cross section of the higher dimensional element in the centre of the side of every VB neighbour.
+    std::vector<double> ngh_cross_section;
+};
+
+
 
 class AssemblyBase
 {
@@ -37,6 +208,10 @@ public:
     typedef std::shared_ptr<DarcyMH::EqData> AssemblyDataPtr;
     typedef std::vector<std::shared_ptr<AssemblyBase> > MultidimAssembly;
 
+    AssemblyBase()
+    : buffer_(nullptr)
+    {}
+
     virtual ~AssemblyBase() {}
 
     /**
@@ -54,9 +229,12 @@ public:
 //     virtual LocalSystem & get_local_system() = 0;
     virtual void fix_velocity(LocalElementAccessorBase<3> ele_ac) = 0;
     virtual void assemble(LocalElementAccessorBase<3> ele_ac) = 0;
+
+    /// Variant of @p assemble using the field values @p values evaluated in advance.
+    virtual void assemble(LocalElementAccessorBase<3> ele_ac, const ElementFieldValues &values) = 0;
         
     // assembly compatible neighbourings
-    virtual void assembly_local_vb(ElementAccessor<3> ele, Neighbour *ngh) = 0;
+    virtual void assembly_local_vb(ElementAccessor<3> ele, Neighbour *ngh, unsigned int i_ngh) = 0;
 
     // compute velocity value in the barycenter
     // TODO: implement and use general interpolations between discrete spaces
@@ -65,12 +243,29 @@ public:
     virtual void update_water_content(LocalElementAccessorBase<3> ele)
     {}
 
+    /**
+     * Redirect results of @p assemble into the @p buffer instead of the global linear system and balance.
+     * Pass nullptr to assemble directly again.
+     */
+    void set_buffer(AssemblyBuffer *buffer)
+    { buffer_ = buffer; }
+
 protected:
 
     virtual void assemble_sides(LocalElementAccessorBase<3> ele) =0;
     
     virtual void assemble_source_term(LocalElementAccessorBase<3> ele)
     {}
+
+    /// Set local system either to the global linear system @p ls or to the buffer.
+    void set_local_system(LinSys *ls, LocalSystem &loc_system)
+    {
+        if (buffer_) buffer_->add_local_system(loc_system);
+        else ls->set_local_system(loc_system);
+    }
+
+    /// Target of the local assembly in the threaded mode, null for the direct assembly.
+    AssemblyBuffer *buffer_;
 };
 
 
@@ -107,6 +302,7 @@ public:
         velocity_interpolation_fv_(map_,velocity_interpolation_quad_, fe_rt_, update_values | update_quadrature_points),
 
         ad_(data),
+        values_(nullptr),
         loc_system_(size(), size()),
         loc_system_vb_(2,2)
     {
@@ -133,6 +329,12 @@ public:
         
         sp.submat(0, nsides+1, nsides-1, size()-1).diag().ones();
         sp.submat(nsides+1, 0, size()-1, nsides-1).diag().ones();
+        // derivatives of the conductivity couple every side flux with all edges of the element
+        if (ad_->newton_jacobian)
+            sp.submat(0, nsides+1, nsides-1, size()-1).ones();
+        // the complement assembled from local systems fills whole (element, edges) block
+        if (ad_->schur_direct_assembly)
+            sp.submat(nsides, nsides, size()-1, size()-1).ones();
         
         loc_system_.set_sparsity(sp);
         
@@ -163,8 +365,15 @@ public:
     }
 
     void assemble(LocalElementAccessorBase<3> ele_ac) override
+    {
+        ele_values_.evaluate(*ad_, ele_ac, false);
+        assemble(ele_ac, ele_values_);
+    }
+
+    void assemble(LocalElementAccessorBase<3> ele_ac, const ElementFieldValues &values) override
     {
         ASSERT_EQ_DBG(ele_ac.dim(), dim);
+        values_ = &values;
         loc_system_.reset();
     
         set_dofs_and_bc(ele_ac);
@@ -173,7 +382,7 @@ public:
         assemble_element(ele_ac);
         assemble_source_term(ele_ac);
         
-        ad_->lin_sys->set_local_system(loc_system_);
+        set_local_system(ad_->lin_sys, loc_system_);
 
         assembly_dim_connections(ele_ac);
 
@@ -184,7 +393,7 @@ public:
             mortar_assembly->assembly(ele_ac);
     }
 
-    void assembly_local_vb(ElementAccessor<3> ele, Neighbour *ngh) override
+    void assembly_local_vb(ElementAccessor<3> ele, Neighbour *ngh, unsigned int i_ngh) override
     {
         ASSERT_LT_DBG(ele->dim(), 3);
         //DebugOut() << "alv " << print_var(this);
@@ -195,12 +404,12 @@ public:
         ngh_values_.fe_side_values_.reinit(ele_higher, ngh->side()->side_idx());
         nv = ngh_values_.fe_side_values_.normal_vector(0);
 
-        double value = ad_->sigma.value( ele.centre(), ele) *
-                        2*ad_->conductivity.value( ele.centre(), ele) *
-                        arma::dot(ad_->anisotropy.value( ele.centre(), ele)*nv, nv) *
-                        ad_->cross_section.value( ngh->side()->centre(), ele_higher ) * // cross-section of higher dim. (2d)
-                        ad_->cross_section.value( ngh->side()->centre(), ele_higher ) /
-                        ad_->cross_section.value( ele.centre(), ele ) *      // crossection of lower dim.
+        double value = values_->sigma *
+                        2*values_->conductivity *
+                        arma::dot(values_->anisotropy*nv, nv) *
+                        values_->ngh_cross_section[i_ngh] * // cross-section of higher dim. (2d)
+                        values_->ngh_cross_section[i_ngh] /
+                        values_->cross_section *      // crossection of lower dim.
                         ngh->side()->measure();
 
         loc_system_vb_.add_value(0,0, -value);
@@ -259,22 +468,24 @@ protected:
             dirichlet_edge[i] = 0;
             if (bcd) {
                 ElementAccessor<3> b_ele = bcd->element_accessor();
-                DarcyMH::EqData::BC_Type type = (DarcyMH::EqData::BC_Type)ad_->bc_type.value(b_ele.centre(), b_ele);
+                if (! values_->has_bc) side_bc_.evaluate(*ad_, b_ele);
+                const ElementFieldValues::SideBC &side_bc = values_->has_bc ? values_->bc[i] : side_bc_;
+                DarcyMH::EqData::BC_Type type = side_bc.type;
 
-                double cross_section = ad_->cross_section.value(ele_ac.centre(), ele_ac.element_accessor());
+                double cross_section = values_->cross_section;
 
                 if ( type == DarcyMH::EqData::none) {
                     // homogeneous neumann
                 } else if ( type == DarcyMH::EqData::dirichlet ) {
-                    double bc_pressure = ad_->bc_pressure.value(b_ele.centre(), b_ele);
+                    double bc_pressure = side_bc.pressure;
                     loc_system_.set_solution(loc_edge_dofs[i],bc_pressure,-1);
                     dirichlet_edge[i] = 1;
                     
                 } else if ( type == DarcyMH::EqData::total_flux) {
                     // internally we work with outward flux
-                    double bc_flux = -ad_->bc_flux.value(b_ele.centre(), b_ele);
-                    double bc_pressure = ad_->bc_pressure.value(b_ele.centre(), b_ele);
-                    double bc_sigma = ad_->bc_robin_sigma.value(b_ele.centre(), b_ele);
+                    double bc_flux = -side_bc.flux;
+                    double bc_pressure = side_bc.pressure;
+                    double bc_sigma = side_bc.robin_sigma;
                     
                     dirichlet_edge[i] = 2;  // to be skipped in LMH source assembly
                     loc_system_.add_value(edge_row, edge_row,
@@ -282,12 +493,12 @@ protected:
                                             (bc_flux - bc_sigma * bc_pressure) * b_ele.measure() * cross_section);
                 }
                 else if (type==DarcyMH::EqData::seepage) {
-                    ad_->is_linear=false;
+                    set_nonlinear_bc();
 
                     unsigned int loc_edge_idx = bcd->bc_ele_idx_;
                     char & switch_dirichlet = ad_->bc_switch_dirichlet[loc_edge_idx];
-                    double bc_pressure = ad_->bc_switch_pressure.value(b_ele.centre(), b_ele);
-                    double bc_flux = -ad_->bc_flux.value(b_ele.centre(), b_ele);
+                    double bc_pressure = side_bc.switch_pressure;
+                    double bc_flux = -side_bc.flux;
                     double side_flux = bc_flux * b_ele.measure() * cross_section;
 
                     // ** Update BC type. **
@@ -337,12 +548,12 @@ protected:
                         }
 
                 } else if (type==DarcyMH::EqData::river) {
-                    ad_->is_linear=false;
+                    set_nonlinear_bc();
 
-                    double bc_pressure = ad_->bc_pressure.value(b_ele.centre(), b_ele);
-                    double bc_switch_pressure = ad_->bc_switch_pressure.value(b_ele.centre(), b_ele);
-                    double bc_flux = -ad_->bc_flux.value(b_ele.centre(), b_ele);
-                    double bc_sigma = ad_->bc_robin_sigma.value(b_ele.centre(), b_ele);
+                    double bc_pressure = side_bc.pressure;
+                    double bc_switch_pressure = side_bc.switch_pressure;
+                    double bc_flux = -side_bc.flux;
+                    double bc_sigma = side_bc.robin_sigma;
                     ASSERT_DBG(ad_->mh_dh->rows_ds->is_local(ele_ac.edge_row(i)))(ele_ac.edge_row(i));
                     unsigned int loc_edge_row = ele_ac.edge_local_row(i);
                     double & solution_head = ls->get_solution_array()[loc_edge_row];
@@ -379,9 +590,7 @@ protected:
         
      void assemble_sides(LocalElementAccessorBase<3> ele_ac) override
      {
-        double cs = ad_->cross_section.value(ele_ac.centre(), ele_ac.element_accessor());
-        double conduct =  ad_->conductivity.value(ele_ac.centre(), ele_ac.element_accessor());
-        double scale = 1 / cs /conduct;
+        double scale = 1 / values_->cross_section / values_->conductivity;
         
         assemble_sides_scale(ele_ac, scale);
     }
@@ -395,6 +604,7 @@ protected:
         unsigned int ndofs = fe_values_.get_fe()->n_dofs();
         unsigned int qsize = fe_values_.get_quadrature()->size();
         auto velocity = fe_values_.vector_view(0);
+        arma::mat33 inv_anisotropy = values_->anisotropy.i();
 
         for (unsigned int k=0; k<qsize; k++)
             for (unsigned int i=0; i<ndofs; i++){
@@ -405,9 +615,7 @@ protected:
                 
                 for (unsigned int j=0; j<ndofs; j++){
                     double mat_val = 
-                        arma::dot(velocity.value(i,k), //TODO: compute anisotropy before
-                                    (ad_->anisotropy.value(ele_ac.centre(), ele_ac.element_accessor() )).i()
-                                        * velocity.value(j,k))
+                        arma::dot(velocity.value(i,k), inv_anisotropy * velocity.value(j,k))
                         * scale * fe_values_.JxW(k);
                     
                     loc_system_.add_value(i, j, mat_val);
@@ -473,9 +681,9 @@ protected:
             loc_system_vb_.row_dofs[0] = loc_system_vb_.col_dofs[0] = ele_row;
             loc_system_vb_.row_dofs[1] = loc_system_vb_.col_dofs[1] = ad_->mh_dh->row_4_edge[ ngh->edge_idx() ];
 
-            assembly_local_vb(ele, ngh);
+            assembly_local_vb(ele, ngh, i);
 
-            ad_->lin_sys->set_local_system(loc_system_vb_);
+            set_local_system(ad_->lin_sys, loc_system_vb_);
 
             // update matrix for weights in BDDCML
             if ( typeid(*ad_->lin_sys) == typeid(LinSys_BDDC) ) {
@@ -487,6 +695,13 @@ protected:
         }
     }
 
+    /// Nonlinear boundary condition is marked in the buffer in the threaded assembly to avoid a data race.
+    void set_nonlinear_bc()
+    {
+        if (this->buffer_) this->buffer_->set_nonlinear_bc();
+        else ad_->is_linear = false;
+    }
+
     void add_fluxes_in_balance_matrix(LocalElementAccessorBase<3> ele_ac){
 
         for (unsigned int i = 0; i < ele_ac.n_sides(); i++) {
@@ -499,8 +714,11 @@ protected:
                             ele_ac.ele_global_idx(),
                             ele_ac.side_row(i));
                  */
-                ad_->balance->add_flux_matrix_values(ad_->water_balance_idx, ele_ac.side(i),
-                                                     {(LongIdx)(ele_ac.side_row(i))}, {1});
+                if (buffer_)
+                    buffer_->add_balance_flux(ele_ac.side(i), (LongIdx)(ele_ac.side_row(i)));
+                else
+                    ad_->balance->add_flux_matrix_values(ad_->water_balance_idx, ele_ac.side(i),
+                                                         {(LongIdx)(ele_ac.side_row(i))}, {1});
             }
         }
     }
@@ -523,6 +741,13 @@ protected:
     AssemblyDataPtr ad_;
     std::vector<unsigned int> dirichlet_edge;
 
+    /// Field values of the serially assembled element.
+    ElementFieldValues ele_values_;
+    /// Field values of the element currently assembled.
+    const ElementFieldValues *values_;
+    /// Boundary data of the actual side in the serial assembly.
+    ElementFieldValues::SideBC side_bc_;
+
     LocalSystem loc_system_;
     LocalSystem loc_system_vb_;
     std::vector<unsigned int> loc_side_dofs;
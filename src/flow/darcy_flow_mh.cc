@@ -19,10 +19,14 @@
 
 //#include <limits>
 #include <vector>
+#include <exception>
 //#include <iostream>
 //#include <iterator>
 //#include <algorithm>
 #include <armadillo>
+#ifdef FLOW123D_HAVE_OPENMP
+#include <omp.h>
+#endif
 
 #include "petscmat.h"
 #include "petscviewer.h"
@@ -84,6 +88,15 @@ const it::Selection & DarcyMH::get_mh_mortar_selection() {
 }
 
 
+const it::Selection & DarcyMH::get_nonlinear_method_selection() {
+	return it::Selection("NonlinearMethod")
+		.add_value(NonlinearPicard, "picard", "Picard iterations, the nonlinear coefficients are taken from the previous iteration.")
+		.add_value(NonlinearNewton, "newton", "Newton method with the analytic derivatives of the soil model and the backtracking line search. "
+		        "The linear system is nonsymmetric, the linear solver has to be chosen accordingly.")
+		.close();
+}
+
+
 const it::Selection & DarcyMH::EqData::get_bc_type_selection() {
 	return it::Selection("Flow_Darcy_BC_Type")
         .add_value(none, "none",
@@ -145,6 +158,15 @@ const it::Record & DarcyMH::get_input_type() {
             "If a stagnation of the nonlinear solver is detected the solver stops. "
             "A divergence is reported by default, forcing the end of the simulation. By setting this flag to 'true', the solver "
             "ends with convergence success on stagnation, but it reports warning about it.")
+        .declare_key("method", get_nonlinear_method_selection(), it::Default("\"picard\""),
+            "Linearization of the nonlinear problem. The Newton method makes difference only for the Richards model.")
+        .declare_key("max_damping_steps", it::Integer(0), it::Default("5"),
+            "Maximal number of halvings of the Newton update until the residual decreases (backtracking line search). "
+            "Not used by the Picard method.")
+        .declare_key("target_it", it::Integer(1), it::Default::optional(),
+            "Number of nonlinear iterations the time step control aims at. The next time step is scaled by the ratio "
+            "of 'target_it' and the actual number of iterations, limited to the interval [0.5, 2]. "
+            "If not set, the time step is prolonged for less then 3 and shortened for more then 7 iterations.")
         .close();
 
     return it::Record("Flow_Darcy_MH", "Mixed-Hybrid  solver for saturated Darcy flow.")
@@ -171,6 +193,13 @@ const it::Record & DarcyMH::get_input_type() {
 				"Number of Schur complements to perform when solving MH system.")
 		.declare_key("mortar_method", get_mh_mortar_selection(), it::Default("\"None\""),
 				"Method for coupling Darcy flow between dimensions on incompatible meshes. [Experimental]" )
+		.declare_key("assembly_threads", it::Integer(1), it::Default("1"),
+				"Number of shared memory threads used for the assembly of the MH system on every MPI process. "
+				"Values greater then one require Flow123d build with OpenMP support. The threaded assembly "
+				"is not used with the BDDC solver, with the mortar methods and by the Richards model.")
+		.declare_key("schur_direct_assembly", it::Bool(), it::Default("false"),
+				"Assemble the first Schur complement directly from the element local systems "
+				"instead of the products of the global sub-matrices. Used only with the PETSc solver and n_schurs > 0.")
 		.close();
 }
 
@@ -184,6 +213,8 @@ const int DarcyMH::registrar =
 DarcyMH::EqData::EqData()
 {
     mortar_method_=NoMortar;
+    schur_direct_assembly=false;
+    newton_jacobian=false;
 
     *this += anisotropy.name("anisotropy")
             .description("Anisotropy of the conductivity tensor.")
@@ -289,7 +320,9 @@ DarcyMH::DarcyMH(Mesh &mesh_in, const Input::Record in_rec)
 	steady_diagonal(nullptr),
 	steady_rhs(nullptr),
 	new_diagonal(nullptr),
-	previous_solution(nullptr)
+	previous_solution(nullptr),
+	prepared_step_(-1),
+	output_step_(false)
 {
 
     START_TIMER("Darcy constructor");
@@ -312,6 +345,21 @@ DarcyMH::DarcyMH(Mesh &mesh_in, const Input::Record in_rec)
     if (data_->mortar_method_ != NoMortar) {
         mesh_->mixed_intersections();
     }
+
+    n_assembly_threads_ = in_rec.val<unsigned int>("assembly_threads");
+    schur_direct_assembly_ = in_rec.val<bool>("schur_direct_assembly");
+
+    Input::Record nl_solver_rec = in_rec.val<Input::Record>("nonlinear_solver");
+    nonlinear_method_ = nl_solver_rec.val<NonlinearMethod>("method");
+    max_damping_steps_ = nl_solver_rec.val<unsigned int>("max_damping_steps");
+    target_n_it_ = 0;
+    nl_solver_rec.opt_val("target_it", target_n_it_);
+#ifndef FLOW123D_HAVE_OPENMP
+    if (n_assembly_threads_ > 1) {
+        WarningOut() << "Flow123d was build without OpenMP support, using serial assembly.";
+        n_assembly_threads_ = 1;
+    }
+#endif
     
 
 
@@ -332,6 +380,11 @@ void DarcyMH::init_eq_data()
     data_->mesh = mesh_;
     data_->mh_dh = &mh_dh;
     data_->set_mesh(*mesh_);
+    // fields evaluated in every assembly, usually constant in time
+    data_->anisotropy.enable_value_cache();
+    data_->conductivity.enable_value_cache();
+    data_->cross_section.enable_value_cache();
+    data_->sigma.enable_value_cache();
 
     auto gravity_array = input_record_.val<Input::Array>("gravity");
     std::vector<double> gvec;
@@ -376,6 +429,7 @@ void DarcyMH::initialize() {
 
 
     nonlinear_iteration_=0;
+    data_->newton_jacobian = (nonlinear_method_ == NonlinearNewton);
     Input::AbstractRecord rec = this->input_record_
             .val<Input::Record>("nonlinear_solver")
             .val<Input::AbstractRecord>("linear_solver");
@@ -455,6 +509,12 @@ void DarcyMH::update_solution()
     time_->next_time();
 
     time_->view("DARCY"); //time governor information output
+    solve_time_step();
+}
+
+
+void DarcyMH::solve_time_step(bool output)
+{
     data_changed_ = data_->set_time(time_->step(), LimitSide::left) || data_changed_;
     bool zero_time_term_from_left=zero_time_term();
 
@@ -465,7 +525,11 @@ void DarcyMH::update_solution()
 
         // this flag is necesssary for switching BC to avoid setting zero neumann on the whole boundary in the steady case
         use_steady_assembly_ = false;
-        prepare_new_time_step(); //SWAP
+        // the step may be solved repeatedly, keep data of the previous time
+        if (int(time_->step().index()) != prepared_step_) {
+            prepare_new_time_step(); //SWAP
+            prepared_step_ = time_->step().index();
+        }
 
         solve_nonlinear(); // with left limit data
         if (jump_time) {
@@ -478,7 +542,8 @@ void DarcyMH::update_solution()
     if (time_->is_end()) {
         // output for unsteady case, end_time should not be the jump time
         // but rether check that
-        if (! zero_time_term_from_left && ! jump_time) output_data();
+        output_step_ = (! zero_time_term_from_left && ! jump_time);
+        if (output) output_time_step();
         return;
     }
 
@@ -495,8 +560,15 @@ void DarcyMH::update_solution()
         //solve_nonlinear(); // with right limit data
     }
     //solution_output(T,right_limit); // data for time T in any case
-    output_data();
+    output_step_ = true;
+    if (output) output_time_step();
+
+}
+
 
+void DarcyMH::output_time_step()
+{
+    if (output_step_) output_data();
 }
 
 bool DarcyMH::zero_time_term(bool time_global) {
@@ -510,6 +582,7 @@ bool DarcyMH::zero_time_term(bool time_global) {
 
 void DarcyMH::solve_nonlinear()
 {
+    START_TIMER("Darcy nonlinear solver");
 
     assembly_linear_system();
     double residual_norm = schur0->compute_residual();
@@ -536,6 +609,7 @@ void DarcyMH::solve_nonlinear()
     VecDuplicate(schur0->get_solution(), &save_solution);
     while (nonlinear_iteration_ < this->min_n_it_ ||
            (residual_norm > this->tolerance_ &&  nonlinear_iteration_ < this->max_n_it_ )) {
+        START_TIMER("Darcy nonlinear iteration");
     	OLD_ASSERT_EQUAL( convergence_history.size(), nonlinear_iteration_ );
         convergence_history.push_back(residual_norm);
 
@@ -567,9 +641,6 @@ void DarcyMH::solve_nonlinear()
         }
         data_changed_=true; // force reassembly for non-linear case
 
-        double alpha = 1; // how much of new solution
-        VecAXPBY(schur0->get_solution(), (1-alpha), alpha, save_solution);
-
         /*
         double * sol;
         unsigned int sol_size;
@@ -581,8 +652,24 @@ void DarcyMH::solve_nonlinear()
         //LogOut().fmt("Linear solver ended with reason: {} \n", si.converged_reason );
         //OLD_ASSERT( si.converged_reason >= 0, "Linear solver failed to converge. Convergence reason %d \n", si.converged_reason );
         assembly_linear_system();
+        double new_residual_norm = schur0->compute_residual();
+
+        if (nonlinear_method_ == NonlinearNewton) {
+            // backtracking line search, halve the update until the residual decreases
+            double alpha = 1; // how much of new solution
+            for(unsigned int i_damp = 0; new_residual_norm > residual_norm && i_damp < max_damping_steps_; i_damp++) {
+                START_TIMER("Darcy line search");
+                alpha *= 0.5;
+                VecAXPBY(schur0->get_solution(), 0.5, 0.5, save_solution);
+                data_changed_=true;
+                assembly_linear_system();
+                new_residual_norm = schur0->compute_residual();
+            }
+            if (alpha < 1)
+                MessageOut().fmt("[nonlinear solver] damping: {}\n", alpha);
+        }
+        residual_norm = new_residual_norm;
 
-        residual_norm = schur0->compute_residual();
         MessageOut().fmt("[nonlinear solver] it: {} lin. it: {}, reason: {}, residual: {}\n",
         		nonlinear_iteration_, si.n_iterations, si.converged_reason, residual_norm);
     }
@@ -590,19 +677,29 @@ void DarcyMH::solve_nonlinear()
     this -> postprocess();
 
     // adapt timestep
-    if (! this->zero_time_term()) {
-        double mult = 1.0;
-        if (nonlinear_iteration_ < 3) mult = 1.6;
-        if (nonlinear_iteration_ > 7) mult = 0.7;
-        int result = time_->set_upper_constraint(time_->dt() * mult, "Darcy adaptivity.");
-        //DebugOut().fmt("time adaptivity, res: {} it: {} m: {} dt: {} edt: {}\n", result, nonlinear_iteration_, mult, time_->dt(), time_->estimate_dt());
-    }
+    if (! this->zero_time_term()) adapt_time_step();
 
     solution_changed_for_scatter=true;
 
 }
 
 
+void DarcyMH::adapt_time_step()
+{
+    double mult = 1.0;
+    if (target_n_it_ > 0) {
+        // scale the time step by the ratio of the target and the actual number of iterations
+        mult = double(target_n_it_) / std::max(nonlinear_iteration_, 1u);
+        mult = std::min(2.0, std::max(0.5, mult));
+    } else {
+        if (nonlinear_iteration_ < 3) mult = 1.6;
+        if (nonlinear_iteration_ > 7) mult = 0.7;
+    }
+    time_->set_upper_constraint(time_->dt() * mult, "Darcy adaptivity.");
+    //DebugOut().fmt("time adaptivity, it: {} m: {} dt: {} edt: {}\n", nonlinear_iteration_, mult, time_->dt(), time_->estimate_dt());
+}
+
+
 void DarcyMH::prepare_new_time_step()
 {
     //VecSwap(previous_solution, schur0->get_solution());
@@ -718,6 +815,89 @@ void DarcyMH::assembly_mh_matrix(MultidimAssembly& assembler)
 }
 
 
+bool DarcyMH::use_threaded_assembly() const
+{
+    return n_assembly_threads_ > 1
+            && data_->mortar_method_ == NoMortar
+            && typeid(*schur0) != typeid(LinSys_BDDC);
+}
+
+
+void DarcyMH::assembly_mh_matrix_threaded()
+{
+    START_TIMER("DarcyFlowMH_Steady::assembly_steady_mh_matrix");
+
+    // set auxiliary flag for switchting Dirichlet like BC
+    data_->force_bc_switch = use_steady_assembly_ && (nonlinear_iteration_ == 0);
+    data_->n_schur_compls = n_schur_compls;
+
+    balance_->start_flux_assembly(data_->water_balance_idx);
+
+    // Assemblers keep FE values and local systems, so every thread needs its own set.
+    // Create them here, since construction of FE objects is not thread safe.
+    std::vector<MultidimAssembly> thread_assemblers;
+    std::vector<AssemblyBuffer> buffers(n_assembly_threads_);
+    for (unsigned int i_thread = 0; i_thread < n_assembly_threads_; i_thread++) {
+        thread_assemblers.push_back( AssemblyBase::create< AssemblyMH >(data_) );
+        for (auto &assembler : thread_assemblers.back())
+            assembler->set_buffer(&buffers[i_thread]);
+    }
+
+    // Limit size of buffers by assembling in batches.
+    const unsigned int batch_size = 1024 * n_assembly_threads_;
+    const unsigned int n_loc_elements = mh_dh.el_ds->lsize();
+    std::vector<ElementFieldValues> batch_values(std::min(batch_size, n_loc_elements));
+    std::exception_ptr thread_exception;
+
+    for (unsigned int batch_begin = 0; batch_begin < n_loc_elements; batch_begin += batch_size) {
+        const unsigned int batch_end = std::min(batch_begin + batch_size, n_loc_elements);
+
+        // Fields can not be evaluated concurrently, evaluate the whole batch in advance.
+        {
+            START_TIMER("assembly_field_values");
+            for (unsigned int i_loc = batch_begin; i_loc < batch_end; i_loc++)
+                batch_values[i_loc - batch_begin].evaluate(*data_, mh_dh.accessor(i_loc));
+        }
+
+        START_TIMER("assembly_local_systems");
+#ifdef FLOW123D_HAVE_OPENMP
+        #pragma omp parallel num_threads(n_assembly_threads_)
+#endif
+        {
+            try {
+#ifdef FLOW123D_HAVE_OPENMP
+                MultidimAssembly &assembler = thread_assemblers[omp_get_thread_num()];
+                // static schedule assigns contiguous ranges in the thread order
+                #pragma omp for schedule(static) nowait
+#else
+                MultidimAssembly &assembler = thread_assemblers[0];
+#endif
+                for (unsigned int i_loc = batch_begin; i_loc < batch_end; i_loc++) {
+                    auto ele_ac = mh_dh.accessor(i_loc);
+                    assembler[ele_ac.dim()-1]->assemble(ele_ac, batch_values[i_loc - batch_begin]);
+                }
+            } catch (...) {
+#ifdef FLOW123D_HAVE_OPENMP
+                #pragma omp critical (assembly_exception)
+#endif
+                thread_exception = std::current_exception();
+            }
+        }
+        END_TIMER("assembly_local_systems");
+        if (thread_exception) std::rethrow_exception(thread_exception);
+
+        for (auto &buffer : buffers) {
+            // combine the per thread flags of nonlinear boundary conditions
+            if (buffer.nonlinear_bc()) data_->is_linear = false;
+            buffer.flush(schur0, balance_, data_->water_balance_idx);
+        }
+    }
+
+    balance_->finish_flux_assembly(data_->water_balance_idx);
+
+}
+
+
 void DarcyMH::allocate_mh_matrix()
 {
     START_TIMER("DarcyFlowMH_Steady::allocate_mh_matrix");
@@ -858,6 +1038,9 @@ void DarcyMH::create_linear_system(Input::AbstractRecord in_rec) {
        
     	if (in_rec.type() == LinSys_BDDC::get_input_type()) {
 #ifdef FLOW123D_HAVE_BDDCML
+            // BDDC is set up for the symmetric system only
+            if (data_->newton_jacobian)
+                THROW( ExcNewtonBDDC() << in_rec.ei_address() );
     		WarningOut() << "For BDDC no Schur complements are used.";
             mh_dh.prepare_parallel_bddc();
             n_schur_compls = 0;
@@ -906,19 +1089,26 @@ void DarcyMH::create_linear_system(Input::AbstractRecord in_rec) {
 
                 // make schur1
                 Distribution *ds = ls->make_complement_distribution();
+                if (schur_direct_assembly_) {
+                    ls->set_direct_assembly();
+                    data_->schur_direct_assembly = true;
+                }
+                // the Newton jacobian breaks symmetry of the system
+                bool spd = ! data_->newton_jacobian;
                 if (n_schur_compls==1) {
                     schur1 = new LinSys_PETSC(ds);
-                    schur1->set_positive_definite();
+                    schur1->set_positive_definite(spd);
                 } else {
                     IS is;
                     ISCreateStride(PETSC_COMM_WORLD, mh_dh.el_ds->lsize(), ls->get_distribution()->begin(), 1, &is);
                     //OLD_ASSERT(err == 0,"Error in ISCreateStride.");
                     SchurComplement *ls1 = new SchurComplement(ds, is); // is is deallocated by SchurComplement
-                    ls1->set_negative_definite();
+                    ls1->set_symmetric(spd);
+                    ls1->set_negative_definite(spd);
 
                     // make schur2
                     schur2 = new LinSys_PETSC( ls1->make_complement_distribution() );
-                    schur2->set_positive_definite();
+                    schur2->set_positive_definite(spd);
                     ls1->set_complement( schur2 );
                     schur1 = ls1;
                 }
@@ -929,7 +1119,7 @@ void DarcyMH::create_linear_system(Input::AbstractRecord in_rec) {
             }
 
             START_TIMER("PETSC PREALLOCATION");
-            schur0->set_symmetric();
+            schur0->set_symmetric(! data_->newton_jacobian);
             schur0->start_allocation();
             
             allocate_mh_matrix();
@@ -971,8 +1161,12 @@ void DarcyMH::assembly_linear_system() {
 
         assembly_source_term();
         
-        auto multidim_assembler =  AssemblyBase::create< AssemblyMH >(data_);
-	    assembly_mh_matrix( multidim_assembler ); // fill matrix
+        if (use_threaded_assembly()) {
+            assembly_mh_matrix_threaded(); // fill matrix
+        } else {
+            auto multidim_assembler =  AssemblyBase::create< AssemblyMH >(data_);
+            assembly_mh_matrix( multidim_assembler ); // fill matrix
+        }
 
 	    schur0->finish_assembly();
 //         print_matlab_matrix("matrix");
@@ -132,6 +132,9 @@ public:
              );
     DECLARE_INPUT_EXCEPTION(ExcMissingTimeGovernor,
             << "Missing the key 'time', obligatory for the transient problems.");
+    DECLARE_INPUT_EXCEPTION(ExcNewtonBDDC,
+            << "The Newton method produces a nonsymmetric system, which can not be solved by the BDDC solver.\n"
+            << "Use the Picard method or the Petsc solver.");
 
 
     typedef std::vector<std::shared_ptr<AssemblyBase> > MultidimAssembly;
@@ -143,6 +146,12 @@ public:
         MortarP1 = 2
     };
 
+    /// Linearization used by the nonlinear solver.
+    enum NonlinearMethod {
+        NonlinearPicard = 0,
+        NonlinearNewton = 1
+    };
+
     /// Class with all fields used in the equation DarcyFlow.
     /// This is common to all implementations since this provides interface
     /// to this equation for possible coupling.
@@ -202,8 +211,10 @@ public:
         LinSys *lin_sys;
         
         unsigned int n_schur_compls;
+        bool schur_direct_assembly; ///< First Schur complement is assembled from the local systems.
         int is_linear;              ///< Hack fo BDDC solver.
         bool force_bc_switch;       ///< auxiliary flag for switchting Dirichlet like BC
+        bool newton_jacobian;       ///< Assemble derivatives of the soil model into the matrix (Newton method).
         
         /// Idicator of dirichlet or neumann type of switch boundary conditions.
         std::vector<char> bc_switch_dirichlet;
@@ -212,6 +223,9 @@ public:
     /// Selection for enum MortarMethod.
     static const Input::Type::Selection & get_mh_mortar_selection();
 
+    /// Selection for enum NonlinearMethod.
+    static const Input::Type::Selection & get_nonlinear_method_selection();
+
 
 
 
@@ -243,9 +257,22 @@ public:
     virtual void initialize_specific();
     void zero_time_step() override;
     void update_solution() override;
+    /**
+     * Solve the actual time step, without moving to the next time.
+     * May be called repeatedly within one time step by an iterative coupling,
+     * the data of the previous time are kept.
+     * @param output  Write the solution to the output stream, otherwise call output_time_step later.
+     */
+    void solve_time_step(bool output = true);
+    /// Write the solution of the last solve_time_step, unless the output is not supported for the time step.
+    void output_time_step();
 
     void get_solution_vector(double * &vec, unsigned int &vec_size) override;
     void get_parallel_solution_vector(Vec &vector) override;
+
+    /// Number of nonlinear iterations of the last solved time step.
+    inline unsigned int n_nonlinear_iterations() const
+    { return nonlinear_iteration_; }
     
     /// postprocess velocity field (add sources)
     virtual void prepare_new_time_step();
@@ -266,6 +293,8 @@ protected:
 
     /// Solve method common to zero_time_step and update solution.
     void solve_nonlinear();
+    /// Set upper constraint of the next time step according to the number of nonlinear iterations.
+    void adapt_time_step();
     void make_serial_scatter();
     void modify_system();
     virtual void setup_time_term();
@@ -318,6 +347,19 @@ protected:
      */
     void assembly_mh_matrix(MultidimAssembly& assembler);
 
+    /**
+     * Threaded variant of @p assembly_mh_matrix using AssemblyMH.
+     * Local elements are processed in batches. Field values of the batch are evaluated serially
+     * (see ElementFieldValues), then each thread assembles a contiguous part of the batch
+     * with its own assemblers into its own AssemblyBuffer. The buffers are then passed to the linear system
+     * in the element order, so the assembled system is the same as for the serial assembly.
+     * Used only for PETSc solvers without mortar method, see @p use_threaded_assembly.
+     */
+    void assembly_mh_matrix_threaded();
+
+    /// True if the threaded assembly can be used for the current setting.
+    bool use_threaded_assembly() const;
+
     /// Source term is implemented differently in LMH version.
     virtual void assembly_source_term();
 
@@ -360,6 +402,15 @@ protected:
 	unsigned int min_n_it_;
 	unsigned int max_n_it_;
 	unsigned int nonlinear_iteration_; //< Actual number of completed nonlinear iterations, need to pass this information into assembly.
+	NonlinearMethod nonlinear_method_;
+	unsigned int max_damping_steps_;   //< Maximal number of halvings of the Newton update in the line search.
+	unsigned int target_n_it_;         //< Number of nonlinear iterations targeted by the time step control, zero for the fixed rule.
+
+	/// Number of threads used by the assembly of the MH matrix.
+	unsigned int n_assembly_threads_;
+
+	/// Assemble the first Schur complement directly from the local systems.
+	bool schur_direct_assembly_;
 
 
 	LinSys *schur0;  		//< whole MH Linear System
@@ -374,6 +425,12 @@ protected:
     Vec new_diagonal;
     Vec previous_solution;
 
+    /// Index of the time step prepared by prepare_new_time_step, -1 before the first step.
+    int prepared_step_;
+
+    /// Output of the solution computed by the last solve_time_step is supported.
+    bool output_step_;
+
 	std::shared_ptr<EqData> data_;
 
     friend class DarcyFlowMHOutput;
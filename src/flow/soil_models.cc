@@ -67,6 +67,18 @@ auto SoilModelImplBase<Model>::water_content_diff(const DiffDouble &p_head)->Dif
     return model_.water_content_(p_head);
 }
 
+template <class Model>
+double SoilModelImplBase<Model>::conductivity_derivative( const double &p_head) const
+{
+    return model_.conductivity_derivative_(p_head);
+}
+
+template <class Model>
+double SoilModelImplBase<Model>::water_content_derivative( const double &p_head) const
+{
+    return model_.water_content_derivative_(p_head);
+}
+
 
 
 
@@ -116,6 +128,14 @@ T VanGenuchten::Q_rel_inv(const T &q) const
 }
 
 
+double VanGenuchten::Q_rel_derivative(double h) const
+{
+    double ah = -soil_param_.alpha * h;
+    return m * soil_param_.n * soil_param_.alpha * pow(ah, soil_param_.n - 1)
+           * pow( 1 + pow(ah, soil_param_.n), -m - 1);
+}
+
+
 
 // pri generovani grafu jsem zjistil ze originalni vzorecek pro
 // vodivost pres theta je numericky nestabilni pro tlaky blizke
@@ -145,6 +165,27 @@ T VanGenuchten::conductivity_(const T& h) const
 //template double VanGenuchten::conductivity_<double>(const double &h) const;
 
 
+double VanGenuchten::conductivity_derivative_(double h) const
+{
+    if (h >= Hs) return 0.0;
+
+    double Q_unscaled = Q_rel(h);
+    double Q_cut_unscaled = Q_unscaled / soil_param_.cut_fraction;
+    double Q_pow = pow(Q_unscaled, 1/m);
+    double FFQ = pow(1 - Q_pow, m);
+    double G = (FFQr - FFQ)/(FFQr - FFQs);
+    double Kr = soil_param_.Ks * pow(Q_cut_unscaled,Bpar)*pow(G,Ppar);
+    if (Kr < K_lower_limit) return 0.0;
+
+    // d FFQ / d Q = -(1 - Q^{1/m})^{m-1} Q^{1/m - 1}
+    double dG_dQ = pow(1 - Q_pow, m - 1) * Q_pow / Q_unscaled / (FFQr - FFQs);
+    double dKr_dQ = soil_param_.Ks * (
+            Bpar * pow(Q_cut_unscaled, Bpar - 1) / soil_param_.cut_fraction * pow(G,Ppar)
+            + pow(Q_cut_unscaled,Bpar) * Ppar * pow(G, Ppar - 1) * dG_dQ );
+    return dKr_dQ * Q_rel_derivative(h);
+}
+
+
 template <class T>
 T VanGenuchten::water_content_(const T& h) const
 {
@@ -155,6 +196,13 @@ T VanGenuchten::water_content_(const T& h) const
 //template SoilModelBase::DiffDouble VanGenuchten::water_content_<SoilModelBase::DiffDouble>(const SoilModelBase::DiffDouble &h) const;
 //template double VanGenuchten::water_content_<double>(const double &h) const;
 
+
+double VanGenuchten::water_content_derivative_(double h) const
+{
+    if (h < Hs) return (Qs_nc - soil_param_.Qr) * Q_rel_derivative(h);
+    else return 0.0;
+}
+
 Irmay::Irmay()
 : VanGenuchten()
 {
@@ -180,6 +228,18 @@ T Irmay::conductivity_(const T& h) const
 //template SoilModelBase::DiffDouble Irmay::conductivity_<SoilModelBase::DiffDouble>(const SoilModelBase::DiffDouble &h) const;
 //template double Irmay::conductivity_<double>(const double &h) const;
 
+
+double Irmay::conductivity_derivative_(double h) const
+{
+    if (h >= Hs) return 0.0;
+
+    double Q = this->Q_rel(h);
+    double Kr = soil_param_.Ks * pow(Q, Ppar);
+    if (Kr < K_lower_limit) return 0.0;
+
+    return soil_param_.Ks * Ppar * pow(Q, Ppar - 1) * this->Q_rel_derivative(h);
+}
+
 } //close namespace internal
 
 
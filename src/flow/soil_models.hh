@@ -66,6 +66,10 @@ public:
     virtual double water_content( const double &phead) const =0;
     virtual auto water_content_diff(const DiffDouble &p_head)->DiffDouble const =0;
 
+    /// Analytic derivatives with respect to the pressure head, cheaper alternative to the fadbad evaluation.
+    virtual double conductivity_derivative( const double &phead) const =0;
+    virtual double water_content_derivative( const double &phead) const =0;
+
     virtual ~SoilModelBase() {};
 };
 
@@ -76,6 +80,9 @@ public:
     // We assume that Model have method templates:
     // template <class T>  T conductivity_(const T &h) const;
     // template <class T>  T water_content_(const T &h) const;
+    // and methods for the analytic derivatives:
+    // double conductivity_derivative_(double h) const;
+    // double water_content_derivative_(double h) const;
 
 
 
@@ -91,6 +98,9 @@ public:
     double water_content( const double &p_head) const override;
     auto water_content_diff(const DiffDouble &p_head)->DiffDouble const override;
 
+    double conductivity_derivative( const double &p_head) const override;
+    double water_content_derivative( const double &p_head) const override;
+
     ~SoilModelImplBase() {}
 
 private:
@@ -115,10 +125,15 @@ public:
     template <class T>
     T water_content_(const T &h) const;
 
+    double conductivity_derivative_(double h) const;
+    double water_content_derivative_(double h) const;
+
 protected:
 
     template <class T> T Q_rel(const T &h) const;
     template <class T> T Q_rel_inv(const T &q) const;
+    /// Derivative of Q_rel with respect to the pressure head.
+    double Q_rel_derivative(double h) const;
 
     // input parameters
     SoilData  soil_param_;
@@ -146,6 +161,8 @@ public:
 
     template <class T>
     T conductivity_(const T &h) const;
+
+    double conductivity_derivative_(double h) const;
 };
 
 } // close namespace internal
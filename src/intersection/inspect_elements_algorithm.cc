@@ -6,6 +6,8 @@
  */
 
 #include <unordered_set>
+#include <algorithm>
+#include <exception>
 #include <boost/functional/hash.hpp>
 
 #include "inspect_elements_algorithm.hh"
@@ -23,6 +25,10 @@
 #include "mesh/accessors.hh"
 #include "mesh/range_wrapper.hh"
 
+#ifdef FLOW123D_HAVE_OPENMP
+#include <omp.h>
+#endif
+
 
 
 template<unsigned int dimA, unsigned int dimB>
@@ -44,7 +50,8 @@ IntersectionAlgorithmBase<dimA,dimB>::IntersectionAlgorithmBase(Mesh* mesh)
 
 template<unsigned int dim>    
 InspectElementsAlgorithm<dim>::InspectElementsAlgorithm(Mesh* input_mesh)
-: IntersectionAlgorithmBase<dim,3>(input_mesh)
+: IntersectionAlgorithmBase<dim,3>(input_mesh),
+  n_threads_(1)
 {
 }
 
@@ -53,6 +60,17 @@ InspectElementsAlgorithm<dim>::~InspectElementsAlgorithm()
 {}
 
 
+template<unsigned int dim>
+void InspectElementsAlgorithm<dim>::set_n_threads(unsigned int n_threads)
+{
+#ifdef FLOW123D_HAVE_OPENMP
+    n_threads_ = std::max(n_threads, 1u);
+#else
+    n_threads_ = 1;
+#endif
+}
+
+
     
 template<unsigned int dim>
 void InspectElementsAlgorithm<dim>::init()
@@ -140,124 +158,132 @@ bool InspectElementsAlgorithm<dim>::intersection_exists(unsigned int component_e
 
 
 template<unsigned int dim>
-void InspectElementsAlgorithm<dim>::compute_intersections(const BIHTree& bih)
+void InspectElementsAlgorithm<dim>::compute_element_intersections(const BIHTree& bih, const ElementAccessor<3> &elm)
 {
-    //DebugOut() << "#########   ALGORITHM: compute_intersections   #########\n";
-    
-    init();
+    unsigned int component_ele_idx = elm.idx();
     
-    START_TIMER("Element iteration");
-    
-    for (auto elm : mesh->elements_range()) {
-        unsigned int component_ele_idx = elm.idx();
+    if (elm->dim() == dim &&                                // is component element
+        !closed_elements[component_ele_idx] &&                    // is not closed yet
+        bih.ele_bounding_box(component_ele_idx).intersect(bih.tree_box()))    // its bounding box intersects 3D mesh bounding box
+    {    
+        std::vector<unsigned int> searchedElements;
         
-        if (elm->dim() == dim &&                                // is component element
-            !closed_elements[component_ele_idx] &&                    // is not closed yet
-            bih.ele_bounding_box(component_ele_idx).intersect(bih.tree_box()))    // its bounding box intersects 3D mesh bounding box
-        {    
-            std::vector<unsigned int> searchedElements;
-            
-            START_TIMER("BIHtree find");
-            bih.find_bounding_box(bih.ele_bounding_box(component_ele_idx), searchedElements);
-            END_TIMER("BIHtree find");
+        START_TIMER("BIHtree find");
+        bih.find_bounding_box(bih.ele_bounding_box(component_ele_idx), searchedElements);
+        END_TIMER("BIHtree find");
 
-            START_TIMER("Bounding box element iteration");
-            
-            // Go through all element which bounding box intersects the component element bounding box
-            for (std::vector<unsigned int>::iterator it = searchedElements.begin(); it!=searchedElements.end(); it++)
-            {
-                unsigned int bulk_ele_idx = *it;
-                ElementAccessor<3> ele_3D = mesh->element_accessor( bulk_ele_idx );
+        START_TIMER("Bounding box element iteration");
+        
+        // Go through all element which bounding box intersects the component element bounding box
+        for (std::vector<unsigned int>::iterator it = searchedElements.begin(); it!=searchedElements.end(); it++)
+        {
+            unsigned int bulk_ele_idx = *it;
+            ElementAccessor<3> ele_3D = mesh->element_accessor( bulk_ele_idx );
+
+            // if:
+            // check 3D only
+            // check with the last component element computed for the current 3D element
+            // intersection has not been computed already
+            if (ele_3D->dim() == 3 &&
+                (last_slave_for_3D_elements[bulk_ele_idx] != component_ele_idx &&
+                 !intersection_exists(component_ele_idx,bulk_ele_idx) )
+            ) {
+                // check that tetrahedron element is numbered correctly and is not degenerated
+                ASSERT_DBG(ele_3D.tetrahedron_jacobian() > 0).add_value(ele_3D.index(),"element index").error(
+                       "Tetrahedron element (%d) has wrong numbering or is degenerated (negative Jacobian).");
+                
+                    // - find first intersection
+                    // - if found, prolongate and possibly fill both prolongation queues
+                    // do-while loop:
+                    // - empty prolongation queues:
+                    //      - empty bulk queue:
+                    //          - get a candidate from queue and compute CI
+                    //          - prolongate and possibly push new candidates into queues
+                    //          - repeat until bulk queue is empty
+                    //          - the component element is still the same whole time in here
+                    //
+                    //      - the component element might get fully covered by bulk elements
+                    //        and only then it can be closed
+                    //
+                    //      - pop next candidate from component queue:
+                    //          - the component element is now changed
+                    //          - compute CI
+                    //          - prolongate and possibly push new candidates into queues
+                    //
+                    // - repeat until both queues are empty
+                
+                bool found = compute_initial_CI(elm, ele_3D);
 
-                // if:
-                // check 3D only
-                // check with the last component element computed for the current 3D element
-                // intersection has not been computed already
-                if (ele_3D->dim() == 3 &&
-                    (last_slave_for_3D_elements[bulk_ele_idx] != component_ele_idx &&
-                     !intersection_exists(component_ele_idx,bulk_ele_idx) )
-                ) {
-                    // check that tetrahedron element is numbered correctly and is not degenerated
-                    ASSERT_DBG(ele_3D.tetrahedron_jacobian() > 0).add_value(ele_3D.index(),"element index").error(
-                           "Tetrahedron element (%d) has wrong numbering or is degenerated (negative Jacobian).");
-                    
-                        // - find first intersection
-                        // - if found, prolongate and possibly fill both prolongation queues
-                        // do-while loop:
-                        // - empty prolongation queues:
-                        //      - empty bulk queue:
-                        //          - get a candidate from queue and compute CI
-                        //          - prolongate and possibly push new candidates into queues
-                        //          - repeat until bulk queue is empty
-                        //          - the component element is still the same whole time in here
-                        //
-                        //      - the component element might get fully covered by bulk elements
-                        //        and only then it can be closed
-                        //
-                        //      - pop next candidate from component queue:
-                        //          - the component element is now changed
-                        //          - compute CI
-                        //          - prolongate and possibly push new candidates into queues
-                        //
-                        // - repeat until both queues are empty
+                // keep the index of the current component element that is being investigated
+                unsigned int current_component_element_idx = component_ele_idx;
+                
+                if(found){
                     
-                    bool found = compute_initial_CI(elm, ele_3D);
-
-                    // keep the index of the current component element that is being investigated
-                    unsigned int current_component_element_idx = component_ele_idx;
+                    prolongation_decide(elm, ele_3D, intersection_list_[component_ele_idx].back());
                     
-                    if(found){
+                    START_TIMER("Prolongation algorithm");
+                    do{
+                        // flag is set false if the component element is not fully covered with tetrahedrons
+                        bool element_covered = true;
                         
-                        prolongation_decide(elm, ele_3D, intersection_list_[component_ele_idx].back());
-                        
-                        START_TIMER("Prolongation algorithm");
-                        do{
-                            // flag is set false if the component element is not fully covered with tetrahedrons
-                            bool element_covered = true;
+                        while(!bulk_queue_.empty()){
+                            Prolongation pr = bulk_queue_.front();
+                            //DebugOut().fmt("Bulk queue: ele_idx {}.\n",pr.elm_3D_idx);
                             
-                            while(!bulk_queue_.empty()){
-                                Prolongation pr = bulk_queue_.front();
-                                //DebugOut().fmt("Bulk queue: ele_idx {}.\n",pr.elm_3D_idx);
-                                
-                                if( pr.elm_3D_idx == undefined_elm_idx_)
-                                {
-                                    //DebugOut().fmt("Open intersection component element: {}\n",current_component_element_idx);
-                                    element_covered = false;
-                                }
-                                else prolongate(pr);
-                                
-                                bulk_queue_.pop();
+                            if( pr.elm_3D_idx == undefined_elm_idx_)
+                            {
+                                //DebugOut().fmt("Open intersection component element: {}\n",current_component_element_idx);
+                                element_covered = false;
                             }
+                            else prolongate(pr);
                             
-                            if(! closed_elements[current_component_element_idx])
-                                closed_elements[current_component_element_idx] = element_covered;
-                            
-                            
-                            if(!component_queue_.empty()){
-                                Prolongation pr = component_queue_.front();
-
-                                // note the component element index
-                                current_component_element_idx = pr.component_elm_idx;
-                                //DebugOut().fmt("Component queue: ele_idx {}.\n",current_component_element_idx);
-                                
-                                prolongate(pr);
-                                component_queue_.pop();
-                            }
+                            bulk_queue_.pop();
                         }
-                        while( !(component_queue_.empty() && bulk_queue_.empty()) );
-                        END_TIMER("Prolongation algorithm");
                         
-                        // if component element is closed, do not check other bounding boxes
-                        if(closed_elements[component_ele_idx])
-                            break;
+                        if(! closed_elements[current_component_element_idx])
+                            closed_elements[current_component_element_idx] = element_covered;
+                        
+                        
+                        if(!component_queue_.empty()){
+                            Prolongation pr = component_queue_.front();
+
+                            // note the component element index
+                            current_component_element_idx = pr.component_elm_idx;
+                            //DebugOut().fmt("Component queue: ele_idx {}.\n",current_component_element_idx);
+                            
+                            prolongate(pr);
+                            component_queue_.pop();
+                        }
                     }
+                    while( !(component_queue_.empty() && bulk_queue_.empty()) );
+                    END_TIMER("Prolongation algorithm");
+                    
+                    // if component element is closed, do not check other bounding boxes
+                    if(closed_elements[component_ele_idx])
+                        break;
                 }
             }
-            END_TIMER("Bounding box element iteration");
         }
+        END_TIMER("Bounding box element iteration");
     }
+}
 
-    END_TIMER("Element iteration");
+template<unsigned int dim>
+void InspectElementsAlgorithm<dim>::compute_intersections(const BIHTree& bih)
+{
+    //DebugOut() << "#########   ALGORITHM: compute_intersections   #########\n";
+    
+    if (n_threads_ > 1) {
+        compute_intersections_threaded(bih, true);
+    }
+    else {
+        init();
+        
+        START_TIMER("Element iteration");
+        for (auto elm : mesh->elements_range())
+            compute_element_intersections(bih, elm);
+        END_TIMER("Element iteration");
+    }
     
     MessageOut().fmt("{}D-3D: number of intersections = {}\n", dim, n_intersections_);
     // DBG write which elements are closed
@@ -266,64 +292,187 @@ void InspectElementsAlgorithm<dim>::compute_intersections(const BIHTree& bih)
 //     }
 }
   
+template<unsigned int dim>
+void InspectElementsAlgorithm<dim>::compute_element_intersections_BIHtree(const BIHTree& bih, const ElementAccessor<3> &elm)
+{
+    unsigned int component_ele_idx = elm.idx();
+    
+    if (elm.dim() == dim &&                                    // is component element
+        bih.ele_bounding_box(component_ele_idx).intersect(bih.tree_box()))   // its bounding box intersects 3D mesh bounding box
+    {   
+        std::vector<unsigned int> searchedElements;
+        
+        START_TIMER("BIHtree find");
+        bih.find_bounding_box(bih.ele_bounding_box(component_ele_idx), searchedElements);
+        END_TIMER("BIHtree find");
+        
+        START_TIMER("Bounding box element iteration");
+        
+        // Go through all element which bounding box intersects the component element bounding box
+        for (std::vector<unsigned int>::iterator it = searchedElements.begin(); it!=searchedElements.end(); it++)
+        {
+            unsigned int bulk_ele_idx = *it;
+            ElementAccessor<3> ele_3D = mesh->element_accessor( bulk_ele_idx );
+            
+            if (ele_3D.dim() == 3
+            ) {
+                // check that tetrahedron element is numbered correctly and is not degenerated
+                ASSERT_DBG(ele_3D.tetrahedron_jacobian() > 0).add_value(ele_3D.idx(),"element index").error(
+                       "Tetrahedron element (%d) has wrong numbering or is degenerated (negative Jacobian).");
+                
+                IntersectionAux<dim,3> is(component_ele_idx, bulk_ele_idx);
+                START_TIMER("Compute intersection");
+                ComputeIntersection<dim,3> CI(elm, ele_3D, mesh);
+                CI.init();
+                CI.compute(is);
+                END_TIMER("Compute intersection");
+                
+                if(is.points().size() > 0) {
+                    
+                    intersection_list_[component_ele_idx].push_back(is);
+                    n_intersections_++;
+                    // if component element is closed, do not check other bounding boxes
+                    closed_elements[component_ele_idx] = true;
+                }
+            }
+        }
+        END_TIMER("Bounding box element iteration");
+    }
+}
+
 template<unsigned int dim>
 void InspectElementsAlgorithm<dim>::compute_intersections_BIHtree(const BIHTree& bih)
 {
     DebugOut() << "#########   ALGORITHM: compute_intersections_BIHtree   #########\n";
     
-    init();
+    if (n_threads_ > 1) {
+        compute_intersections_threaded(bih, false);
+    }
+    else {
+        init();
+        
+        START_TIMER("Element iteration");
+        for (auto elm : mesh->elements_range())
+            compute_element_intersections_BIHtree(bih, elm);
+        END_TIMER("Element iteration");
+    }
+}
+
+template<unsigned int dim>
+void InspectElementsAlgorithm<dim>::create_thread_groups(bool whole_components,
+                                                         std::vector<std::vector<unsigned int>> &groups)
+{
+    groups.clear();
     
-    START_TIMER("Element iteration");
+    if (! whole_components) {
+        // elements are independent, make groups of consecutive elements
+        const unsigned int group_size = 64;
+        for (auto ele : mesh->elements_range()) {
+            if (ele->dim() != dim) continue;
+            if (groups.empty() || groups.back().size() == group_size)
+                groups.push_back(std::vector<unsigned int>());
+            groups.back().push_back(ele.idx());
+        }
+        return;
+    }
     
-    for (auto elm : mesh->elements_range()) {
-        unsigned int component_ele_idx = elm.idx();
-        
-        if (elm.dim() == dim &&                                    // is component element
-            bih.ele_bounding_box(component_ele_idx).intersect(bih.tree_box()))   // its bounding box intersects 3D mesh bounding box
-        {   
-            std::vector<unsigned int> searchedElements;
-            
-            START_TIMER("BIHtree find");
-            bih.find_bounding_box(bih.ele_bounding_box(component_ele_idx), searchedElements);
-            END_TIMER("BIHtree find");
-            
-            START_TIMER("Bounding box element iteration");
+    // prolongation never leaves a connected component of dim-D elements (connected through edges),
+    // same numbering algorithm as InspectElementsAlgorithm22::create_component_numbering
+    std::vector<bool> in_component(mesh->n_elements(), false);
+    std::queue<unsigned int> queue;
+    
+    for (auto ele : mesh->elements_range()) {
+        if (ele->dim() == dim && !in_component[ele.idx()])
+        {
+            // start component
+            groups.push_back(std::vector<unsigned int>());
+            std::vector<unsigned int> &component = groups.back();
+            in_component[ele.idx()] = true;
+            queue.push(ele.idx());
             
-            // Go through all element which bounding box intersects the component element bounding box
-            for (std::vector<unsigned int>::iterator it = searchedElements.begin(); it!=searchedElements.end(); it++)
-            {
-                unsigned int bulk_ele_idx = *it;
-                ElementAccessor<3> ele_3D = mesh->element_accessor( bulk_ele_idx );
-                
-                if (ele_3D.dim() == 3
-                ) {
-                    // check that tetrahedron element is numbered correctly and is not degenerated
-                    ASSERT_DBG(ele_3D.tetrahedron_jacobian() > 0).add_value(ele_3D.idx(),"element index").error(
-                           "Tetrahedron element (%d) has wrong numbering or is degenerated (negative Jacobian).");
-                    
-                    IntersectionAux<dim,3> is(component_ele_idx, bulk_ele_idx);
-                    START_TIMER("Compute intersection");
-                    ComputeIntersection<dim,3> CI(elm, ele_3D, mesh);
-                    CI.init();
-                    CI.compute(is);
-                    END_TIMER("Compute intersection");
-                    
-                    if(is.points().size() > 0) {
-                        
-                        intersection_list_[component_ele_idx].push_back(is);
-                        n_intersections_++;
-                        // if component element is closed, do not check other bounding boxes
-                        closed_elements[component_ele_idx] = true;
+            while(!queue.empty()){
+                unsigned int ele_idx = queue.front();
+                queue.pop();
+                component.push_back(ele_idx);
+                const ElementAccessor<3>& elm = mesh->element_accessor( ele_idx );
+                for(unsigned int sid=0; sid < elm->n_sides(); sid++) {
+                    const Edge* edg = elm.side(sid)->edge();
+
+                    for(int j=0; j < edg->n_sides;j++) {
+                        uint neigh_idx = edg->side(j)->element().idx();
+                        if (!in_component[neigh_idx]) {
+                            in_component[neigh_idx] = true;
+                            queue.push(neigh_idx);
+                        }
                     }
                 }
             }
-            END_TIMER("Bounding box element iteration");
+            // keep the order of the serial algorithm
+            std::sort(component.begin(), component.end());
         }
     }
+}
+
 
+template<unsigned int dim>
+void InspectElementsAlgorithm<dim>::compute_intersections_threaded(const BIHTree& bih, bool prolongation)
+{
+    init();
+    
+    START_TIMER("Create thread groups");
+    std::vector<std::vector<unsigned int>> groups;
+    create_thread_groups(prolongation, groups);
+    END_TIMER("Create thread groups");
+    
+    START_TIMER("Element iteration");
+    // Every thread runs the serial algorithm with its own queues and auxiliary arrays.
+    // Groups do not share component elements, so the resulting intersection lists
+    // of the group elements are moved to the common list without any synchronization.
+    std::vector<InspectElementsAlgorithm<dim>> workers(n_threads_, InspectElementsAlgorithm<dim>(mesh));
+    for (auto &worker : workers) worker.init();
+    std::exception_ptr thread_exception;
+    
+#ifdef FLOW123D_HAVE_OPENMP
+    #pragma omp parallel num_threads(n_threads_)
+#endif
+    {
+        try {
+#ifdef FLOW123D_HAVE_OPENMP
+            InspectElementsAlgorithm<dim> &worker = workers[omp_get_thread_num()];
+#else
+            InspectElementsAlgorithm<dim> &worker = workers[0];
+#endif
+            
+#ifdef FLOW123D_HAVE_OPENMP
+            #pragma omp for schedule(dynamic) nowait
+#endif
+            for (int i_group = 0; i_group < (int)groups.size(); i_group++) {
+                for (unsigned int ele_idx : groups[i_group]) {
+                    ElementAccessor<3> elm = mesh->element_accessor( ele_idx );
+                    if (prolongation) worker.compute_element_intersections(bih, elm);
+                    else worker.compute_element_intersections_BIHtree(bih, elm);
+                }
+                for (unsigned int ele_idx : groups[i_group])
+                    intersection_list_[ele_idx].swap(worker.intersection_list_[ele_idx]);
+            }
+        } catch (...) {
+#ifdef FLOW123D_HAVE_OPENMP
+            #pragma omp critical (intersection_exception)
+#endif
+            thread_exception = std::current_exception();
+        }
+    }
+    if (thread_exception) std::rethrow_exception(thread_exception);
+    
+    for (auto &worker : workers) {
+        n_intersections_ += worker.n_intersections_;
+        for (unsigned int i = 0; i < closed_elements.size(); i++)
+            if (worker.closed_elements[i]) closed_elements[i] = true;
+    }
     END_TIMER("Element iteration");
 }
 
+
 template<unsigned int dim>
 void InspectElementsAlgorithm<dim>::compute_intersections_BB()
 {
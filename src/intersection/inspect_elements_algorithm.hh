@@ -113,6 +113,14 @@ public:
     void compute_intersections_BB();
     //@}
     
+    /** @brief Sets number of threads used by the BIH algorithms.
+     * 
+     * Component elements are split into independent groups (whole components for the prolongation algorithm),
+     * the groups are distributed among threads and every thread runs the serial algorithm on its own data.
+     * The result is same as in the serial computation. Ignored if OpenMP is not available.
+     */
+    void set_n_threads(unsigned int n_threads);
+    
 private:
     using IntersectionAlgorithmBase<dim,3>::mesh;
     using IntersectionAlgorithmBase<dim,3>::undefined_elm_idx_;
@@ -133,6 +141,9 @@ private:
     /// Counter for intersection among elements.
     unsigned int n_intersections_;
     
+    /// Number of threads used by the BIH algorithms.
+    unsigned int n_threads_;
+    
     /// Prolongation queue in the component mesh.
     std::queue<Prolongation> component_queue_;
     /// Prolongation queue in the bulk mesh.
@@ -157,6 +168,21 @@ private:
     /// Computes bounding boxes of all elements. Fills @p elements_bb and @p mesh_3D_bb.
     void compute_bounding_boxes();
     
+    /// Single step of @p compute_intersections: finds initial candidate of component element @p elm
+    /// and prolongates the intersection.
+    void compute_element_intersections(const BIHTree& bih, const ElementAccessor<3> &elm);
+    
+    /// Single step of @p compute_intersections_BIHtree: computes intersections of component element @p elm
+    /// with all candidates found in BIH.
+    void compute_element_intersections_BIHtree(const BIHTree& bih, const ElementAccessor<3> &elm);
+    
+    /// Splits component elements into groups that can be computed independently. Elements of a group are sorted.
+    /// If @p whole_components is true, every group is a connected component of @p dim-D elements.
+    void create_thread_groups(bool whole_components, std::vector<std::vector<unsigned int>> &groups);
+    
+    /// Computes intersections by @p n_threads_ threads, runs the prolongation algorithm if @p prolongation is true.
+    void compute_intersections_threaded(const BIHTree& bih, bool prolongation);
+    
     void assert_same_intersection(unsigned int comp_ele_idx, unsigned int bulk_ele_idx);
     
     /// A hard way to find whether the intersection of two elements has already been computed, or not.
@@ -5,6 +5,15 @@
  *      Author: viktor, pe, jb
  */
 
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "inspect_elements_algorithm.hh"
 #include "intersection_point_aux.hh"
 #include "intersection_aux.hh"
@@ -23,8 +32,122 @@
 #include "mesh/range_wrapper.hh"
 
 
+namespace {
+
+/// Magic bytes at the beginning of an intersection cache file.
+const char cache_magic[8] = {'F','1','2','3','I','S','E','C'};
+/// Version of the cache file format, change it with every change of the format or of the algorithms.
+const uint32_t cache_version = 1;
+
+/// Storage indices used in the cache file for the intersection map.
+enum CacheStorage : uint8_t { storage13 = 0, storage23 = 1, storage22 = 2, storage12 = 3 };
+
+/// Incremental FNV-1a hash, stable across runs and platforms with the same byte order.
+class CacheHash {
+public:
+    void add(const void *data, std::size_t size) {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        for (std::size_t i = 0; i < size; i++) {
+            hash_ ^= bytes[i];
+            hash_ *= 1099511628211ULL;
+        }
+    }
+
+    template<class T>
+    void add(const T &value) {
+        add(&value, sizeof(T));
+    }
+
+    uint64_t value() const {
+        return hash_;
+    }
+
+private:
+    uint64_t hash_ = 14695981039346656037ULL;
+};
+
+/// Sequential reader of a memory mapped cache file, checks the file bounds.
+class CacheReader {
+public:
+    CacheReader(const char *data, std::size_t size)
+    : pos_(data), end_(data + size)
+    {}
+
+    template<class T>
+    bool read(T &value) {
+        if (remaining() < sizeof(T)) return false;
+        std::memcpy(&value, pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return true;
+    }
+
+    std::size_t remaining() const {
+        return end_ - pos_;
+    }
+
+private:
+    const char *pos_;
+    const char *end_;
+};
+
+template<class T>
+void write_value(std::ostream &os, const T &value) {
+    os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template<unsigned int dimA, unsigned int dimB>
+void write_storage(std::ostream &os, const std::vector<IntersectionLocal<dimA,dimB>> &storage) {
+    write_value(os, (uint64_t)storage.size());
+    for (const IntersectionLocal<dimA,dimB> &il : storage) {
+        write_value(os, (uint32_t)il.component_ele_idx());
+        write_value(os, (uint32_t)il.bulk_ele_idx());
+        write_value(os, (uint32_t)il.size());
+        for (const IntersectionPoint<dimA,dimB> &ip : il.points()) {
+            os.write(reinterpret_cast<const char *>(ip.comp_coords().memptr()), dimA*sizeof(double));
+            os.write(reinterpret_cast<const char *>(ip.bulk_coords().memptr()), dimB*sizeof(double));
+        }
+    }
+}
+
+template<unsigned int dimA, unsigned int dimB>
+bool read_storage(CacheReader &reader, std::vector<IntersectionLocal<dimA,dimB>> &storage) {
+    storage.clear();
+    uint64_t n_intersections;
+    if (! reader.read(n_intersections) || n_intersections > reader.remaining()) return false;
+    storage.reserve(n_intersections);
+
+    uint32_t component_idx, bulk_idx, n_points;
+    arma::vec::fixed<dimA> comp_coords;
+    arma::vec::fixed<dimB> bulk_coords;
+    for (uint64_t i = 0; i < n_intersections; i++) {
+        if (! (reader.read(component_idx) && reader.read(bulk_idx) && reader.read(n_points)) ) return false;
+        storage.push_back(IntersectionLocal<dimA,dimB>(component_idx, bulk_idx));
+        for (uint32_t j = 0; j < n_points; j++) {
+            for (unsigned int k = 0; k < dimA; k++)
+                if (! reader.read(comp_coords[k])) return false;
+            for (unsigned int k = 0; k < dimB; k++)
+                if (! reader.read(bulk_coords[k])) return false;
+            storage.back().points().push_back(IntersectionPoint<dimA,dimB>(comp_coords, bulk_coords));
+        }
+    }
+    return true;
+}
+
+/// Returns index of the intersection @p il in @p storage, or -1 if it is not there.
+template<unsigned int dimA, unsigned int dimB>
+int64_t storage_index(const std::vector<IntersectionLocal<dimA,dimB>> &storage, const IntersectionLocalBase *il) {
+    auto *ptr = dynamic_cast<const IntersectionLocal<dimA,dimB> *>(il);
+    if (ptr == nullptr || storage.empty()) return -1;
+    int64_t idx = ptr - storage.data();
+    return (idx >= 0 && idx < (int64_t)storage.size()) ? idx : -1;
+}
+
+} // namespace
+
+
 MixedMeshIntersections::MixedMeshIntersections(Mesh* mesh)
-: mesh(mesh), algorithm13_(mesh), algorithm23_(mesh), algorithm22_(mesh), algorithm12_(mesh)
+: mesh(mesh), algorithm13_(mesh), algorithm23_(mesh), algorithm22_(mesh), algorithm12_(mesh),
+  read_from_cache_(false)
 {}
 
 MixedMeshIntersections::~MixedMeshIntersections()
@@ -161,6 +284,7 @@ void MixedMeshIntersections::compute_intersections(InspectElementsAlgorithm< dim
 {
     START_TIMER("Intersection algorithm");
 
+    iea.set_n_threads(mesh->get_intersection_threads());
     Mesh::IntersectionSearch is = mesh->get_intersection_search();
     switch(is){
         case Mesh::BIHsearch: iea.compute_intersections(mesh->get_bih_tree()); break;
@@ -325,6 +449,21 @@ void MixedMeshIntersections::compute_intersections_12_1(vector< IntersectionLoca
 
 void MixedMeshIntersections::compute_intersections(IntersectionType d)
 {
+    FilePath cache_file;
+    bool use_cache = mesh->get_intersection_cache(cache_file);
+    uint64_t key = 0;
+    read_from_cache_ = false;
+    if (use_cache) {
+        START_TIMER("Intersection cache read");
+        key = cache_key(d);
+        read_from_cache_ = read_cache(string(cache_file), key);
+        END_TIMER("Intersection cache read");
+        if (read_from_cache_) {
+            MessageOut() << "Intersections read from the cache file: " << string(cache_file) << "\n";
+            return;
+        }
+    }
+
     element_intersections_.resize(mesh->n_elements());
     
     // check whether the mesh is in plane only
@@ -393,6 +532,12 @@ void MixedMeshIntersections::compute_intersections(IntersectionType d)
         if(elm->dim() == 3) element_intersections_[elm.idx()].clear();
     }
 
+    if (use_cache) {
+        START_TIMER("Intersection cache write");
+        cache_file.create_output_dir();
+        write_cache(string(cache_file), key);
+        END_TIMER("Intersection cache write");
+    }
 
 
 }
@@ -603,3 +748,157 @@ void MixedMeshIntersections::print_mesh_to_file_23(string name)
 }
 
 
+
+uint64_t MixedMeshIntersections::cache_key(IntersectionType d)
+{
+    CacheHash hash;
+    hash.add(cache_version);
+    hash.add((uint32_t)d);
+    hash.add((uint32_t)mesh->get_intersection_search());
+
+    hash.add((uint32_t)mesh->n_nodes());
+    for (unsigned int i = 0; i < mesh->n_nodes(); i++)
+        hash.add(mesh->node_accessor(i)->point().memptr(), 3*sizeof(double));
+
+    hash.add((uint32_t)mesh->n_elements());
+    for (auto elm : mesh->elements_range()) {
+        hash.add((uint32_t)elm->dim());
+        for (unsigned int i = 0; i < elm->n_nodes(); i++)
+            hash.add((uint32_t)elm->node_idx(i));
+    }
+    return hash.value();
+}
+
+
+bool MixedMeshIntersections::read_cache(const std::string &file_name, uint64_t key)
+{
+    int fd = open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    std::size_t size = file_stat.st_size;
+    void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return false;
+
+    CacheReader reader(static_cast<const char *>(data), size);
+    char magic[sizeof(cache_magic)];
+    uint64_t file_key;
+    uint32_t n_elements;
+    // header, file of other mesh or other version is silently replaced
+    bool header_valid = reader.read(magic) && std::memcmp(magic, cache_magic, sizeof(cache_magic)) == 0
+            && reader.read(file_key) && file_key == key;
+    bool valid = header_valid
+            && reader.read(n_elements) && n_elements == mesh->n_elements()
+            && read_storage(reader, intersection_storage13_)
+            && read_storage(reader, intersection_storage23_)
+            && read_storage(reader, intersection_storage22_)
+            && read_storage(reader, intersection_storage12_);
+
+    // intersection map, pointers are stored as pairs (storage, index)
+    if (valid) element_intersections_.assign(n_elements, std::vector<ILpair>());
+    for (uint32_t i_ele = 0; valid && i_ele < n_elements; i_ele++) {
+        uint32_t n_pairs, other_idx;
+        uint8_t storage;
+        uint64_t idx;
+        valid = reader.read(n_pairs) && n_pairs <= reader.remaining();
+        if (valid) element_intersections_[i_ele].reserve(n_pairs);
+        for (uint32_t i = 0; valid && i < n_pairs; i++) {
+            valid = reader.read(other_idx) && reader.read(storage) && reader.read(idx) && other_idx < n_elements;
+            if (! valid) break;
+            IntersectionLocalBase *il = nullptr;
+            switch (storage) {
+                case storage13: if (idx < intersection_storage13_.size()) il = &(intersection_storage13_[idx]); break;
+                case storage23: if (idx < intersection_storage23_.size()) il = &(intersection_storage23_[idx]); break;
+                case storage22: if (idx < intersection_storage22_.size()) il = &(intersection_storage22_[idx]); break;
+                case storage12: if (idx < intersection_storage12_.size()) il = &(intersection_storage12_[idx]); break;
+            }
+            valid = (il != nullptr);
+            if (valid) element_intersections_[i_ele].push_back(std::make_pair(other_idx, il));
+        }
+    }
+    valid = valid && reader.remaining() == 0;
+    munmap(data, size);
+
+    if (! valid) {
+        if (header_valid)
+            WarningOut() << "Corrupted intersection cache file: " << file_name << ", intersections are recomputed.\n";
+        intersection_storage13_.clear();
+        intersection_storage23_.clear();
+        intersection_storage22_.clear();
+        intersection_storage12_.clear();
+        element_intersections_.clear();
+    }
+    return valid;
+}
+
+
+void MixedMeshIntersections::write_cache(const std::string &file_name, uint64_t key)
+{
+    // all processes compute the same intersections, only the first one writes them
+    int rank;
+    MPI_Comm_rank(mesh->get_comm(), &rank);
+    if (rank != 0) return;
+
+    // Write into a temporary file with unique name in the same directory and rename it,
+    // so that concurrent runs sharing the cache never write into the same file
+    // and never read a partially written one.
+    std::vector<char> tmp_name(file_name.begin(), file_name.end());
+    const char tmp_suffix[] = ".XXXXXX";
+    tmp_name.insert(tmp_name.end(), tmp_suffix, tmp_suffix + sizeof(tmp_suffix));
+    int fd = mkstemp(tmp_name.data());
+    if (fd < 0) {
+        WarningOut() << "Can not create temporary intersection cache file: " << tmp_name.data() << "\n";
+        return;
+    }
+    // mkstemp creates the file readable only by the owner
+    fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    close(fd);
+    std::string tmp_file_name(tmp_name.data());
+    std::ofstream os(tmp_file_name.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (! os.is_open()) {
+        WarningOut() << "Can not open intersection cache file: " << tmp_file_name << "\n";
+        std::remove(tmp_file_name.c_str());
+        return;
+    }
+
+    os.write(cache_magic, sizeof(cache_magic));
+    write_value(os, key);
+    write_value(os, (uint32_t)element_intersections_.size());
+    write_storage(os, intersection_storage13_);
+    write_storage(os, intersection_storage23_);
+    write_storage(os, intersection_storage22_);
+    write_storage(os, intersection_storage12_);
+
+    for (const std::vector<ILpair> &pairs : element_intersections_) {
+        write_value(os, (uint32_t)pairs.size());
+        for (const ILpair &pair : pairs) {
+            int64_t idx;
+            uint8_t storage;
+            if ( (idx = storage_index(intersection_storage13_, pair.second)) >= 0 ) storage = storage13;
+            else if ( (idx = storage_index(intersection_storage23_, pair.second)) >= 0 ) storage = storage23;
+            else if ( (idx = storage_index(intersection_storage22_, pair.second)) >= 0 ) storage = storage22;
+            else if ( (idx = storage_index(intersection_storage12_, pair.second)) >= 0 ) storage = storage12;
+            else {
+                // broken intersection map, do not leave a cache file that could not be read
+                WarningOut() << "Intersection map points out of the intersection storages, "
+                             << "the intersection cache file is not written: " << file_name << "\n";
+                os.close();
+                std::remove(tmp_file_name.c_str());
+                return;
+            }
+            write_value(os, (uint32_t)pair.first);
+            write_value(os, storage);
+            write_value(os, (uint64_t)idx);
+        }
+    }
+    os.close();
+
+    if (os.fail() || std::rename(tmp_file_name.c_str(), file_name.c_str()) != 0) {
+        WarningOut() << "Can not write intersection cache file: " << file_name << "\n";
+        std::remove(tmp_file_name.c_str());
+    }
+}
@@ -22,6 +22,8 @@
 #ifndef INSPECT_ELEMENTS_H_
 #define INSPECT_ELEMENTS_H_
 
+#include <cstdint>
+#include <string>
 #include "inspect_elements_algorithm.hh"
 #include "input/input_type_forward.hh"
 
@@ -87,7 +89,12 @@ public:
     
     /// Calls @p InspectElementsAlgorithm<dim>, computes intersections, 
     /// move them to storage, create the map and throw away the rest.
+    /// If the mesh defines an intersection cache file, the intersections are read from it if possible.
     void compute_intersections(IntersectionType d = IntersectionType::all);
+
+    /// True if the last @p compute_intersections read the intersections from the cache file.
+    bool read_from_cache() const
+    { return read_from_cache_; }
     
     // TODO: move following functions into common intersection test code.
     // Functions for tests.
@@ -110,6 +117,9 @@ private:
     InspectElementsAlgorithm<2> algorithm23_;
     InspectElementsAlgorithm22 algorithm22_;
     InspectElementsAlgorithm12 algorithm12_;
+
+    /// Set by @p compute_intersections, see @p read_from_cache.
+    bool read_from_cache_;
     
     template<uint dim_A, uint dim_B>
     void store_intersection(std::vector<IntersectionLocal<dim_A, dim_B>> &storage, IntersectionAux<dim_A, dim_B> &isec_aux);
@@ -124,6 +134,17 @@ private:
     void compute_intersections_12_3(std::vector<IntersectionLocal<1,2>> &storage);
     void compute_intersections_12_1(std::vector<IntersectionLocal<1,2>> &storage);
     void compute_intersections_12_2(std::vector<IntersectionLocal<1,2>> &storage);
+    
+    ///@name Intersection cache.
+    //@{
+    /// Hash of mesh nodes, elements and intersection settings, identifies the content of a cache file.
+    uint64_t cache_key(IntersectionType d);
+    /// Memory maps the cache file and fills the storages and @p element_intersections_.
+    /// Returns false if the file does not exist, is corrupted or has a different @p key.
+    bool read_cache(const std::string &file_name, uint64_t key);
+    /// Writes the storages and @p element_intersections_ to the cache file.
+    void write_cache(const std::string &file_name, uint64_t key);
+    //@}
 };
 
     
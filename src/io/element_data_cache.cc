@@ -16,12 +16,14 @@
  */
 
 
+#include <cstring>
 #include <limits>
 #include <ostream>
 #include "io/element_data_cache.hh"
 #include "io/msh_basereader.hh"
 #include "la/distribution.hh"
 #include "system/armadillo_tools.hh"
+#include "system/buffer_parser.hh"
 #include "system/system.hh"
 #include "system/tokenizer.hh"
 #include "boost/lexical_cast.hpp"
@@ -91,7 +93,10 @@ void ElementDataCache<T>::read_ascii_data(Tokenizer &tok, unsigned int n_compone
 		idx = i_row * n_components;
 		std::vector<T> &vec = *( data_[i_vec].get() );
 		for (unsigned int i_col=0; i_col < n_components; ++i_col, ++idx) {
-			vec[idx] = boost::lexical_cast<T>(*tok);
+			// same conversion as boost::lexical_cast, without the string stream
+			const std::string &token = *tok;
+			const char *pos = token.c_str();
+			if (! buffer_parser::read_value<T>(pos, pos + token.size(), vec[idx]) ) throw boost::bad_lexical_cast();
 			++tok;
 		}
 	}
@@ -111,6 +116,58 @@ void ElementDataCache<T>::read_binary_data(std::istream &data_stream, unsigned i
 }
 
 
+template <typename T>
+bool ElementDataCache<T>::read_ascii_data(const char *pos, const char *line_end, unsigned int n_components, unsigned int i_row) {
+	unsigned int idx;
+	for (unsigned int i_vec=0; i_vec<data_.size(); ++i_vec) {
+		idx = i_row * n_components;
+		std::vector<T> &vec = *( data_[i_vec].get() );
+		for (unsigned int i_col=0; i_col < n_components; ++i_col, ++idx) {
+			if (! buffer_parser::read_value<T>(pos, line_end, vec[idx]) ) return false;
+		}
+	}
+	return true;
+}
+
+
+template <typename T>
+bool ElementDataCache<T>::read_ascii_values(const char *begin, const char *end, unsigned int n_components,
+		std::size_t first_value, const std::vector<int> &rows) {
+	std::size_t row_size = data_.size() * n_components;
+	std::size_t i_row = first_value / row_size;
+	unsigned int i_row_value = first_value % row_size;
+	for (const char *pos = begin; pos < end && i_row < rows.size(); ) {
+		const char *eol = buffer_parser::line_end(pos, end);
+		while (i_row < rows.size() && buffer_parser::skip_blank(pos, eol)) {
+			std::vector<T> &vec = *( data_[i_row_value / n_components].get() );
+			unsigned int idx = rows[i_row] * n_components + i_row_value % n_components;
+			if (! buffer_parser::read_value<T>(pos, eol, vec[idx]) ) return false;
+			if (++i_row_value == row_size) {
+				i_row_value = 0;
+				++i_row;
+			}
+		}
+		pos = eol + 1;
+	}
+	return true;
+}
+
+
+template <typename T>
+void ElementDataCache<T>::read_binary_data(const char *data, unsigned int n_components, unsigned int i_row) {
+	unsigned int idx;
+	double value;
+	for (unsigned int i_vec=0; i_vec<data_.size(); ++i_vec) {
+		idx = i_row * n_components;
+		std::vector<T> &vec = *( data_[i_vec].get() );
+		for (unsigned int i_col=0; i_col < n_components; ++i_col, ++idx, data += sizeof(double)) {
+			std::memcpy(&value, data, sizeof(double));
+			vec[idx] = static_cast<T>(value);
+		}
+	}
+}
+
+
 /**
  * Output data element on given index @p idx. Method for writing data
  * to output stream.
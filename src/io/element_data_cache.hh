@@ -97,6 +97,16 @@ public:
 	/// Implements @p ElementDataCacheBase::read_binary_data.
 	void read_binary_data(std::istream &data_stream, unsigned int n_components, unsigned int i_row) override;
 
+	/// Implements @p ElementDataCacheBase::read_ascii_data.
+	bool read_ascii_data(const char *pos, const char *line_end, unsigned int n_components, unsigned int i_row) override;
+
+	/// Implements @p ElementDataCacheBase::read_ascii_values.
+	bool read_ascii_values(const char *begin, const char *end, unsigned int n_components,
+			std::size_t first_value, const std::vector<int> &rows) override;
+
+	/// Implements @p ElementDataCacheBase::read_binary_data.
+	void read_binary_data(const char *data, unsigned int n_components, unsigned int i_row) override;
+
     /**
      * Output data element on given index @p idx. Method for writing data
      * to output stream.
@@ -23,6 +23,7 @@
 #include <ostream>
 #include <string>
 #include <istream>
+#include <vector>
 #include "system/system.hh"
 #include "mesh/long_idx.hh"
 
@@ -78,6 +79,30 @@ public:
 	 */
 	virtual void read_binary_data(std::istream &data_stream, unsigned int n_components, unsigned int i_row)=0;
 
+	/**
+	 * Read ascii data of given \p i_row from the line [\p pos, \p line_end) of a character buffer.
+	 *
+	 * Returns false if the line doesn't contain valid values. Can be called concurrently for different rows.
+	 */
+	virtual bool read_ascii_data(const char *pos, const char *line_end, unsigned int n_components, unsigned int i_row)=0;
+
+	/**
+	 * Read ascii values from the part [\p begin, \p end) of a data block of whitespace separated values,
+	 * values can continue across lines. Every row of the block contains \p n_components values of every
+	 * vector of the cache, the first value of the part has index \p first_value in the block and values of
+	 * the row \p i of the block are stored to the row \p rows[i] of the cache. Values behind the last row are ignored.
+	 *
+	 * Returns false if the part doesn't contain valid values. Can be called concurrently for different parts.
+	 */
+	virtual bool read_ascii_values(const char *begin, const char *end, unsigned int n_components,
+			std::size_t first_value, const std::vector<int> &rows)=0;
+
+	/**
+	 * Read binary data of given \p i_row from the buffer \p data of (possibly unaligned) double values,
+	 * i.e. data of binary GMSH file. Can be called concurrently for different rows.
+	 */
+	virtual void read_binary_data(const char *data, unsigned int n_components, unsigned int i_row)=0;
+
     /**
      * Print one value at given index in ascii format
      */
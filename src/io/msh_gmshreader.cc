@@ -17,15 +17,24 @@
  * @author  dalibor
  */
 
+#include <algorithm>
+#include <cstring>
 #include <istream>
+#include <sstream>
 #include <string>
 #include <limits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "msh_gmshreader.h"
 #include "io/element_data_cache_base.hh"
 
+#include "system/global_defs.h"
 #include "system/system.hh"
 #include "system/tokenizer.hh"
+#include "system/buffer_parser.hh"
 #include "boost/lexical_cast.hpp"
 
 #include "mesh/mesh.h"
@@ -35,125 +44,453 @@
 using namespace std;
 
 
+namespace {
+
+/// Node read from ASCII $Nodes section.
+struct NodeRecord {
+    unsigned int id;
+    double coords[3];
+};
+
+/// Element read from ASCII $Elements section.
+struct ElementRecord {
+    unsigned int id;
+    unsigned int dim;
+    unsigned int region_id;
+    unsigned int partition_id;
+    unsigned int node_ids[4];
+};
+
+/// Errors of reading of ASCII lines.
+enum class LineError {
+    none,          ///< Line is valid.
+    number,        ///< Invalid or missing number.
+    element_type,  ///< Unsupported type of element.
+    element_tags   ///< Less than two element tags.
+};
+
+/// Records read from one part of a section and the first error.
+template <class Record>
+struct PartResult {
+    PartResult() : error(LineError::none), error_pos(nullptr), error_id(0), error_type(0) {}
+
+    std::vector<Record> records;
+    LineError error;
+    const char *error_pos;
+    unsigned int error_id, error_type;
+};
+
+
+/**
+ * Dimension of GMSH element type, supported are:
+ *  1 Line (2 nodes)
+ *  2 Triangle (3 nodes)
+ *  4 Tetrahedron (4 nodes)
+ * 15 Point (1 node)
+ * Returns false for unsupported types.
+ */
+inline bool gmsh_element_dim(unsigned int type, unsigned int &dim) {
+    switch (type) {
+        case 1: dim = 1; return true;
+        case 2: dim = 2; return true;
+        case 4: dim = 3; return true;
+        case 15: dim = 0; return true;
+        default: return false;
+    }
+}
+
+
+/**
+ * Call @p read_line(pos, eol) for all non-empty lines in [begin, end).
+ * Returns position of the first line where @p read_line fails or NULL.
+ */
+template <class ReadLine>
+const char *read_lines(const char *begin, const char *end, ReadLine read_line) {
+    for (const char *pos = begin; pos < end; ) {
+        const char *eol = buffer_parser::line_end(pos, end);
+        if (!buffer_parser::is_empty_line(pos, eol) && !read_line(pos, eol)) return pos;
+        pos = eol + 1;
+    }
+    return nullptr;
+}
+
+
+/// Move @p pos to the beginning of the next non-empty line and return end of this line.
+inline const char *next_line(const char *&pos, const char *end) {
+    while (pos < end) {
+        const char *eol = buffer_parser::line_end(pos, end);
+        if (! buffer_parser::is_empty_line(pos, eol)) return eol;
+        pos = eol + 1;
+    }
+    return end;
+}
+
+
+/// Read first value of the next non-empty line, move @p pos behind this line.
+template <class T>
+bool read_line_value(const char *&pos, const char *end, T &val) {
+    const char *eol = next_line(pos, end);
+    bool ok = buffer_parser::read_value(pos, eol, val);
+    pos = (eol < end) ? eol + 1 : end;
+    return ok;
+}
+
+
+/// Read first (possibly quoted) string of the next non-empty line, move @p pos behind this line.
+inline bool read_line_string(const char *&pos, const char *end, std::string &val) {
+    const char *eol = next_line(pos, end);
+    bool ok = buffer_parser::read_string(pos, eol, val);
+    pos = (eol < end) ? eol + 1 : end;
+    return ok;
+}
+
+
+/// Read value of type T from unaligned binary data, move @p pos behind the value.
+template <class T>
+inline T read_binary(const char *&pos) {
+    T val;
+    std::memcpy(&val, pos, sizeof(T));
+    pos += sizeof(T);
+    return val;
+}
+
+
+/// Read line of ASCII $Nodes section.
+inline bool read_node_line(const char *pos, const char *eol, NodeRecord &node) {
+    using buffer_parser::read_value;
+    // mesh size parameter possibly following the coordinates is ignored
+    return read_value(pos, eol, node.id) && read_value(pos, eol, node.coords[0])
+            && read_value(pos, eol, node.coords[1]) && read_value(pos, eol, node.coords[2]);
+}
+
+
+/// Read line of ASCII $Elements section.
+LineError read_element_line(const char *pos, const char *eol, ElementRecord &elm, unsigned int &type) {
+    using buffer_parser::read_value;
+    unsigned int n_tags, tag;
+    if (! (read_value(pos, eol, elm.id) && read_value(pos, eol, type)) ) return LineError::number;
+    if (! gmsh_element_dim(type, elm.dim) ) return LineError::element_type;
+    //get number of tags (at least 2)
+    if (! read_value(pos, eol, n_tags) ) return LineError::number;
+    if (n_tags < 2) return LineError::element_tags;
+    //get tags 1 and 2, GMSH region number is not stored
+    if (! (read_value(pos, eol, elm.region_id) && read_value(pos, eol, tag)) ) return LineError::number;
+    //get remaining tags, save partition number from the new GMSH format
+    elm.partition_id = 0;
+    if (n_tags > 2 && !read_value(pos, eol, elm.partition_id) ) return LineError::number;
+    for (unsigned int ti = 3; ti < n_tags; ti++)
+        if (! buffer_parser::skip_token(pos, eol) ) return LineError::number;
+    // read node ids
+    for (unsigned int ni=0; ni<elm.dim+1; ++ni)
+        if (! read_value(pos, eol, elm.node_ids[ni]) ) return LineError::number;
+    return LineError::none;
+}
+
+} // namespace
+
+
+
 GmshMeshReader::GmshMeshReader(const FilePath &file_name)
-: BaseMeshReader(file_name)
+: BaseMeshReader(file_name),
+  file_data_(nullptr),
+  file_size_(0),
+  binary_format_(false)
 {
     tok_.set_comment_pattern( "#");
     data_section_name_ = "$ElementData";
     has_compatible_mesh_ = false;
+    map_file(file_name);
+    make_section_table();
     make_header_table();
 }
 
 
 
 GmshMeshReader::~GmshMeshReader()   // Tokenizer close the file automatically
-{}
+{
+    if (file_data_ != nullptr) munmap(const_cast<char *>(file_data_), file_size_);
+}
+
+
+
+void GmshMeshReader::map_file(const FilePath &file_name) {
+    string path = file_name;
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) THROW(ExcMapFile() << EI_GMSHFile(path) );
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) {
+        void *data = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            file_data_ = static_cast<const char *>(data);
+            file_size_ = file_stat.st_size;
+        }
+    }
+    close(fd);
+    // empty file is accepted, missing sections are reported later
+    if (file_data_ == nullptr && file_stat.st_size > 0) THROW(ExcMapFile() << EI_GMSHFile(path) );
+}
+
+
+
+void GmshMeshReader::make_section_table() {
+    using namespace buffer_parser;
+    sections_.clear();
+    if (file_data_ == nullptr) return;
+
+    const char *file_end = file_data_ + file_size_;
+    // return beginning of the next line starting by '$'
+    auto next_section_line = [this, file_end](const char *pos) -> const char * {
+        while (pos < file_end) {
+            const char *dollar = static_cast<const char *>( std::memchr(pos, '$', file_end - pos) );
+            if (dollar == nullptr) return file_end;
+            if (dollar == file_data_ || *(dollar-1) == '\n') return dollar;
+            pos = dollar + 1;
+        }
+        return file_end;
+    };
+
+    for (const char *pos = next_section_line(file_data_); pos < file_end; ) {
+        const char *eol = line_end(pos, file_end);
+        const char *name_end = pos;
+        while (name_end < eol && !is_blank(*name_end)) ++name_end;
+
+        MeshSection section;
+        section.name.assign(pos, name_end);
+        section.begin = (eol < file_end) ? eol + 1 : file_end;
+        if (section.name.compare(0, 4, "$End") == 0) {
+            pos = next_section_line(section.begin);
+            continue;
+        }
+
+        if (section.name == "$MeshFormat") {
+            // format line: version file-type data-size, binary format continues by integer 1 in binary form
+            const char *format_pos = section.begin;
+            const char *format_eol = next_line(format_pos, file_end);
+            double version;
+            unsigned int file_type, data_size;
+            if (! (read_value(format_pos, format_eol, version) && read_value(format_pos, format_eol, file_type)
+                    && read_value(format_pos, format_eol, data_size)) )
+                THROW(ExcWrongFormat() << EI_Type("$MeshFormat") << EI_TokenizerMsg(position_msg(format_pos))
+                        << EI_MeshFile(tok_.f_name()) );
+            if (file_type == 1) {
+                if (data_size != sizeof(double) || format_eol + 1 + sizeof(int) > file_end)
+                    THROW(ExcBinaryFormat() << EI_GMSHFile(tok_.f_name()) );
+                format_pos = format_eol + 1;
+                if (read_binary<int>(format_pos) != 1) THROW(ExcBinaryFormat() << EI_GMSHFile(tok_.f_name()) );
+                binary_format_ = true;
+            }
+            section.end = next_section_line(format_pos);
+        } else if (binary_format_ && (section.name == "$Nodes" || section.name == "$Elements" || section.name == data_section_name_)) {
+            section.end = binary_section_end(section);
+        } else {
+            section.end = next_section_line(section.begin);
+        }
+
+        sections_.push_back(section);
+        pos = next_section_line(section.end);
+    }
+}
+
+
+
+const char *GmshMeshReader::binary_section_end(const MeshSection &section) {
+    const char *file_end = file_data_ + file_size_;
+    const char *pos = section.begin;
+    auto check_size = [&](std::size_t size) {
+        if (pos + size > file_end)
+            THROW(ExcWrongFormat() << EI_Type("binary " + section.name + " section") << EI_TokenizerMsg(position_msg(pos))
+                    << EI_MeshFile(tok_.f_name()) );
+    };
+
+    if (section.name == data_section_name_) {
+        MeshDataHeader header;
+        read_data_header(pos, file_end, header);
+        std::size_t data_size = (std::size_t)header.n_entities * (sizeof(int) + header.n_components*sizeof(double));
+        check_size(data_size);
+        return pos + data_size;
+    }
+
+    unsigned int n_entities;
+    if (! read_line_value(pos, file_end, n_entities) )
+        THROW(ExcWrongFormat() << EI_Type("number") << EI_TokenizerMsg(position_msg(section.begin)) << EI_MeshFile(tok_.f_name()) );
+
+    if (section.name == "$Nodes") {
+        std::size_t data_size = (std::size_t)n_entities * (sizeof(int) + 3*sizeof(double));
+        check_size(data_size);
+        return pos + data_size;
+    }
+
+    // $Elements: blocks of elements of same type and same number of tags, every block starts by header:
+    // element-type number-of-elements number-of-tags
+    for (unsigned int n_read = 0; n_read < n_entities; ) {
+        check_size(3*sizeof(int));
+        int type = read_binary<int>(pos);
+        int n_block = read_binary<int>(pos);
+        int n_tags = read_binary<int>(pos);
+        unsigned int dim;
+        if (! gmsh_element_dim(type, dim) ) {
+            check_size(sizeof(int));
+            THROW(ExcUnsupportedType() << EI_ElementId(read_binary<int>(pos)) << EI_ElementType(type) << EI_GMSHFile(tok_.f_name()) );
+        }
+        if (n_block <= 0 || n_tags < 0)
+            THROW(ExcWrongFormat() << EI_Type("binary $Elements section") << EI_TokenizerMsg(position_msg(pos))
+                    << EI_MeshFile(tok_.f_name()) );
+        std::size_t data_size = (std::size_t)n_block * (1 + n_tags + dim + 1) * sizeof(int);
+        check_size(data_size);
+        pos += data_size;
+        n_read += n_block;
+    }
+    return pos;
+}
+
+
+
+const GmshMeshReader::MeshSection *GmshMeshReader::find_section(const std::string &name) const {
+    for (const MeshSection &section : sections_)
+        if (section.name == name) return &section;
+    return nullptr;
+}
+
+
+
+std::string GmshMeshReader::position_msg(const char *pos) const {
+    std::stringstream ss;
+    if (binary_format_) ss << "offset: " << (pos - file_data_);
+    else ss << "line: " << std::count(file_data_, pos, '\n') + 1;
+    ss << ", in file '" << tok_.f_name() << "'";
+    return ss.str();
+}
 
 
 
 void GmshMeshReader::read_nodes(Mesh * mesh) {
-    using namespace boost;
-    unsigned int n_nodes;
     MessageOut() << "- Reading nodes...";
-    tok_.set_position( Tokenizer::Position() );
 
-    if (! tok_.skip_to("$Nodes")) THROW(ExcMissingSection() << EI_Section("$Nodes") << EI_GMSHFile(tok_.f_name()) );
-    try {
-    	tok_.next_line(false);
-        n_nodes = lexical_cast<unsigned int> (*tok_);
-        mesh->init_node_vector( n_nodes );
-        INPUT_CHECK( n_nodes > 0, "Zero number of nodes, %s.\n", tok_.position_msg().c_str() );
-        ++tok_; // end of line
+    const MeshSection *section = find_section("$Nodes");
+    if (section == nullptr) THROW(ExcMissingSection() << EI_Section("$Nodes") << EI_GMSHFile(tok_.f_name()) );
 
+    const char *pos = section->begin;
+    unsigned int n_nodes;
+    if (! read_line_value(pos, section->end, n_nodes) )
+    	THROW(ExcWrongFormat() << EI_Type("number") << EI_TokenizerMsg(position_msg(section->begin)) << EI_MeshFile(tok_.f_name()) );
+    INPUT_CHECK( n_nodes > 0, "Zero number of nodes, %s.\n", position_msg(section->begin).c_str() );
+    mesh->init_node_vector( n_nodes );
+
+    arma::vec3 coords; // node coordinates
+    if (binary_format_) {
+        // records: node-number x y z, size of the section is checked by make_section_table
         for (unsigned int i = 0; i < n_nodes; ++i) {
-        	tok_.next_line();
-
-            unsigned int id = lexical_cast<unsigned int> (*tok_); ++tok_; // node id
-        	arma::vec3 coords;                                         // node coordinates
-        	coords(0) = lexical_cast<double> (*tok_); ++tok_;
-        	coords(1) = lexical_cast<double> (*tok_); ++tok_;
-        	coords(2) = lexical_cast<double> (*tok_); ++tok_;
-            ++tok_; // skip mesh size parameter
-
+            unsigned int id = read_binary<int>(pos);
+            for (unsigned int j = 0; j < 3; ++j) coords(j) = read_binary<double>(pos);
             mesh->add_node(id, coords);
         }
-
-    } catch (bad_lexical_cast &) {
-    	THROW(ExcWrongFormat() << EI_Type("number") << EI_TokenizerMsg(tok_.position_msg()) << EI_MeshFile(tok_.f_name()) );
+    } else {
+        // parts of the section are read in parallel, nodes are added to the mesh in order of the file
+        std::vector<const char *> bounds = buffer_parser::split_lines(pos, section->end, buffer_parser::n_read_parts(pos, section->end));
+        std::vector< PartResult<NodeRecord> > parts(bounds.size()-1);
+        buffer_parser::read_parts(parts.size(), [&bounds, &parts](unsigned int i_part) {
+            PartResult<NodeRecord> &part = parts[i_part];
+            NodeRecord node;
+            part.error_pos = read_lines(bounds[i_part], bounds[i_part+1], [&part, &node](const char *pos, const char *eol) {
+                if (! read_node_line(pos, eol, node) ) return false;
+                part.records.push_back(node);
+                return true;
+            });
+        });
+
+        unsigned int n_read = 0;
+        for (PartResult<NodeRecord> &part : parts) {
+            for (unsigned int i = 0; i < part.records.size() && n_read < n_nodes; ++i, ++n_read) {
+                for (unsigned int j = 0; j < 3; ++j) coords(j) = part.records[i].coords[j];
+                mesh->add_node(part.records[i].id, coords);
+            }
+            if (part.error_pos != nullptr && n_read < n_nodes)
+                THROW(ExcWrongFormat() << EI_Type("number") << EI_TokenizerMsg(position_msg(part.error_pos)) << EI_MeshFile(tok_.f_name()) );
+            std::vector<NodeRecord>().swap(part.records);
+        }
+        if (n_read < n_nodes)
+            THROW(ExcWrongFormat() << EI_Type("number") << EI_TokenizerMsg(position_msg(section->end)) << EI_MeshFile(tok_.f_name()) );
     }
+
     MessageOut().fmt("... {} nodes read. \n", n_nodes);
 }
 
 
 void GmshMeshReader::read_elements(Mesh * mesh) {
-    using namespace boost;
     MessageOut() << "- Reading elements...";
 
-    if (! tok_.skip_to("$Elements")) THROW(ExcMissingSection() << EI_Section("$Elements") << EI_GMSHFile(tok_.f_name()) );
-    try {
-    	tok_.next_line(false);
-        unsigned int n_elements = lexical_cast<unsigned int> (*tok_);
-        INPUT_CHECK( n_elements > 0, "Zero number of elements, %s.\n", tok_.position_msg().c_str());
-        ++tok_; // end of line
+    const MeshSection *section = find_section("$Elements");
+    if (section == nullptr) THROW(ExcMissingSection() << EI_Section("$Elements") << EI_GMSHFile(tok_.f_name()) );
 
-        std::vector<unsigned int> node_ids; //node_ids of elements
-        node_ids.resize(4); // maximal count of nodes
+    const char *pos = section->begin;
+    unsigned int n_elements;
+    if (! read_line_value(pos, section->end, n_elements) )
+    	THROW(ExcWrongFormat() << EI_Type("number") << EI_TokenizerMsg(position_msg(section->begin)) << EI_MeshFile(tok_.f_name()) );
+    INPUT_CHECK( n_elements > 0, "Zero number of elements, %s.\n", position_msg(section->begin).c_str() );
 
-        mesh->init_element_vector(n_elements);
+    std::vector<unsigned int> node_ids; //node_ids of elements
+    node_ids.resize(4); // maximal count of nodes
 
-        for (unsigned int i = 0; i < n_elements; ++i) {
-        	tok_.next_line();
-            unsigned int id = lexical_cast<unsigned int>(*tok_); ++tok_;
+    mesh->init_element_vector(n_elements);
 
-            //get element type: supported:
-            //  1 Line (2 nodes)
-            //  2 Triangle (3 nodes)
-            //  4 Tetrahedron (4 nodes)
-            // 15 Point (1 node)
-            unsigned int type = lexical_cast<unsigned int>(*tok_); ++tok_;
+    if (binary_format_) {
+        // blocks of elements, block header: element-type number-of-elements number-of-tags,
+        // element record: element-number tags node-numbers; sizes are checked by make_section_table
+        std::vector<int> record;
+        for (unsigned int n_read = 0; n_read < n_elements; ) {
+            int type = read_binary<int>(pos);
+            int n_block = read_binary<int>(pos);
+            int n_tags = read_binary<int>(pos);
             unsigned int dim;
-            switch (type) {
-                case 1:
-                    dim = 1;
-                    break;
-                case 2:
-                    dim = 2;
-                    break;
-                case 4:
-                    dim = 3;
-                    break;
-                case 15:
-                    dim = 0;
-                    break;
-                default:
-                    dim = 0;
-                    THROW(ExcUnsupportedType() << EI_ElementId(id) << EI_ElementType(type) << EI_GMSHFile(tok_.f_name()) );
-                    break;
+            gmsh_element_dim(type, dim);
+            record.resize(1 + n_tags + dim + 1);
+            for (int i_elm = 0; i_elm < n_block; ++i_elm, ++n_read) {
+                std::memcpy(&(record[0]), pos, record.size()*sizeof(int));
+                pos += record.size()*sizeof(int);
+                INPUT_CHECK(n_tags >= 2, "At least two element tags have to be defined for element with id=%d, %s.\n",
+                        record[0], position_msg(pos).c_str());
+                unsigned int partition_id = (n_tags > 2) ? record[3] : 0;
+                for (unsigned int ni=0; ni<dim+1; ++ni) node_ids[ni] = record[1 + n_tags + ni];
+                mesh->add_element(record[0], dim, record[1], partition_id, node_ids);
             }
-
-            //get number of tags (at least 2)
-            unsigned int n_tags = lexical_cast<unsigned int>(*tok_);
-            INPUT_CHECK(n_tags >= 2, "At least two element tags have to be defined for element with id=%d, %s.\n",
-                    id, tok_.position_msg().c_str());
-            ++tok_;
-
-            //get tags 1 and 2
-            unsigned int region_id = lexical_cast<unsigned int>(*tok_); ++tok_; // region_id
-            lexical_cast<unsigned int>(*tok_); ++tok_; // GMSH region number, we do not store this
-            //get remaining tags
-            unsigned int partition_id = 0;
-            if (n_tags > 2)  { partition_id = lexical_cast<unsigned int>(*tok_); ++tok_; } // save partition number from the new GMSH format
-            for (unsigned int ti = 3; ti < n_tags; ti++) ++tok_;         //skip remaining tags
-
-            for (unsigned int ni=0; ni<dim+1; ++ni) { // read node ids
-            	node_ids[ni] = lexical_cast<unsigned int>(*tok_);
-                ++tok_;
+        }
+    } else {
+        // parts of the section are read in parallel, elements are added to the mesh in order of the file
+        std::vector<const char *> bounds = buffer_parser::split_lines(pos, section->end, buffer_parser::n_read_parts(pos, section->end));
+        std::vector< PartResult<ElementRecord> > parts(bounds.size()-1);
+        buffer_parser::read_parts(parts.size(), [&bounds, &parts](unsigned int i_part) {
+            PartResult<ElementRecord> &part = parts[i_part];
+            ElementRecord elm;
+            part.error_pos = read_lines(bounds[i_part], bounds[i_part+1], [&part, &elm](const char *pos, const char *eol) {
+                part.error = read_element_line(pos, eol, elm, part.error_type);
+                if (part.error != LineError::none) {
+                    part.error_id = elm.id;
+                    return false;
+                }
+                part.records.push_back(elm);
+                return true;
+            });
+        });
+
+        unsigned int n_read = 0;
+        for (PartResult<ElementRecord> &part : parts) {
+            for (unsigned int i = 0; i < part.records.size() && n_read < n_elements; ++i, ++n_read) {
+                const ElementRecord &elm = part.records[i];
+                for (unsigned int ni=0; ni<elm.dim+1; ++ni) node_ids[ni] = elm.node_ids[ni];
+                mesh->add_element(elm.id, elm.dim, elm.region_id, elm.partition_id, node_ids);
+            }
+            if (part.error != LineError::none && n_read < n_elements) {
+                if (part.error == LineError::element_type)
+                    THROW(ExcUnsupportedType() << EI_ElementId(part.error_id) << EI_ElementType(part.error_type) << EI_GMSHFile(tok_.f_name()) );
+                INPUT_CHECK(part.error != LineError::element_tags, "At least two element tags have to be defined for element with id=%d, %s.\n",
+                        part.error_id, position_msg(part.error_pos).c_str());
+                THROW(ExcWrongFormat() << EI_Type("number") << EI_TokenizerMsg(position_msg(part.error_pos)) << EI_MeshFile(tok_.f_name()) );
             }
-            mesh->add_element(id, dim, region_id, partition_id, node_ids);
+            std::vector<ElementRecord>().swap(part.records);
         }
-
-    } catch (bad_lexical_cast &) {
-    	THROW(ExcWrongFormat() << EI_Type("number") << EI_TokenizerMsg(tok_.position_msg()) << EI_MeshFile(tok_.f_name()) );
+        if (n_read < n_elements)
+            THROW(ExcWrongFormat() << EI_Type("number") << EI_TokenizerMsg(position_msg(section->end)) << EI_MeshFile(tok_.f_name()) );
     }
 
     mesh->create_boundary_elements();
@@ -191,102 +528,155 @@ void GmshMeshReader::read_physical_names(Mesh * mesh) {
 }
 
 
-// Is assumed to be called just after tok.skip_to("..")
-// reads the header from the tokenizer @p tok and return it as the second parameter
-void GmshMeshReader::read_data_header(MeshDataHeader &head) {
-    using namespace boost;
-    try {
-        // string tags
-    	tok_.next_line(false);
-        unsigned int n_str = lexical_cast<unsigned int>(*tok_); ++tok_;
-        head.field_name="";
-        head.interpolation_scheme = "";
-        if (n_str > 0) {
-        	tok_.next_line(); n_str--;
-            head.field_name= *tok_; ++tok_; //  unquoted by tokenizer if needed
-        }
-        if (n_str > 0) {
-        	tok_.next_line(); n_str--;
-            head.interpolation_scheme = *tok_; ++tok_;
-        }
-        for(;n_str>0;n_str--) tok_.next_line(false); // skip possible remaining tags
-
-        //real tags
-        tok_.next_line();
-        unsigned int n_real = lexical_cast<unsigned int>(*tok_); ++tok_;
-        head.time=0.0;
-        if (n_real>0) {
-        	tok_.next_line(); n_real--;
-            head.time=lexical_cast<double>(*tok_); ++tok_;
-        }
-        for(;n_real>0;n_real--) tok_.next_line(false);
-
-        // int tags
-        tok_.next_line();
-        unsigned int n_int = lexical_cast<unsigned int>(*tok_); ++tok_;
-        head.time_index=0;
-        head.n_components=1;
-        head.n_entities=0;
-        head.partition_index=0;
-        if (n_int>0) {
-        	tok_.next_line(); n_int--;
-            head.time_index=lexical_cast<unsigned int>(*tok_); ++tok_;
-        }
-        if (n_int>0) {
-        	tok_.next_line(); n_int--;
-            head.n_components=lexical_cast<unsigned int>(*tok_); ++tok_;
-        }
-        if (n_int>0) {
-        	tok_.next_line(); n_int--;
-            head.n_entities=lexical_cast<unsigned int>(*tok_); ++tok_;
-        }
-        for(;n_int>0;n_int--) tok_.next_line(false);
-        head.position = tok_.get_position();
-        head.discretization = OutputTime::DiscreteSpace::ELEM_DATA;
-    } catch (bad_lexical_cast &) {
-    	THROW(ExcWrongFormat() << EI_Type("$ElementData header") << EI_TokenizerMsg(tok_.position_msg()) << EI_MeshFile(tok_.f_name()) );
+// reads the header of $ElementData section starting at @p pos and return it as the third parameter
+void GmshMeshReader::read_data_header(const char *&pos, const char *end, MeshDataHeader &head) {
+    // every tag is on a separate line, possible remaining content of the line is ignored
+    std::string str_tag;
+    double real_tag;
+    unsigned int n_str, n_real, n_int;
+    const char *header_begin = pos;
+    bool ok;
+
+    // string tags
+    ok = read_line_value(pos, end, n_str);
+    head.field_name="";
+    head.interpolation_scheme = "";
+    for (unsigned int i=0; ok && i<n_str; ++i) {
+        ok = read_line_string(pos, end, str_tag); //  unquoted if needed
+        if (i == 0) head.field_name = str_tag;
+        else if (i == 1) head.interpolation_scheme = str_tag;
+    }
+
+    //real tags
+    ok = ok && read_line_value(pos, end, n_real);
+    head.time=0.0;
+    for (unsigned int i=0; ok && i<n_real; ++i) {
+        ok = read_line_value(pos, end, real_tag);
+        if (i == 0) head.time = real_tag;
+    }
+
+    // int tags
+    ok = ok && read_line_value(pos, end, n_int);
+    head.time_index=0;
+    head.n_components=1;
+    head.n_entities=0;
+    head.partition_index=0;
+    unsigned int int_tags[3] = {0, 1, 0};
+    for (unsigned int i=0; ok && i<n_int; ++i) {
+        if (i < 3) ok = read_line_value(pos, end, int_tags[i]);
+        else ok = read_line_string(pos, end, str_tag); // skip possible remaining tags
     }
+    if (! ok)
+    	THROW(ExcWrongFormat() << EI_Type("$ElementData header") << EI_TokenizerMsg(position_msg(header_begin))
+    			<< EI_MeshFile(tok_.f_name()) );
+    head.time_index = int_tags[0];
+    head.n_components = int_tags[1];
+    head.n_entities = int_tags[2];
+
+    head.position = Tokenizer::Position(pos - file_data_, 0, 0);
+    head.discretization = OutputTime::DiscreteSpace::ELEM_DATA;
 }
 
 
 
 void GmshMeshReader::read_element_data(ElementDataCacheBase &data_cache, MeshDataHeader actual_header, unsigned int n_components,
 		bool boundary_domain) {
-    unsigned int id, i_row;
-    unsigned int n_read = 0;
-    std::vector<int> const & el_ids = this->get_element_vector(boundary_domain);
-    vector<int>::const_iterator id_iter = el_ids.begin();
+    // rows are matched by IDs independently on their order, so parts of the section can be read in any order
+    const std::vector< std::pair<int, unsigned int> > &id_index = this->element_id_index(boundary_domain);
 
     // read @p data buffer as we have correct header with already passed time
     // we assume that @p data buffer is big enough
-    tok_.set_position(actual_header.position);
-
-    // read data
-    for (i_row = 0; i_row < actual_header.n_entities; ++i_row)
-        try {
-            tok_.next_line();
-            id = boost::lexical_cast<unsigned int>(*tok_); ++tok_;
-            //skip_element = false;
-            while (id_iter != el_ids.end() && *id_iter < (int)id) {
-                ++id_iter; // skip initialization of some rows in data if ID is missing
-            }
-            if (id_iter == el_ids.end()) {
-            	WarningOut().fmt("In file '{}', '$ElementData' section for field '{}', time: {}.\nData ID {} not found or is not in order. Skipping rest of data.\n",
-                        tok_.f_name(), actual_header.field_name, actual_header.time, id);
-                break;
-            }
-            // save data from the line if ID was found
-            if (*id_iter == (int)id) {
-            	data_cache.read_ascii_data(tok_, n_components, (id_iter - el_ids.begin()) );
-                n_read++;
-            }
-            // skip the line if ID on the line  < actual ID in the map el_ids
-        } catch (boost::bad_lexical_cast &) {
-        	THROW(ExcWrongFormat() << EI_Type("$ElementData line") << EI_TokenizerMsg(tok_.position_msg())
+    const char *data_begin = file_data_ + std::streamoff(actual_header.position.file_position_);
+    const MeshSection *section = nullptr;
+    for (const MeshSection &s : sections_)
+        if (s.begin <= data_begin && data_begin <= s.end) section = &s;
+    ASSERT(section != nullptr).error("Position of data out of $ElementData sections.\n");
+
+    // Data of every part are read independently. Rows with ID not found in the mesh are skipped.
+    struct DataPart {
+        unsigned int n_read;
+        const char *error_pos;
+        unsigned int n_missing;
+        int missing_id;
+    };
+    auto find_idx = [&id_index](int id, DataPart &part) -> int {
+        auto it = std::lower_bound(id_index.begin(), id_index.end(), std::make_pair(id, 0u));
+        if (it != id_index.end() && it->first == id) return it->second;
+        if (part.n_missing++ == 0) part.missing_id = id;
+        return -1;
+    };
+
+    std::vector<DataPart> parts;
+    if (binary_format_) {
+        // record: element-number value ... , number of values in the file is given by header of the section
+        unsigned int n_file_components = actual_header.n_components;
+        for (const MeshDataHeader &header : header_table_[actual_header.field_name])
+            if (header.position.file_position_ == actual_header.position.file_position_) n_file_components = header.n_components;
+        unsigned int n_row_values = (n_components == 1) ? n_file_components : n_components;
+        if (n_row_values > n_file_components)
+        	THROW(ExcWrongFormat() << EI_Type("$ElementData line") << EI_TokenizerMsg(position_msg(data_begin))
         			<< EI_MeshFile(tok_.f_name()) );
+        std::size_t record_size = sizeof(int) + n_file_components*sizeof(double);
+
+        unsigned int n_parts = buffer_parser::n_read_parts(data_begin, data_begin + actual_header.n_entities*record_size);
+        parts.resize(n_parts);
+        buffer_parser::read_parts(n_parts, [&](unsigned int i_part) {
+            DataPart &part = parts[i_part];
+            part.n_read = 0;
+            part.error_pos = nullptr;
+            part.n_missing = 0;
+            unsigned int i_begin = (std::size_t)actual_header.n_entities * i_part / n_parts;
+            unsigned int i_end = (std::size_t)actual_header.n_entities * (i_part+1) / n_parts;
+            for (unsigned int i_row = i_begin; i_row < i_end; ++i_row) {
+                const char *pos = data_begin + i_row*record_size;
+                int idx = find_idx(read_binary<int>(pos), part);
+                // save data from the row if ID was found
+                if (idx >= 0) {
+                    data_cache.read_binary_data(pos, n_components, idx);
+                    part.n_read++;
+                }
+            }
+        });
+    } else {
+        // only the number of rows given by the header is read, as for the binary data
+        const char *data_end = data_begin;
+        for (unsigned int i_row = 0; i_row < actual_header.n_entities && data_end < section->end; ++i_row) {
+            const char *eol = next_line(data_end, section->end);
+            data_end = (eol < section->end) ? eol + 1 : section->end;
         }
-    // possibly skip remaining lines after break
-    while (i_row < actual_header.n_entities) tok_.next_line(false), ++i_row;
+        std::vector<const char *> bounds = buffer_parser::split_lines(data_begin, data_end, buffer_parser::n_read_parts(data_begin, data_end));
+        parts.resize(bounds.size()-1);
+        buffer_parser::read_parts(parts.size(), [&](unsigned int i_part) {
+            DataPart &part = parts[i_part];
+            part.n_read = 0;
+            part.n_missing = 0;
+            part.error_pos = read_lines(bounds[i_part], bounds[i_part+1], [&](const char *pos, const char *eol) {
+                int id;
+                if (! buffer_parser::read_value(pos, eol, id) ) return false;
+                int idx = find_idx(id, part);
+                // save data from the line if ID was found
+                if (idx >= 0) {
+                    if (! data_cache.read_ascii_data(pos, eol, n_components, idx) ) return false;
+                    part.n_read++;
+                }
+                return true;
+            });
+        });
+    }
+
+    unsigned int n_read = 0, n_missing = 0;
+    int missing_id = -1;
+    for (const DataPart &part : parts) {
+        if (part.error_pos != nullptr)
+        	THROW(ExcWrongFormat() << EI_Type("$ElementData line") << EI_TokenizerMsg(position_msg(part.error_pos))
+        			<< EI_MeshFile(tok_.f_name()) );
+        n_read += part.n_read;
+        if (n_missing == 0 && part.n_missing > 0) missing_id = part.missing_id;
+        n_missing += part.n_missing;
+    }
+    if (n_missing > 0)
+    	WarningOut().fmt("In file '{}', '$ElementData' section for field '{}', time: {}.\nData ID {} not found. Skipping {} rows with IDs not in the mesh.\n",
+                tok_.f_name(), actual_header.field_name, actual_header.time, missing_id, n_missing);
 
     LogOut().fmt("time: {}; {} entities of field {} read.\n",
     		actual_header.time, n_read, actual_header.field_name);
@@ -298,9 +688,10 @@ void GmshMeshReader::make_header_table()
 {
 	header_table_.clear();
 	MeshDataHeader header;
-	while ( !tok_.eof() ) {
-        if ( tok_.skip_to("$ElementData") ) {
-            read_data_header(header);
+	for (const MeshSection &section : sections_) {
+        if ( section.name == data_section_name_ ) {
+            const char *pos = section.begin;
+            read_data_header(pos, section.end, header);
             HeaderTable::iterator it = header_table_.find(header.field_name);
 
             if (it == header_table_.end()) {  // field doesn't exists, insert new vector to map
@@ -315,8 +706,6 @@ void GmshMeshReader::make_header_table()
             }
         }
 	}
-
-	tok_.set_position( Tokenizer::Position() );
 }
 
 
@@ -363,6 +752,22 @@ void GmshMeshReader::check_compatible_mesh(Mesh &mesh)
 {
 	bulk_elements_id_.clear();
 	boundary_elements_id_.clear();
+	bulk_id_index_.clear();
+	boundary_id_index_.clear();
 	mesh.elements_id_maps(bulk_elements_id_, boundary_elements_id_);
 	has_compatible_mesh_ = true;
 }
+
+
+
+const std::vector< std::pair<int, unsigned int> > &GmshMeshReader::element_id_index(bool boundary_domain)
+{
+	std::vector<int> const & el_ids = this->get_element_vector(boundary_domain);
+	std::vector< std::pair<int, unsigned int> > &id_index = boundary_domain ? boundary_id_index_ : bulk_id_index_;
+	if (id_index.size() != el_ids.size()) {
+		id_index.resize(el_ids.size());
+		for (unsigned int i = 0; i < el_ids.size(); ++i) id_index[i] = std::make_pair(el_ids[i], i);
+		std::sort(id_index.begin(), id_index.end());
+	}
+	return id_index;
+}
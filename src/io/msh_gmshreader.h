@@ -22,6 +22,7 @@
 #include <boost/exception/info.hpp>  // for error_info::~error_info<Tag, T>
 #include <map>                       // for map, map<>::value_compare
 #include <string>                    // for string
+#include <utility>                   // for pair
 #include <vector>                    // for vector
 #include "io/msh_basereader.hh"      // for MeshDataHeader, BaseMeshReader
 #include "system/exceptions.hh"      // for ExcStream, operator<<, EI, TYPED...
@@ -43,15 +44,23 @@ public:
 	DECLARE_EXCEPTION(ExcUnsupportedType,
 			<< "Element " << EI_ElementId::val << "in the GMSH input file " << EI_GMSHFile::qval
 			<< " is of the unsupported type " << EI_ElementType::val );
+	DECLARE_EXCEPTION(ExcMapFile,
+			<< "Can not map the GMSH input file " << EI_GMSHFile::qval << " to memory.");
+	DECLARE_EXCEPTION(ExcBinaryFormat,
+			<< "Unsupported byte order or size of double in the binary GMSH input file " << EI_GMSHFile::qval << ".");
 
     /**
      * Construct the GMSH format reader from given FilePath.
-     * This opens the file for reading.
+     * This opens the file for reading and maps it to the memory.
+     *
+     * Sections $Nodes, $Elements and $ElementData are read directly from the mapped file, both in ASCII
+     * and in binary GMSH format. ASCII sections are split into parts read in parallel by OpenMP threads
+     * (number of threads is given by OMP_NUM_THREADS).
      */
     GmshMeshReader(const FilePath &file_name);
 
     /**
-     * Destructor close the file if opened.
+     * Destructor close the file if opened and unmaps it.
      */
     virtual ~GmshMeshReader();
 
@@ -86,6 +95,39 @@ protected:
 	 */
 	typedef typename std::map< std::string, std::vector<MeshDataHeader> > HeaderTable;
 
+	/// Section of the GMSH file.
+	struct MeshSection {
+		/// Name of the section, e.g. '$Nodes'.
+		std::string name;
+		/// Begin of the section data (beginning of the line following the section name).
+		const char *begin;
+		/// End of the section data (beginning of the line with end of the section).
+		const char *end;
+	};
+
+    /**
+     * Map the file to memory, sets @p file_data_ and @p file_size_.
+     */
+    void map_file(const FilePath &file_name);
+    /**
+     * Find all sections of the mapped file and store them to @p sections_.
+     *
+     * Binary data of sections $Nodes, $Elements and $ElementData are skipped according to numbers of entities.
+     */
+    void make_section_table();
+    /**
+     * Return end of binary data of the section @p section (used for binary GMSH format).
+     */
+    const char *binary_section_end(const MeshSection &section);
+    /**
+     * Return first section of given name or NULL if the section doesn't exist.
+     */
+    const MeshSection *find_section(const std::string &name) const;
+    /**
+     * Return description of the position @p pos in the file used in error messages.
+     */
+    std::string position_msg(const char *pos) const;
+
     /**
      * private method for reading of nodes
      */
@@ -100,11 +142,12 @@ protected:
      */
     void read_elements(Mesh * mesh);
     /**
-     * Reads the header from the tokenizer @p tok and return it as the second parameter.
+     * Reads the header of $ElementData section starting at @p pos and return it as the third parameter.
+     * Position @p pos is moved to the beginning of data.
      */
-    void read_data_header(MeshDataHeader &head);
+    void read_data_header(const char *&pos, const char *end, MeshDataHeader &head);
     /**
-     * Reads table of ElementData headers from the tokenizer file.
+     * Reads table of ElementData headers from the mapped file.
      */
     void make_header_table() override;
     /**
@@ -112,10 +155,30 @@ protected:
      */
     void read_element_data(ElementDataCacheBase &data_cache, MeshDataHeader actual_header, unsigned int n_components,
     		bool boundary_domain) override;
+    /**
+     * Return pairs (element ID, index) of the bulk or boundary elements sorted by IDs.
+     * Created from @p get_element_vector on first use after @p check_compatible_mesh.
+     */
+    const std::vector< std::pair<int, unsigned int> > &element_id_index(bool boundary_domain);
 
 
     /// Table with data of ElementData headers
     HeaderTable header_table_;
+
+    /// Content of the mapped file.
+    const char *file_data_;
+
+    /// Size of the mapped file.
+    std::size_t file_size_;
+
+    /// File is in binary GMSH format.
+    bool binary_format_;
+
+    /// Sections of the file in order of appearance.
+    std::vector<MeshSection> sections_;
+
+    /// Sorted ID to index maps of bulk and boundary elements, see @p element_id_index.
+    std::vector< std::pair<int, unsigned int> > bulk_id_index_, boundary_id_index_;
 };
 
 #endif	/* _GMSHMESHREADER_H */
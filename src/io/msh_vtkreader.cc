@@ -24,6 +24,7 @@
 
 #include "msh_vtkreader.hh"
 #include "system/system.hh"
+#include "system/buffer_parser.hh"
 #include "mesh/side_impl.hh"
 #include "mesh/bih_tree.hh"
 #include "mesh/long_idx.hh"
@@ -344,7 +345,8 @@ void VtkMeshReader::read_element_data(ElementDataCacheBase &data_cache, MeshData
 
     switch (data_format_) {
 		case DataFormat::ascii: {
-			parse_ascii_data( data_cache, n_components, actual_header.n_entities, actual_header.position, boundary_domain );
+			parse_ascii_data( data_cache, n_components, actual_header.n_entities, actual_header.n_components,
+					actual_header.position, boundary_domain );
 			break;
 		}
 		case DataFormat::binary_uncompressed: {
@@ -371,21 +373,44 @@ void VtkMeshReader::read_element_data(ElementDataCacheBase &data_cache, MeshData
 
 
 void VtkMeshReader::parse_ascii_data(ElementDataCacheBase &data_cache, unsigned int n_components, unsigned int n_entities,
-		Tokenizer::Position pos, bool boundary_domain)
+		unsigned int n_row_values, Tokenizer::Position pos, bool boundary_domain)
 {
     n_read_ = 0;
 
-	tok_.set_position( pos );
-    try {
-    	tok_.next_line();
-    	for (unsigned int i_row = 0; i_row < n_entities; ++i_row) {
-    		data_cache.read_ascii_data(tok_, n_components, get_element_vector(boundary_domain)[i_row]);
-            n_read_++;
-    	}
-	} catch (boost::bad_lexical_cast &) {
-		THROW(ExcWrongFormat() << EI_Type("DataArray tag") << EI_TokenizerMsg(tok_.position_msg())
+    // values start on the line following the DataArray tag and end by the closing tag
+    std::string data;
+    data_stream_->clear();
+    data_stream_->seekg(pos.file_position_);
+    std::getline(*data_stream_, data, '<');
+    const char *begin = data.c_str();
+    const char *end = begin + data.size();
+
+    // Parts of the data are read in parallel, the first value of every part is given by the numbers of values
+    // in the previous parts. Data written by Flow123d are on a single line, so the parts are split between tokens.
+    std::vector<const char *> bounds = buffer_parser::split_tokens(begin, end, buffer_parser::n_read_parts(begin, end));
+    unsigned int n_parts = bounds.size() - 1;
+    std::vector<std::size_t> first_value(n_parts + 1, 0);
+    buffer_parser::read_parts(n_parts, [&bounds, &first_value](unsigned int i_part) {
+        first_value[i_part + 1] = buffer_parser::count_tokens(bounds[i_part], bounds[i_part + 1]);
+    });
+    for (unsigned int i_part = 0; i_part < n_parts; ++i_part) first_value[i_part + 1] += first_value[i_part];
+
+    std::string position_msg = "data of DataArray from line " + std::to_string(pos.line_counter_ + 1);
+    if (first_value[n_parts] < (std::size_t)n_entities * n_row_values)
+		THROW(ExcWrongFormat() << EI_Type("DataArray tag") << EI_TokenizerMsg(position_msg)
 				<< EI_MeshFile(tok_.f_name()) );
-	}
+
+    const std::vector<int> &rows = get_element_vector(boundary_domain);
+    std::vector<char> part_ok(n_parts);
+    buffer_parser::read_parts(n_parts, [&](unsigned int i_part) {
+        part_ok[i_part] = data_cache.read_ascii_values(bounds[i_part], bounds[i_part + 1], n_components,
+                first_value[i_part], rows);
+    });
+    for (unsigned int i_part = 0; i_part < n_parts; ++i_part)
+        if (! part_ok[i_part])
+    		THROW(ExcWrongFormat() << EI_Type("DataArray tag") << EI_TokenizerMsg(position_msg)
+    				<< EI_MeshFile(tok_.f_name()) );
+    n_read_ = n_entities;
 }
 
 
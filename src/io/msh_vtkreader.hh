@@ -149,9 +149,12 @@ protected:
 	/// Return size of value of data_type.
 	unsigned int type_value_size(DataType data_type);
 
-	/// Parse ascii data to data cache
+	/**
+	 * Parse ascii data to data cache. Data block is read at once and its parts are parsed in parallel,
+	 * @p n_row_values is number of values of one entity in the block.
+	 */
 	void parse_ascii_data(ElementDataCacheBase &data_cache, unsigned int n_components, unsigned int n_entities,
-			Tokenizer::Position pos, bool boundary_domain);
+			unsigned int n_row_values, Tokenizer::Position pos, bool boundary_domain);
 
 	/// Parse binary data to data cache
 	void parse_binary_data(ElementDataCacheBase &data_cache, unsigned int n_components, unsigned int n_entities,
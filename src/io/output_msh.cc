@@ -75,6 +75,16 @@ public:
     void read_binary_data(std::istream &data_stream, unsigned int n_components, unsigned int i_row) override
     {}
 
+    bool read_ascii_data(const char *pos, const char *line_end, unsigned int n_components, unsigned int i_row) override
+    { return true; }
+
+    bool read_ascii_values(const char *begin, const char *end, unsigned int n_components,
+            std::size_t first_value, const std::vector<int> &rows) override
+    { return true; }
+
+    void read_binary_data(const char *data, unsigned int n_components, unsigned int i_row) override
+    {}
+
     std::shared_ptr< ElementDataCacheBase > gather(Distribution *distr, LongIdx *local_to_global) override
     {
     	return std::make_shared<DummyOutputData>(this->field_input_name_, this->n_comp_);
@@ -126,6 +136,7 @@ OutputMSH::OutputMSH()
 
 OutputMSH::~OutputMSH()
 {
+    this->stop_writer();
     this->write_tail();
 }
 
@@ -218,10 +229,10 @@ void OutputMSH::write_msh_ascii_data(std::shared_ptr<ElementDataCache<unsigned i
 }
 
 
-void OutputMSH::write_node_data(OutputDataPtr output_data)
+void OutputMSH::write_node_data(const OutputFrame &frame, OutputDataPtr output_data)
 {
     ofstream &file = this->_base_file;
-    double time_fixed = isfinite(this->time)?this->time:0;
+    double time_fixed = isfinite(frame.time)?frame.time:0;
     time_fixed /= UnitSI().s().convert_unit_from(this->unit_string_);
 
     file << "$NodeData" << endl;
@@ -233,7 +244,7 @@ void OutputMSH::write_node_data(OutputDataPtr output_data)
     file << time_fixed << endl;    // first real tag = time
 
     file << "3" << endl;     // 3 integer tags
-    file << this->current_step << endl;    // step number (start = 0)
+    file << frame.step << endl;    // step number (start = 0)
     file << output_data->n_comp() << endl;   // number of components
     file << output_data->n_values() << endl;  // number of values
 
@@ -243,10 +254,10 @@ void OutputMSH::write_node_data(OutputDataPtr output_data)
 }
 
 
-void OutputMSH::write_corner_data(OutputDataPtr output_data)
+void OutputMSH::write_corner_data(const OutputFrame &frame, OutputDataPtr output_data)
 {
     ofstream &file = this->_base_file;
-    double time_fixed = isfinite(this->time)?this->time:0;
+    double time_fixed = isfinite(frame.time)?frame.time:0;
 
     file << "$ElementNodeData" << endl;
 
@@ -257,7 +268,7 @@ void OutputMSH::write_corner_data(OutputDataPtr output_data)
     file << time_fixed << endl;    // first real tag = time
 
     file << "3" << endl;     // 3 integer tags
-    file << this->current_step << endl;    // step number (start = 0)
+    file << frame.step << endl;    // step number (start = 0)
     file << output_data->n_comp() << endl;   // number of components
     file << this->offsets_->n_values() << endl; // number of values
 
@@ -266,10 +277,10 @@ void OutputMSH::write_corner_data(OutputDataPtr output_data)
     file << "$EndElementNodeData" << endl;
 }
 
-void OutputMSH::write_elem_data(OutputDataPtr output_data)
+void OutputMSH::write_elem_data(const OutputFrame &frame, OutputDataPtr output_data)
 {
     ofstream &file = this->_base_file;
-    double time_fixed = isfinite(this->time)?this->time:0;
+    double time_fixed = isfinite(frame.time)?frame.time:0;
 
     file << "$ElementData" << endl;
 
@@ -280,7 +291,7 @@ void OutputMSH::write_elem_data(OutputDataPtr output_data)
     file << time_fixed << endl;    // first real tag = time
 
     file << "3" << endl;     // 3 integer tags
-    file << this->current_step << endl;    // step number (start = 0)
+    file << frame.step << endl;    // step number (start = 0)
     file << output_data->n_comp() << endl;   // number of components
     file << output_data->n_values() << endl;  // number of values
 
@@ -304,11 +315,11 @@ int OutputMSH::write_head(void)
     return 1;
 }
 
-int OutputMSH::write_data(void)
+void OutputMSH::prepare_frame()
 {
     /* Output of serial format is implemented only in the first process */
     if (this->rank_ != 0) {
-        return 0;
+        return;
     }
 
     // Write header with mesh, when it hasn't been written to output file yet
@@ -322,28 +333,31 @@ int OutputMSH::write_data(void)
         this->write_head();
         this->header_written = true;
     }
+}
 
-    LogOut() << __func__ << ": Writing output file " << this->_base_filename << " ... ";
-
+int OutputMSH::write_frame(const OutputFrame &frame)
+{
+    /* Output of serial format is implemented only in the first process */
+    if (this->rank_ != 0) {
+        return 0;
+    }
 
-    auto &node_data_list = this->output_data_vec_[NODE_DATA];
+    auto &node_data_list = frame.data[NODE_DATA];
     for(auto data_it = node_data_list.begin(); data_it != node_data_list.end(); ++data_it) {
-    	write_node_data(*data_it);
+    	write_node_data(frame, *data_it);
     }
-    auto &corner_data_list = this->output_data_vec_[CORNER_DATA];
+    auto &corner_data_list = frame.data[CORNER_DATA];
     for(auto data_it = corner_data_list.begin(); data_it != corner_data_list.end(); ++data_it) {
-    	write_corner_data(*data_it);
+    	write_corner_data(frame, *data_it);
     }
-    auto &elem_data_list = this->output_data_vec_[ELEM_DATA];
+    auto &elem_data_list = frame.data[ELEM_DATA];
     for(auto data_it = elem_data_list.begin(); data_it != elem_data_list.end(); ++data_it) {
-    	write_elem_data(*data_it);
+    	write_elem_data(frame, *data_it);
     }
 
     // Flush stream to be sure everything is in the file now
     this->_base_file.flush();
 
-    LogOut() << "O.K.";
-
     return 1;
 }
 
@@ -33,7 +33,7 @@ public:
 
     /**
      * \brief The constructor of this class.
-     * We open the output file in first call of write_data
+     * We open the output file in first call of prepare_frame
      */
     OutputMSH();
 
@@ -55,11 +55,16 @@ public:
     int write_head(void);
 
     /**
-     * \brief This method writes data to GMSH (.msh) file format for current time
+     * \brief This method writes data of the time frame to GMSH (.msh) file format
      *
      * \return      This function returns 1
      */
-    int write_data(void);
+    int write_frame(const OutputFrame &frame) override;
+
+    /**
+     * \brief Open the output file and write the head at first call
+     */
+    void prepare_frame() override;
 
     /**
      * \brief This method should write tail of GMSH (.msh) file format
@@ -123,25 +128,25 @@ private:
      * \brief This function write all data on nodes to output file. This function
      * is used for static and dynamic data
      *
-     * \param[in]   time        The time from start
-     * \param[in]   step        The number of steps from start
+     * \param[in]   frame       The time frame (time and step number)
+     * \param[in]   output_data The data written to the file
      */
-    void write_node_data(OutputDataPtr output_data);
+    void write_node_data(const OutputFrame &frame, OutputDataPtr output_data);
     /**
      * \brief writes ElementNode data ascii GMSH (.msh) output file.
      *
      */
-    void write_corner_data(OutputDataPtr output_data);
+    void write_corner_data(const OutputFrame &frame, OutputDataPtr output_data);
 
 
     /**
      * \brief This function write all data on elements to output file. This
      * function is used for static and dynamic data
      *
-     * \param[in]   time        The time from start
-     * \param[in]   step        The number of steps from start
+     * \param[in]   frame       The time frame (time and step number)
+     * \param[in]   output_data The data written to the file
      */
-    void write_elem_data(OutputDataPtr output_data);
+    void write_elem_data(const OutputFrame &frame, OutputDataPtr output_data);
 
     /**
      * \brief This method add right suffix to .msh GMSH file
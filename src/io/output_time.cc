@@ -24,6 +24,7 @@
 #include "output_time.impl.hh"
 #include "output_vtk.hh"
 #include "output_msh.hh"
+#include "output_xdmf.hh"
 #include "output_mesh.hh"
 #include "io/output_time_set.hh"
 #include "io/observe.hh"
@@ -31,6 +32,9 @@
 
 FLOW123D_FORCE_LINK_IN_PARENT(vtk)
 FLOW123D_FORCE_LINK_IN_PARENT(gmsh)
+#ifdef FLOW123D_HAVE_HDF5
+FLOW123D_FORCE_LINK_IN_PARENT(xdmf)
+#endif
 
 
 namespace IT = Input::Type;
@@ -58,6 +62,9 @@ const IT::Record & OutputTime::get_input_type() {
                 "Default is 17 decimal digits which are necessary to reproduce double values exactly after write-read cycle.")
         .declare_key("observe_points", IT::Array(ObservePoint::get_input_type()), IT::Default("[]"),
                 "Array of observe points.")
+        .declare_key("write_queue", IT::Integer(0), IT::Default("0"),
+                "Maximal number of time frames that are written by a background thread while the computation continues.\n"
+                "Default value 0 means that every time frame is written immediately.")
 		.close();
 }
 
@@ -73,7 +80,9 @@ OutputTime::OutputTime()
 : current_step(0),
   time(-1.0),
   write_time(-1.0),
-  parallel_(false)
+  parallel_(false),
+  max_queued_frames_(0),
+  stop_writer_(false)
 {
     MPI_Comm_rank(MPI_COMM_WORLD, &this->rank_);
     MPI_Comm_size(MPI_COMM_WORLD, &this->n_proc_);
@@ -93,6 +102,7 @@ void OutputTime::init_from_input(const std::string &equation_name, const Input::
     FilePath output_file_path(equation_name+"_fields", FilePath::output_file);
     input_record_.opt_val("file", output_file_path);
     this->precision_ = input_record_.val<int>("precision");
+    this->max_queued_frames_ = input_record_.val<unsigned int>("write_queue");
     this->_base_filename = output_file_path;
 }
 
@@ -112,6 +122,7 @@ OutputTime::~OutputTime(void)
      //    return;
     // }
 
+    this->stop_writer();
     if (this->_base_file.is_open()) this->_base_file.close();
 
     LogOut() << "O.K.";
@@ -209,7 +220,9 @@ void OutputTime::write_time_frame()
     	if (this->rank_ == 0 || this->parallel_) // for serial output write log only one (same output file on all processes)
     	    LogOut() << "Write output to output stream: " << this->_base_filename << " for time: " << time;
     	gather_output_data();
-        write_data();
+    	this->prepare_frame();
+    	if (max_queued_frames_ > 0) this->push_frame( this->make_frame() );
+    	else this->write_frame( *this->make_frame() );
         // Remember the last time of writing to output stream
         write_time = time;
         current_step++;
@@ -227,6 +240,111 @@ void OutputTime::write_time_frame()
     clear_data();
 }
 
+int OutputTime::write_data(void)
+{
+    this->prepare_frame();
+    return this->write_frame( *this->make_frame() );
+}
+
+
+std::shared_ptr<OutputTime::OutputFrame> OutputTime::make_frame()
+{
+    auto frame = std::make_shared<OutputFrame>();
+    frame->time = this->time;
+    frame->step = this->current_step;
+    for (unsigned int i=0; i<N_DISCRETE_SPACES; ++i) frame->data[i] = this->output_data_vec_[i];
+    return frame;
+}
+
+
+void OutputTime::push_frame(std::shared_ptr<OutputFrame> frame)
+{
+    START_TIMER("OutputTime::push_frame");
+    this->rethrow_writer_exception();
+    if (! writer_thread_.joinable()) {
+        stop_writer_ = false;
+        writer_thread_ = std::thread(&OutputTime::writer_loop, this);
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        queue_cond_.wait(lock, [this] { return frame_queue_.size() < max_queued_frames_; });
+        frame_queue_.push_back(frame);
+    }
+    queue_cond_.notify_all();
+}
+
+
+void OutputTime::writer_loop()
+{
+    Profiler::exclude_thread();
+    while (true) {
+        std::shared_ptr<OutputFrame> frame;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_cond_.wait(lock, [this] { return stop_writer_ || !frame_queue_.empty(); });
+            if (frame_queue_.empty()) return;
+            frame = frame_queue_.front();
+        }
+
+        std::exception_ptr exc;
+        try {
+            this->write_frame(*frame);
+        } catch (...) {
+            exc = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            if (exc && !writer_exception_) writer_exception_ = exc;
+            frame_queue_.pop_front();
+        }
+        queue_cond_.notify_all();
+    }
+}
+
+
+void OutputTime::flush_frames()
+{
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        queue_cond_.wait(lock, [this] { return frame_queue_.empty(); });
+    }
+    this->rethrow_writer_exception();
+}
+
+
+void OutputTime::stop_writer()
+{
+    if (! writer_thread_.joinable()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        stop_writer_ = true;
+    }
+    queue_cond_.notify_all();
+    writer_thread_.join();
+
+    // called from destructors, error can not be propagated
+    try {
+        this->rethrow_writer_exception();
+    } catch (std::exception &e) {
+        WarningOut() << "Output to the stream " << this->_base_filename << " failed:\n" << e.what();
+    }
+}
+
+
+void OutputTime::rethrow_writer_exception()
+{
+    std::exception_ptr exc;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        std::swap(exc, writer_exception_);
+    }
+    if (exc) std::rethrow_exception(exc);
+}
+
+
 std::shared_ptr<Observe> OutputTime::observe(Mesh *mesh)
 {
     // create observe object at first call
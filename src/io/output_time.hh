@@ -18,9 +18,14 @@
 #ifndef OUTPUT_TIME_HH_
 #define OUTPUT_TIME_HH_
 
+#include <condition_variable>   // for condition_variable
+#include <deque>                // for deque
+#include <exception>            // for exception_ptr
 #include <fstream>              // for ofstream
 #include <memory>               // for shared_ptr
+#include <mutex>                // for mutex
 #include <string>               // for string, allocator
+#include <thread>               // for thread
 #include <vector>               // for vector
 #include "input/accessors.hh"   // for Iterator, Array (ptr only), Record
 #include "system/file_path.hh"  // for FilePath
@@ -46,6 +51,14 @@ template <typename T> class ElementDataCache;
  * This class is descendant of Output class. This class is used for outputting
  * data varying in time. Own output to specific file formats is done at other
  * places to. See output_vtk.cc and output_msh.cc.
+ *
+ * Data of a time frame are collected (and gathered to the master process) by @p write_time_frame
+ * and stored in OutputFrame object. The frame is written either immediately or, if the key
+ * 'write_queue' is positive, by a background thread, so the computation can continue during formatting,
+ * compression and writing of the files. The data caches of the frame are not touched by the computation
+ * after the frame is created (new caches are created by @p prepare_compute_data), the caches of the output
+ * mesh (nodes_, connectivity_, offsets_) are constant. Size of the queue of frames is bounded, if the queue
+ * is full @p write_time_frame waits until the oldest frame is written.
  */
 class OutputTime {
 
@@ -126,6 +139,18 @@ public:
     typedef std::pair< std::string, unsigned int > FieldInterpolationData;
     typedef std::map< DiscreteSpace, std::vector<FieldInterpolationData> > InterpolationMap;
 
+    /**
+     * Data of one time frame, snapshot of @p output_data_vec_, @p time and @p current_step.
+     */
+    struct OutputFrame {
+        /// Time of the frame.
+        double time;
+        /// Output step of the frame.
+        int step;
+        /// Output data of the frame.
+        OutputDataFieldVec data[N_DISCRETE_SPACES];
+    };
+
     /**
      * \brief This method delete all object instances of class OutputTime stored
      * in output_streams vector
@@ -143,6 +168,17 @@ public:
      */
     void write_time_frame();
 
+    /**
+     * Write data registered in @p output_data_vec_ for current time and step immediately.
+     */
+    int write_data(void);
+
+    /**
+     * Wait until all time frames passed to the background writer are written.
+     * Exception thrown during writing of a frame is rethrown.
+     */
+    void flush_frames();
+
     /**
      * Getter of the observe object.
      */
@@ -242,15 +278,42 @@ protected:
 
 
     /**
-     * \brief Virtual method for writing data to output file
+     * \brief Virtual method for writing data of the time frame to output file
+     *
+     * Can be called from the background writer thread, so it can not use the data that are changed by the computation
+     * (@p output_data_vec_, @p time, @p current_step), Logger and Profiler.
+     */
+    virtual int write_frame(const OutputFrame &frame) = 0;
+
+    /**
+     * Called in the main thread before the time frame is written, can open files and write headers.
      */
-    virtual int write_data(void) = 0;
+    virtual void prepare_frame()
+    {}
+
+    /**
+     * Stop the background writer thread. Must be called in destructors of descendants before the tail
+     * of the output file is written. Remaining frames are written, possible error is reported.
+     */
+    void stop_writer();
 
     /**
      * \brief Collect data of individual processes to serial data on master (0th) process
      */
     void gather_output_data(void);
 
+    /// Create time frame from currently registered data.
+    std::shared_ptr<OutputFrame> make_frame();
+
+    /// Pass the time frame to the background writer, wait if the queue of frames is full.
+    void push_frame(std::shared_ptr<OutputFrame> frame);
+
+    /// Main loop of the background writer thread.
+    void writer_loop();
+
+    /// Rethrow exception caught in the background writer thread.
+    void rethrow_writer_exception();
+
     /**
      * Cached MPI rank of process (is tested in methods)
      */
@@ -329,6 +392,27 @@ protected:
     /// Vector of offsets of node indices of elements. Maps elements to their nodes in connectivity_.
     std::shared_ptr<ElementDataCache<unsigned int>> offsets_;
 
+    /// Maximal number of time frames written or waiting in the background writer, zero for synchronous output.
+    unsigned int max_queued_frames_;
+
+    /// Background writer thread, started at first asynchronous output.
+    std::thread writer_thread_;
+
+    /// Time frames passed to the background writer, the front one is just written.
+    std::deque< std::shared_ptr<OutputFrame> > frame_queue_;
+
+    /// Mutex guarding @p frame_queue_, @p stop_writer_ and @p writer_exception_.
+    std::mutex queue_mutex_;
+
+    /// Notifies changes of @p frame_queue_ and @p stop_writer_.
+    std::condition_variable queue_cond_;
+
+    /// Flag to finish the background writer thread.
+    bool stop_writer_;
+
+    /// Exception thrown in the background writer thread.
+    std::exception_ptr writer_exception_;
+
 };
 
 
@@ -79,6 +79,7 @@ OutputVTK::OutputVTK()
 
 OutputVTK::~OutputVTK()
 {
+    this->stop_writer();
     this->write_tail();
 }
 
@@ -112,11 +113,11 @@ string OutputVTK::form_vtu_filename_(string basename, int i_step, int rank) {
     if (this->parallel_) {
         // parallel file
         ss << main_output_basename_ << "/" << main_output_basename_ << "-"
-           << std::setw(6) << std::setfill('0') << current_step << "." << rank << ".vtu";
+           << std::setw(6) << std::setfill('0') << i_step << "." << rank << ".vtu";
     } else {
         // serial file
         ss << main_output_basename_ << "/" << main_output_basename_ << "-"
-           << std::setw(6) << std::setfill('0') << current_step << ".vtu";
+           << std::setw(6) << std::setfill('0') << i_step << ".vtu";
     }
     return ss.str();
 }
@@ -131,7 +132,7 @@ string pvd_dataset_line(double step, int rank, string file) {
     return ss.str();
 }
 
-int OutputVTK::write_data(void)
+int OutputVTK::write_frame(const OutputFrame &frame)
 {
     ASSERT_PTR(this->nodes_).error();
 
@@ -156,15 +157,15 @@ int OutputVTK::write_data(void)
     	//int current_step = this->get_parallel_current_step();
 
         /* Write dataset lines to the PVD file. */
-        double corrected_time = (isfinite(this->time)?this->time:0);
+        double corrected_time = (isfinite(frame.time)?frame.time:0);
         corrected_time /= UnitSI().s().convert_unit_from(this->unit_string_);
         if (parallel_) {
         	for (int i_rank=0; i_rank<n_proc_; ++i_rank) {
-                string file = this->form_vtu_filename_(main_output_basename_, current_step, i_rank);
+                string file = this->form_vtu_filename_(main_output_basename_, frame.step, i_rank);
                 this->_base_file << pvd_dataset_line(corrected_time, i_rank, file);
         	}
         } else {
-            string file = this->form_vtu_filename_(main_output_basename_, current_step, -1);
+            string file = this->form_vtu_filename_(main_output_basename_, frame.step, -1);
             this->_base_file << pvd_dataset_line(corrected_time, 0, file);
         }
     }
@@ -172,26 +173,19 @@ int OutputVTK::write_data(void)
     /* write VTU file */
     {
         /* Open VTU file */
-        std::string frame_file_name = this->form_vtu_filename_(main_output_basename_, current_step, this->rank_);
+        std::string frame_file_name = this->form_vtu_filename_(main_output_basename_, frame.step, this->rank_);
         FilePath frame_file_path({main_output_dir_, frame_file_name}, FilePath::output_file);
         try {
             frame_file_path.open_stream(_data_file);
             this->set_stream_precision(_data_file);
         } INPUT_CATCH(FilePath::ExcFileOpen, FilePath::EI_Address_String, input_record_)
 
-        LogOut() << __func__ << ": Writing output (frame: " << this->current_step
-                 << ", rank: " << this->rank_
-                 << ") file: " << frame_file_name << " ... ";
-
-        this->write_vtk_vtu();
+        this->write_vtk_vtu(frame);
 
         /* Close stream for file of current frame */
         _data_file.close();
         //delete data_file;
         //this->_data_file = NULL;
-
-        LogOut() << "O.K.";
-
     }
 
     return 1;
@@ -390,7 +384,7 @@ void OutputVTK::compress_data(stringstream &uncompressed_stream, stringstream &c
 }
 
 
-void OutputVTK::write_vtk_field_data(OutputDataFieldVec &output_data_vec)
+void OutputVTK::write_vtk_field_data(const OutputDataFieldVec &output_data_vec)
 {
     for(OutputDataPtr data :  output_data_vec)
         write_vtk_data(data);
@@ -400,7 +394,7 @@ void OutputVTK::write_vtk_field_data(OutputDataFieldVec &output_data_vec)
 
 
 void OutputVTK::write_vtk_data_names(ofstream &file,
-        OutputDataFieldVec &output_data_vec)
+        const OutputDataFieldVec &output_data_vec)
 {
     if (output_data_vec.empty()) return;
 
@@ -421,14 +415,14 @@ void OutputVTK::write_vtk_data_names(ofstream &file,
 }
 
 
-void OutputVTK::write_vtk_node_data(void)
+void OutputVTK::write_vtk_node_data(const OutputFrame &frame)
 {
     ofstream &file = this->_data_file;
 
     // merge node and corner data
-    OutputDataFieldVec node_corner_data(output_data_vec_[NODE_DATA]);
+    OutputDataFieldVec node_corner_data(frame.data[NODE_DATA]);
     node_corner_data.insert(node_corner_data.end(),
-            output_data_vec_[CORNER_DATA].begin(), output_data_vec_[CORNER_DATA].end());
+            frame.data[CORNER_DATA].begin(), frame.data[CORNER_DATA].end());
 
     if( ! node_corner_data.empty() ) {
         /* Write <PointData begin */
@@ -437,10 +431,10 @@ void OutputVTK::write_vtk_node_data(void)
         file << ">" << endl;
 
         /* Write data on nodes */
-        this->write_vtk_field_data(output_data_vec_[NODE_DATA]);
+        this->write_vtk_field_data(frame.data[NODE_DATA]);
 
         /* Write data in corners of elements */
-        this->write_vtk_field_data(output_data_vec_[CORNER_DATA]);
+        this->write_vtk_field_data(frame.data[CORNER_DATA]);
 
         /* Write PointData end */
         file << "</PointData>" << endl;
@@ -448,11 +442,11 @@ void OutputVTK::write_vtk_node_data(void)
 }
 
 
-void OutputVTK::write_vtk_element_data(void)
+void OutputVTK::write_vtk_element_data(const OutputFrame &frame)
 {
     ofstream &file = this->_data_file;
 
-    auto &data_map = this->output_data_vec_[ELEM_DATA];
+    auto &data_map = frame.data[ELEM_DATA];
     if (data_map.empty()) return;
 
     /* Write CellData begin */
@@ -468,11 +462,11 @@ void OutputVTK::write_vtk_element_data(void)
 }
 
 
-void OutputVTK::write_vtk_native_data(void)
+void OutputVTK::write_vtk_native_data(const OutputFrame &frame)
 {
     ofstream &file = this->_data_file;
 
-    auto &data_map = this->output_data_vec_[NATIVE_DATA];
+    auto &data_map = frame.data[NATIVE_DATA];
     if (data_map.empty()) return;
 
     /* Write Flow123dData begin */
@@ -532,7 +526,7 @@ void OutputVTK::write_vtk_vtu_tail(void)
 }
 
 
-void OutputVTK::write_vtk_vtu(void)
+void OutputVTK::write_vtk_vtu(const OutputFrame &frame)
 {
     ofstream &file = this->_data_file;
 
@@ -557,13 +551,13 @@ void OutputVTK::write_vtk_vtu(void)
     file << "</Cells>" << endl;
 
     /* Write VTK scalar and vector data on nodes to the file */
-    this->write_vtk_node_data();
+    this->write_vtk_node_data(frame);
 
     /* Write VTK data on elements */
-    this->write_vtk_element_data();
+    this->write_vtk_element_data(frame);
 
     /* Write own VTK native data (skipped by Paraview) */
-    this->write_vtk_native_data();
+    this->write_vtk_native_data(frame);
 
     /* Write Piece end */
     file << "</Piece>" << endl;
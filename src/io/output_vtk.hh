@@ -71,10 +71,9 @@ public:
 
 
     /**
-     * \brief This function write data to VTK (.pvd) file format
-     * for curent time
+     * \brief This function write data of the time frame to VTK (.pvd) file format
      */
-    int write_data(void);
+    int write_frame(const OutputFrame &frame) override;
 
     /**
      * \brief This function writes header of VTK (.pvd) file format
@@ -154,7 +153,7 @@ protected:
     /**
      * Write registered data of all components of given Field to output stream
      */
-    void write_vtk_field_data(OutputDataFieldVec &output_data_map);
+    void write_vtk_field_data(const OutputDataFieldVec &output_data_map);
 
     /**
      * Write output data stored in OutputData vector to output stream
@@ -166,24 +165,24 @@ protected:
      * Output is done into stream @p file.
      */
     void write_vtk_data_names(ofstream &file,
-            OutputDataFieldVec &output_data_map);
+            const OutputDataFieldVec &output_data_map);
 
     /**
      * \brief Write data on nodes to the VTK file (.vtu)
      */
-    void write_vtk_node_data(void);
+    void write_vtk_node_data(const OutputFrame &frame);
 
     /**
      * \brief Write data on elements to the VTK file (.vtu)
      */
-   void write_vtk_element_data(void);
+   void write_vtk_element_data(const OutputFrame &frame);
 
    /**
     * \brief Write native data (part of our own data skipped by Paraview) to the VTK file (.vtu)
     *
     * Tags of native data are subtags of 'Flow123dData' tag, that is subtag of 'Piece' tag
     */
-  void write_vtk_native_data(void);
+  void write_vtk_native_data(const OutputFrame &frame);
 
    /**
     * \brief Write tail of VTK file (.vtu)
@@ -194,7 +193,7 @@ protected:
     * \brief This function write all scalar and vector data on nodes and elements
     * to the VTK file (.vtu)
     */
-   void write_vtk_vtu(void);
+   void write_vtk_vtu(const OutputFrame &frame);
 
    /**
     * Set appropriate file path substrings.
@@ -0,0 +1,331 @@
+/*!
+ *
+﻿ * Copyright (C) 2015 Technical University of Liberec.  All rights reserved.
+ * 
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License version 3 as published by the
+ * Free Software Foundation. (http://www.gnu.org/licenses/gpl-3.0.en.html)
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * 
+ * @file    output_xdmf.cc
+ * @brief   Parallel output to HDF5 file described by XDMF metadata.
+ */
+
+#include "output_xdmf.hh"
+
+#ifdef FLOW123D_HAVE_HDF5
+
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include "element_data_cache.hh"
+#include "output_mesh.hh"
+#include "input/factory.hh"
+#include "input/accessors.hh"
+#include "system/file_path.hh"
+#include "system/logger.hh"
+#include "system/sys_profiler.hh"
+#include "tools/unit_si.hh"
+
+
+FLOW123D_FORCE_LINK_IN_CHILD(xdmf)
+
+
+using namespace Input::Type;
+
+
+/// XDMF codes of element types in mixed topology.
+enum XDMFElementType {
+    XDMF_POLYVERTEX = 1,
+    XDMF_POLYLINE = 2,
+    XDMF_TRIANGLE = 4,
+    XDMF_TETRAHEDRON = 6
+};
+
+
+/// Return pointer to values of the data cache of type T.
+template <class T>
+static const void *cache_values(ElementDataCacheBase &cache) {
+    return dynamic_cast<ElementDataCache<T> &>(cache).get_component_data(0)->data();
+}
+
+
+const Record & OutputXDMF::get_input_type() {
+    return Record("xdmf", "Parameters of XDMF output format. Mesh and data are stored in a HDF5 file written in parallel "
+                "by all processes, the XDMF file describes the data for visualization.")
+		// It is derived from abstract class
+		.derive_from(OutputTime::get_input_format_type())
+		.close();
+}
+
+
+const int OutputXDMF::registrar = Input::register_class< OutputXDMF >("xdmf") +
+		OutputXDMF::get_input_type().size();
+
+
+OutputXDMF::OutputXDMF()
+: file_id_(-1),
+  mesh_written_(false)
+{
+    this->enable_refinement_ = false;
+    this->parallel_ = true;
+}
+
+
+OutputXDMF::~OutputXDMF()
+{
+    this->stop_writer();
+    if (file_id_ >= 0) H5Fclose(file_id_);
+}
+
+
+void OutputXDMF::init_from_input(const std::string &equation_name, const Input::Record &in_rec, std::string unit_str)
+{
+	OutputTime::init_from_input(equation_name, in_rec, unit_str);
+    this->fix_main_file_extension(".xdmf");
+
+    // collective HDF5 calls can not be performed by the background writer concurrently with MPI calls of computation
+    if (this->max_queued_frames_ > 0) {
+        WarningOut() << "Background writing (key 'write_queue') is not supported by the XDMF output, writing frames immediately.";
+        this->max_queued_frames_ = 0;
+    }
+
+    h5_file_name_ = this->_base_filename.stem() + ".h5";
+    FilePath h5_file_path({this->_base_filename.parent_path(), h5_file_name_}, FilePath::output_file);
+    if (this->rank_ == 0) h5_file_path.create_output_dir();
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    hid_t access_plist = H5Pcreate(H5P_FILE_ACCESS);
+    H5Pset_fapl_mpio(access_plist, MPI_COMM_WORLD, MPI_INFO_NULL);
+    file_id_ = H5Fcreate(std::string(h5_file_path).c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, access_plist);
+    H5Pclose(access_plist);
+    if (file_id_ < 0) {
+        THROW( FilePath::ExcFileOpen() << FilePath::EI_Path(std::string(h5_file_path))
+                << FilePath::EI_Address_String(input_record_.address_string()) );
+    }
+
+    if (this->rank_ == 0) LogOut() << "Writing XDMF output file: " << this->_base_filename << " ... ";
+}
+
+
+OutputXDMF::Hyperslab OutputXDMF::make_hyperslab(unsigned long long n_local)
+{
+    Hyperslab slab;
+    slab.n_local = n_local;
+    slab.offset = 0;
+    MPI_Exscan(&n_local, &slab.offset, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    if (this->rank_ == 0) slab.offset = 0; // result of MPI_Exscan is undefined on the first process
+    MPI_Allreduce(&n_local, &slab.n_total, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    return slab;
+}
+
+
+void OutputXDMF::write_dataset(const std::string &path, hid_t mem_type, const void *data, const Hyperslab &slab, unsigned int n_cols)
+{
+    int rank = (n_cols == 1) ? 1 : 2;
+    hsize_t dims[2] = { slab.n_total, n_cols };
+    hsize_t start[2] = { slab.offset, 0 };
+    hsize_t count[2] = { slab.n_local, n_cols };
+
+    hid_t file_space = H5Screate_simple(rank, dims, NULL);
+    hid_t link_plist = H5Pcreate(H5P_LINK_CREATE);
+    H5Pset_create_intermediate_group(link_plist, 1);
+    hid_t dataset = H5Dcreate2(file_id_, path.c_str(), mem_type, file_space, link_plist, H5P_DEFAULT, H5P_DEFAULT);
+    H5Pclose(link_plist);
+
+    // processes without data take part in the collective write with empty selection
+    hid_t mem_space;
+    if (slab.n_local > 0) {
+        H5Sselect_hyperslab(file_space, H5S_SELECT_SET, start, NULL, count, NULL);
+        mem_space = H5Screate_simple(rank, count, NULL);
+    } else {
+        hsize_t one_row[2] = { 1, n_cols };
+        H5Sselect_none(file_space);
+        mem_space = H5Screate_simple(rank, one_row, NULL);
+        H5Sselect_none(mem_space);
+    }
+
+    hid_t transfer_plist = H5Pcreate(H5P_DATASET_XFER);
+    H5Pset_dxpl_mpio(transfer_plist, H5FD_MPIO_COLLECTIVE);
+    herr_t status = (dataset < 0) ? -1 : H5Dwrite(dataset, mem_type, mem_space, file_space, transfer_plist, data);
+
+    H5Pclose(transfer_plist);
+    H5Sclose(mem_space);
+    if (dataset >= 0) H5Dclose(dataset);
+    H5Sclose(file_space);
+
+    if (status < 0) {
+        THROW( ExcHDF5Error() << EI_HDF5Path(path) << EI_HDF5File(h5_file_name_) );
+    }
+}
+
+
+OutputXDMF::Hyperslab OutputXDMF::write_data_cache(const std::string &path, OutputDataPtr output_data)
+{
+    Hyperslab slab = this->make_hyperslab(output_data->n_values());
+    switch (output_data->vtk_type()) {
+        case ElementDataCacheBase::VTK_FLOAT64:
+            this->write_dataset(path, H5T_NATIVE_DOUBLE, cache_values<double>(*output_data), slab, output_data->n_comp());
+            break;
+        case ElementDataCacheBase::VTK_UINT32:
+            this->write_dataset(path, H5T_NATIVE_UINT, cache_values<unsigned int>(*output_data), slab, output_data->n_comp());
+            break;
+        case ElementDataCacheBase::VTK_INT32:
+            this->write_dataset(path, H5T_NATIVE_INT, cache_values<int>(*output_data), slab, output_data->n_comp());
+            break;
+        default:
+            ASSERT(false)(output_data->vtk_type()).error("Unsupported type of output data.");
+            break;
+    }
+    return slab;
+}
+
+
+void OutputXDMF::write_mesh()
+{
+    ASSERT_PTR(this->nodes_).error();
+
+    node_slab_ = this->write_data_cache("/Mesh/Geometry", this->nodes_);
+
+    // mixed topology: XDMF type of element, (number of nodes for polyvertex and polyline), global indices of nodes
+    auto &offsets = *( this->offsets_->get_component_data(0).get() );
+    auto &connectivity = *( this->connectivity_->get_component_data(0).get() );
+    std::vector<long long> topology;
+    topology.reserve(connectivity.size() + 2*offsets.size());
+    unsigned int begin = 0;
+    for (unsigned int i_elm=0; i_elm<offsets.size(); ++i_elm) {
+        unsigned int n_nodes = offsets[i_elm] - begin;
+        switch (n_nodes) {
+            case 1:
+                topology.push_back(XDMF_POLYVERTEX);
+                topology.push_back(1);
+                break;
+            case 2:
+                topology.push_back(XDMF_POLYLINE);
+                topology.push_back(2);
+                break;
+            case 3:
+                topology.push_back(XDMF_TRIANGLE);
+                break;
+            case 4:
+                topology.push_back(XDMF_TETRAHEDRON);
+                break;
+            default:
+                ASSERT(false)(n_nodes).error("Unsupported number of element nodes.");
+                break;
+        }
+        for (unsigned int i=begin; i<offsets[i_elm]; ++i)
+            topology.push_back(node_slab_.offset + connectivity[i]);
+        begin = offsets[i_elm];
+    }
+
+    elem_slab_ = this->make_hyperslab(offsets.size());
+    corner_slab_ = this->make_hyperslab(connectivity.size());
+    topology_slab_ = this->make_hyperslab(topology.size());
+    this->write_dataset("/Mesh/Topology", H5T_NATIVE_LLONG, topology.data(), topology_slab_, 1);
+    mesh_written_ = true;
+}
+
+
+int OutputXDMF::write_frame(const OutputFrame &frame)
+{
+    START_TIMER("OutputXDMF::write_frame");
+    if (! mesh_written_) this->write_mesh();
+
+    std::ostringstream attributes;
+    for (unsigned int space : {NODE_DATA, CORNER_DATA, ELEM_DATA}) {
+        for (OutputDataPtr output_data : frame.data[space]) {
+            std::ostringstream path;
+            path << "/Fields/" << output_data->field_input_name() << "/" << std::setw(6) << std::setfill('0') << frame.step;
+            // corner data are written as node data, so every corner needs its own node
+            if (space == CORNER_DATA && corner_slab_.n_total != node_slab_.n_total)
+                THROW( ExcCornerData() << EI_FieldName(output_data->field_input_name()) << EI_HDF5File(h5_file_name_) );
+            Hyperslab slab = this->write_data_cache(path.str(), output_data);
+
+            unsigned long long n_entities;
+            switch (space) {
+                case ELEM_DATA:   n_entities = elem_slab_.n_total; break;
+                case CORNER_DATA: n_entities = corner_slab_.n_total; break;
+                default:          n_entities = node_slab_.n_total; break;
+            }
+            ASSERT_EQ(slab.n_total, n_entities)(output_data->field_input_name()).error("Size of output data doesn't match the output mesh.");
+
+            std::string type;
+            switch (output_data->n_comp()) {
+                case ElementDataCacheBase::N_SCALAR: type = "Scalar"; break;
+                case ElementDataCacheBase::N_VECTOR: type = "Vector"; break;
+                case ElementDataCacheBase::N_TENSOR: type = "Tensor"; break;
+                default: type = "Matrix"; break;
+            }
+            attributes << "<Attribute Name=\"" << output_data->field_input_name() << "\" AttributeType=\"" << type
+                       << "\" Center=\"" << ((space == ELEM_DATA) ? "Cell" : "Node") << "\">\n"
+                       << this->xdmf_data_item(path.str(), slab, output_data->n_comp(), output_data->vtk_type())
+                       << "</Attribute>\n";
+        }
+    }
+
+    H5Fflush(file_id_, H5F_SCOPE_GLOBAL);
+    if (this->rank_ == 0) this->write_xdmf(frame, attributes.str());
+
+    return 1;
+}
+
+
+std::string OutputXDMF::xdmf_data_item(const std::string &path, const Hyperslab &slab, unsigned int n_cols,
+        ElementDataCacheBase::VTKValueType type)
+{
+    std::ostringstream ss;
+    ss << "<DataItem Dimensions=\"" << slab.n_total;
+    if (n_cols > 1) ss << " " << n_cols;
+    ss << "\" ";
+    switch (type) {
+        case ElementDataCacheBase::VTK_FLOAT64: ss << "NumberType=\"Float\" Precision=\"8\" "; break;
+        case ElementDataCacheBase::VTK_UINT32:  ss << "NumberType=\"UInt\" Precision=\"4\" "; break;
+        case ElementDataCacheBase::VTK_INT32:   ss << "NumberType=\"Int\" Precision=\"4\" "; break;
+        default: ASSERT(false)(type).error("Unsupported type of output data."); break;
+    }
+    ss << "Format=\"HDF\">" << h5_file_name_ << ":" << path << "</DataItem>\n";
+    return ss.str();
+}
+
+
+void OutputXDMF::write_xdmf(const OutputFrame &frame, const std::string &attributes)
+{
+    double corrected_time = (std::isfinite(frame.time)?frame.time:0);
+    corrected_time /= UnitSI().s().convert_unit_from(this->unit_string_);
+
+    std::ostringstream grid;
+    grid.precision(this->precision_);
+    grid << "<Grid Name=\"frame_" << frame.step << "\" GridType=\"Uniform\">\n"
+         << "<Time Value=\"" << corrected_time << "\"/>\n"
+         << "<Topology TopologyType=\"Mixed\" NumberOfElements=\"" << elem_slab_.n_total << "\">\n"
+         << "<DataItem Dimensions=\"" << topology_slab_.n_total << "\" NumberType=\"Int\" Precision=\"8\" Format=\"HDF\">"
+         << h5_file_name_ << ":/Mesh/Topology</DataItem>\n"
+         << "</Topology>\n"
+         << "<Geometry GeometryType=\"XYZ\">\n"
+         << this->xdmf_data_item("/Mesh/Geometry", node_slab_, ElementDataCacheBase::N_VECTOR, ElementDataCacheBase::VTK_FLOAT64)
+         << "</Geometry>\n"
+         << attributes
+         << "</Grid>\n";
+    xdmf_grids_ += grid.str();
+
+    // rewrite whole file, so it is valid after every frame
+    try {
+        this->_base_filename.open_stream( this->_base_file );
+    } INPUT_CATCH(FilePath::ExcFileOpen, FilePath::EI_Address_String, input_record_)
+    this->_base_file << "<?xml version=\"1.0\" ?>\n"
+                     << "<Xdmf Version=\"3.0\">\n"
+                     << "<Domain>\n"
+                     << "<Grid Name=\"" << this->equation_name_ << "\" GridType=\"Collection\" CollectionType=\"Temporal\">\n"
+                     << xdmf_grids_
+                     << "</Grid>\n"
+                     << "</Domain>\n"
+                     << "</Xdmf>\n";
+    this->_base_file.close();
+}
+
+#endif // FLOW123D_HAVE_HDF5
@@ -0,0 +1,139 @@
+/*!
+ *
+﻿ * Copyright (C) 2015 Technical University of Liberec.  All rights reserved.
+ * 
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License version 3 as published by the
+ * Free Software Foundation. (http://www.gnu.org/licenses/gpl-3.0.en.html)
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * 
+ * @file    output_xdmf.hh
+ * @brief   Parallel output to HDF5 file described by XDMF metadata.
+ */
+
+#ifndef OUTPUT_XDMF_HH_
+#define OUTPUT_XDMF_HH_
+
+#include "config.h"
+
+#ifdef FLOW123D_HAVE_HDF5
+
+#include <string>          // for string
+#include <hdf5.h>
+#include "output_time.hh"  // for OutputTime, OutputTime::OutputFrame
+#include "element_data_cache_base.hh"
+#include "system/exceptions.hh"
+
+namespace Input { namespace Type { class Record; } }
+
+
+/**
+ * \brief Parallel output to HDF5 file with XDMF description.
+ *
+ * The mesh and the field data are stored in a single HDF5 file (same name as the XDMF file, extension .h5).
+ * Every process writes data of its own part of the output mesh (no gather to the first process)
+ * into its hyperslab of the datasets, all writes are collective. Datasets:
+ *  - /Mesh/Geometry - coordinates of nodes, [n_nodes x 3]
+ *  - /Mesh/Topology - XDMF mixed topology (type of element followed by its nodes)
+ *  - /Fields/<field name>/<step> - values of the field in the time frame, [n_values x n_comp]
+ *
+ * The XDMF file (temporal collection of grids referring to the datasets) is written by the first process
+ * after every time frame, so it describes all written frames anytime during computation.
+ *
+ * Nodes are local to the processes, nodes on boundaries of the mesh partitions are stored by every
+ * process that uses them. Native data are not written, corner data need discontinuous output mesh.
+ * Requires HDF5 library built with MPI support.
+ */
+class OutputXDMF : public OutputTime {
+public:
+	typedef OutputTime FactoryBaseType;
+
+	TYPEDEF_ERR_INFO(EI_HDF5File, std::string);
+	TYPEDEF_ERR_INFO(EI_HDF5Path, std::string);
+	DECLARE_EXCEPTION(ExcHDF5Error,
+			<< "HDF5 error while writing dataset " << EI_HDF5Path::qval << " to the file " << EI_HDF5File::qval << ".");
+	TYPEDEF_ERR_INFO(EI_FieldName, std::string);
+	DECLARE_EXCEPTION(ExcCornerData,
+			<< "Corner data of the field " << EI_FieldName::qval << " can not be written to the XDMF file "
+			<< EI_HDF5File::qval << ", they need the discontinuous output mesh.");
+
+    /// Constructor.
+    OutputXDMF();
+
+    /// Destructor, closes the HDF5 file.
+    ~OutputXDMF();
+
+    /// The definition of input record for XDMF file format.
+    static const Input::Type::Record & get_input_type();
+
+    /// Override @p OutputTime::init_from_input.
+    void init_from_input(const std::string &equation_name, const Input::Record &in_rec, std::string unit_str) override;
+
+    /// Write data of the time frame to the HDF5 file and update the XDMF file.
+    int write_frame(const OutputFrame &frame) override;
+
+protected:
+    /// Registrar of class to factory
+    static const int registrar;
+
+    /// Number of values written by one process together with its offset and total number over all processes.
+    struct Hyperslab {
+        unsigned long long n_local;
+        unsigned long long offset;
+        unsigned long long n_total;
+    };
+
+    /// Collective, compute offset and total count of @p n_local values of processes.
+    Hyperslab make_hyperslab(unsigned long long n_local);
+
+    /**
+     * Collective, write local part of dataset of @p n_cols columns (one dimensional dataset for @p n_cols = 1)
+     * to the HDF5 file. @p data must contain slab.n_local rows.
+     */
+    void write_dataset(const std::string &path, hid_t mem_type, const void *data, const Hyperslab &slab, unsigned int n_cols);
+
+    /// Write the data cache to the dataset @p path, return row slab of the dataset.
+    Hyperslab write_data_cache(const std::string &path, OutputDataPtr output_data);
+
+    /// Write geometry and topology of the output mesh (at first frame).
+    void write_mesh();
+
+    /// Append description of the time frame with field @p attributes to @p xdmf_grids_ and rewrite the XDMF file.
+    void write_xdmf(const OutputFrame &frame, const std::string &attributes);
+
+    /// Return XDMF DataItem element referring dataset @p path.
+    std::string xdmf_data_item(const std::string &path, const Hyperslab &slab, unsigned int n_cols,
+            ElementDataCacheBase::VTKValueType type);
+
+    /// HDF5 file, opened by all processes.
+    hid_t file_id_;
+
+    /// Name of HDF5 file (relative to the directory of the XDMF file).
+    std::string h5_file_name_;
+
+    /// True after the mesh is written.
+    bool mesh_written_;
+
+    /// Slab of nodes of this process.
+    Hyperslab node_slab_;
+
+    /// Slab of elements of this process.
+    Hyperslab elem_slab_;
+
+    /// Slab of the topology dataset of this process.
+    Hyperslab topology_slab_;
+
+    /// Slab of element corners (values of corner data) of this process.
+    Hyperslab corner_slab_;
+
+    /// XDMF description of written time frames.
+    std::string xdmf_grids_;
+};
+
+#endif // FLOW123D_HAVE_HDF5
+
+#endif /* OUTPUT_XDMF_HH_ */
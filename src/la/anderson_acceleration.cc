@@ -0,0 +1,128 @@
+/*!
+ *
+﻿ * Copyright (C) 2015 Technical University of Liberec.  All rights reserved.
+ * 
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License version 3 as published by the
+ * Free Software Foundation. (http://www.gnu.org/licenses/gpl-3.0.en.html)
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * 
+ * @file    anderson_acceleration.cc
+ * @brief   Anderson acceleration of fixed-point iterations on PETSc vectors.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <armadillo>
+
+#include "la/anderson_acceleration.hh"
+#include "system/sys_profiler.hh"
+#include "system/system.hh"
+
+
+AndersonAcceleration::AndersonAcceleration(unsigned int depth)
+: depth_(depth),
+  n_history_(0),
+  has_residual_(false)
+{}
+
+
+void AndersonAcceleration::add_block(Vec solution)
+{
+    IterateBlock block;
+    block.solution = solution;
+    VecDuplicate(solution, &block.iterate);
+    VecDuplicate(solution, &block.residual);
+    VecDuplicate(solution, &block.value);
+    block.d_residual.resize(depth_);
+    block.d_value.resize(depth_);
+    for (unsigned int i=0; i<depth_; i++) {
+        VecDuplicate(solution, &block.d_residual[i]);
+        VecDuplicate(solution, &block.d_value[i]);
+    }
+    blocks_.push_back(block);
+}
+
+
+void AndersonAcceleration::start_iterations()
+{
+    for (auto &block : blocks_)
+        VecCopy(block.solution, block.iterate);
+    n_history_ = 0;
+    has_residual_ = false;
+}
+
+
+double AndersonAcceleration::update_residual()
+{
+    bool update_history = (has_residual_ && depth_ > 0);
+    double norm_sq = 0;
+    for (auto &block : blocks_) {
+        if (update_history) {
+            // reuse the oldest differences for the new ones
+            std::rotate(block.d_residual.begin(), block.d_residual.begin()+1, block.d_residual.end());
+            std::rotate(block.d_value.begin(), block.d_value.begin()+1, block.d_value.end());
+            VecWAXPY(block.d_value.back(), -1.0, block.value, block.solution);
+            VecCopy(block.residual, block.d_residual.back());
+        }
+        VecWAXPY(block.residual, -1.0, block.iterate, block.solution);
+        if (update_history) VecAYPX(block.d_residual.back(), -1.0, block.residual);
+        VecCopy(block.solution, block.value);
+
+        double norm;
+        VecNorm(block.residual, NORM_2, &norm);
+        norm_sq += norm*norm;
+    }
+    if (update_history) n_history_ = std::min(n_history_ + 1, depth_);
+    has_residual_ = true;
+
+    return std::sqrt(norm_sq);
+}
+
+
+void AndersonAcceleration::accelerate()
+{
+    START_TIMER("Anderson acceleration");
+    unsigned int m = n_history_;
+    if (m > 0) {
+        // least squares: min |residual - d_residual * gamma|, solved by normal equations
+        arma::mat normal_mat(m, m, arma::fill::zeros);
+        arma::vec normal_rhs(m, arma::fill::zeros);
+        std::vector<PetscScalar> dots(m);
+        for (auto &block : blocks_) {
+            Vec *d_residual = &(block.d_residual[depth_ - m]);
+            for (unsigned int i=0; i<m; i++) {
+                VecMDot(d_residual[i], m, d_residual, dots.data());
+                for (unsigned int j=0; j<m; j++) normal_mat(i,j) += dots[j];
+            }
+            VecMDot(block.residual, m, d_residual, dots.data());
+            for (unsigned int j=0; j<m; j++) normal_rhs(j) += dots[j];
+        }
+        // pseudo-inverse handles linearly dependent differences
+        arma::vec gamma = - arma::pinv(normal_mat) * normal_rhs;
+
+        for (auto &block : blocks_)
+            VecMAXPY(block.solution, m, gamma.memptr(), &(block.d_value[depth_ - m]));
+    }
+
+    for (auto &block : blocks_)
+        VecCopy(block.solution, block.iterate);
+}
+
+
+AndersonAcceleration::~AndersonAcceleration()
+{
+    for (auto &block : blocks_) {
+        chkerr(VecDestroy(&block.iterate));
+        chkerr(VecDestroy(&block.residual));
+        chkerr(VecDestroy(&block.value));
+        for (unsigned int i=0; i<block.d_residual.size(); i++) {
+            chkerr(VecDestroy(&block.d_residual[i]));
+            chkerr(VecDestroy(&block.d_value[i]));
+        }
+    }
+}
@@ -0,0 +1,95 @@
+/*!
+ *
+﻿ * Copyright (C) 2015 Technical University of Liberec.  All rights reserved.
+ * 
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License version 3 as published by the
+ * Free Software Foundation. (http://www.gnu.org/licenses/gpl-3.0.en.html)
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * 
+ * @file    anderson_acceleration.hh
+ * @brief   Anderson acceleration of fixed-point iterations on PETSc vectors.
+ */
+
+#ifndef ANDERSON_ACCELERATION_HH_
+#define ANDERSON_ACCELERATION_HH_
+
+#include <vector>
+#include <petscvec.h>
+
+
+/**
+ * @brief Anderson acceleration of a fixed-point iteration x = G(x) [see Walker&Ni, SIAM J. Numer. Anal. 49(4), 2011].
+ *
+ * The iterate consists of blocks, the solution vectors of the coupled equations. The equations compute
+ * G(x) into their solution vectors, update_residual() computes the residual G(x) - x and its norm, and
+ * accelerate() sets the next iterate into the solution vectors. The next iterate is a combination
+ * of the last values of G that minimizes the linearized residual over the last @p depth differences.
+ *
+ * Usage:
+ * 1) add_block() for every solution vector;
+ * 2) start_iterations() at the beginning of every time step;
+ * 3) repeat: compute the solutions, update_residual(), accelerate().
+ */
+class AndersonAcceleration {
+public:
+    /// Constructor, @p depth is the number of previous iterations used, zero for the plain fixed-point iterations.
+    AndersonAcceleration(unsigned int depth);
+
+    /// Destructor, destroys all vectors except of the solutions.
+    ~AndersonAcceleration();
+
+    /// Add the solution vector @p solution of an equation to the iterate, the vector is not owned.
+    void add_block(Vec solution);
+
+    /// Set the iterate to the actual solutions and clear the acceleration history.
+    void start_iterations();
+
+    /// Update the residuals and the history after the solutions were computed; return norm of the residual.
+    double update_residual();
+
+    /// Set the next iterate into the solution vectors.
+    void accelerate();
+
+    /// Number of valid differences in the acceleration history.
+    inline unsigned int n_history() const
+    { return n_history_; }
+
+private:
+    /**
+     * One block of the fixed-point iterate, i.e. the solution vector of one equation.
+     * All vectors are owned except of the solution of the equation.
+     */
+    struct IterateBlock {
+        /// Solution vector of the equation, the value of the fixed-point map.
+        Vec solution;
+        /// Iterate the map was applied to.
+        Vec iterate;
+        /// Last residual: solution - iterate.
+        Vec residual;
+        /// Last value of the map.
+        Vec value;
+        /// Differences of succeeding residuals, the last @p n_history_ are valid.
+        std::vector<Vec> d_residual;
+        /// Differences of succeeding values of the map, the last @p n_history_ are valid.
+        std::vector<Vec> d_value;
+    };
+
+    /// Number of previous iterations used by the acceleration.
+    unsigned int depth_;
+
+    /// Number of valid differences in the acceleration history.
+    unsigned int n_history_;
+
+    /// False before the first update_residual() after start_iterations(), i.e. there is no previous residual.
+    bool has_residual_;
+
+    /// Blocks of the iterate.
+    std::vector<IterateBlock> blocks_;
+};
+
+#endif /* ANDERSON_ACCELERATION_HH_ */
@@ -389,7 +389,7 @@ public:
         rhs_set_values(nrow, rows, rhs_vals);
     }
 
-    void set_local_system(LocalSystem & local){
+    virtual void set_local_system(LocalSystem & local){
         local.eliminate_solution();
         arma::mat tmp = local.matrix.t();
 //         DBGCOUT(<< "\n" << tmp);
@@ -23,6 +23,7 @@
 #include "petscmat.h"
 #include "system/sys_profiler.hh"
 #include "system/system.hh"
+#include <algorithm>
 
 
 //#include <boost/bind.hpp>
@@ -51,6 +52,15 @@ const it::Record & LinSys_PETSC::get_input_type() {
                     "Maximum number of outer iterations of the linear solver.")
 		.declare_key("options", it::String(), it::Default("\"\""),  "This options is passed to PETSC to create a particular KSP (Krylov space method).\n"
                                                                     "If the string is left empty (by default), the internal default options is used.")
+        .declare_key("pc_reuse", it::Integer(0), it::Default("0"),
+                    "Maximal number of following solutions with a changed matrix that reuse the preconditioner. "
+                    "Zero sets up the preconditioner for every solution.")
+        .declare_key("pc_reuse_it_factor", it::Double(1.0), it::Default("2.0"),
+                    "The reused preconditioner is set up again if the number of iterations exceeds this multiple "
+                    "of the number of iterations of the first solution with the preconditioner.")
+        .declare_key("extrapolate_initial_guess", it::Bool(), it::Default("false"),
+                    "Use linear extrapolation of the last two solutions as the initial guess. "
+                    "Used only by equations that start from the previous solution (transient problems).")
 		.close();
 }
 
@@ -62,7 +72,15 @@ LinSys_PETSC::LinSys_PETSC( const Distribution * rows_ds, const std::string &par
         : LinSys( rows_ds ),
           params_(params),
           init_guess_nonzero(false),
-          matrix_(0)
+          matrix_(0),
+          system(NULL),
+          pc_max_reuse_(0),
+          pc_it_factor_(2.0),
+          pc_n_reused_(0),
+          pc_setup_its_(-1),
+          last_its_(0),
+          extrapolate_guess_(false),
+          solution_old_(NULL)
 {
     // create PETSC vectors:
     PetscErrorCode ierr;
@@ -79,7 +97,10 @@ LinSys_PETSC::LinSys_PETSC( const Distribution * rows_ds, const std::string &par
 }
 
 LinSys_PETSC::LinSys_PETSC( LinSys_PETSC &other )
-	: LinSys(other), params_(other.params_), v_rhs_(NULL), solution_precision_(other.solution_precision_)
+	: LinSys(other), params_(other.params_), v_rhs_(NULL), solution_precision_(other.solution_precision_),
+	  system(NULL), pc_max_reuse_(other.pc_max_reuse_), pc_it_factor_(other.pc_it_factor_),
+	  pc_n_reused_(0), pc_setup_its_(-1), last_its_(0),
+	  extrapolate_guess_(other.extrapolate_guess_), solution_old_(NULL)
 {
 	MatCopy(other.matrix_, matrix_, DIFFERENT_NONZERO_PATTERN);
 	VecCopy(other.rhs_, rhs_);
@@ -247,6 +268,28 @@ void LinSys_PETSC::preallocate_matrix()
     delete[] off_nz;
 }
 
+void LinSys_PETSC::allocate_as(const LinSys_PETSC &other)
+{
+    OLD_ASSERT(other.matrix_ != NULL, "Matrix of the other system is not allocated.");
+
+    if (status_ == ALLOCATE) {
+        VecDestroy(&on_vec_);
+        VecDestroy(&off_vec_);
+    }
+    if (matrix_ != NULL)
+    {
+    	chkerr(MatDestroy(&matrix_));
+    }
+    chkerr(MatDuplicate(other.matrix_, MAT_DO_NOT_COPY_VALUES, &matrix_));
+
+    if (symmetric_) MatSetOption(matrix_, MAT_SYMMETRIC, PETSC_TRUE);
+    MatSetOption(matrix_, MAT_NEW_NONZERO_ALLOCATION_ERR, PETSC_FALSE);
+    MatSetOption(matrix_, MAT_IGNORE_ZERO_ENTRIES, PETSC_TRUE);
+
+    status_ = ADD;
+    matrix_changed_ = true;
+}
+
 void LinSys_PETSC::finish_assembly( )
 {
     MatAssemblyType assemblyType = MAT_FINAL_ASSEMBLY;
@@ -328,11 +371,105 @@ void LinSys_PETSC::set_initial_guess_nonzero(bool set_nonzero)
 }
 
 
+void LinSys_PETSC::set_preconditioner_reuse(unsigned int max_reuse, double it_factor)
+{
+    pc_max_reuse_ = max_reuse;
+    pc_it_factor_ = it_factor;
+}
+
+
+void LinSys_PETSC::set_extrapolate_initial_guess(bool extrapolate)
+{
+    extrapolate_guess_ = extrapolate;
+}
+
+
 LinSys::SolveInfo LinSys_PETSC::solve()
 {
+    this->setup_solver();
+    this->extrapolate_initial_guess();
+    LinSys::SolveInfo si = this->solve_rhs(rhs_, solution_);
+    this->finish_solver();
+
+    return si;
+}
+
+
+LinSys::SolveInfo LinSys_PETSC::solve_shared(const std::vector<LinSys_PETSC *> &systems)
+{
+    START_TIMER("LinSys_PETSC::solve_shared");
+    LinSys::SolveInfo si(0, 0);
+    this->setup_solver();
+    for (LinSys_PETSC *ls : systems) {
+        ls->extrapolate_initial_guess();
+        si = this->solve_rhs(ls->rhs_, ls->solution_);
+        ls->reason = reason;
+        ls->residual_norm_ = residual_norm_;
+        ls->solution_precision_ = solution_precision_;
+    }
+    this->finish_solver();
+
+    return si;
+}
+
+
+bool LinSys_PETSC::reuse_preconditioner()
+{
+    if (pc_max_reuse_ == 0 || pc_n_reused_ >= pc_max_reuse_) return false;
+    if (reason < 0) return false;
+
+    // matrix recreated, e.g. with a new nonzero pattern
+    Mat op;
+    chkerr(KSPGetOperators(system, &op, NULL));
+    if (op != matrix_) return false;
+
+    // convergence degraded with the old preconditioner
+    if (pc_setup_its_ >= 0 && last_its_ > pc_it_factor_ * std::max(pc_setup_its_, 1)) return false;
+
+    return true;
+}
+
+
+void LinSys_PETSC::finish_solver()
+{
+    if (pc_max_reuse_ == 0) chkerr(KSPDestroy(&system));
+}
+
+
+void LinSys_PETSC::extrapolate_initial_guess()
+{
+    if (! extrapolate_guess_ || ! init_guess_nonzero) return;
+
+    if (solution_old_ == NULL) {
+        // first solution, only store the previous one
+        chkerr(VecDuplicate(solution_, &solution_old_));
+        chkerr(VecCopy(solution_, solution_old_));
+        return;
+    }
+    // solution_old_ = x_n - x_{n-1}, solution_ = 2 x_n - x_{n-1}, solution_old_ = x_n
+    chkerr(VecAXPBY(solution_old_, 1.0, -1.0, solution_));
+    chkerr(VecAXPY(solution_, 1.0, solution_old_));
+    chkerr(VecAYPX(solution_old_, -1.0, solution_));
+}
+
+
+void LinSys_PETSC::setup_solver()
+{
+    START_TIMER("PETSC solver setup");
+
+    if (system != NULL) {
+        if (reuse_preconditioner()) {
+            // new values of the matrix, the preconditioner is kept due to KSPSetReusePreconditioner
+            chkerr(KSPSetOperators(system, matrix_, matrix_));
+            chkerr(KSPSetTolerances(system, r_tol_, a_tol_, PETSC_DEFAULT,  max_it_));
+            pc_n_reused_++;
+            DebugOut().fmt("reusing preconditioner, {} times\n", pc_n_reused_);
+            return;
+        }
+        chkerr(KSPDestroy(&system));
+    }
 
     const char *petsc_dflt_opt;
-    int nits;
     
     // -mat_no_inode ... inodes are usefull only for
     //  vector problems e.g. MH without Schur complement reduction
@@ -389,16 +526,30 @@ LinSys::SolveInfo LinSys_PETSC::solve()
     		KSPSetInitialGuessNonzero(system, PETSC_TRUE);
     }
 
+    // set up the preconditioner here, so that its time is not included in the solution
+    if (pc_max_reuse_ > 0) chkerr(KSPSetReusePreconditioner(system, PETSC_TRUE));
+    chkerr(KSPSetUp(system));
+    pc_n_reused_ = 0;
+    pc_setup_its_ = -1;
+}
+
+
+LinSys::SolveInfo LinSys_PETSC::solve_rhs(Vec rhs, Vec solution)
+{
+    int nits;
+
     {
 		START_TIMER("PETSC linear solver");
 		START_TIMER("PETSC linear iteration");
-		chkerr(KSPSolve(system, rhs_, solution_ ));
+		chkerr(KSPSolve(system, rhs, solution ));
 		KSPGetConvergedReason(system,&reason);
 		KSPGetIterationNumber(system,&nits);
 		ADD_CALLS(nits);
     }
+    last_its_ = nits;
+    if (pc_setup_its_ < 0) pc_setup_its_ = nits;
     // substitute by PETSc call for residual
-    VecNorm(rhs_, NORM_2, &residual_norm_);
+    VecNorm(rhs, NORM_2, &residual_norm_);
     
     LogOut().fmt("convergence reason {}, number of iterations is {}\n", reason, nits);
 
@@ -408,8 +559,6 @@ LinSys::SolveInfo LinSys_PETSC::solve()
     // TODO: I do not understand this 
     //Profiler::instance()->set_timer_subframes("SOLVING MH SYSTEM", nits);
 
-    chkerr(KSPDestroy(&system));
-
     return LinSys::SolveInfo(static_cast<int>(reason), static_cast<int>(nits));
 
 }
@@ -442,8 +591,10 @@ void LinSys_PETSC::view( )
 
 LinSys_PETSC::~LinSys_PETSC( )
 {
+    if (system != NULL) { chkerr(KSPDestroy(&system)); }
     if (matrix_ != NULL) { chkerr(MatDestroy(&matrix_)); }
     chkerr(VecDestroy(&rhs_));
+    if (solution_old_ != NULL) chkerr(VecDestroy(&solution_old_));
 
     if (residual_ != NULL) chkerr(VecDestroy(&residual_));
     if (v_rhs_ != NULL) delete[] v_rhs_;
@@ -460,6 +611,9 @@ void LinSys_PETSC::set_from_input(const Input::Record in_rec)
     // otherwise keep settings provided in constructor of LinSys_PETSC.
     std::string user_params = in_rec.val<string>("options");
 	if (user_params != "") params_ = user_params;
+
+	set_preconditioner_reuse(in_rec.val<unsigned int>("pc_reuse"), in_rec.val<double>("pc_reuse_it_factor"));
+	set_extrapolate_initial_guess(in_rec.val<bool>("extrapolate_initial_guess"));
 }
 
 
@@ -115,6 +115,12 @@ public:
 
     void preallocate_matrix();
 
+    /**
+     * Create matrix with the same nonzero pattern as the matrix of @p other (values are not copied)
+     * and start ADD assembly. Used instead of allocation, when the matrix structure is known from other system.
+     */
+    void allocate_as(const LinSys_PETSC &other);
+
     void finish_assembly() override;
 
     void finish_assembly( MatAssemblyType assembly_type );
@@ -123,8 +129,30 @@ public:
 
     void set_initial_guess_nonzero(bool set_nonzero = true);
 
+    /**
+     * Keep the solver and its preconditioner between solutions. The preconditioner is reused
+     * for at most @p max_reuse following solutions with a changed matrix, or until the number of iterations
+     * exceeds @p it_factor times the number of iterations of the first solution with the preconditioner.
+     * Zero @p max_reuse sets up the solver for every solution.
+     */
+    void set_preconditioner_reuse(unsigned int max_reuse, double it_factor = 2.0);
+
+    /**
+     * Use linear extrapolation of the last two solutions as the initial guess.
+     * Takes effect only with nonzero initial guess, see @p set_initial_guess_nonzero.
+     */
+    void set_extrapolate_initial_guess(bool extrapolate = true);
+
     LinSys::SolveInfo solve() override;
 
+    /**
+     * Solve systems given by the matrix of this system and the right-hand sides of @p systems.
+     * Solutions are stored into the solution vectors of @p systems, their matrices are not used.
+     * The solver and the preconditioner are set up only once for all right-hand sides.
+     * Returns solve info of the last system.
+     */
+    LinSys::SolveInfo solve_shared(const std::vector<LinSys_PETSC *> &systems);
+
     /**
      * Returns information on absolute solver accuracy
      */
@@ -167,6 +195,20 @@ private:
     };
 
 protected:
+    /// Set PETSc options and create the solver @p system with the current matrix.
+    void setup_solver();
+
+    /// Solve the system with the right-hand side @p rhs by the solver created by @p setup_solver.
+    LinSys::SolveInfo solve_rhs(Vec rhs, Vec solution);
+
+    /// True if the solver @p system can be used with the current matrix without new setup of the preconditioner.
+    bool reuse_preconditioner();
+
+    /// Destroy the solver unless it is kept for the preconditioner reuse.
+    void finish_solver();
+
+    /// Extrapolate the initial guess from the last two solutions (if switched on) and store the previous solution.
+    void extrapolate_initial_guess();
 
     std::string params_;		 //!< command-line-like options for the PETSc solver
 
@@ -187,6 +229,15 @@ protected:
     KSP                system;
     KSPConvergedReason reason;
 
+    unsigned int pc_max_reuse_;  //!< maximal number of solutions with a reused preconditioner, zero for no reuse
+    double  pc_it_factor_;       //!< limit of iterations (relative to the first solution) for the reuse
+    unsigned int pc_n_reused_;   //!< number of solutions with the actual preconditioner reused
+    int     pc_setup_its_;       //!< iterations of the first solution with the actual preconditioner, -1 before it
+    int     last_its_;           //!< iterations of the last solution
+
+    bool    extrapolate_guess_;  //!< extrapolate initial guess from the last two solutions
+    Vec     solution_old_;       //!< previous solution for the extrapolation, NULL before the first solution
+
 
 };
 
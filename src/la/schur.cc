@@ -42,6 +42,7 @@
 #include "system/system.hh"
 #include "la/linsys.hh"
 #include "la/linsys_BDDC.hh"
+#include "la/local_system.hh"
 #include "la/schur.hh"
 
 /**
@@ -59,7 +60,8 @@
  */
 
 SchurComplement::SchurComplement(Distribution *ds, IS ia, IS ib)
-: LinSys_PETSC(ds), IsA(ia), IsB(ib), state(created)
+: LinSys_PETSC(ds), IsA(ia), IsB(ib), state(created),
+  direct_assembly_(false), a_begin_(0), n_elim_rows_(0)
 {
         // check index set
         OLD_ASSERT(IsA != NULL, "Index set IsA is not defined.\n" );
@@ -77,6 +79,7 @@ SchurComplement::SchurComplement(Distribution *ds, IS ia, IS ib)
         RHS2    = NULL;
         Sol1    = NULL;
         Sol2    = NULL;
+        IA_RHS1 = NULL;
         ds_     = NULL;
 
         // create A block index set
@@ -111,7 +114,9 @@ SchurComplement::SchurComplement(Distribution *ds, IS ia, IS ib)
 SchurComplement::SchurComplement(SchurComplement &other)
 : LinSys_PETSC(other),
   loc_size_A(other.loc_size_A), loc_size_B(other.loc_size_B), state(other.state),
-  Compl(other.Compl), ds_(other.ds_)
+  Compl(other.Compl), ds_(other.ds_),
+  direct_assembly_(other.direct_assembly_), a_begin_(other.a_begin_), n_elim_rows_(other.n_elim_rows_),
+  local_elims_(other.local_elims_), elim_dofs_(other.elim_dofs_), elim_values_(other.elim_values_)
 {
 	MatCopy(other.IA, IA, DIFFERENT_NONZERO_PATTERN);
 	MatCopy(other.IAB, IAB, DIFFERENT_NONZERO_PATTERN);
@@ -126,6 +131,7 @@ SchurComplement::SchurComplement(SchurComplement &other)
 	Bt  = NULL;
 	xA  = NULL;
 	C   = NULL;
+	IA_RHS1 = NULL;
 }
 
 
@@ -138,6 +144,94 @@ void SchurComplement::set_from_input(const Input::Record in_rec)
     Compl->set_from_input( in_rec );
 }
 
+void SchurComplement::set_direct_assembly()
+{
+    ASSERT_PTR(ds_).error("Complement distribution must be created before switching on the direct assembly.");
+    direct_assembly_ = true;
+    // A block precedes the B block on every process
+    a_begin_ = rows_ds_->begin() - ds_->begin();
+}
+
+
+void SchurComplement::set_local_system(LocalSystem & local)
+{
+    LinSys_PETSC::set_local_system(local);
+    if (direct_assembly_ && status_ != ALLOCATE) eliminate_local_system(local);
+}
+
+
+PetscErrorCode SchurComplement::mat_zero_entries()
+{
+    local_elims_.clear();
+    elim_dofs_.clear();
+    elim_values_.clear();
+    n_elim_rows_ = 0;
+    return LinSys_PETSC::mat_zero_entries();
+}
+
+
+bool SchurComplement::is_a_row(unsigned int row) const
+{
+    unsigned int proc = rows_ds_->get_proc(row);
+    return row - rows_ds_->begin(proc) < rows_ds_->lsize(proc) - ds_->lsize(proc);
+}
+
+
+unsigned int SchurComplement::complement_row(unsigned int row) const
+{
+    unsigned int proc = rows_ds_->get_proc(row);
+    return ds_->begin(proc) + (row - rows_ds_->begin(proc)) - (rows_ds_->lsize(proc) - ds_->lsize(proc));
+}
+
+
+/**
+ * Static condensation of the local system
+ *  A  B
+ *  Bt C
+ * where A are rows of the local system in the A block of the whole system.
+ * Store inv(A), inv(A)*B and Bt*inv(A)*B, C is already set in the original matrix.
+ */
+void SchurComplement::eliminate_local_system(LocalSystem & local)
+{
+    std::vector<arma::uword> a_loc, b_loc;
+    for (unsigned int i=0; i<local.row_dofs.n_elem; i++) {
+        if (is_a_row(local.row_dofs[i])) a_loc.push_back(i);
+        else b_loc.push_back(i);
+    }
+    if (a_loc.empty()) return;
+
+    ASSERT( local.row_dofs.n_elem == local.col_dofs.n_elem && arma::all(local.row_dofs == local.col_dofs) )
+            .error("Local system with rows of the A block must have same row and column dofs.");
+
+    arma::uvec a_idx(a_loc), b_idx(b_loc);
+    const arma::mat &mat = local.get_matrix();
+    arma::mat inv_a = arma::inv( mat.submat(a_idx, a_idx) );
+    arma::mat iab = inv_a * mat.submat(a_idx, b_idx);
+    arma::mat xa = mat.submat(b_idx, a_idx) * iab;
+
+    LocalElimination elim;
+    elim.n_a = a_loc.size();
+    elim.n_b = b_loc.size();
+    elim.dofs_begin = elim_dofs_.size();
+    elim.values_begin = elim_values_.size();
+    local_elims_.push_back(elim);
+
+    for (arma::uword i : a_loc) {
+        ASSERT( rows_ds_->is_local(local.row_dofs[i]) )(local.row_dofs[i]).error("Row of the A block is not local.");
+        elim_dofs_.push_back(a_begin_ + local.row_dofs[i] - rows_ds_->begin());
+    }
+    for (arma::uword i : b_loc)
+        elim_dofs_.push_back(complement_row(local.row_dofs[i]));
+    n_elim_rows_ += elim.n_a;
+
+    // PETSc expects row-wise blocks, armadillo stores them column-wise
+    for (const arma::mat &block : {inv_a, iab, xa}) {
+        arma::mat block_t = block.t();
+        elim_values_.insert(elim_values_.end(), block_t.begin(), block_t.end());
+    }
+}
+
+
 /**
  *  COMPUTE A SCHUR COMPLEMENT OF A PETSC MATRIX
  *
@@ -154,7 +248,7 @@ void SchurComplement::set_from_input(const Input::Record in_rec)
  *  x_1 = IA * RHS_1 - IAB * x_2
  *
  *  Actually as B' is stored separetly, the routine can be used also for nonsymetric original
- * system
+ * system, then the RHS of the complement is computed as Bt * (IA * RHS_1), see form_rhs.
  *
  */
 
@@ -215,8 +309,11 @@ void SchurComplement::form_schur()
     // Probably no way to make this optimal using high level methods. We should have our own
     // format for schur complement matrix, store local systems and perform elimination localy.
     // Or even better assembly the complement directly. (not compatible with raw P0 method)
+    // The direct assembly is optional, see set_direct_assembly and form_schur_direct.
 
-    if (matrix_changed_) {
+    if (matrix_changed_ && direct_assembly_) {
+        form_schur_direct(mat_reuse);
+    } else if (matrix_changed_) {
        	create_inversion_matrix();
 
        	// compute IAB=IA*B, loc_size_B removed
@@ -253,11 +350,100 @@ void SchurComplement::form_schur()
     state=formed;
 }
 
+/**
+ * Same as the matrix part of form_schur, but IA, IAB and Bt*IA*B are assembled from the blocks
+ * stored by eliminate_local_system. Only the C block is taken from the original matrix.
+ */
+void SchurComplement::form_schur_direct(MatReuse mat_reuse)
+{
+    START_TIMER("form schur direct");
+    PetscErrorCode ierr = 0;
+
+    ASSERT_EQ(n_elim_rows_, (unsigned int)loc_size_A).error("Not all rows of the A block were set by local systems.");
+
+    if (state==created) {
+        // preallocation given by the element blocks, IA is block diagonal and local
+        std::vector<PetscInt> ia_nnz(loc_size_A, 0), iab_d_nnz(loc_size_A, 0), iab_o_nnz(loc_size_A, 0);
+        for (const LocalElimination &elim : local_elims_) {
+            const PetscInt *a_dofs = &elim_dofs_[elim.dofs_begin];
+            const PetscInt *b_dofs = a_dofs + elim.n_a;
+            unsigned int n_b_local = 0;
+            for (unsigned int j=0; j<elim.n_b; j++)
+                if (ds_->is_local(b_dofs[j])) n_b_local++;
+            for (unsigned int i=0; i<elim.n_a; i++) {
+                unsigned int loc_row = a_dofs[i] - a_begin_;
+                ia_nnz[loc_row] += elim.n_a;
+                iab_d_nnz[loc_row] += n_b_local;
+                iab_o_nnz[loc_row] += elim.n_b - n_b_local;
+            }
+        }
+        // counts may exceed number of columns if the blocks overlap
+        for (int i=0; i<loc_size_A; i++) {
+            ia_nnz[i] = std::min(ia_nnz[i], (PetscInt)loc_size_A);
+            iab_d_nnz[i] = std::min(iab_d_nnz[i], (PetscInt)loc_size_B);
+        }
+        ierr+=MatCreateAIJ(PETSC_COMM_WORLD, loc_size_A, loc_size_A, PETSC_DETERMINE, PETSC_DETERMINE,
+                0, ia_nnz.data(), 0, nullptr, &IA);
+        ierr+=MatCreateAIJ(PETSC_COMM_WORLD, loc_size_A, loc_size_B, PETSC_DETERMINE, PETSC_DETERMINE,
+                0, iab_d_nnz.data(), 0, iab_o_nnz.data(), &IAB);
+        // structure of local systems may change in later assemblies
+        MatSetOption(IA, MAT_NEW_NONZERO_ALLOCATION_ERR, PETSC_FALSE);
+        MatSetOption(IAB, MAT_NEW_NONZERO_ALLOCATION_ERR, PETSC_FALSE);
+    } else {
+        ierr+=MatZeroEntries(IA);
+        ierr+=MatZeroEntries(IAB);
+    }
+
+    // get C block, its structure contains blocks Bt*IA*B if the local systems keep the structure of their C part
+    ierr+=MatGetSubMatrix( matrix_, IsB, IsB, mat_reuse, &C);
+    // Bt differs from B' and is necessary for the RHS of the complement
+    if ( ! is_symmetric() )
+        ierr+=MatGetSubMatrix(matrix_, IsB, IsA, (Bt == NULL ? MAT_INITIAL_MATRIX : mat_reuse), &Bt);
+    Mat &compl_mat = *const_cast<Mat *>( Compl->get_matrix() );
+    if (state==created) {
+        MatDuplicate(C, MAT_DO_NOT_COPY_VALUES, &compl_mat );
+        MatSetOption(compl_mat, MAT_NEW_NONZERO_ALLOCATION_ERR, PETSC_FALSE);
+    }
+    MatZeroEntries( compl_mat );
+
+    for (const LocalElimination &elim : local_elims_) {
+        const PetscInt *a_dofs = &elim_dofs_[elim.dofs_begin];
+        const PetscInt *b_dofs = a_dofs + elim.n_a;
+        const PetscScalar *ia_vals = &elim_values_[elim.values_begin];
+        const PetscScalar *iab_vals = ia_vals + elim.n_a * elim.n_a;
+        const PetscScalar *xa_vals = iab_vals + elim.n_a * elim.n_b;
+        ierr+=MatSetValues(IA, elim.n_a, a_dofs, elim.n_a, a_dofs, ia_vals, INSERT_VALUES);
+        ierr+=MatSetValues(IAB, elim.n_a, a_dofs, elim.n_b, b_dofs, iab_vals, INSERT_VALUES);
+        ierr+=MatSetValues(compl_mat, elim.n_b, b_dofs, elim.n_b, b_dofs, xa_vals, ADD_VALUES);
+    }
+    ierr+=MatAssemblyBegin(IA, MAT_FINAL_ASSEMBLY);
+    ierr+=MatAssemblyBegin(IAB, MAT_FINAL_ASSEMBLY);
+    ierr+=MatAssemblyBegin(compl_mat, MAT_FINAL_ASSEMBLY);
+    ierr+=MatAssemblyEnd(IA, MAT_FINAL_ASSEMBLY);
+    ierr+=MatAssemblyEnd(IAB, MAT_FINAL_ASSEMBLY);
+    ierr+=MatAssemblyEnd(compl_mat, MAT_FINAL_ASSEMBLY);
+
+    // compute complement = xA - C, or C - xA for the negative definite system
+    ierr+=MatAXPY(compl_mat, -1, C, SUBSET_NONZERO_PATTERN);
+    if ( is_negative_definite() ) ierr+=MatScale(compl_mat, -1);
+    Compl->set_matrix_changed();
+
+    OLD_ASSERT( ierr == 0, "PETSC Error during direct assembly of Schur complement.\n");
+}
+
+
 void SchurComplement::form_rhs()
 {
     START_TIMER("form rhs");
 	if (rhs_changed_ || matrix_changed_) {
-	    MatMultTranspose(IAB, RHS1, *( Compl->get_rhs() ));
+	    if ( is_symmetric() ) {
+	        // Bt * IA * RHS1 = (IA * B)' * RHS1 for Bt = B' and symmetric IA
+	        MatMultTranspose(IAB, RHS1, *( Compl->get_rhs() ));
+	    } else {
+	        if (IA_RHS1 == NULL) VecDuplicate(RHS1, &IA_RHS1);
+	        MatMult(IA, RHS1, IA_RHS1);
+	        MatMult(Bt, IA_RHS1, *( Compl->get_rhs() ));
+	    }
 	    VecAXPY(*( Compl->get_rhs() ), -1, RHS2);
 	    if ( is_negative_definite() ) {
 	    	VecScale(*( Compl->get_rhs() ), -1.0);
@@ -439,6 +625,7 @@ SchurComplement :: ~SchurComplement() {
     if ( RHS2 != NULL )           chkerr(VecDestroy(&RHS2));
     if ( Sol1 != NULL )           chkerr(VecDestroy(&Sol1));
     if ( Sol2 != NULL )           chkerr(VecDestroy(&Sol2));
+    if ( IA_RHS1 != NULL )        chkerr(VecDestroy(&IA_RHS1));
     if ( IA != NULL )             chkerr(MatDestroy(&IA));
 
     if (Compl != NULL)            delete Compl;
@@ -20,6 +20,7 @@
 #define LA_SCHUR_HH_
 
 #include <petscmat.h>          // for Mat, _p_Mat
+#include <vector>              // for vector
 #include "la/linsys_PETSC.hh"  // for LinSys_PETSC
 #include "petscistypes.h"      // for IS, _p_IS
 #include "petscvec.h"          // for Vec, _p_Vec
@@ -53,6 +54,11 @@ namespace Input { class Record; }
  * @ENDCODE
  *
  * Input record is passed to the complement system.
+ *
+ * Direct assembly (see @p set_direct_assembly): the A block is eliminated element by element
+ * when the local systems are passed through @p set_local_system. Matrices IA, IAB and the complement
+ * are then assembled from the stored element blocks, without extraction of the sub-matrices
+ * and without the global matrix products.
  */
 
 typedef enum SchurState {
@@ -85,6 +91,24 @@ public:
      */
     void set_from_input(const Input::Record in_rec) override;
 
+    /**
+     * Switch on the direct assembly of the complement from the local systems. Must be called after
+     * @p make_complement_distribution and before the assembly.
+     *
+     * Every row of the A block has to be set (together with all other rows of its block of A)
+     * by a single call of @p set_local_system with the same row and column dofs. The rows of the A block
+     * are expected at the beginning of the local part of the system (as it is the case of MH systems).
+     */
+    void set_direct_assembly();
+
+    /**
+     * Add local system into the matrix, in the direct assembly eliminate its part from the A block.
+     */
+    void set_local_system(LocalSystem & local) override;
+
+    /// Zero matrix entries, in the direct assembly drop also the stored element blocks.
+    PetscErrorCode mat_zero_entries() override;
+
     /**
      * Returns pointer to LinSys object representing the schur complement.
      */
@@ -141,7 +165,24 @@ protected:
 
     void form_schur();
 
+    /// Form IA, IAB and the complement from the stored element blocks (direct assembly).
+    void form_schur_direct(MatReuse mat_reuse);
+
+    /// Eliminate the A block of the local system and store the element blocks (direct assembly).
+    void eliminate_local_system(LocalSystem & local);
 
+    /// Returns true if the global row @p row of the original system belongs to the A block.
+    bool is_a_row(unsigned int row) const;
+
+    /// Returns global index of the row @p row of the B block in the complement system.
+    unsigned int complement_row(unsigned int row) const;
+
+    /// Sizes and positions of the stored blocks of one eliminated local system.
+    struct LocalElimination {
+        unsigned int n_a, n_b;          ///< Number of dofs in A and B block.
+        unsigned int dofs_begin;        ///< Position of A indices of IA and complement indices in elim_dofs_.
+        unsigned int values_begin;      ///< Position of row-wise blocks IA, IA*B and Bt*IA*B in elim_values_.
+    };
 
     Mat IA;                     // Inverse of block A
 
@@ -153,13 +194,21 @@ protected:
     IS IsA, IsB;                // parallel index sets of the A and B block
     Vec RHS1, RHS2;             // A and B - part of the RHS
     Vec Sol1, Sol2;             // A and B part of solution
+    Vec IA_RHS1;                // IA * RHS1, complement RHS of nonsymmetric systems is Bt * IA_RHS1
 
     SchurState state;           // object internal state
     int orig_lsize;             ///< Size of local vector part of original system
 
-    LinSys_PETSC *Compl;        // Schur complement system: (C - B' IA B) * Sol2 = (B' * IA * RHS1 - RHS2)
+    LinSys_PETSC *Compl;        // Schur complement system: (Bt IA B - C) * Sol2 = (Bt * IA * RHS1 - RHS2)
 
     Distribution *ds_;          // Distribution of B block
+
+    bool direct_assembly_;      ///< Complement is assembled from the local systems.
+    unsigned int a_begin_;      ///< First global row of the local part of IA (direct assembly).
+    unsigned int n_elim_rows_;  ///< Number of local rows of A eliminated from the local systems.
+    std::vector<LocalElimination> local_elims_;  ///< Eliminated local systems.
+    std::vector<PetscInt> elim_dofs_;            ///< Dofs of all eliminated local systems.
+    std::vector<PetscScalar> elim_values_;       ///< Element blocks of all eliminated local systems.
 } SchurComplement;
 
 #endif /* LA_SCHUR_HH_ */
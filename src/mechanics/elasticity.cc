@@ -23,6 +23,7 @@
 #include "quadrature/quadrature_lib.hh"
 #include "fem/mapping_p1.hh"
 #include "fem/fe_values.hh"
+#include "fem/fe_values_batch.hh"
 #include "fem/fe_p.hh"
 #include "fem/fe_rt.hh"
 #include "fem/fe_system.hh"
@@ -378,7 +379,15 @@ void Elasticity::update_solution()
 
 	time_->next_time();
 	time_->view("MECH");
-    
+
+	solve_time_step();
+
+	END_TIMER("DG-ONE STEP");
+}
+
+
+void Elasticity::solve_time_step(bool output)
+{
     START_TIMER("data reinit");
     data_.set_time(time_->step(), LimitSide::right);
     END_TIMER("data reinit");
@@ -424,9 +433,7 @@ void Elasticity::update_solution()
 
     calculate_cumulative_balance();
     
-    output_data();
-
-    END_TIMER("DG-ONE STEP");
+    if (output) output_data();
 }
 
 
@@ -513,22 +520,18 @@ void Elasticity::assemble_volume_integrals()
     vector<int> dof_indices(ndofs);
     vector<arma::vec3> velocity(qsize);
     vector<double> young(qsize), poisson(qsize), csection(qsize);
-    PetscScalar local_matrix[ndofs*ndofs];
+    vector<PetscScalar> local_matrix(ndofs*ndofs);
     auto vec = fe_values.vector_view(0);
 
-	// assemble integral over elements
-    for (auto cell : feo->dh()->own_range())
+	// assemble integral over elements, geometry of cells is computed in batches
+    for_each_cell_batched<dim>(*feo->dh(), {&fe_values}, [&](DHCellAccessor &cell, ElementAccessor<3> &elm_acc)
     {
-        if (cell.dim() != dim) continue;
-        ElementAccessor<3> elm_acc = cell.elm();
-
-        fe_values.reinit(elm_acc);
         cell.get_dof_indices(dof_indices);
 
         data_.cross_section.value_list(fe_values.point_list(), elm_acc, csection);
         data_.young_modulus.value_list(fe_values.point_list(), elm_acc, young);
         data_.poisson_ratio.value_list(fe_values.point_list(), elm_acc, poisson);
-        
+    
         // assemble the local stiffness matrix
         for (unsigned int i=0; i<ndofs; i++)
             for (unsigned int j=0; j<ndofs; j++)
@@ -547,8 +550,8 @@ void Elasticity::assemble_volume_integrals()
                                                )*fe_values.JxW(k);
             }
         }
-        ls->mat_set_values(ndofs, dof_indices.data(), ndofs, dof_indices.data(), local_matrix);
-    }
+        ls->mat_set_values(ndofs, dof_indices.data(), ndofs, dof_indices.data(), local_matrix.data());
+    });
 }
 
 
@@ -574,24 +577,20 @@ void Elasticity::set_sources()
     vector<arma::vec3> load(qsize);
     vector<double> csection(qsize);
     vector<int> dof_indices(ndofs);
-    PetscScalar local_rhs[ndofs];
+    vector<PetscScalar> local_rhs(ndofs);
     vector<PetscScalar> local_source_balance_vector(ndofs), local_source_balance_rhs(ndofs);
     auto vec = fe_values.vector_view(0);
 
-	// assemble integral over elements
-    for (auto cell : feo->dh()->own_range())
+	// assemble integral over elements, geometry of cells is computed in batches
+    for_each_cell_batched<dim>(*feo->dh(), {&fe_values}, [&](DHCellAccessor &cell, ElementAccessor<3> &elm_acc)
     {
-        if (cell.dim() != dim) continue;
-        ElementAccessor<3> elm_acc = cell.elm();
-
-        fe_values.reinit(elm_acc);
         cell.get_dof_indices(dof_indices);
 
         // assemble the local stiffness matrix
-        fill_n(local_rhs, ndofs, 0);
+        local_rhs.assign(ndofs, 0);
         local_source_balance_vector.assign(ndofs, 0);
         local_source_balance_rhs.assign(ndofs, 0);
-        
+    
         data_.cross_section.value_list(fe_values.point_list(), elm_acc, csection);
         data_.load.value_list(fe_values.point_list(), elm_acc, load);
 
@@ -601,7 +600,7 @@ void Elasticity::set_sources()
             for (unsigned int i=0; i<ndofs; i++)
                 local_rhs[i] += arma::dot(load[k], vec.value(i,k))*csection[k]*fe_values.JxW(k);
         }
-        ls->rhs_set_values(ndofs, &(dof_indices[0]), local_rhs);
+        ls->rhs_set_values(ndofs, &(dof_indices[0]), local_rhs.data());
 
 //         for (unsigned int i=0; i<ndofs; i++)
 //         {
@@ -612,7 +611,7 @@ void Elasticity::set_sources()
 //         }
 //         balance_->add_source_matrix_values(subst_idx, elm_acc.region().bulk_idx(), dof_indices, local_source_balance_vector);
 //         balance_->add_source_vec_values(subst_idx, elm_acc.region().bulk_idx(), dof_indices, local_source_balance_rhs);
-    }
+    });
 }
 
 
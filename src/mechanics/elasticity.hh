@@ -164,6 +164,14 @@ public:
      */
 	void update_solution() override;
 
+	/**
+	 * @brief Computes the solution in the actual time, without moving to the next time.
+	 *
+	 * May be called repeatedly within one time step by an iterative coupling.
+	 * @param output  Write the solution to the output stream.
+	 */
+	void solve_time_step(bool output = true);
+
 	/**
 	 * @brief Postprocesses the solution and writes to output file.
 	 */
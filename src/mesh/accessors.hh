@@ -118,6 +118,11 @@ public:
         return element_idx_;
     }
 
+    /// Return the mesh of the element
+    inline const Mesh *mesh() const {
+        return mesh_;
+    }
+
     inline unsigned int index() const {
     	return (unsigned int)mesh_->find_elem_id(element_idx_);
     }
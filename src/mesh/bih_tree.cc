@@ -22,6 +22,10 @@
 #include <ctime>
 #include <stack>
 
+#ifdef FLOW123D_HAVE_OPENMP
+#include <omp.h>
+#endif
+
 /**
  * Minimum reduction of box size to allow
  * splitting of a node during tree creation.
@@ -32,7 +36,8 @@ const unsigned int BIHTree::default_leaf_size_limit = 20;
 
 
 BIHTree::BIHTree(unsigned int soft_leaf_size_limit)
-: leaf_size_limit(soft_leaf_size_limit) //, r_gen(123)
+: max_stack_size_(0),
+  leaf_size_limit(soft_leaf_size_limit) //, r_gen(123)
 {}
 
 
@@ -65,7 +70,52 @@ void BIHTree::construct() {
     nodes_.back().set_leaf(0, in_leaves_.size(), 0, 0);
     uint height = make_node(main_box_, 0);
 
-    node_stack_.reserve(2*height);
+    max_stack_size_ = 2*height;
+    make_flat_tree();
+}
+
+
+void BIHTree::make_flat_tree() {
+    flat_nodes_.clear();
+    flat_nodes_.reserve(nodes_.size());
+    make_flat_node(0);
+
+    unsigned int n = in_leaves_.size();
+    leaf_boxes_.resize(2*dimension*n);
+    for (unsigned int i=0; i<n; i++) {
+        const BoundingBox &box = elements_[ in_leaves_[i] ];
+        for (unsigned int axis=0; axis<dimension; axis++) {
+            leaf_boxes_[axis*n + i] = box.min(axis);
+            leaf_boxes_[(dimension+axis)*n + i] = box.max(axis);
+        }
+    }
+}
+
+
+unsigned int BIHTree::make_flat_node(unsigned int node_idx) {
+    unsigned int flat_idx = flat_nodes_.size();
+    flat_nodes_.push_back(FlatNode());
+
+    const BIHNode &node = nodes_[node_idx];
+    if (node.is_leaf()) {
+        FlatNode &flat = flat_nodes_[flat_idx];
+        flat.child_bound[0] = flat.child_bound[1] = 0.0;
+        flat.child[0] = node.leaf_begin();
+        flat.child[1] = node.leaf_end();
+        flat.axis = dimension;
+    } else {
+        // left child follows its parent
+        unsigned int left = make_flat_node(node.child(0));
+        unsigned int right = make_flat_node(node.child(1));
+        FlatNode &flat = flat_nodes_[flat_idx];
+        flat.child_bound[0] = nodes_[ node.child(0) ].bound();
+        flat.child_bound[1] = nodes_[ node.child(1) ].bound();
+        flat.child[0] = left;
+        flat.child[1] = right;
+        flat.axis = node.axis();
+    }
+    flat_nodes_[flat_idx].padding_ = 0;
+    return flat_idx;
 }
 
 
@@ -233,60 +283,141 @@ const BoundingBox &BIHTree::tree_box() const {
 
 void BIHTree::find_bounding_box(const BoundingBox &box, std::vector<unsigned int> &result_list, bool full_list) const
 {
+    // local buffer, the search can be called from several threads at once
+    SearchBuffer buffer;
+    find_bounding_box(box, result_list, buffer, full_list);
+}
+
 
+void BIHTree::find_bounding_box(const BoundingBox &box, std::vector<unsigned int> &result_list, SearchBuffer &buffer,
+        bool full_list) const
+{
 	ASSERT_EQ(result_list.size() , 0);
+	search(box, result_list, buffer, full_list);
+}
+
+
+void BIHTree::find_point(const Space<3>::Point &point, std::vector<unsigned int> &result_list, bool full_list) const
+{
+	find_bounding_box(BoundingBox(point), result_list, full_list);
+}
 
-    unsigned int counter = 0;
-    node_stack_.clear();
-    node_stack_.push_back(0);
-	while (! node_stack_.empty()) {
-		const BIHNode &node = nodes_[node_stack_.back()];
-		//DebugOut().fmt("node: {}\n", node_stack.top() );
-		node_stack_.pop_back();
+
+void BIHTree::find_point(const Space<3>::Point &point, std::vector<unsigned int> &result_list, SearchBuffer &buffer,
+        bool full_list) const
+{
+	find_bounding_box(BoundingBox(point), result_list, buffer, full_list);
+}
 
 
-		if (node.is_leaf()) {
+void BIHTree::search(const BoundingBox &box, std::vector<unsigned int> &result_list, SearchBuffer &buffer, bool full_list) const
+{
+    const unsigned int n = in_leaves_.size();
+    const double epsilon = BoundingBox::epsilon;
+    // same comparisons as in BoundingBox::intersect
+    double box_min[dimension], box_max[dimension];
+    for (unsigned int axis=0; axis<dimension; axis++) {
+        box_min[axis] = box.min(axis);
+        box_max[axis] = box.max(axis) + epsilon;
+    }
 
-            counter ++;
-			//START_TIMER("leaf");
-			for (unsigned int i=node.leaf_begin(); i<node.leaf_end(); i++) {
-				if (full_list || elements_[ in_leaves_[i] ].intersect(box)) {
+    std::vector<unsigned int> &node_stack = buffer.node_stack_;
+    node_stack.clear();
+    node_stack.reserve(max_stack_size_);
+    node_stack.push_back(0);
+	while (! node_stack.empty()) {
+		const FlatNode &node = flat_nodes_[node_stack.back()];
+		node_stack.pop_back();
+
+		if (node.axis == dimension) {
+			unsigned int begin = node.child[0];
+			unsigned int size = node.child[1] - begin;
+			if (full_list) {
+				result_list.insert(result_list.end(), in_leaves_.begin() + begin, in_leaves_.begin() + begin + size);
+				continue;
+			}
 
-					result_list.push_back(in_leaves_[i]);
-				}
+			// test all boxes of the leaf at once, then collect the intersecting ones
+			if (buffer.leaf_mask_.size() < size) buffer.leaf_mask_.resize(size);
+			char *mask = buffer.leaf_mask_.data();
+			const double *min_0 = &(leaf_boxes_[begin]);
+			const double *min_1 = min_0 + n, *min_2 = min_0 + 2*n;
+			const double *max_0 = min_0 + 3*n, *max_1 = min_0 + 4*n, *max_2 = min_0 + 5*n;
+			for (unsigned int i=0; i<size; i++) {
+				mask[i] = (min_0[i] <= box_max[0]) & (box_min[0] <= max_0[i] + epsilon)
+						& (min_1[i] <= box_max[1]) & (box_min[1] <= max_1[i] + epsilon)
+						& (min_2[i] <= box_max[2]) & (box_min[2] <= max_2[i] + epsilon);
+			}
+			for (unsigned int i=0; i<size; i++) {
+				if (mask[i]) result_list.push_back(in_leaves_[begin + i]);
 			}
-			//END_TIMER("leaf");
 		} else {
-			//START_TIMER("recursion");
-			if ( ! box.projection_gt( node.axis(), nodes_[node.child(0)].bound() ) ) {
+			if ( ! box.projection_gt( node.axis, node.child_bound[0] ) ) {
 				// box intersects left group
-				node_stack_.push_back( node.child(0) );
+				node_stack.push_back( node.child[0] );
 			}
-			if ( ! box.projection_lt( node.axis(), nodes_[node.child(1)].bound() ) ) {
+			if ( ! box.projection_lt( node.axis, node.child_bound[1] ) ) {
 				// box intersects right group
-				node_stack_.push_back( node.child(1) );
+				node_stack.push_back( node.child[1] );
 			}
-			//END_TIMER("recursion");
 		}
 	}
-	//node_stack_.pop_back();
-	//cout << "stack size: " << node_stack_.size();
-
-// 	xprintf(Msg,"leaves: %d\n",counter);
-
-//#ifdef FLOW123D_DEBUG_ASSERTS
-//	// check uniqueness of element indexes
-//	std::vector<unsigned int> cpy(result_list);
-//	sort(cpy.begin(), cpy.end());
-//	std::vector<unsigned int>::iterator it = unique(cpy.begin(), cpy.end());
-//	OLD_ASSERT_EQUAL(cpy.size() , it - cpy.begin());
-//#endif
 }
 
 
-void BIHTree::find_point(const Space<3>::Point &point, std::vector<unsigned int> &result_list, bool full_list) const
+template <class GetBox>
+void BIHTree::search_batch(unsigned int n_boxes, GetBox get_box, std::vector<unsigned int> &result_list,
+        std::vector<unsigned int> &result_offsets, bool full_list) const
 {
-	find_bounding_box(BoundingBox(point), result_list, full_list);
+    // small batches are not split
+    static const unsigned int min_chunk_size = 256;
+    unsigned int n_chunks = 1;
+#ifdef FLOW123D_HAVE_OPENMP
+    n_chunks = std::max(1u, std::min((unsigned int)omp_get_max_threads(), n_boxes / min_chunk_size));
+#endif
+
+    // every chunk of boxes stores its results separately, offsets are relative to the chunk
+    std::vector< std::vector<unsigned int> > chunk_results(n_chunks);
+    result_offsets.resize(n_boxes + 1);
+    result_offsets[0] = 0;
+#ifdef FLOW123D_HAVE_OPENMP
+    #pragma omp parallel for schedule(static) num_threads(n_chunks)
+#endif
+    for (int i_chunk=0; i_chunk<(int)n_chunks; i_chunk++) {
+        SearchBuffer buffer;
+        std::vector<unsigned int> &chunk_result = chunk_results[i_chunk];
+        unsigned int begin = (std::size_t)n_boxes * i_chunk / n_chunks;
+        unsigned int end = (std::size_t)n_boxes * (i_chunk+1) / n_chunks;
+        for (unsigned int i=begin; i<end; i++) {
+            search(get_box(i), chunk_result, buffer, full_list);
+            result_offsets[i+1] = chunk_result.size();
+        }
+    }
+
+    result_list.clear();
+    for (unsigned int i_chunk=0; i_chunk<n_chunks; i_chunk++) {
+        unsigned int chunk_offset = result_list.size();
+        unsigned int begin = (std::size_t)n_boxes * i_chunk / n_chunks;
+        unsigned int end = (std::size_t)n_boxes * (i_chunk+1) / n_chunks;
+        for (unsigned int i=begin; i<end; i++) result_offsets[i+1] += chunk_offset;
+        result_list.insert(result_list.end(), chunk_results[i_chunk].begin(), chunk_results[i_chunk].end());
+    }
+}
+
+
+void BIHTree::find_bounding_boxes(const std::vector<BoundingBox> &boxes, std::vector<unsigned int> &result_list,
+        std::vector<unsigned int> &result_offsets, bool full_list) const
+{
+    search_batch(boxes.size(), [&boxes](unsigned int i) -> const BoundingBox & { return boxes[i]; },
+            result_list, result_offsets, full_list);
+}
+
+
+void BIHTree::find_points(const std::vector<Space<3>::Point> &points, std::vector<unsigned int> &result_list,
+        std::vector<unsigned int> &result_offsets, bool full_list) const
+{
+    search_batch(points.size(), [&points](unsigned int i) { return BoundingBox(points[i]); },
+            result_list, result_offsets, full_list);
 }
 
 
@@ -34,6 +34,10 @@ class Mesh;
  * Assumes spacedim=3. Implementation was designed for arbitrary number of childs per node, but
  * currently it supports max 2 childs per node (binary tree).
  *
+ * Searches use a flat copy of the tree created by @p construct: nodes in depth-first order with bounds
+ * of both children stored in the parent and bounding boxes of elements stored by coordinates in the order
+ * of leaves, so that boxes of a leaf are tested by a loop vectorized by the compiler.
+ * Searches are reentrant, threads searching in the same tree have to use separate SearchBuffer objects.
  */
 class BIHTree {
 public:
@@ -44,6 +48,19 @@ public:
     /// Default leaf size limit
     static const unsigned int default_leaf_size_limit;
 
+    /**
+     * Buffers of a search in the tree. Repeated searches with the same buffer do not allocate memory.
+     */
+    class SearchBuffer {
+    private:
+        /// Stack of nodes to visit.
+        std::vector<unsigned int> node_stack_;
+        /// Results of box tests of elements in a leaf.
+        std::vector<char> leaf_mask_;
+
+        friend class BIHTree;
+    };
+
     /**
 	 * Constructor
 	 *
@@ -91,6 +108,27 @@ public:
 	 */
     void find_point(const Space<3>::Point &point, std::vector<unsigned int> &result_list, bool full_list = false) const;
 
+    /// Same as previous, use given @p buffer (e.g. one per thread) for repeated searches.
+    void find_bounding_box(const BoundingBox &boundingBox, std::vector<unsigned int> &result_list, SearchBuffer &buffer,
+            bool full_list = false) const;
+
+    /// Same as previous, use given @p buffer (e.g. one per thread) for repeated searches.
+    void find_point(const Space<3>::Point &point, std::vector<unsigned int> &result_list, SearchBuffer &buffer,
+            bool full_list = false) const;
+
+    /**
+     * Gets elements which can have intersection with each of @p boxes.
+     *
+     * Elements of box @p i are stored in result_list[ result_offsets[i] ], ..., result_list[ result_offsets[i+1]-1 ],
+     * in the same order as returned by @p find_bounding_box. Boxes are processed by several threads if OpenMP is available.
+     */
+    void find_bounding_boxes(const std::vector<BoundingBox> &boxes, std::vector<unsigned int> &result_list,
+            std::vector<unsigned int> &result_offsets, bool full_list = false) const;
+
+    /// Same as previous for a vector of points.
+    void find_points(const std::vector<Space<3>::Point> &points, std::vector<unsigned int> &result_list,
+            std::vector<unsigned int> &result_offsets, bool full_list = false) const;
+
     /**
      * Get vector of mesh elements bounding boxes
      *
@@ -126,14 +164,39 @@ protected:
      */
     double estimate_median(unsigned char axis, const BIHNode &node);
 
+    /// Node of the flat tree used by searches (32 bytes).
+    struct FlatNode {
+        /// Bounds of the left and right child (see BIHNode::bound).
+        double child_bound[2];
+        /// Indexes of child nodes in @p flat_nodes_ or range of the leaf in @p in_leaves_.
+        unsigned int child[2];
+        /// Splitting axis of inner node, value @p dimension for leaf node.
+        unsigned int axis;
+        unsigned int padding_;
+    };
+
+    /// Create @p flat_nodes_ and @p leaf_boxes_ from @p nodes_, called at the end of @p construct.
+    void make_flat_tree();
+
+    /// Append flat copy of the subtree of @p node_idx to @p flat_nodes_, return its index.
+    unsigned int make_flat_node(unsigned int node_idx);
+
+    /// Append elements which can have intersection with @p box to @p result_list.
+    void search(const BoundingBox &box, std::vector<unsigned int> &result_list, SearchBuffer &buffer, bool full_list) const;
+
+    /// Implementation of @p find_bounding_boxes and @p find_points, @p get_box(i) returns the i-th box.
+    template <class GetBox>
+    void search_batch(unsigned int n_boxes, GetBox get_box, std::vector<unsigned int> &result_list,
+            std::vector<unsigned int> &result_offsets, bool full_list) const;
+
     /// mesh
     //Mesh* mesh_;
 	/// vector of mesh elements bounding boxes (from mesh)
     std::vector<BoundingBox> elements_;
     /// Main bounding box. (from mesh)
     BoundingBox main_box_;
-    /// Stack for search algorithms.
-    mutable std::vector<unsigned int>  node_stack_;
+    /// Capacity of the node stack reserved by search algorithms (twice the tree height).
+    unsigned int max_stack_size_;
 
     /// vector of tree nodes
     std::vector<BIHNode> nodes_;
@@ -144,6 +207,13 @@ protected:
 
     /// vector stored element indexes in leaf nodes
     std::vector<unsigned int> in_leaves_;
+    /// Nodes of the flat tree in depth-first order, the root is the first node.
+    std::vector<FlatNode> flat_nodes_;
+    /**
+     * Bounding boxes of elements in the order of @p in_leaves_ stored by coordinates: for n elements min(axis)
+     * of the i-th box is at axis*n + i and max(axis) at (dimension + axis)*n + i.
+     */
+    std::vector<double> leaf_boxes_;
     /// temporary vector stored values of coordinations for calculating median
     std::vector<double> coors_;
 
@@ -0,0 +1,105 @@
+/*!
+ *
+ * Copyright (C) 2015 Technical University of Liberec.  All rights reserved.
+ * 
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License version 3 as published by the
+ * Free Software Foundation. (http://www.gnu.org/licenses/gpl-3.0.en.html)
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * 
+ * @file    element_geometry_cache.cc
+ * @brief   Precomputed geometry of mesh elements for the affine mapping.
+ */
+
+#include "system/system.hh"
+#include "system/sys_profiler.hh"
+#include "mesh/element_geometry_cache.hh"
+#include "mesh/mesh.h"
+#include "mesh/accessors.hh"
+#include "mesh/ref_element.hh"
+#include "mesh/side_impl.hh"
+
+#ifdef FLOW123D_HAVE_OPENMP
+#include <omp.h>
+#endif
+
+
+ElementGeometryCache::ElementGeometryCache(const Mesh &mesh)
+{
+    START_TIMER("ElementGeometryCache");
+    unsigned int n_elm = mesh.n_elements() + mesh.n_elements(true);
+    jacobians_.resize(n_elm*max_jac_size, 0.0);
+    inverse_jacobians_.resize(n_elm*max_jac_size, 0.0);
+    determinants_.resize(n_elm, 0.0);
+    normals_.resize(n_elm*max_sides*3, 0.0);
+    side_determinants_.resize(n_elm*max_sides, 0.0);
+
+    // elements are independent, every thread writes only data of its elements
+#ifdef FLOW123D_HAVE_OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int i=0; i<(int)n_elm; i++)
+    {
+        ElementAccessor<3> elm = mesh.element_accessor(i);
+        switch (elm.dim()) {
+        case 1: compute_element<1>(elm); break;
+        case 2: compute_element<2>(elm); break;
+        case 3: compute_element<3>(elm); break;
+        default: break;
+        }
+    }
+}
+
+
+template<unsigned int dim>
+void ElementGeometryCache::compute_element(const ElementAccessor<3> &elm)
+{
+    unsigned int idx = elm.mesh_idx();
+
+    // Jacobian columns are the edges from the first node
+    arma::mat::fixed<3,dim> jac;
+    for (unsigned int i=0; i<dim; i++)
+        jac.col(i) = elm.node(i+1)->point() - elm.node(0)->point();
+
+    arma::mat::fixed<dim,3> ijac;
+    if (dim == 3)
+    {
+        ijac = inv(jac);
+        determinants_[idx] = fabs(det(jac));
+    }
+    else
+    {
+        // square root of the determinant of the Gram matrix
+        ijac = pinv(jac);
+        double g00 = arma::dot(jac.col(0), jac.col(0));
+        if (dim == 1)
+            determinants_[idx] = sqrt(g00);
+        else
+        {
+            double g01 = arma::dot(jac.col(0), jac.col(dim-1)), g11 = arma::dot(jac.col(dim-1), jac.col(dim-1));
+            determinants_[idx] = sqrt(g00*g11 - g01*g01);
+        }
+    }
+    std::copy(jac.memptr(), jac.memptr()+3*dim, &jacobians_[idx*max_jac_size]);
+    std::copy(ijac.memptr(), ijac.memptr()+3*dim, &inverse_jacobians_[idx*max_jac_size]);
+
+    for (unsigned int sid=0; sid<RefElement<dim>::n_sides; sid++)
+    {
+        arma::vec3 normal = trans(ijac)*RefElement<dim>::normal_vector(sid);
+        normal /= norm(normal,2);
+        std::copy(normal.memptr(), normal.memptr()+3, &normals_[(idx*max_sides + sid)*3]);
+
+        // determinant of the side mapping: 1 for a point, length of a line, double area of a triangle
+        double side_det = 1;
+        if (dim == 2)
+            side_det = norm(elm.side(sid)->node(1)->point() - elm.side(sid)->node(0)->point(), 2);
+        else if (dim == 3)
+            side_det = norm(arma::cross(elm.side(sid)->node(1)->point() - elm.side(sid)->node(0)->point(),
+                                        elm.side(sid)->node(2)->point() - elm.side(sid)->node(0)->point()), 2);
+        side_determinants_[idx*max_sides + sid] = side_det;
+    }
+}
@@ -0,0 +1,94 @@
+/*!
+ *
+ * Copyright (C) 2015 Technical University of Liberec.  All rights reserved.
+ * 
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License version 3 as published by the
+ * Free Software Foundation. (http://www.gnu.org/licenses/gpl-3.0.en.html)
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * 
+ * @file    element_geometry_cache.hh
+ * @brief   Precomputed geometry of mesh elements for the affine mapping.
+ */
+
+#ifndef ELEMENT_GEOMETRY_CACHE_HH_
+#define ELEMENT_GEOMETRY_CACHE_HH_
+
+#include <vector>
+#include <armadillo>
+
+class Mesh;
+template <int spacedim> class ElementAccessor;
+
+
+/**
+ * @brief Geometry of all elements of a mesh precomputed for the affine (P1) mapping.
+ *
+ * For every element (bulk and boundary) the cache holds the Jacobian of the mapping from the reference
+ * element (matrix 3 x dim), its inverse (pseudoinverse for dim < 3), the absolute value of its determinant,
+ * and for every side the unit outer normal and the determinant of the side mapping.
+ * The values are the same as computed by MappingP1 from node coordinates. If the mesh has the cache
+ * (see Mesh::geometry_cache), MappingP1 reads them instead, so FEValues and FESideValues need no inversion
+ * of matrices in reinit. The memory cost is 35 doubles per element.
+ *
+ * Elements are indexed by ElementAccessor::mesh_idx().
+ */
+class ElementGeometryCache {
+public:
+    /// Maximal number of entries of the Jacobian matrix.
+    static const unsigned int max_jac_size = 9;
+    /// Maximal number of sides of an element.
+    static const unsigned int max_sides = 4;
+
+    /// Compute the geometry of all elements of the @p mesh (in parallel if OpenMP is available).
+    ElementGeometryCache(const Mesh &mesh);
+
+    /// Jacobian of the mapping of the element.
+    template<unsigned int dim>
+    inline arma::mat::fixed<3,dim> jacobian(unsigned int elm_idx) const
+    { return arma::mat::fixed<3,dim>(&jacobians_[elm_idx*max_jac_size]); }
+
+    /// Inverse (pseudoinverse) Jacobian of the mapping of the element.
+    template<unsigned int dim>
+    inline arma::mat::fixed<dim,3> inverse_jacobian(unsigned int elm_idx) const
+    { return arma::mat::fixed<dim,3>(&inverse_jacobians_[elm_idx*max_jac_size]); }
+
+    /// Absolute value of the Jacobian determinant of the element.
+    inline double determinant(unsigned int elm_idx) const
+    { return determinants_[elm_idx]; }
+
+    /// Unit outer normal vector of the side @p sid of the element.
+    inline arma::vec3 normal_vector(unsigned int elm_idx, unsigned int sid) const
+    { return arma::vec3(&normals_[(elm_idx*max_sides + sid)*3]); }
+
+    /// Absolute value of the Jacobian determinant of the side @p sid of the element.
+    inline double side_determinant(unsigned int elm_idx, unsigned int sid) const
+    { return side_determinants_[elm_idx*max_sides + sid]; }
+
+    /// Number of elements in the cache.
+    inline unsigned int size() const
+    { return determinants_.size(); }
+
+private:
+    /// Compute data of one element of dimension @p dim.
+    template<unsigned int dim>
+    void compute_element(const ElementAccessor<3> &elm);
+
+    /// Jacobians stored by columns, max_jac_size entries per element.
+    std::vector<double> jacobians_;
+    /// Inverse Jacobians stored by columns, max_jac_size entries per element.
+    std::vector<double> inverse_jacobians_;
+    /// Jacobian determinants.
+    std::vector<double> determinants_;
+    /// Side normals, 3*max_sides entries per element.
+    std::vector<double> normals_;
+    /// Side Jacobian determinants, max_sides entries per element.
+    std::vector<double> side_determinants_;
+};
+
+
+#endif /* ELEMENT_GEOMETRY_CACHE_HH_ */
@@ -24,6 +24,7 @@
 #include <ostream>                             // for operator<<
 #include <string>                              // for operator<<
 #include <vector>                              // for vector
+#include <array>                               // for array
 #include <armadillo>
 #include "mesh/nodes.hh"                       // for Node
 #include "mesh/ref_element.hh"                 // for RefElement
@@ -90,7 +91,7 @@ public:
 
 protected:
     int pid_;                            ///< Id # of mesh partition
-    std::vector<unsigned int> edge_idx_; ///< Edges on sides
+    std::array<unsigned int, 4> edge_idx_; ///< Edges on sides (first n_sides() values are valid)
     mutable unsigned int n_neighs_vb_;   ///< # of neighbours, V-B type (comp.)
                                          // only ngh from this element to higher dimension edge
                                          // TODO fix and remove mutable directive
@@ -101,10 +102,11 @@ protected:
     * the same order as on the reference side (side 0 on the particular edge).
     *
     * Permutations are defined in RefElement::side_permutations.
+    * Stored in place (as well as @p edge_idx_ and @p nodes_), so the element needs no heap allocations.
     *
     * TODO fix and remove mutable directive
     */
-    mutable std::vector<unsigned int> permutation_idx_;
+    mutable std::array<unsigned int, 4> permutation_idx_;
 
     // Data readed from mesh file
     RegionIdx  region_idx_;
@@ -137,12 +139,12 @@ inline unsigned int Element::n_sides() const {
 }
 
 inline unsigned int Element::edge_idx(unsigned int edg_idx) const {
-	ASSERT(edg_idx<edge_idx_.size())(edg_idx)(edge_idx_.size()).error("Index of Edge is out of bound!");
+	ASSERT(edg_idx<n_sides())(edg_idx)(n_sides()).error("Index of Edge is out of bound!");
 	return edge_idx_[edg_idx];
 }
 
 inline unsigned int Element::permutation_idx(unsigned int prm_idx) const {
-	ASSERT(prm_idx<permutation_idx_.size())(prm_idx)(permutation_idx_.size()).error("Index of permutation is out of bound!");
+	ASSERT(prm_idx<n_sides())(prm_idx)(n_sides()).error("Index of permutation is out of bound!");
 	return permutation_idx_[prm_idx];
 }
 
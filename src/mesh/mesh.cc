@@ -46,10 +46,15 @@
 
 
 #include "mesh/bih_tree.hh"
+#include "mesh/element_geometry_cache.hh"
 #include "mesh/duplicate_nodes.h"
 
 #include "intersection/mixed_mesh_intersections.hh"
 
+#ifdef FLOW123D_HAVE_OPENMP
+#include <omp.h>
+#endif
+
 
 //TODO: sources, concentrations, initial condition  and similarly boundary conditions should be
 // instances of a Element valued field
@@ -88,10 +93,22 @@ const IT::Record & Mesh::get_input_type() {
 	    .declare_key("print_regions", IT::Bool(), IT::Default("true"), "If true, print table of all used regions.")
         .declare_key("intersection_search", Mesh::get_input_intersection_variant(), 
                      IT::Default("\"BIHsearch\""), "Search algorithm for element intersections.")
+        .declare_key("intersection_threads", IT::Integer(1), IT::Default("1"),
+                     "Number of threads used for computation of 1D-3D and 2D-3D intersections. "
+                     "The components of lower dimensional elements are distributed among the threads. "
+                     "Has no effect if Flow123d is compiled without OpenMP support.")
+        .declare_key("intersection_cache", IT::FileName::output(), IT::Default::optional(),
+                     "Binary file used as a cache of computed mesh intersections, placed in the output directory. If the file exists and was created "
+                     "for the same mesh (nodes and elements) and the same intersection settings, the intersections "
+                     "are read from it. Otherwise they are computed and the file is (re)written.")
         .declare_key("global_snap_radius", IT::Double(0.0), IT::Default("1E-3"),
                      "Maximal snapping distance from the mesh in various search operations. In particular, it is used "
                      "to find the closest mesh element of an observe point; and in FieldFormula to find closest surface "
                      "element in plan view (Z projection).")
+        .declare_key("geometry_cache", IT::Bool(), IT::Default("false"),
+                     "If true, Jacobians of the element mappings, their inverses, determinants and side normals are computed "
+                     "once for all elements and used in the assembly of equations instead of recomputing them "
+                     "for every element in every time step. Requires about 280 bytes per element.")
         .declare_key("raw_ngh_output", IT::FileName::output(), IT::Default::optional(),
                      "Output file with neighboring data from mesh.")
 		.close();
@@ -153,6 +170,16 @@ Mesh::IntersectionSearch Mesh::get_intersection_search()
     return in_record_.val<Mesh::IntersectionSearch>("intersection_search");
 }
 
+unsigned int Mesh::get_intersection_threads() const
+{
+    return in_record_.val<unsigned int>("intersection_threads");
+}
+
+bool Mesh::get_intersection_cache(FilePath &cache_file)
+{
+    return in_record_.opt_val("intersection_cache", cache_file);
+}
+
 
 void Mesh::reinit(Input::Record in_record)
 {
@@ -200,9 +227,6 @@ void Mesh::reinit(Input::Record in_record)
 
 
 Mesh::~Mesh() {
-    for(Edge &edg : this->edges)
-        if (edg.side_) delete[] edg.side_;
-
     for (unsigned int idx=0; idx < bulk_size_; idx++) {
     	Element *ele=&(element_vec_[idx]);
         if (ele->boundary_idx_) delete[] ele->boundary_idx_;
@@ -317,6 +341,9 @@ void Mesh::setup_topology() {
     
     this->distribute_nodes();
 
+    if (in_record_.val<bool>("geometry_cache"))
+        this->init_geometry_cache();
+
     output_internal_ngh_data();
 }
 
@@ -435,6 +462,20 @@ void Mesh::make_neighbours_and_edges()
 	//vector<Edge *> tmp_edges;
     edges.resize(0); // be sure that edges are empty
 
+    // Sides of all edges are stored in the single array edge_sides_. Every new edge gets a slice
+    // of the array, pointers Edge::side_ are valid until the array is reallocated by the next edge
+    // and they are set finally after all edges are created.
+    edge_sides_.clear();
+    unsigned int n_bulk_sides = 0;
+    for (auto e : this->elements_range()) n_bulk_sides += e->n_sides();
+    edge_sides_.reserve(n_bulk_sides);
+    std::vector<unsigned int> edge_sides_begin;
+    auto allocate_edge_sides = [this, &edge_sides_begin](unsigned int n_sides) -> SideIter * {
+        edge_sides_begin.push_back(edge_sides_.size());
+        edge_sides_.resize(edge_sides_.size() + n_sides);
+        return &( edge_sides_[edge_sides_begin.back()] );
+    };
+
 	vector<unsigned int> side_nodes;
 	vector<unsigned int> intersection_list; // list of elements in intersection of node element lists
 
@@ -459,7 +500,7 @@ void Mesh::make_neighbours_and_edges()
             edges.resize(last_edge_idx+1);
             edg = &( edges.back() );
             edg->n_sides = 0;
-            edg->side_ = new struct SideIter[ intersection_list.size() ];
+            edg->side_ = allocate_edge_sides( intersection_list.size() );
 
             // common boundary object
             unsigned int bdr_idx=boundary_.size();
@@ -527,7 +568,7 @@ void Mesh::make_neighbours_and_edges()
                 edges.resize(last_edge_idx+1);
                 edg = &( edges.back() );
                 edg->n_sides = 0;
-                edg->side_ = new struct SideIter[ intersection_list.size() ];
+                edg->side_ = allocate_edge_sides( intersection_list.size() );
                 if (intersection_list.size() > max_edge_sides_[e->dim()-1])
                 	max_edge_sides_[e->dim()-1] = intersection_list.size();
 
@@ -576,7 +617,7 @@ void Mesh::make_neighbours_and_edges()
                             edges.resize(last_edge_idx+1);
                             edg = &( edges.back() );
                             edg->n_sides = 1;
-                            edg->side_ = new struct SideIter[1];
+                            edg->side_ = allocate_edge_sides(1);
                             edg->side_[0] = si;
                             element_vec_[elem.idx()].edge_idx_[ecs] = last_edge_idx;
 
@@ -596,6 +637,9 @@ void Mesh::make_neighbours_and_edges()
 		} // for element sides
 	}   // for elements
 
+	ASSERT_EQ(edge_sides_begin.size(), edges.size());
+	for (unsigned int i=0; i<edges.size(); i++) edges[i].side_ = &( edge_sides_[edge_sides_begin[i]] );
+
 	MessageOut().fmt( "Created {} edges and {} neighbours.\n", edges.size(), vb_neighbours_.size() );
 }
 
@@ -929,6 +973,177 @@ std::vector<BoundingBox> Mesh::get_element_boxes() {
     return boxes;
 }
 
+namespace {
+
+/**
+ * Compute local coordinates of the projection of @p point to the element @p ele.
+ * Returns true if the point lies in the element.
+ */
+bool point_in_element(const ElementAccessor<3> &ele, const arma::vec3 &point, arma::vec3 &local)
+{
+    unsigned int dim = ele.dim();
+    arma::vec3 x0 = ele.node(0)->point();
+    arma::vec3 b = point - x0;
+    local.zeros();
+    if (dim == 0) return arma::norm(b, 2) <= BoundingBox::epsilon;
+
+    // columns of the element map, local coordinates solve the normal equations of A*local = b
+    arma::vec3 a[3];
+    double size = 0.0;
+    for (unsigned int i=0; i<dim; i++) {
+        a[i] = ele.node(i+1)->point() - x0;
+        size = std::max(size, arma::norm(a[i], 2));
+    }
+    switch (dim) {
+    case 1:
+        local[0] = arma::dot(a[0], b) / arma::dot(a[0], a[0]);
+        break;
+    case 2: {
+        double g00 = arma::dot(a[0], a[0]), g01 = arma::dot(a[0], a[1]), g11 = arma::dot(a[1], a[1]);
+        double r0 = arma::dot(a[0], b), r1 = arma::dot(a[1], b);
+        double det = g00*g11 - g01*g01;
+        local[0] = (r0*g11 - r1*g01) / det;
+        local[1] = (g00*r1 - g01*r0) / det;
+        break;
+    }
+    case 3: {
+        double det = arma::dot(a[0], arma::cross(a[1], a[2]));
+        local[0] = arma::dot(b, arma::cross(a[1], a[2])) / det;
+        local[1] = arma::dot(a[0], arma::cross(b, a[2])) / det;
+        local[2] = arma::dot(a[0], arma::cross(a[1], b)) / det;
+        break;
+    }
+    }
+
+    // barycentric coordinates must be non-negative
+    double sum = 0.0;
+    for (unsigned int i=0; i<dim; i++) {
+        if (local[i] < -BoundingBox::epsilon) return false;
+        sum += local[i];
+    }
+    if (sum > 1.0 + BoundingBox::epsilon) return false;
+
+    // distance of the point from the element
+    switch (dim) {
+    case 1:
+        b -= local[0] * a[0];
+        return arma::norm(b, 2) <= BoundingBox::epsilon * size;
+    case 2: {
+        // distance from the plane of the triangle is not spoiled by bad shape of the triangle
+        arma::vec3 normal = arma::cross(a[0], a[1]);
+        return std::fabs(arma::dot(b, normal)) <= BoundingBox::epsilon * size * arma::norm(normal, 2);
+    }
+    }
+    return true;
+}
+
+}
+
+
+Mesh::PointLocation Mesh::locate_point(const arma::vec3 &point, unsigned int dim, unsigned int hint,
+        BIHTree::SearchBuffer &buffer, std::vector<unsigned int> &candidates) const
+{
+    PointLocation location;
+    location.elem_idx = undef_idx;
+
+    // walk over the hint element and its neighbours
+    if (hint != undef_idx) {
+        ElementAccessor<3> hint_ele = this->element_accessor(hint);
+        if (hint_ele.dim() == dim && point_in_element(hint_ele, point, location.local_coords)) {
+            location.elem_idx = hint;
+        } else {
+            for (unsigned int n=0; n<hint_ele->n_nodes() && location.elem_idx == undef_idx; n++)
+                for (unsigned int i_ele : node_elements_[hint_ele.node_accessor(n).idx()]) {
+                    if (i_ele == hint) continue;
+                    ElementAccessor<3> ele = this->element_accessor(i_ele);
+                    if (ele.dim() == dim && point_in_element(ele, point, location.local_coords)) {
+                        location.elem_idx = i_ele;
+                        break;
+                    }
+                }
+        }
+    }
+
+    // candidates from the BIH tree
+    if (location.elem_idx == undef_idx) {
+        candidates.clear();
+        bih_tree_->find_point(point, candidates, buffer);
+        for (unsigned int i_ele : candidates) {
+            ElementAccessor<3> ele = this->element_accessor(i_ele);
+            if (ele.dim() == dim && point_in_element(ele, point, location.local_coords)) {
+                location.elem_idx = i_ele;
+                break;
+            }
+        }
+    }
+    if (location.elem_idx == undef_idx) {
+        location.local_coords.zeros();
+        return location;
+    }
+
+    // point on the boundary of the element, return the containing element with the lowest index,
+    // so the result does not depend on the hint; other containing elements share a node with the found one
+    double sum = 0.0, min_coord = 1.0;
+    for (unsigned int i=0; i<dim; i++) {
+        sum += location.local_coords[i];
+        min_coord = std::min(min_coord, location.local_coords[i]);
+    }
+    if (dim > 0 && std::min(min_coord, 1.0 - sum) <= BoundingBox::epsilon) {
+        ElementAccessor<3> found_ele = this->element_accessor(location.elem_idx);
+        arma::vec3 local;
+        for (unsigned int n=0; n<found_ele->n_nodes(); n++)
+            for (unsigned int i_ele : node_elements_[found_ele.node_accessor(n).idx()]) {
+                if (i_ele >= location.elem_idx) continue;
+                ElementAccessor<3> ele = this->element_accessor(i_ele);
+                if (ele.dim() == dim && point_in_element(ele, point, local)) {
+                    location.elem_idx = i_ele;
+                    location.local_coords = local;
+                }
+            }
+    }
+    return location;
+}
+
+
+void Mesh::find_points(const std::vector<arma::vec3> &points, std::vector<PointLocation> &locations, unsigned int dim)
+{
+    ASSERT_LE(dim, 3).error();
+    // threads calling the method at once must not create the structures at once
+#ifdef FLOW123D_HAVE_OPENMP
+    #pragma omp critical (mesh_find_points)
+#endif
+    {
+        this->get_bih_tree();
+        this->node_elements();
+    }
+
+    // small batches are not split, parts are contiguous to keep the coherence of points
+    static const unsigned int min_chunk_size = 256;
+    unsigned int n_points = points.size();
+    unsigned int n_chunks = 1;
+#ifdef FLOW123D_HAVE_OPENMP
+    if (! omp_in_parallel())
+        n_chunks = std::max(1u, std::min((unsigned int)omp_get_max_threads(), n_points / min_chunk_size));
+#endif
+
+    locations.resize(n_points);
+#ifdef FLOW123D_HAVE_OPENMP
+    #pragma omp parallel for schedule(static) num_threads(n_chunks)
+#endif
+    for (int i_chunk=0; i_chunk<(int)n_chunks; i_chunk++) {
+        BIHTree::SearchBuffer buffer;
+        std::vector<unsigned int> candidates;
+        unsigned int hint = undef_idx;
+        unsigned int begin = (std::size_t)n_points * i_chunk / n_chunks;
+        unsigned int end = (std::size_t)n_points * (i_chunk+1) / n_chunks;
+        for (unsigned int i=begin; i<end; i++) {
+            locations[i] = locate_point(points[i], dim, hint, buffer, candidates);
+            if (locations[i].elem_idx != undef_idx) hint = locations[i].elem_idx;
+        }
+    }
+}
+
+
 const BIHTree &Mesh::get_bih_tree() {
     if (! this->bih_tree_) {
         bih_tree_ = std::make_shared<BIHTree>();
@@ -938,6 +1153,11 @@ const BIHTree &Mesh::get_bih_tree() {
     return *bih_tree_;
 }
 
+void Mesh::init_geometry_cache() {
+    if (! this->geometry_cache_)
+        geometry_cache_ = std::make_shared<ElementGeometryCache>(*this);
+}
+
 double Mesh::global_snap_radius() const {
 	return in_record_.val<double>("global_snap_radius");
 }
@@ -956,7 +1176,7 @@ void Mesh::add_node(unsigned int node_id, arma::vec3 coords) {
 
 
 void Mesh::add_element(unsigned int elm_id, unsigned int dim, unsigned int region_id, unsigned int partition_id,
-		std::vector<unsigned int> node_ids) {
+		const std::vector<unsigned int> &node_ids) {
 	RegionIdx region_idx = region_db_.get_region( region_id, dim );
 	if ( !region_idx.is_valid() ) {
 		region_idx = region_db_.add_region( region_id, region_db_.create_label_from_id(region_id), dim, "$Element" );
@@ -978,7 +1198,7 @@ void Mesh::add_element(unsigned int elm_id, unsigned int dim, unsigned int regio
 
 
 void Mesh::init_element(Element *ele, unsigned int elm_id, unsigned int dim, RegionIdx region_idx, unsigned int partition_id,
-		std::vector<unsigned int> node_ids) {
+		const std::vector<unsigned int> &node_ids) {
 	ele->init(dim, region_idx);
 	ele->pid_ = partition_id;
 
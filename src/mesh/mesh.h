@@ -34,6 +34,7 @@
 #include "mesh/region.hh"                    // for RegionDB, RegionDB::MapE...
 #include "mesh/nodes.hh"
 #include "mesh/bounding_box.hh"              // for BoundingBox
+#include "mesh/bih_tree.hh"                  // for BIHTree::SearchBuffer
 #include "mesh/range_wrapper.hh"
 #include "tools/bidirectional_map.hh"
 #include "tools/general_iterator.hh"
@@ -41,7 +42,6 @@
 #include "system/file_path.hh"               // for FilePath
 #include "system/sys_vector.hh"              // for FullIterator, VectorId<>...
 
-class BIHTree;
 class Distribution;
 class Partitioning;
 class MixedMeshIntersections;
@@ -49,6 +49,7 @@ class Neighbour;
 class SideIter;
 class BCMesh;
 class DuplicateNodes;
+class ElementGeometryCache;
 template <int spacedim> class ElementAccessor;
 template <int spacedim> class NodeAccessor;
 
@@ -302,6 +303,14 @@ public:
     /// Getter for BIH. Creates and compute BIH at first call.
     const BIHTree &get_bih_tree();\
 
+    /// Create the cache of element geometry (Jacobians, normals etc.) used by MappingP1, if not created yet.
+    void init_geometry_cache();
+
+    /// Getter for the cache of element geometry, nullptr if the cache is not created.
+    inline const ElementGeometryCache *geometry_cache() const {
+        return geometry_cache_.get();
+    }
+
     /**
      * Find intersection of element lists given by Mesh::node_elements_ for elements givne by @p nodes_list parameter.
      * The result is placed into vector @p intersection_element_list. If the @p node_list is empty, and empty intersection is
@@ -309,12 +318,35 @@ public:
      */
     void intersect_element_lists(vector<unsigned int> const &nodes_list, vector<unsigned int> &intersection_element_list);
 
+    /// Element containing a point and local coordinates of the point, result of @p find_points.
+    struct PointLocation {
+        /// Index of the element, Mesh::undef_idx if no element contains the point.
+        unsigned int elem_idx;
+        /// Local coordinates of the point on the element, first dim() values are valid.
+        arma::vec3 local_coords;
+    };
+
+    /**
+     * Find elements of dimension @p dim containing given @p points, result for points[i] is stored in locations[i].
+     *
+     * Search of every point starts at the element found for the previous point and its neighbours (elements with
+     * a common node), the BIH tree is used only if the point is not there. So coherent sequences of points
+     * (e.g. quadrature points of neighbouring elements) are located mostly without the tree. If the point lies
+     * on a common face of more elements, the element with the lowest index is returned, so the result does not
+     * depend on the order of points and on the number of threads. Points of lower dimensional elements
+     * must lie in the element up to a relative tolerance BoundingBox::epsilon.
+     *
+     * Large batches are split into parts located by several threads. The method can be called concurrently
+     * from more threads, BIH tree and node_elements_ are created at the first call.
+     */
+    void find_points(const std::vector<arma::vec3> &points, std::vector<PointLocation> &locations, unsigned int dim = 3);
+
     /// Add new node of given id and coordinates to mesh
     void add_node(unsigned int node_id, arma::vec3 coords);
 
     /// Add new element of given id to mesh
     void add_element(unsigned int elm_id, unsigned int dim, unsigned int region_id, unsigned int partition_id,
-    		std::vector<unsigned int> node_ids);
+    		const std::vector<unsigned int> &node_ids);
 
     /// Add new node of given id and coordinates to mesh
     void add_physical_name(unsigned int dim, unsigned int id, std::string name);
@@ -327,6 +359,12 @@ public:
     /// Getter for input type selection for intersection search algorithm.
     IntersectionSearch get_intersection_search();
 
+    /// Getter for number of threads used by computation of intersections.
+    unsigned int get_intersection_threads() const;
+
+    /// Getter for the intersection cache file, returns false if the cache is not used.
+    bool get_intersection_cache(FilePath &cache_file);
+
     /// Maximal distance of observe point from Mesh relative to its size
     double global_snap_radius() const;
 
@@ -392,6 +430,14 @@ public:
 
 protected:
 
+    /**
+     * Find element of dimension @p dim containing @p point, used by @p find_points.
+     * Search starts at element @p hint (if not undef_idx), then the BIH tree is used with given @p buffer
+     * and @p candidates vector. BIH tree and node_elements_ must exist.
+     */
+    PointLocation locate_point(const arma::vec3 &point, unsigned int dim, unsigned int hint,
+            BIHTree::SearchBuffer &buffer, std::vector<unsigned int> &candidates) const;
+
     /**
      * Allow store boundary element data to temporary structure.
      *
@@ -464,7 +510,7 @@ protected:
 
     /// Initialize element
     void init_element(Element *ele, unsigned int elm_id, unsigned int dim, RegionIdx region_idx, unsigned int partition_id,
-    		std::vector<unsigned int> node_ids);
+    		const std::vector<unsigned int> &node_ids);
 
     unsigned int n_bb_neigh, n_vb_neigh;
 
@@ -489,6 +535,11 @@ protected:
      */
     std::shared_ptr<BIHTree> bih_tree_;
 
+    /**
+     * Precomputed geometry of elements, created by init_geometry_cache.
+     */
+    std::shared_ptr<ElementGeometryCache> geometry_cache_;
+
 
     /**
      * Accessor to the input record for the mesh.
@@ -527,6 +578,9 @@ protected:
     /// Maps node ids to indexes into vector node_vec_
     BidirectionalMap<int> node_ids_;
 
+    /// Sides of all edges, Edge::side_ points to a contiguous part of this array.
+    std::vector<SideIter> edge_sides_;
+
 
 
 
@@ -23,7 +23,8 @@ class SimpleTableFormatter (object):
 
         self.bodyRows = []
         self.maxBodySize = None
-        self.headerFields = ("tag", "call count (max)", "max T", "min/max T", "avg T", "total T", "source", "line")
+        self.headerFields = ("tag", "call count (max)", "max T", "min/max T", "avg T", "total T",
+                             "threads", "thread min/max T", "source", "line")
         self.styles = {
             "linesep": os.linesep, "padding": 0,
             "min_width": 9, "colsep": '',
@@ -136,6 +137,9 @@ class SimpleTableFormatter (object):
         self.append_to_header("Task size", linebreak=self.styles.linesep)
 
         self.append_to_header("Run process count")
+        # reports of older versions have no thread information
+        if 'run-thread-count' in json:
+            self.append_to_header("Run thread count")
         self.append_to_header("Run started", json["run-started-at"])
         self.append_to_header("Run ended", json["run-finished-at"])
 
@@ -169,6 +173,15 @@ class SimpleTableFormatter (object):
             else:
                 min_max_ratio = 0
 
+            # safe thread min max ratio
+            thread_count = json.get("thread-count-max", 1)
+            thread_time_max = json.get("cumul-time-thread-max", json["cumul-time-max"])
+            thread_time_min = json.get("cumul-time-thread-min", json["cumul-time-max"])
+            if thread_time_max > 0:
+                thread_min_max_ratio = thread_time_min / thread_time_max
+            else:
+                thread_min_max_ratio = 0
+
             self.append_to_body((
                 ("<", "{abs_prc:6.2f} {leading} {rel_prc:5.2f} {tag}".format(
                     abs_prc=abs_prc, leading=self.styles.leading_char * (level - 1), rel_prc=rel_prc, tag=json["tag"])),
@@ -177,6 +190,8 @@ class SimpleTableFormatter (object):
                 ("^", "{:1.4f}".format(min_max_ratio)),
                 ("^", "{:1.4f}".format(avg_cumul_time)),
                 ("^", "{:1.4f}".format(json["cumul-time-sum"])),
+                ("^", "{:d}".format(thread_count)),
+                ("^", "{:1.4f}".format(thread_min_max_ratio)),
                 ("<", "{path:s}, {function:s}()".format(function=json["function"], path=path)),
                 ("^", "{line:5d}".format(line=json["file-line"]))
             ))
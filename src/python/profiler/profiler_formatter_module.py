@@ -37,10 +37,11 @@ class ProfilerJSONDecoder(json.JSONDecoder):
         """Decodes json_string which is string that is given to json.loads method"""
         default_obj = super(ProfilerJSONDecoder, self).decode(json_string)
 
-        self.intFields = ["file-line", "call-count", "call-count-min", "call-count-max", "call-count-sum"]
+        self.intFields = ["file-line", "call-count", "call-count-min", "call-count-max", "call-count-sum",
+                          "thread-count-min", "thread-count-max", "thread-count-sum"]
         self.floatFields = ["cumul-time", "cumul-time-min", "cumul-time-max", "cumul-time-sum", "percent",
-                            "run-duration"]
-        self.intFieldsRoot = ["task-size", "run-process-count"]
+                            "run-duration", "cumul-time-thread-min", "cumul-time-thread-max", "cumul-time-thread-avg"]
+        self.intFieldsRoot = ["task-size", "run-process-count", "run-thread-count"]
         self.floatFieldsRoot = ["timer-resolution"]
         self.dateFields = ["run-started-at", "run-finished-at"]
 
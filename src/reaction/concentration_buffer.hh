@@ -0,0 +1,106 @@
+/*!
+ *
+﻿ * Copyright (C) 2015 Technical University of Liberec.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License version 3 as published by the
+ * Free Software Foundation. (http://www.gnu.org/licenses/gpl-3.0.en.html)
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *
+ * @file    concentration_buffer.hh
+ * @brief   Element-major copy of concentrations of all substances.
+ */
+
+#ifndef CONCENTRATION_BUFFER_HH_
+#define CONCENTRATION_BUFFER_HH_
+
+#include <algorithm>
+#include <vector>
+
+
+/**
+ * @brief Concentrations of all substances on local elements stored element by element.
+ *
+ * Transport keeps concentrations of every substance in a separate array (PETSc vector),
+ * i.e. concentration of substance @p sbi on local element @p loc_el is conc[sbi][loc_el].
+ * Reaction terms compute element by element, so they access values of all substances
+ * on an element at once. The buffer stores the same values element-major: the values
+ * of all substances on an element are contiguous and the reaction kernels read and write
+ * the memory linearly.
+ *
+ * The buffer is filled by @p gather before the reaction step and copied back by @p scatter after it.
+ * Both copies are done in blocks of elements, so that all substance arrays are also accessed linearly.
+ */
+class ConcentrationBuffer {
+public:
+    /// Number of elements copied at once by @p gather and @p scatter.
+    static const unsigned int block_size = 64;
+
+    ConcentrationBuffer(unsigned int n_substances, unsigned int n_elements)
+    : n_substances_(n_substances),
+      n_elements_(n_elements),
+      values_(n_substances * n_elements, 0.0)
+    {}
+
+    inline unsigned int n_substances() const
+    { return n_substances_; }
+
+    inline unsigned int n_elements() const
+    { return n_elements_; }
+
+    /// Values of all elements, concentration of substance @p sbi on element @p loc_el is at loc_el*n_substances + sbi.
+    inline double *data()
+    { return values_.data(); }
+
+    /// Values of all substances on local element @p loc_el.
+    inline double *element(unsigned int loc_el)
+    { return &(values_[loc_el * n_substances_]); }
+
+    inline const double *element(unsigned int loc_el) const
+    { return &(values_[loc_el * n_substances_]); }
+
+    /// Copy concentrations from the substance-major array @p conc[sbi][loc_el].
+    void gather(double **conc)
+    {
+        for (unsigned int begin=0; begin<n_elements_; begin+=block_size)
+        {
+            unsigned int end = std::min(begin+block_size, n_elements_);
+            for (unsigned int sbi=0; sbi<n_substances_; sbi++)
+            {
+                const double *subst_conc = conc[sbi];
+                double *val = &(values_[begin * n_substances_ + sbi]);
+                for (unsigned int loc_el=begin; loc_el<end; loc_el++, val+=n_substances_)
+                    *val = subst_conc[loc_el];
+            }
+        }
+    }
+
+    /// Copy concentrations back to the substance-major array @p conc[sbi][loc_el].
+    void scatter(double **conc) const
+    {
+        for (unsigned int begin=0; begin<n_elements_; begin+=block_size)
+        {
+            unsigned int end = std::min(begin+block_size, n_elements_);
+            for (unsigned int sbi=0; sbi<n_substances_; sbi++)
+            {
+                double *subst_conc = conc[sbi];
+                const double *val = &(values_[begin * n_substances_ + sbi]);
+                for (unsigned int loc_el=begin; loc_el<end; loc_el++, val+=n_substances_)
+                    subst_conc[loc_el] = *val;
+            }
+        }
+    }
+
+private:
+    unsigned int n_substances_;
+    unsigned int n_elements_;
+    /// Concentration of substance @p sbi on element @p loc_el is at position loc_el*n_substances_ + sbi.
+    std::vector<double> values_;
+};
+
+
+#endif /* CONCENTRATION_BUFFER_HH_ */
@@ -178,6 +178,7 @@ void DualPorosity::initialize()
     reaction_mobile->substances(substances_)
                 .output_stream(output_stream_)
                 .concentration_matrix(concentration_matrix_, distribution_, el_4_loc_, row_4_el_)
+                .concentration_buffer(conc_buffer_)
 				.set_dh(this->dof_handler_)
                 .set_time_governor(*time_);
     reaction_mobile->initialize();
@@ -322,7 +323,7 @@ double **DualPorosity::compute_reaction(double **concentrations, int loc_el)
     {
         exponent = diff_vec[sbi] * temp_exponent;
         //previous values
-        previous_conc_mob = concentration_matrix_[sbi][loc_el];
+        previous_conc_mob = conc(sbi, loc_el);
         previous_conc_immob = conc_immobile[sbi][loc_el];
         
         // ---compute average concentration------------------------------------------
@@ -354,7 +355,7 @@ double **DualPorosity::compute_reaction(double **concentrations, int loc_el)
             conc_immob = (previous_conc_immob - conc_average) * temp + conc_average;
         }
         
-        concentration_matrix_[sbi][loc_el] = conc_mob;
+        conc(sbi, loc_el) = conc_mob;
         conc_immobile[sbi][loc_el] = conc_immob;
     }
     
@@ -112,8 +112,11 @@ void FirstOrderReactionBase::update_solution(void)
 
     START_TIMER("linear reaction step");
 
-    for (unsigned int loc_el = 0; loc_el < distribution_->lsize(); loc_el++)
-        this->compute_reaction(concentration_matrix_, loc_el);
+    // apply the reaction matrix to blocks of elements at once
+    if (conc_buffer_)
+        linear_ode_solver_->update_solution_columns(conc_buffer_->data(), distribution_->lsize());
+    else
+        linear_ode_solver_->update_solution_rows(concentration_matrix_, 0, distribution_->lsize());
     
     END_TIMER("linear reaction step");
 }
@@ -60,7 +60,8 @@ public:
                 
     /// Updates the solution. 
     /**
-     * Goes through local distribution of elements and calls @p compute_reaction.
+     * Applies the reaction matrix to blocks of local elements at once, to the element-major
+     * concentration buffer if it is set, otherwise to the concentration matrix.
      */
     void update_solution(void) override;
     
@@ -37,7 +37,7 @@ Isotherm::Isotherm()
 void Isotherm::clear_table()
 {
     table_limit_ = 0.0;
-    interpolation_table.clear();
+    table_.reset();
 }
 
 
@@ -97,6 +97,72 @@ void Isotherm::interpolate( double &c_aqua, double &c_sorbed )
 }
 
 
+/// Polynomial of the interval of interpolation table, same as InterpolationTable::value.
+template<unsigned int n_coefs>
+inline double table_polynomial(const double *c, double t);
+
+template<>
+inline double table_polynomial<2>(const double *c, double t)
+{ return c[0] + t*c[1]; }
+
+template<>
+inline double table_polynomial<4>(const double *c, double t)
+{ return c[0] + t*(c[1] + t*(c[2] + t*c[3])); }
+
+
+template<unsigned int n_coefs>
+void Isotherm::interpolate_block( double *c_aqua, double *c_sorbed, unsigned int n )
+{
+    // same computation as in compute_projection, points out of the table use the first interval
+    // and keep their values
+    const double n_intervals = table_->n_intervals;
+    const double total_mass_step = table_->total_mass_step;
+    const double *coefs = table_->coefs.data();
+    in_table_.resize(n);
+    for (unsigned int i=0; i<n; i++) {
+        double total_mass = scale_aqua_* c_aqua[i] + scale_sorbed_ * c_sorbed[i];
+        double total_mass_steps = total_mass / total_mass_step;
+        bool in_table = (total_mass >= 0.0) && (total_mass_steps < n_intervals);
+        double steps = in_table ? total_mass_steps : 0.0;
+        unsigned int total_mass_idx = static_cast <unsigned int>(steps);
+        double rot_sorbed = table_polynomial<n_coefs>(coefs + total_mass_idx*n_coefs, steps - total_mass_idx);
+        double new_aqua = total_mass * inv_scale_aqua_ - rot_sorbed * inv_scale_sorbed_;
+        double new_sorbed = total_mass * inv_scale_sorbed_ + rot_sorbed * inv_scale_aqua_;
+        c_aqua[i] = in_table ? new_aqua : c_aqua[i];
+        c_sorbed[i] = in_table ? new_sorbed : c_sorbed[i];
+        in_table_[i] = in_table;
+    }
+}
+
+
+void Isotherm::compute_block( double *c_aqua, double *c_sorbed, unsigned int n )
+{
+    // if sorption is switched off, do not compute anything
+    if(adsorption_type_ == SorptionType::none)
+        return;
+
+    if (! is_precomputed()) {
+        for (unsigned int i=0; i<n; i++) {
+            ConcPair result = solve_conc( ConcPair(c_aqua[i], c_sorbed[i]) );
+            c_aqua[i] = result.fluid;
+            c_sorbed[i] = result.solid;
+        }
+        return;
+    }
+
+    if (table_->n_coefs == 2) interpolate_block<2>(c_aqua, c_sorbed, n);
+    else interpolate_block<4>(c_aqua, c_sorbed, n);
+
+    // negative mass, precipitation or mass over the table limit
+    for (unsigned int i=0; i<n; i++) {
+        if (in_table_[i]) continue;
+        ConcPair result = compute_projection( ConcPair(c_aqua[i], c_sorbed[i]) );
+        c_aqua[i] = result.fluid;
+        c_sorbed[i] = result.solid;
+    }
+}
+
+
 Isotherm::ConcPair Isotherm::compute_projection( Isotherm::ConcPair c_pair )
 {
     double total_mass = get_total_mass(c_pair);
@@ -105,14 +171,12 @@ Isotherm::ConcPair Isotherm::compute_projection( Isotherm::ConcPair c_pair )
         THROW( Isotherm::ExcNegativeTotalMass() 
                 << EI_TotalMass(total_mass)
                 );
-    // total_mass_step_ is set and checked in make_table
-    double total_mass_steps = total_mass / total_mass_step_;
+    // total_mass_step is set and checked in make_table
+    double total_mass_steps = total_mass / table_->total_mass_step;
     unsigned int total_mass_idx = static_cast <unsigned int>(std::floor(total_mass_steps));
 
-    if (total_mass_idx < (interpolation_table.size() - 1) ) {
-        double rot_sorbed = interpolation_table[total_mass_idx]
-                            + (total_mass_steps - total_mass_idx)*(interpolation_table[total_mass_idx+1]
-                            - interpolation_table[total_mass_idx]);
+    if (total_mass_idx < table_->n_intervals ) {
+        double rot_sorbed = table_->value(total_mass_idx, total_mass_steps - total_mass_idx);
         return ConcPair( (total_mass * inv_scale_aqua_ - rot_sorbed * inv_scale_sorbed_),
                          (total_mass * inv_scale_sorbed_ + rot_sorbed * inv_scale_aqua_) );
     } else {
@@ -214,7 +278,21 @@ Isotherm::ConcPair Isotherm::solve_conc( Isotherm::ConcPair conc )
 
 
 template<class Func>
-void Isotherm::make_table( const Func &isotherm, int n_steps )
+void Isotherm::table_knot( const Func &isotherm, double mass, double &value, double &derivative )
+{
+    ConcPair result = solve_conc( ConcPair( mass/scale_aqua_, 0.0 ), isotherm);
+    value = result.solid * scale_aqua_ - result.fluid * scale_sorbed_;
+
+    // differentiate scale_aqua * c_aqua + scale_sorbed * f(c_aqua / rho_aqua) = mass
+    double isotherm_derivative = const_cast<Func &>(isotherm).derivative(result.fluid / this->rho_aqua_) / this->rho_aqua_;
+    double d_aqua = 1.0 / (scale_aqua_ + scale_sorbed_ * isotherm_derivative);
+    double d_sorbed = (1.0 - scale_aqua_ * d_aqua) / scale_sorbed_;
+    derivative = d_sorbed * scale_aqua_ - d_aqua * scale_sorbed_;
+}
+
+
+template<class Func>
+void Isotherm::make_table( const Func &isotherm, int n_steps, double table_tolerance, InterpolationTable &table )
 {
     // limit aqueous concentration for the interpolation table; cannot be higher than solubility limit
     double aqua_limit = table_limit_;
@@ -228,68 +306,147 @@ void Isotherm::make_table( const Func &isotherm, int n_steps )
         THROW( Isotherm::ExcNegativeTotalMass()
                 << EI_TotalMass(mass_limit)
                 );
-    total_mass_step_ = mass_limit / n_steps;
-    double mass = 0.0;
-    interpolation_table.clear();
-    interpolation_table.reserve(n_steps);
-    for(int i=0; i<= n_steps; i++) {
-         // aqueous concentration (original coordinates c_a) corresponding to i-th total_mass_step_
-        ConcPair c_pair( mass/scale_aqua_, 0.0 );
-
-        ConcPair result = solve_conc( c_pair, isotherm);
-        double c_sorbed_rot = ( result.solid * scale_aqua_ - result.fluid * scale_sorbed_);
-        interpolation_table.push_back(c_sorbed_rot);
-        mass = mass+total_mass_step_;
+
+    if (table_tolerance <= 0.0) {
+        // piecewise linear table with n_steps equidistant intervals
+        table.total_mass_step = mass_limit / n_steps;
+        std::vector<double> values;
+        values.reserve(n_steps+1);
+        double mass = 0.0;
+        for(int i=0; i<= n_steps; i++) {
+             // aqueous concentration (original coordinates c_a) corresponding to i-th total_mass_step
+            ConcPair c_pair( mass/scale_aqua_, 0.0 );
+
+            ConcPair result = solve_conc( c_pair, isotherm);
+            double c_sorbed_rot = ( result.solid * scale_aqua_ - result.fluid * scale_sorbed_);
+            values.push_back(c_sorbed_rot);
+            mass = mass+table.total_mass_step;
+        }
+        table.n_intervals = n_steps;
+        table.n_coefs = 2;
+        table.coefs.resize(2*n_steps);
+        for(int i=0; i< n_steps; i++) {
+            table.coefs[2*i] = values[i];
+            table.coefs[2*i+1] = values[i+1] - values[i];
+        }
+        return;
+    }
+
+    // piecewise cubic Hermite table, intervals are halved until the error in their midpoints is small enough;
+    // values in the midpoints become knots of the refined table
+    std::vector<double> values(2), derivatives(2), mid_values, mid_derivatives;
+    table_knot(isotherm, 0.0, values[0], derivatives[0]);
+    table_knot(isotherm, mass_limit, values[1], derivatives[1]);
+    unsigned int n_intervals = 1;
+    table.n_coefs = 4;
+    while (true) {
+        double step = mass_limit / n_intervals;
+        table.total_mass_step = step;
+        table.n_intervals = n_intervals;
+        table.coefs.resize(4*n_intervals);
+        for(unsigned int i=0; i< n_intervals; i++) {
+            double *c = &(table.coefs[4*i]);
+            double d0 = step * derivatives[i], d1 = step * derivatives[i+1];
+            c[0] = values[i];
+            c[1] = d0;
+            c[2] = 3*(values[i+1] - values[i]) - 2*d0 - d1;
+            c[3] = 2*(values[i] - values[i+1]) + d0 + d1;
+        }
+        if (2*n_intervals > (unsigned int)n_steps) break;
+
+        mid_values.resize(n_intervals);
+        mid_derivatives.resize(n_intervals);
+        double max_error = 0.0;
+        for(unsigned int i=0; i< n_intervals; i++) {
+            table_knot(isotherm, (i+0.5)*step, mid_values[i], mid_derivatives[i]);
+            max_error = std::max(max_error, std::fabs(table.value(i, 0.5) - mid_values[i]));
+        }
+        if (max_error <= table_tolerance * mass_limit) break;
+
+        std::vector<double> new_values(2*n_intervals+1), new_derivatives(2*n_intervals+1);
+        for(unsigned int i=0; i< n_intervals; i++) {
+            new_values[2*i] = values[i];
+            new_values[2*i+1] = mid_values[i];
+            new_derivatives[2*i] = derivatives[i];
+            new_derivatives[2*i+1] = mid_derivatives[i];
+        }
+        new_values[2*n_intervals] = values[n_intervals];
+        new_derivatives[2*n_intervals] = derivatives[n_intervals];
+        values.swap(new_values);
+        derivatives.swap(new_derivatives);
+        n_intervals *= 2;
     }
 }
 
 // Isotherm None specialization
-template<> void Isotherm::make_table( const None &isotherm, int n_steps )
+template<> void Isotherm::make_table( const None &isotherm, int n_steps, double table_tolerance, InterpolationTable &table )
 {
     // Solve_conc returns the same, so we need to do that also in compute_projection.
-    // We set size of the table to 1, so it follow the conditions into solve_conc again.
-    
-    limited_solubility_on_ = false; // so it cannot go in precipitate function
+    // The table has no interval, so it follow the conditions into solve_conc again.
     
-    total_mass_step_ = 1;            // set just one step in the table, so we void zero division
-    interpolation_table.resize(1,0); // set one value in the table so the condition in compute_projection fails
+    table.total_mass_step = 1;       // set just one step in the table, so we void zero division
+    table.n_intervals = 0;           // the condition in compute_projection fails
+    table.n_coefs = 2;
+    table.coefs.resize(2, 0.0);      // coefficients read by compute_block for points out of table
     return;
 }
 
-void Isotherm::make_table( unsigned int n_points, double table_limit )
+void Isotherm::make_table( unsigned int n_points, double table_limit, double table_tolerance,
+                           std::vector<TablePtr> *table_cache )
 {
     START_TIMER("Isotherm::make_table");
     table_limit_ = table_limit;
-    if(table_limit_ > 0.0) 
-        switch(adsorption_type_)
+    if(table_limit_ <= 0.0) {
+        clear_table();
+        return;
+    }
+
+    if(adsorption_type_ == SorptionType::none)
+        limited_solubility_on_ = false; // so it cannot go in precipitate function
+
+    // the table depends only on these parameters
+    std::vector<double> parameters = { double(adsorption_type_), double(limited_solubility_on_), rho_aqua_,
+            scale_aqua_, scale_sorbed_, solubility_limit_, mult_coef_, second_coef_,
+            table_limit_, double(n_points), table_tolerance };
+    if (table_cache != nullptr)
+        for (const TablePtr &cached : *table_cache)
+            if (cached->parameters == parameters) {
+                table_ = cached;
+                return;
+            }
+
+    std::shared_ptr<InterpolationTable> table = std::make_shared<InterpolationTable>();
+    table->parameters = parameters;
+    switch(adsorption_type_)
     {
         case 0: // none
             {
                     None obj_isotherm;
-                    make_table(obj_isotherm, 1);
+                    make_table(obj_isotherm, 1, table_tolerance, *table);
             }
             break;
         case 1: //  linear:
             {
                 Linear obj_isotherm(mult_coef_);
-                make_table(obj_isotherm, n_points);
+                make_table(obj_isotherm, n_points, table_tolerance, *table);
             }
             break;
         case 2: // freundlich:
             {
                 Freundlich obj_isotherm(mult_coef_, second_coef_);
-                make_table(obj_isotherm, n_points);
+                make_table(obj_isotherm, n_points, table_tolerance, *table);
             }
             break;
         case 3: // langmuir:
             {
                 Langmuir obj_isotherm(mult_coef_, second_coef_);
-                make_table(obj_isotherm, n_points);
+                make_table(obj_isotherm, n_points, table_tolerance, *table);
             }
             break;
         default:
-            break;
+            return;
     }
-    else
-        clear_table();
+    table_ = table;
+    if (table_cache != nullptr)
+        table_cache->push_back(table_);
 }
@@ -54,6 +54,7 @@
 #include <complex>                                            // for fabs
 #include <ostream>                                            // for operator<<
 #include <string>                                             // for string
+#include <memory>                                             // for shared_ptr
 #include "input/input_exception.hh"                           // for EI_Address
 #include "system/exceptions.hh"                               // for operator<<
 #include <boost/math/special_functions/detail/round_fwd.hpp>  // for BOOST_M...
@@ -93,6 +94,10 @@ public:
     inline double operator()(double x) {
         return (0.0);
     }
+    /// Derivative of the isotherm.
+    inline double derivative(double x) {
+        return (0.0);
+    }
 };
 
 /**
@@ -106,6 +111,10 @@ public:
     inline double operator()(double x) {
     	return (mult_coef_*x);
     }
+    /// Derivative of the isotherm.
+    inline double derivative(double x) {
+    	return (mult_coef_);
+    }
 private:
     /// Parameters of the isotherm.
     double mult_coef_;
@@ -124,6 +133,10 @@ public:
     inline double operator()( double x) {
     	return (mult_coef_*(alpha_ * x)/(alpha_ *x + 1));
     }
+    /// Derivative of the isotherm.
+    inline double derivative( double x) {
+    	return (mult_coef_*alpha_/((alpha_ *x + 1)*(alpha_ *x + 1)));
+    }
 
 private:
     /// Parameters of the isotherm.
@@ -144,6 +157,11 @@ public:
 	inline double operator()(double x) {
 		return (mult_coef_*pow(x, exponent_));
 	}
+    /// Derivative of the isotherm, infinite at zero for exponent less then one.
+	inline double derivative(double x) {
+		if (mult_coef_ == 0.0 || exponent_ == 0.0) return 0.0;
+		return (mult_coef_*exponent_*pow(x, exponent_ - 1));
+	}
 
 private:
     /// Parameters of the isotherm.
@@ -185,6 +203,32 @@ public:
 		double solid;
 	};
 
+	/**
+	 * Interpolation table of isotherm in the rotated coordinates.
+	 * The X axes of rotated system is total mass, the Y axes is perpendicular.
+	 * The table is immutable after creation and can be shared by isotherms with same parameters.
+	 */
+	struct InterpolationTable {
+		/// Value of Y in the local coordinate @p t in [0,1] of the interval @p idx.
+		inline double value(unsigned int idx, double t) const {
+			const double *c = &(coefs[idx*n_coefs]);
+			if (n_coefs == 2) return c[0] + t*c[1];
+			return c[0] + t*(c[1] + t*(c[2] + t*c[3]));
+		}
+
+		/// Parameters of the isotherm and of the table, tables with same parameters are equal.
+		std::vector<double> parameters;
+		/// Step on the rotated X axes (total mass).
+		double total_mass_step;
+		/// Number of intervals of the table.
+		unsigned int n_intervals;
+		/// Number of polynomial coefficients per interval, 2 for linear and 4 for cubic interpolation.
+		unsigned int n_coefs;
+		/// Coefficients of polynomials in the local coordinate t of intervals: Y = c_0 + t*(c_1 + t*(c_2 + t*c_3)).
+		std::vector<double> coefs;
+	};
+	typedef std::shared_ptr<const InterpolationTable> TablePtr;
+
     /// Default constructor.
     Isotherm();
 
@@ -207,12 +251,19 @@ public:
 
     /**
      * Create interpolation table for isotherm in rotated coordinate system with X axes given by total mass in
-     * both phases. Currently we support only linear interpolation.
+     * both phases.
      * @p reinit has to be called just before this method.
      * @param n_points is the size of the table
      * @param table_limit is the limit value of aqueous concentration
+     * @param table_tolerance zero for piecewise linear table with @p n_points intervals; if positive,
+     *        the table is piecewise cubic (Hermite) and the number of its intervals is the smallest power of two
+     *        (but at most @p n_points) with interpolation error in the middle of intervals below
+     *        @p table_tolerance times the total mass limit of the table
+     * @param table_cache if given, a table with same parameters is reused from the cache and a new table
+     *        is added to the cache
      */
-    void make_table(unsigned int n_points, double table_limit);
+    void make_table(unsigned int n_points, double table_limit, double table_tolerance = 0.0,
+                    std::vector<TablePtr> *table_cache = nullptr);
 
     /**
      * Clears the interpolation table and resets the table limit.
@@ -233,13 +284,24 @@ public:
      */
     void interpolate(double &c_aqua, double &c_sorbed);
 
+    /**
+     * Same as @p interpolate for @p n pairs of concentrations (or @p compute if the table is not created).
+     * Points within the table are interpolated by a branch-free loop that can be vectorized by the compiler,
+     * the remaining points are then computed one by one in the same way as in @p interpolate.
+     */
+    void compute_block(double *c_aqua, double *c_sorbed, unsigned int n);
+
     /**
      * Returns true if interpolation table is created.
      */
     inline bool is_precomputed(void) {
-        return interpolation_table.size() != 0;
+        return bool(table_);
     }
 
+    /// Getter for the interpolation table (null if not created).
+    inline TablePtr table() const
+    { return table_; }
+
     /// Getter for table limit (limit aqueous concentration).
     inline double table_limit(void) const
     { return table_limit_;}
@@ -250,7 +312,18 @@ protected:
      * Specialized for sorption 'none' - creates empty table.
      */
     template<class Func>
-    void make_table(const Func &isotherm, int n_points);
+    void make_table(const Func &isotherm, int n_points, double table_tolerance, InterpolationTable &table);
+    /**
+     * Compute value @p value of Y and its derivative @p derivative by total mass in the point
+     * of the isotherm with total mass @p mass (knot of the cubic table).
+     */
+    template<class Func>
+    void table_knot(const Func &isotherm, double mass, double &value, double &derivative);
+    /**
+     * Interpolation of points within the table in @p compute_block, @p n_coefs is given by the table.
+     */
+    template<unsigned int n_coefs>
+    void interpolate_block(double *c_aqua, double *c_sorbed, unsigned int n);
     /**
      * Find new values for concentrations in @p c_pair that has same total mass and lies on the
      * @p isotherm (functor object).
@@ -302,15 +375,11 @@ protected:
     double scale_sorbed_;
     /// reciprocal values
     double inv_scale_aqua_, inv_scale_sorbed_;
-    /**
-     * Interpolation table of isotherm in the rotated coordinates.
-     * The X axes of rotated system is total mass, the Y axes is perpendicular.
-     */
-    std::vector<double> interpolation_table;
-    /**
-     * Step on the rotated X axes (total mass).
-     */
-    double total_mass_step_;
+    /// Interpolation table, possibly shared with other isotherms.
+    TablePtr table_;
+
+    /// Flags of points interpolated by the table in @p compute_block.
+    std::vector<char> in_table_;
 
 };
 
@@ -17,11 +17,14 @@
 
 #include "reaction/linear_ode_solver.hh"
 
+#include <algorithm>
 #include "armadillo"
 #include "input/accessors.hh"
 
 using namespace Input::Type;
 
+const unsigned int LinearODESolver::block_size;
+
     
 LinearODESolver::LinearODESolver()
 : step_(0), step_changed_(true),
@@ -45,7 +48,7 @@ void LinearODESolver::set_step(double step)
     step_changed_ = true;
 }
 
-void LinearODESolver::update_solution(arma::vec& init_vector, arma::vec& output_vec)
+void LinearODESolver::update_solution_matrix()
 {
     if(step_changed_ || system_matrix_changed_)
     {
@@ -53,8 +56,55 @@ void LinearODESolver::update_solution(arma::vec& init_vector, arma::vec& output_
         step_changed_ = false;
         system_matrix_changed_ = false;
     }
-    
+}
+
+void LinearODESolver::update_solution(arma::vec& init_vector, arma::vec& output_vec)
+{
+    update_solution_matrix();
     output_vec = solution_matrix_ * init_vector;
 }
 
+void LinearODESolver::update_solution_columns(double *vectors, unsigned int n_vectors)
+{
+    update_solution_matrix();
+    unsigned int n = solution_matrix_.n_rows;
+
+    for (unsigned int begin = 0; begin < n_vectors; begin += block_size)
+    {
+        unsigned int n_block = std::min(block_size, n_vectors - begin);
+        // use memory of the vectors directly
+        arma::mat block(vectors + begin*n, n, n_block, false, true);
+        work_ = solution_matrix_ * block;
+        std::copy(work_.memptr(), work_.memptr() + n*n_block, block.memptr());
+    }
+}
+
+void LinearODESolver::update_solution_rows(double **rows, unsigned int begin, unsigned int end)
+{
+    update_solution_matrix();
+    unsigned int n = solution_matrix_.n_rows;
+
+    for (unsigned int block_begin = begin; block_begin < end; block_begin += block_size)
+    {
+        unsigned int n_block = std::min(block_size, end - block_begin);
+        // i-th column of work_ contains i-th component of the vectors in the block
+        work_.set_size(n_block, n);
+        for (unsigned int i = 0; i < n; i++)
+        {
+            double *out = work_.colptr(i);
+            std::fill(out, out + n_block, 0.0);
+            for (unsigned int j = 0; j < n; j++)
+            {
+                double coef = solution_matrix_(i,j);
+                if (coef == 0.0) continue;   // e.g. decay chains have triangular matrix
+                const double *in = rows[j] + block_begin;
+                for (unsigned int k = 0; k < n_block; k++)
+                    out[k] += coef * in[k];
+            }
+        }
+        for (unsigned int i = 0; i < n; i++)
+            std::copy(work_.colptr(i), work_.colptr(i) + n_block, rows[i] + block_begin);
+    }
+}
+
 
@@ -51,17 +51,37 @@ public:
      * @param output_vec is the column output vector containing the result
      */
     void update_solution(arma::vec &init_vec, arma::vec &output_vec);
+
+    /// Maximal number of vectors updated at once by the block methods.
+    static const unsigned int block_size = 256;
+
+    /**
+     * Updates solutions of @p n_vectors systems in place. The vectors are stored one after another
+     * in @p vectors, i.e. they are columns of a column-major matrix (element-major concentrations).
+     * Blocks of vectors are multiplied by the solution matrix at once, without allocation per vector.
+     */
+    void update_solution_columns(double *vectors, unsigned int n_vectors);
+
+    /**
+     * Updates solutions of systems with indices from @p begin to @p end in place. The i-th component
+     * of the k-th vector is rows[i][k] (substance-major concentration matrix).
+     */
+    void update_solution_rows(double **rows, unsigned int begin, unsigned int end);
     
     /// Estimate upper bound for time step. Return true if constraint was set.
      virtual bool evaluate_time_constraint(double &time_constraint) { return false; }
                                  
 protected:
+    /// Computes the solution matrix if the system matrix or the step has been changed.
+    void update_solution_matrix();
+
     arma::mat system_matrix_;     ///< the square matrix of ODE system
     arma::mat solution_matrix_;   ///< the square solution matrix (exponential of system matrix)
     arma::vec rhs_;               ///< the column vector of RHS values (not used currently)
     double step_;           ///< the step of the numerical method
     bool step_changed_;     ///< flag is true if the step has been changed
     bool system_matrix_changed_; ///< Indicates that the system_matrix_ was recently updated.
+    arma::mat work_;        ///< Results for a block of vectors in the block methods.
 };
 
 
@@ -28,6 +28,7 @@
 #include "input/input_exception.hh"  // for DECLARE_INPUT_EXCEPTION, Exception
 #include "system/exceptions.hh"      // for ExcStream, operator<<, EI, TYPED...
 #include "transport/substance.hh"    // for SubstanceList
+#include "reaction/concentration_buffer.hh"  // for ConcentrationBuffer
 #include "fem/dofhandler.hh"         // for DOFHandlerMultiDim
 
 class Distribution;
@@ -93,6 +94,17 @@ public:
     row_4_el_ = row_4_el;
     return *this;
   }
+
+  /**
+   * Sets element-major copy of the concentration matrix. If set, the reaction term
+   * reads and writes concentrations in the buffer instead of the concentration matrix
+   * during @p update_solution. Caller fills the buffer before the update and copies it back after it.
+   */
+  ReactionTerm &concentration_buffer(std::shared_ptr<ConcentrationBuffer> buffer)
+  {
+    conc_buffer_ = buffer;
+    return *this;
+  }
   //@}
 
   /** @brief Output method.
@@ -121,10 +133,19 @@ protected:
    */
   virtual double **compute_reaction(double **concentrations, int loc_el) =0;
 
+  /// Concentration of substance @p sbi on local element @p loc_el, in the buffer (if set) or in the concentration matrix.
+  inline double &conc(unsigned int sbi, unsigned int loc_el)
+  {
+    return conc_buffer_ ? conc_buffer_->element(loc_el)[sbi] : concentration_matrix_[sbi][loc_el];
+  }
+
   /**
    * Pointer to two-dimensional array[species][elements] containing concentrations.
    */
   double **concentration_matrix_;
+
+  /// Element-major copy of the concentration matrix, used during update_solution if set.
+  std::shared_ptr<ConcentrationBuffer> conc_buffer_;
   
   /// Indices of elements belonging to local dofs.
   LongIdx *el_4_loc_;
@@ -61,6 +61,12 @@ const Record & SorptionBase::get_input_type() {
 					"Density of the solvent.")
 		.declare_key("substeps", Integer(1), Default("1000"),
 					"Number of equidistant substeps, molar mass and isotherm intersections")
+		.declare_key("table_tolerance", Double(0.0), Default("0.0"),
+					"Relative tolerance of the isotherm interpolation tables. "
+					"Use '0' for piecewise linear tables with 'substeps' intervals. "
+					"Use a positive value for piecewise cubic tables, the number of intervals is then chosen "
+					"(at most 'substeps') so that the interpolation error is below the tolerance times the table range of total mass. "
+					"Regions with same isotherm parameters share the table.")
 		.declare_key("solubility", Array(Double(0.0)), Default::optional(), //("-1.0"), //
 								"Specifies solubility limits of all the sorbing species.")
 		.declare_key("table_limits", Array(Double(-1.0)), Default::optional(), //("-1.0"), //
@@ -185,6 +191,9 @@ void SorptionBase::initialize()
   unsigned int nr_of_regions = mesh_->region_db().bulk_size();
   isotherms.resize(nr_of_regions);
   max_conc.resize(nr_of_regions);
+  region_elements_.resize(nr_of_regions);
+  for (unsigned int loc_el = 0; loc_el < distribution_->lsize(); loc_el++)
+    region_elements_[ mesh_->element_accessor( el_4_loc_[loc_el] ).region().bulk_idx() ].push_back(loc_el);
   for(unsigned int i_reg = 0; i_reg < nr_of_regions; i_reg++)
   {
     isotherms[i_reg].resize(n_substances_);
@@ -213,6 +222,7 @@ void SorptionBase::initialize()
   {
     reaction_liquid->substances(substances_)
       .concentration_matrix(concentration_matrix_, distribution_, el_4_loc_, row_4_el_)
+      .concentration_buffer(conc_buffer_)
 	  .set_dh(this->dof_handler_)
       .set_time_governor(*time_);
     reaction_liquid->initialize();
@@ -278,6 +288,7 @@ void SorptionBase::initialize_from_input()
 {
     // read number of interpolation steps - value checked by the record definition
     n_interpolation_steps_ = input_record_.val<int>("substeps");
+    table_tolerance_ = input_record_.val<double>("table_tolerance");
     
     // read the density of solvent - value checked by the record definition
 	solvent_density_ = input_record_.val<double>("solvent_density");
@@ -415,9 +426,14 @@ void SorptionBase::update_solution(void)
   clear_max_conc();
 
   START_TIMER("Sorption");
-  for (unsigned int loc_el = 0; loc_el < distribution_->lsize(); loc_el++)
+  for(const Region &reg_iter: this->mesh_->region_db().get_region_set("BULK"))
   {
-    compute_reaction(concentration_matrix_, loc_el);
+    unsigned int reg_idx = reg_iter.bulk_idx();
+    if (data_->is_constant(reg_iter))
+      compute_region(reg_idx);
+    else
+      for (unsigned int loc_el : region_elements_[reg_idx])
+        compute_reaction(concentration_matrix_, loc_el);
   }
   END_TIMER("Sorption");
   
@@ -493,6 +509,8 @@ void SorptionBase::update_max_conc()
 void SorptionBase::make_tables(void)
 {
     START_TIMER("SorptionBase::make_tables");
+    // tables created in this call, regions with same parameters share them
+    std::vector<Isotherm::TablePtr> table_cache;
     try
     {
         ElementAccessor<3> elm;
@@ -542,7 +560,8 @@ void SorptionBase::make_tables(void)
                 }
                 
                 if(call_make_table){
-                    isotherms[reg_idx][i_subst].make_table(n_interpolation_steps_, subst_table_limit);
+                    isotherms[reg_idx][i_subst].make_table(n_interpolation_steps_, subst_table_limit,
+                                                            table_tolerance_, &table_cache);
 //                     DebugOut().fmt("reg: {} i_subst {}: table_limit = {}\n", reg_idx, i_subst, isotherms[reg_idx][i_subst].table_limit());
                 }
             }
@@ -555,6 +574,60 @@ void SorptionBase::make_tables(void)
     }
 }
 
+void SorptionBase::compute_region(unsigned int reg_idx)
+{
+    const std::vector<unsigned int> &elements = region_elements_[reg_idx];
+    if (elements.size() == 0) return;
+
+    // data are constant on the region, so any element can be used for reinit
+    ElementAccessor<3> elem = mesh_->element_accessor( el_4_loc_[elements[0]] );
+    bool is_common_ele_data_valid = false;
+    const unsigned int block_size = 256;
+    block_aqua_.resize(block_size);
+    block_sorbed_.resize(block_size);
+
+    try{
+        for(unsigned int i_subst = 0; i_subst < n_substances_; i_subst++)
+        {
+            unsigned int subst_id = substance_global_idx_[i_subst];
+            Isotherm & isotherm = isotherms[reg_idx][i_subst];
+            if (! isotherm.is_precomputed()){
+                if(! is_common_ele_data_valid){
+                    compute_common_ele_data(elem);
+                    is_common_ele_data_valid = true;
+                }
+                isotherm_reinit(i_subst, elem);
+            }
+
+            for (unsigned int begin = 0; begin < elements.size(); begin += block_size)
+            {
+                unsigned int n = std::min(block_size, (unsigned int)(elements.size() - begin));
+                for (unsigned int i = 0; i < n; i++)
+                {
+                    block_aqua_[i] = conc(subst_id, elements[begin+i]);
+                    block_sorbed_[i] = conc_solid[subst_id][elements[begin+i]];
+                }
+                isotherm.compute_block(block_aqua_.data(), block_sorbed_.data(), n);
+                for (unsigned int i = 0; i < n; i++)
+                {
+                    conc(subst_id, elements[begin+i]) = block_aqua_[i];
+                    conc_solid[subst_id][elements[begin+i]] = block_sorbed_[i];
+                }
+
+                // update maximal concentration per region (optimization for interpolation)
+                if(table_limit_[i_subst] < 0)
+                    for (unsigned int i = 0; i < n; i++)
+                        max_conc[reg_idx][i_subst] = std::max(max_conc[reg_idx][i_subst], block_aqua_[i]);
+            }
+        }
+    }
+    catch(ExceptionBase const &e)
+    {
+        e << input_record_.ei_address();
+        throw;
+    }
+}
+
 double **SorptionBase::compute_reaction(double **concentrations, int loc_el)
 {
     ElementAccessor<3> elem = mesh_->element_accessor( el_4_loc_[loc_el] );
@@ -570,7 +643,7 @@ double **SorptionBase::compute_reaction(double **concentrations, int loc_el)
             Isotherm & isotherm = isotherms[reg_idx][i_subst];
             if (isotherm.is_precomputed()){
 //                 DebugOut().fmt("isotherms precomputed - interpolate, subst[{}]\n", i_subst);
-                isotherm.interpolate(concentration_matrix_[subst_id][loc_el],
+                isotherm.interpolate(conc(subst_id, loc_el),
                                      conc_solid[subst_id][loc_el]);
             }
             else{
@@ -581,14 +654,14 @@ double **SorptionBase::compute_reaction(double **concentrations, int loc_el)
                 }
                 
                 isotherm_reinit(i_subst, elem);
-                isotherm.compute(concentration_matrix_[subst_id][loc_el],
+                isotherm.compute(conc(subst_id, loc_el),
                                  conc_solid[subst_id][loc_el]);
             }
             
             // update maximal concentration per region (optimization for interpolation)
             if(table_limit_[i_subst] < 0)
                 max_conc[reg_idx][i_subst] = std::max(max_conc[reg_idx][i_subst],
-                                                      concentration_matrix_[subst_id][loc_el]);
+                                                      conc(subst_id, loc_el));
         }
     }
     catch(ExceptionBase const &e)
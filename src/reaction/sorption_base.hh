@@ -166,6 +166,12 @@ protected:
    * For simulation of sorption in just one element either inside of MOBILE or IMMOBILE pores.
    */
   double **compute_reaction(double **concentrations, int loc_el) override;
+
+  /**
+   * Computes sorption on all local elements of region with constant data in blocks of elements.
+   * Isotherms are reinitialized once for the region (if they have no interpolation table).
+   */
+  void compute_region(unsigned int reg_idx);
   
   /// Reinitializes the isotherm.
   /**
@@ -196,6 +202,10 @@ protected:
    * Temporary nr_of_points can be computed using step_length. Should be |nr_of_region x nr_of_substances| matrix later.
    */
   unsigned int n_interpolation_steps_;
+  /**
+   * Relative tolerance of cubic interpolation tables, zero for linear tables with @p n_interpolation_steps_ intervals.
+   */
+  double table_tolerance_;
   /**
    * Density of the solvent. 
    *  TODO: Could be done region dependent, easily.
@@ -221,6 +231,12 @@ protected:
    * lenght in cocidered system of coordinates, just function values are stored.
    */
   std::vector<std::vector<Isotherm> > isotherms;
+
+  /// Local indices of elements in every bulk region.
+  std::vector<std::vector<unsigned int> > region_elements_;
+
+  /// Liquid and solid concentrations of a block of elements in @p compute_region.
+  std::vector<double> block_aqua_, block_sorbed_;
   
   unsigned int n_substances_;   //< number of substances that take part in the sorption mode
   
@@ -0,0 +1,233 @@
+/*!
+ *
+﻿ * Copyright (C) 2015 Technical University of Liberec.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License version 3 as published by the
+ * Free Software Foundation. (http://www.gnu.org/licenses/gpl-3.0.en.html)
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *
+ * @file    buffer_parser.hh
+ * @brief   Parsing of numbers from a character buffer (e.g. memory mapped input file).
+ */
+
+#ifndef BUFFER_PARSER_HH_
+#define BUFFER_PARSER_HH_
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "config.h"
+
+#ifdef FLOW123D_HAVE_OPENMP
+#include <omp.h>
+#endif
+
+
+/**
+ * Functions for reading of whitespace separated values from a line of a character buffer.
+ *
+ * Unlike Tokenizer, no strings are created for individual tokens and the functions can be called
+ * concurrently for different parts of the buffer. A line is given by the pointer to its current position
+ * and pointer to its end (position of '\\n' or end of the buffer). The buffer has to continue by some
+ * non-numeric character after every line (typically '\\n' or '$' of GMSH section end).
+ *
+ * Values are converted in the same way as by boost::lexical_cast: the whole token has to be valid,
+ * integer values can not contain decimal point, unsigned values can not be negative.
+ */
+namespace buffer_parser {
+
+/// Return true for whitespace characters within the line.
+inline bool is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+/// Return true for whitespace characters including the end of line.
+inline bool is_space(char c) {
+    return is_blank(c) || c == '\n';
+}
+
+/// Return end of the line starting at @p pos, i.e. position of '\\n' or @p end.
+inline const char *line_end(const char *pos, const char *end) {
+    const char *eol = static_cast<const char *>( std::memchr(pos, '\n', end - pos) );
+    return (eol == nullptr) ? end : eol;
+}
+
+/// Move @p pos behind the blank characters, return false if the end of line @p eol is reached.
+inline bool skip_blank(const char *&pos, const char *eol) {
+    while (pos < eol && is_blank(*pos)) ++pos;
+    return pos < eol;
+}
+
+/// Return true if the line [pos, eol) contains only blank characters or a comment starting by '#'.
+inline bool is_empty_line(const char *pos, const char *eol) {
+    return !skip_blank(pos, eol) || *pos == '#';
+}
+
+/// Check that the token ends at @p pos.
+inline bool token_end(const char *pos, const char *eol) {
+    return pos >= eol || is_blank(*pos);
+}
+
+/// Move @p pos behind the next token, return false if the line contains no more tokens.
+inline bool skip_token(const char *&pos, const char *eol) {
+    if (! skip_blank(pos, eol)) return false;
+    while (pos < eol && !is_blank(*pos)) ++pos;
+    return true;
+}
+
+/// Read unsigned integer token, helper of read_value.
+inline bool read_unsigned(const char *&pos, const char *eol, unsigned long long max_value, unsigned long long &val) {
+    const char *begin = pos;
+    val = 0;
+    while (pos < eol && *pos >= '0' && *pos <= '9') {
+        val = 10*val + (*pos - '0');
+        if (val > max_value) return false;
+        ++pos;
+    }
+    return pos != begin && token_end(pos, eol);
+}
+
+/**
+ * Read value of type T from the line, move @p pos behind the read token.
+ * Returns false if the line contains no more tokens or the token is not valid value of type T.
+ */
+template <typename T>
+bool read_value(const char *&pos, const char *eol, T &val);
+
+template <>
+inline bool read_value<unsigned int>(const char *&pos, const char *eol, unsigned int &val) {
+    if (! skip_blank(pos, eol)) return false;
+    if (*pos == '+') ++pos;
+    unsigned long long v;
+    if (! read_unsigned(pos, eol, std::numeric_limits<unsigned int>::max(), v)) return false;
+    val = static_cast<unsigned int>(v);
+    return true;
+}
+
+template <>
+inline bool read_value<int>(const char *&pos, const char *eol, int &val) {
+    if (! skip_blank(pos, eol)) return false;
+    bool negative = (*pos == '-');
+    if (*pos == '-' || *pos == '+') ++pos;
+    unsigned long long v;
+    if (! read_unsigned(pos, eol, (unsigned long long)(std::numeric_limits<int>::max()) + 1, v)) return false;
+    if (!negative && v > (unsigned long long)std::numeric_limits<int>::max()) return false;
+    val = negative ? static_cast<int>(-(long long)v) : static_cast<int>(v);
+    return true;
+}
+
+template <>
+inline bool read_value<double>(const char *&pos, const char *eol, double &val) {
+    if (! skip_blank(pos, eol)) return false;
+    char *token_end_pos;
+    val = std::strtod(pos, &token_end_pos);
+    if (token_end_pos == pos || token_end_pos > eol || !token_end(token_end_pos, eol)) return false;
+    pos = token_end_pos;
+    return true;
+}
+
+/**
+ * Read string token, possibly quoted by '"' (quotes are removed, quoted string can contain blanks).
+ */
+inline bool read_string(const char *&pos, const char *eol, std::string &val) {
+    if (! skip_blank(pos, eol)) return false;
+    const char *begin = pos;
+    if (*pos == '"') {
+        ++begin;
+        const char *quote = static_cast<const char *>( std::memchr(begin, '"', eol - begin) );
+        if (quote == nullptr) return false;
+        val.assign(begin, quote);
+        pos = quote + 1;
+        return true;
+    }
+    while (pos < eol && !is_blank(*pos)) ++pos;
+    val.assign(begin, pos);
+    return true;
+}
+
+/**
+ * Split buffer [begin, end) into at most @p n_parts parts of approximately same size,
+ * every part (except the first one) starts at the beginning of a line.
+ * Returns vector of n+1 boundaries of the n parts.
+ */
+inline std::vector<const char *> split_lines(const char *begin, const char *end, unsigned int n_parts) {
+    std::vector<const char *> bounds(1, begin);
+    std::size_t part_size = (end - begin) / n_parts;
+    for (unsigned int i=1; i<n_parts; ++i) {
+        const char *pos = begin + i*part_size;
+        if (pos <= bounds.back()) continue;
+        pos = line_end(pos, end);
+        if (pos < end) ++pos;
+        if (pos > bounds.back() && pos < end) bounds.push_back(pos);
+    }
+    bounds.push_back(end);
+    return bounds;
+}
+
+/**
+ * Return number of whitespace separated tokens in buffer [begin, end), tokens can be on several lines.
+ */
+inline std::size_t count_tokens(const char *begin, const char *end) {
+    std::size_t n_tokens = 0;
+    const char *pos = begin;
+    while (pos < end) {
+        while (pos < end && is_space(*pos)) ++pos;
+        if (pos == end) break;
+        ++n_tokens;
+        while (pos < end && !is_space(*pos)) ++pos;
+    }
+    return n_tokens;
+}
+
+/**
+ * Split buffer [begin, end) into at most @p n_parts parts of approximately same size, every part
+ * (except the first one) starts behind a whitespace character, so no token is split. Unlike @p split_lines
+ * it can split a single long line (e.g. ascii DataArray of a VTK file).
+ * Returns vector of n+1 boundaries of the n parts.
+ */
+inline std::vector<const char *> split_tokens(const char *begin, const char *end, unsigned int n_parts) {
+    std::vector<const char *> bounds(1, begin);
+    std::size_t part_size = (end - begin) / n_parts;
+    for (unsigned int i=1; i<n_parts; ++i) {
+        const char *pos = begin + i*part_size;
+        if (pos <= bounds.back()) continue;
+        while (pos < end && !is_space(*pos)) ++pos;
+        if (pos < end) ++pos;
+        if (pos > bounds.back() && pos < end) bounds.push_back(pos);
+    }
+    bounds.push_back(end);
+    return bounds;
+}
+
+/// Number of parts of the buffer [begin, end) read in parallel.
+inline unsigned int n_read_parts(const char *begin, const char *end) {
+    // small sections are not split
+    static const std::size_t min_part_size = 1 << 16;
+    unsigned int n_parts = 1;
+#ifdef FLOW123D_HAVE_OPENMP
+    n_parts = omp_get_max_threads();
+#endif
+    return std::max(1u, std::min(n_parts, (unsigned int)((end - begin) / min_part_size) + 1));
+}
+
+/// Call @p read_part(i) for all parts 0 <= i < @p n_parts, parts are read in parallel if OpenMP is available.
+template <class ReadPart>
+void read_parts(unsigned int n_parts, ReadPart read_part) {
+#ifdef FLOW123D_HAVE_OPENMP
+    #pragma omp parallel for schedule(static) num_threads(n_parts)
+#endif
+    for (int i=0; i<(int)n_parts; ++i) read_part(i);
+}
+
+} // namespace buffer_parser
+
+#endif /* BUFFER_PARSER_HH_ */
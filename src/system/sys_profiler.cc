@@ -109,6 +109,25 @@ long MPI_Functions::max(long* val, MPI_Comm comm) {
 
 const int timer_no_child=-1;
 
+
+/// Set in threads excluded from profiling by Profiler::exclude_thread.
+static thread_local bool excluded_thread = false;
+
+/// Generation of the Profiler instance the value of thread_tree_idx belongs to.
+static thread_local unsigned int thread_generation = 0;
+
+/// Index of the timer tree of the thread, Profiler::max_n_threads for threads that are not profiled.
+static thread_local unsigned int thread_tree_idx = Profiler::max_n_threads;
+
+/// Counter of created Profiler instances.
+static std::atomic<unsigned int> profiler_generation(0);
+
+/// PETSc memory usage is monitored only in the master thread.
+static inline bool petsc_memory_monitored() {
+    return Profiler::get_petsc_memory_monitoring() && thread_tree_idx == 0;
+}
+
+
 Timer::Timer(const CodePoint &cp, int parent)
 : start_time(TimePoint()),
   cumul_time(0.0),
@@ -118,12 +137,18 @@ Timer::Timer(const CodePoint &cp, int parent)
   full_hash_(cp.hash_),
   hash_idx_(cp.hash_idx_),
   parent_timer(parent),
+  master_node_(-1),
   total_allocated_(0),
   total_deallocated_(0),
   max_allocated_(0),
   current_allocated_(0),
   alloc_called(0),
-  dealloc_called(0)
+  dealloc_called(0),
+  thread_count_(0),
+  thread_call_count_(0),
+  thread_min_time_(0.0),
+  thread_max_time_(0.0),
+  thread_sum_time_(0.0)
 #ifdef FLOW123D_HAVE_PETSC
 , petsc_start_memory(0),
   petsc_end_memory (0),
@@ -191,7 +216,7 @@ void Profiler::accept_from_child(Timer &parent, Timer &child) {
 
 void Timer::pause() {
 #ifdef FLOW123D_HAVE_PETSC
-    if (Profiler::get_petsc_memory_monitoring()) {
+    if (petsc_memory_monitored()) {
         // get the maximum resident set size (memory used) for the program.
         PetscMemoryGetMaximumUsage(&petsc_local_peak_memory);
         if (petsc_peak_memory < petsc_local_peak_memory)
@@ -202,7 +227,7 @@ void Timer::pause() {
 
 void Timer::resume() {
 #ifdef FLOW123D_HAVE_PETSC
-    if (Profiler::get_petsc_memory_monitoring()) {
+    if (petsc_memory_monitored()) {
         // tell PETSc to monitor the maximum memory usage so
         //   that PetscMemoryGetMaximumUsage() will work.
         PetscMemorySetGetMaximumUsage();
@@ -212,7 +237,7 @@ void Timer::resume() {
 
 void Timer::start() {
 #ifdef FLOW123D_HAVE_PETSC
-    if (Profiler::get_petsc_memory_monitoring()) {
+    if (petsc_memory_monitored()) {
         // Tell PETSc to monitor the maximum memory usage so
         //   that PetscMemoryGetMaximumUsage() will work.
         PetscMemorySetGetMaximumUsage();
@@ -231,7 +256,7 @@ void Timer::start() {
 
 bool Timer::stop(bool forced) {
 #ifdef FLOW123D_HAVE_PETSC
-    if (Profiler::get_petsc_memory_monitoring()) {
+    if (petsc_memory_monitored()) {
         // get current memory usage
         PetscMemoryGetCurrentUsage (&petsc_end_memory);
         petsc_memory_difference += petsc_end_memory - petsc_start_memory;
@@ -264,7 +289,7 @@ void Timer::add_child(int child_index, const Timer &child)
         // hash collision, find first empty place
         unsigned int i=idx;
         do {
-            i=( i < max_n_childs ? i+1 : 0);
+            i=( i+1 < max_n_childs ? i+1 : 0);
         } while (i!=idx && child_timers[i] != timer_no_child);
         ASSERT(i!=idx)(tag()).error("Too many children of the timer");
         idx=i;
@@ -299,6 +324,32 @@ Profiler* Profiler::_instance = NULL;
 const long Profiler::malloc_map_reserve = 100 * 1000;
 CodePoint Profiler::null_code_point = CodePoint("__no_tag__", "__no_file__", "__no_func__", 0);
 
+
+void Profiler::exclude_thread() {
+    excluded_thread = true;
+    thread_tree_idx = max_n_threads;
+}
+
+
+Profiler::TimerTree *Profiler::thread_tree() {
+    if (thread_generation != generation_) {
+        // first call from the thread, register its tree
+        thread_generation = generation_;
+        thread_tree_idx = excluded_thread ? max_n_threads : n_thread_trees_.fetch_add(1);
+        if (thread_tree_idx < max_n_threads) {
+            thread_trees_[thread_tree_idx].timers_.push_back( Timer(main_cp, 0) );
+        } else {
+            thread_tree_idx = max_n_threads;
+        }
+    }
+    return (thread_tree_idx < max_n_threads) ? &(thread_trees_[thread_tree_idx]) : NULL;
+}
+
+
+bool Profiler::is_master_thread() const {
+    return thread_generation == generation_ && thread_tree_idx == 0;
+}
+
 void Profiler::initialize() {
     instance();
     set_memory_monitoring(true, true);
@@ -306,12 +357,18 @@ void Profiler::initialize() {
 
 
 Profiler::Profiler()
-: actual_node(0),
+: n_thread_trees_(1),
+  generation_(++profiler_generation),
+  timers_(thread_trees_[0].timers_),
+  actual_node(thread_trees_[0].actual_node),
   task_size_(1),
   start_time( time(NULL) ),
   json_filepath("")
 
 {
+    // thread creating the Profiler is the master thread
+    thread_generation = generation_;
+    thread_tree_idx = 0;
 #ifdef FLOW123D_DEBUG_PROFILER
     timers_.push_back( Timer(main_cp, 0) );
     timers_[0].start();
@@ -332,6 +389,79 @@ void Profiler::propagate_timers() {
 
 
 
+void Profiler::merge_thread_trees() {
+    // statistics of the master thread
+    for (Timer &timer : timers_) {
+        timer.thread_count_ = (timer.call_count > 0) ? 1 : 0;
+        timer.thread_call_count_ = timer.call_count;
+        timer.thread_min_time_ = timer.thread_max_time_ = timer.thread_sum_time_ = timer.cumulative_time();
+    }
+
+    // time and calls of one thread, indexed by timers of the master tree
+    vector<double, internal::SimpleAllocator<double>> time;
+    vector<unsigned int, internal::SimpleAllocator<unsigned int>> calls;
+    for (unsigned int i_tree = 1; i_tree < n_thread_trees(); i_tree++) {
+        const TimerTree &tree = thread_trees_[i_tree];
+        time.assign(timers_.size(), 0.0);
+        calls.assign(timers_.size(), 0);
+        for (unsigned int i = 0; i < Timer::max_n_childs; i++) {
+            int child_idx = tree.timers_[0].child_timers[i];
+            if (child_idx == timer_no_child) continue;
+
+            // place the timer below the master timer that was actual at its creation, but not below
+            // the same timer (e.g. when the master thread executes the same parallel region)
+            const Timer &child = tree.timers_[child_idx];
+            unsigned int master_parent = child.master_node_;
+            for (unsigned int node = master_parent; node != 0; node = timers_[node].parent_timer)
+                if (timers_[node].full_hash_ == child.full_hash_) {
+                    master_parent = timers_[node].parent_timer;
+                    break;
+                }
+            merge_thread_timer(tree, child_idx, master_parent, time, calls);
+        }
+
+        // add statistics of the thread
+        for (unsigned int i = 0; i < time.size(); i++) {
+            if (calls[i] == 0) continue;
+            Timer &timer = timers_[i];
+            if (timer.thread_count_ == 0) {
+                timer.thread_min_time_ = timer.thread_max_time_ = timer.thread_sum_time_ = time[i];
+            } else {
+                timer.thread_min_time_ = min(timer.thread_min_time_, time[i]);
+                timer.thread_max_time_ = max(timer.thread_max_time_, time[i]);
+                timer.thread_sum_time_ += time[i];
+            }
+            timer.thread_count_++;
+            timer.thread_call_count_ += calls[i];
+        }
+    }
+}
+
+
+
+template <class TimeVec, class CallsVec>
+void Profiler::merge_thread_timer(const TimerTree &tree, unsigned int timer_idx, unsigned int master_parent,
+        TimeVec &time, CallsVec &calls) {
+    const Timer &timer = tree.timers_[timer_idx];
+    int master_idx = find_child(thread_trees_[0], master_parent, *timer.code_point_);
+    if (master_idx < 0) {
+        // timer used only by other threads - create it in the master tree
+        master_idx = timers_.size();
+        timers_.push_back( Timer(*timer.code_point_, master_parent) );
+        timers_[master_parent].add_child(master_idx, timers_.back() );
+        time.resize(timers_.size(), 0.0);
+        calls.resize(timers_.size(), 0);
+    }
+    time[master_idx] += timer.cumulative_time();
+    calls[master_idx] += timer.call_count;
+
+    for (unsigned int i = 0; i < Timer::max_n_childs; i++)
+        if (timer.child_timers[i] != timer_no_child)
+            merge_thread_timer(tree, timer.child_timers[i], master_idx, time, calls);
+}
+
+
+
 void Profiler::set_task_info(string description, int size) {
     task_description_ = description;
     task_size_ = size;
@@ -350,38 +480,46 @@ void Profiler::set_program_info(string program_name, string program_version, str
 
 
 int  Profiler::start_timer(const CodePoint &cp) {
-    unsigned int parent_node = actual_node;
+    TimerTree *tree = thread_tree();
+    if (tree == NULL) return -1;
+    auto &timers = tree->timers_;
+
+    unsigned int parent_node = tree->actual_node;
+    // top level timers of other threads are distinguished also by the actual timer of the master thread
+    int master_node = (tree != thread_trees_ && parent_node == 0) ? (int)actual_node.load() : -1;
     //DebugOut().fmt("Start timer: {}\n", cp.tag_);
-    int child_idx = find_child(cp);
+    int child_idx = find_child(*tree, parent_node, cp, master_node);
     if (child_idx < 0) {
         //DebugOut().fmt("Adding timer: {}\n", cp.tag_);
         // tag not present - create new timer
-        child_idx=timers_.size();
-        timers_.push_back( Timer(cp, actual_node) );
-        timers_[actual_node].add_child(child_idx , timers_.back() );
+        child_idx=timers.size();
+        timers.push_back( Timer(cp, parent_node) );
+        timers.back().master_node_ = master_node;
+        timers[parent_node].add_child(child_idx , timers.back() );
     }
-    actual_node=child_idx;
+    tree->actual_node=child_idx;
     
     // pause current timer
-    timers_[parent_node].pause();
+    timers[parent_node].pause();
     
-    timers_[actual_node].start();
+    timers[child_idx].start();
     
-    return actual_node;
+    return child_idx;
 }
 
 
 
-int Profiler::find_child(const CodePoint &cp) {
-    Timer &timer =timers_[actual_node];
+int Profiler::find_child(const TimerTree &tree, unsigned int parent, const CodePoint &cp, int master_node) {
+    const Timer &timer = tree.timers_[parent];
     unsigned int idx = cp.hash_idx_;
     unsigned int child_idx;
     do {
         if (timer.child_timers[idx] == timer_no_child) break; // tag is not there
 
         child_idx=timer.child_timers[idx];
-        ASSERT_LT(child_idx, timers_.size()).error();
-        if (timers_[child_idx].full_hash_ == cp.hash_) return child_idx;
+        ASSERT_LT(child_idx, tree.timers_.size()).error();
+        const Timer &child = tree.timers_[child_idx];
+        if (child.full_hash_ == cp.hash_ && (master_node < 0 || child.master_node_ == master_node)) return child_idx;
         idx = ( (unsigned int)(idx)==(Timer::max_n_childs - 1) ? 0 : idx+1 );
     } while ( (unsigned int)(idx) != cp.hash_idx_ ); // passed through whole array
     return -1;
@@ -390,35 +528,40 @@ int Profiler::find_child(const CodePoint &cp) {
 
 
 void Profiler::stop_timer(const CodePoint &cp) {
+    TimerTree *tree = thread_tree();
+    if (tree == NULL) return;
+    auto &timers = tree->timers_;
+    auto &actual = tree->actual_node;
+
 #ifdef FLOW123D_DEBUG
     // check that all childrens are closed
-    Timer &timer=timers_[actual_node];
+    Timer &timer=timers[actual];
     for(unsigned int i=0; i < Timer::max_n_childs; i++)
         if (timer.child_timers[i] != timer_no_child)
-        	ASSERT(! timers_[timer.child_timers[i]].running())(timers_[timer.child_timers[i]].tag())(timer.tag())
+        	ASSERT(! timers[timer.child_timers[i]].running())(timers[timer.child_timers[i]].tag())(timer.tag())
 				.error("Child timer running while closing timer.");
 #endif
-    unsigned int child_timer = actual_node;
-    if ( cp.hash_ != timers_[actual_node].full_hash_) {
+    unsigned int child_timer = actual;
+    if ( cp.hash_ != timers[actual].full_hash_) {
         // timer to close is not actual - we search for it above actual
-        for(unsigned int node=actual_node; node != 0; node=timers_[node].parent_timer) {
-            if ( cp.hash_ == timers_[node].full_hash_) {
+        for(unsigned int node=actual; node != 0; node=timers[node].parent_timer) {
+            if ( cp.hash_ == timers[node].full_hash_) {
                 // found above - close all nodes between
-                for(; (unsigned int)(actual_node) != node; actual_node=timers_[actual_node].parent_timer) {
+                for(; (unsigned int)(actual) != node; actual=timers[actual].parent_timer) {
                 	WarningOut() << "Timer to close '" << cp.tag_ << "' do not match actual timer '"
-                			<< timers_[actual_node].tag() << "'. Force closing actual." << std::endl;
-                    timers_[actual_node].stop(true);
+                			<< timers[actual].tag() << "'. Force closing actual." << std::endl;
+                    timers[actual].stop(true);
                 }
                 // close 'node' itself
-                timers_[actual_node].stop(false);
-                actual_node = timers_[actual_node].parent_timer;
+                timers[actual].stop(false);
+                actual = timers[actual].parent_timer;
                 
-                // actual_node == child_timer indicates this is root
-                if (actual_node == child_timer)
+                // actual == child_timer indicates this is root
+                if (actual == child_timer)
                     return;
                 
                 // resume current timer
-                timers_[actual_node].resume();
+                timers[actual].resume();
                 return;
             }
         }
@@ -426,15 +569,15 @@ void Profiler::stop_timer(const CodePoint &cp) {
         return;
     }
     // node to close match the actual
-    timers_[actual_node].stop(false);
-    actual_node = timers_[actual_node].parent_timer;
+    timers[actual].stop(false);
+    actual = timers[actual].parent_timer;
     
-    // actual_node == child_timer indicates this is root
-    if (actual_node == child_timer)
+    // actual == child_timer indicates this is root
+    if (actual == child_timer)
         return;
     
     // resume current timer
-    timers_[actual_node].resume();
+    timers[actual].resume();
 }
 
 
@@ -443,9 +586,11 @@ void Profiler::stop_timer(int timer_index) {
     // stop_timer with CodePoint type
     // timer which is still running MUST be the same as actual_node index
     // if timer is not running index will differ
-    if (timers_[timer_index].running()) {
-    	ASSERT_EQ(timer_index, (int)actual_node).error();
-        stop_timer(*timers_[timer_index].code_point_);
+    TimerTree *tree = thread_tree();
+    if (tree == NULL) return;
+    if (tree->timers_[timer_index].running()) {
+    	ASSERT_EQ(timer_index, (int)tree->actual_node).error();
+        stop_timer(*tree->timers_[timer_index].code_point_);
     }
     
 }
@@ -453,13 +598,15 @@ void Profiler::stop_timer(int timer_index) {
 
 
 void Profiler::add_calls(unsigned int n_calls) {
-    timers_[actual_node].call_count += n_calls-1;
+    TimerTree *tree = thread_tree();
+    if (tree == NULL) return;
+    tree->timers_[tree->actual_node].call_count += n_calls-1;
 }
 
 
 
 void Profiler::notify_malloc(const size_t size, const long p) {
-    if (!global_monitor_memory)
+    if (!global_monitor_memory || !is_master_thread())
         return;
 
     MemoryAlloc::malloc_map()[p] = static_cast<int>(size);
@@ -474,7 +621,7 @@ void Profiler::notify_malloc(const size_t size, const long p) {
 
 
 void Profiler::notify_free(const long p) {
-    if (!global_monitor_memory)
+    if (!global_monitor_memory || !is_master_thread())
         return;
     
     int size = sizeof(p);
@@ -628,6 +775,7 @@ void Profiler::output(MPI_Comm comm, ostream &os) {
     MPI_Barrier(comm);
     stop_timer(0);
     propagate_timers();
+    merge_thread_trees();
     
     // stop monitoring memory
     bool temp_memory_monitoring = global_monitor_memory;
@@ -638,14 +786,16 @@ void Profiler::output(MPI_Comm comm, ostream &os) {
 
     // output header
     property_tree::ptree root, children;
-    output_header (root, mpi_size);
+    int thread_count = n_thread_trees();
+    output_header (root, mpi_size, MPI_Functions::max(&thread_count, comm));
 
     // recursively add all timers info
     // define lambda function which reduces timer from multiple processors
     // MPI implementation uses MPI call to reduce values
     auto reduce = [=] (Timer &timer, property_tree::ptree &node) -> double {
-        int call_count = timer.call_count;
-        double cumul_time = timer.cumulative_time ();
+        // time of the slowest thread, calls of all threads
+        int call_count = timer.thread_call_count_;
+        double cumul_time = timer.thread_max_time_;
         
         long memory_allocated = (long)timer.total_allocated_;
         long memory_deallocated = (long)timer.total_deallocated_;
@@ -658,6 +808,18 @@ void Profiler::output(MPI_Comm comm, ostream &os) {
         save_mpi_metric<double>(node, comm, &cumul_time, "cumul-time");
         save_mpi_metric<int>(node, comm, &call_count, "call-count");
         
+        // statistics over threads of all processes
+        int thread_count = timer.thread_count_;
+        double thread_min_time = timer.thread_min_time_;
+        double thread_max_time = timer.thread_max_time_;
+        double thread_sum_time = timer.thread_sum_time_;
+        save_mpi_metric<int>(node, comm, &thread_count, "thread-count");
+        node.put ("cumul-time-thread-min", MPI_Functions::min(&thread_min_time, comm));
+        node.put ("cumul-time-thread-max", MPI_Functions::max(&thread_max_time, comm));
+        int thread_count_sum = MPI_Functions::sum(&thread_count, comm);
+        double thread_time_sum = MPI_Functions::sum(&thread_sum_time, comm);
+        node.put ("cumul-time-thread-avg", thread_count_sum > 0 ? thread_time_sum / thread_count_sum : 0.0);
+        
         save_mpi_metric<long>(node, comm, &memory_allocated, "memory-alloc");
         save_mpi_metric<long>(node, comm, &memory_deallocated, "memory-dealloc");
         save_mpi_metric<long>(node, comm, &memory_peak, "memory-peak");
@@ -725,6 +887,7 @@ void Profiler::output(ostream &os) {
     // last update
     stop_timer(0);
     propagate_timers();
+    merge_thread_trees();
 
     // output header
     property_tree::ptree root, children;
@@ -733,15 +896,16 @@ void Profiler::output(ostream &os) {
      * where there is no MPI to work with (so 1 process)
      */
     const int FLOW123D_MPI_SINGLE_PROCESS = 1;
-    output_header (root, FLOW123D_MPI_SINGLE_PROCESS);
+    output_header (root, FLOW123D_MPI_SINGLE_PROCESS, n_thread_trees());
 
 
     // recursively add all timers info
     // define lambda function which reduces timer from multiple processors
     // non-MPI implementation is just dummy repetition of initial value
     auto reduce = [=] (Timer &timer, property_tree::ptree &node) -> double {
-        int call_count = timer.call_count;
-        double cumul_time = timer.cumulative_time ();
+        // time of the slowest thread, calls of all threads
+        int call_count = timer.thread_call_count_;
+        double cumul_time = timer.thread_max_time_;
         
         long memory_allocated = (long)timer.total_allocated_;
         long memory_deallocated = (long)timer.total_deallocated_;
@@ -753,6 +917,13 @@ void Profiler::output(ostream &os) {
         save_nonmpi_metric<double>(node, &cumul_time, "cumul-time");
         save_nonmpi_metric<int>(node, &call_count, "call-count");
         
+        // statistics over threads
+        int thread_count = timer.thread_count_;
+        save_nonmpi_metric<int>(node, &thread_count, "thread-count");
+        node.put ("cumul-time-thread-min", timer.thread_min_time_);
+        node.put ("cumul-time-thread-max", timer.thread_max_time_);
+        node.put ("cumul-time-thread-avg", thread_count > 0 ? timer.thread_sum_time_ / thread_count : 0.0);
+        
         save_nonmpi_metric<long>(node, &memory_allocated, "memory-alloc");
         save_nonmpi_metric<long>(node, &memory_deallocated, "memory-dealloc");
         save_nonmpi_metric<long>(node, &memory_peak, "memory-peak");
@@ -800,7 +971,7 @@ void Profiler::output(string profiler_path /* = "" */) {
     }
 }
 
-void Profiler::output_header (property_tree::ptree &root, int mpi_size) {
+void Profiler::output_header (property_tree::ptree &root, int mpi_size, int thread_count) {
     time_t end_time = time(NULL);
 
     const char format[] = "%x %X";
@@ -828,6 +999,7 @@ void Profiler::output_header (property_tree::ptree &root, int mpi_size) {
 
     //print some information about the task at the beginning
     root.put ("run-process-count",  mpi_size);
+    root.put ("run-thread-count",   thread_count);
     root.put ("run-started-at",     start_time_string);
     root.put ("run-finished-at",    end_time_string);
 }
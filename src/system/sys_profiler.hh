@@ -51,6 +51,7 @@
 #include "global_defs.h"
 
 #include <mpi.h>
+#include <atomic>
 #include <ostream>
 namespace boost { template <class T> struct hash; }
 #include <boost/functional/hash/hash.hpp>      // for hash
@@ -389,6 +390,12 @@ protected:
      * Index of the parent timer node  in the tree. Negative value means 'not set'.
      */
     int parent_timer;
+    /**
+     * Only for children of the root of a non-master thread tree: index of the master thread timer
+     * that was actual when the timer was created. The timer is merged into the master tree below this timer.
+     * Negative value means 'not set'.
+     */
+    int master_node_;
     /**
      * Indices of the child timers in the Profiler::timers_ vector. Negative values means 'not set'.
      */
@@ -426,6 +433,17 @@ protected:
      * Number of times delete/delete[] operator was used in this scope
      */
     int dealloc_called;
+
+    /**
+     * Statistics over the threads, set by Profiler::merge_thread_trees for timers of the master tree.
+     * Number of threads that opened the frame, their total number of calls and
+     * minimal, maximal and total cumulative time of one thread.
+     */
+    unsigned int thread_count_;
+    unsigned int thread_call_count_;
+    double thread_min_time_;
+    double thread_max_time_;
+    double thread_sum_time_;
     
     #ifdef FLOW123D_HAVE_PETSC
     /**
@@ -516,7 +534,12 @@ struct translator_between<std::basic_string< Ch, Traits, Alloc >, int> {
  * for the currently active timer.
  *
  *
- * Currently the Profiler system is not thread safe. No idea how to do this.
+ * Every thread has its own timer tree, so timers can be used also in OpenMP parallel regions. The thread creating
+ * the Profiler is the master thread, other threads get their trees on their first call of the profiler
+ * (lock-free, by atomic increment of the thread counter). Top level timers of the other threads are placed
+ * below the timer of the master thread that was actual when they were created. Trees are merged into the master
+ * tree by the @p output method, times and call counts are summarized over the threads in the same way
+ * as over the MPI processes. Memory is monitored only in the master thread.
  *
  */
 class Profiler {
@@ -671,6 +694,16 @@ public:
      * @return memory monitoring status
      */
     bool static get_petsc_memory_monitoring();
+
+    /**
+     * Exclude the calling thread from profiling. Should be called at start of threads running
+     * concurrently with unrelated code of the master thread (e.g. background output writer),
+     * their timers would be merged below random timers of the master thread.
+     */
+    static void exclude_thread();
+
+    /// Maximal number of profiled threads (including the master thread), other threads are ignored.
+    static const unsigned int max_n_threads = 64;
     
     /**
      * if under unit testing, specify friend so protected members can be tested
@@ -709,19 +742,60 @@ protected:
      */
     void accept_from_child (Timer &parent, Timer &child);
     
+    /// Timer tree of one thread.
+    struct TimerTree {
+        TimerTree() : actual_node(0) {}
+
+        /// Vector of all timers of the thread.
+        vector<Timer, internal::SimpleAllocator<Timer>> timers_;
+        /// Index of the actual timer node. Read also by other threads, see start_timer.
+        std::atomic<unsigned int> actual_node;
+    };
+
     /**
-     * Try to find timer with tag (in fact only its 32-bit hash) from given code point @p cp.
+     * Try to find child of the timer @p parent in the @p tree with tag (in fact only its 32-bit hash)
+     * from given code point @p cp. For nonnegative @p master_node also Timer::master_node_ of the child must match.
      * Returns -1 if it is not found otherwise it returns its index.
      */
-    int find_child(const CodePoint &cp);
+    int find_child(const TimerTree &tree, unsigned int parent, const CodePoint &cp, int master_node = -1);
+
+    /**
+     * Return timer tree of the calling thread, register the tree if the thread calls the profiler first time.
+     * Returns NULL for threads that are not profiled.
+     */
+    TimerTree *thread_tree();
+
+    /// Returns true if called from the master thread.
+    bool is_master_thread() const;
+
+    /// Number of registered thread trees.
+    inline unsigned int n_thread_trees() const
+    {
+        unsigned int n = n_thread_trees_.load();
+        return (n < max_n_threads) ? n : max_n_threads;
+    }
+
+    /**
+     * Set thread statistics of timers of the master tree (Timer::thread_count_ etc.), merge timers of other
+     * threads into the master tree. Trees of other threads are not modified, so the method can be called repeatedly.
+     */
+    void merge_thread_trees();
+
+    /**
+     * Find or create the timer in the master tree corresponding to the timer @p timer_idx of the thread @p tree,
+     * add its time and calls to @p time and @p calls (indexed by master timers), continue with its children.
+     */
+    template <class TimeVec, class CallsVec>
+    void merge_thread_timer(const TimerTree &tree, unsigned int timer_idx, unsigned int master_parent,
+            TimeVec &time, CallsVec &calls);
 
 
     /**
      * Method will prepare construct specific details about the run (time start and time end)
      * and write them along with basic informations about the run (name, description, ...)
-     * into ptree object
+     * into ptree object. The @p thread_count is the maximal number of profiled threads of one process.
      */
-    void output_header (property_tree::ptree &root, int mpi_size);
+    void output_header (property_tree::ptree &root, int mpi_size, int thread_count);
 
     /**
      * Open a new file for profiler output with default name based on the
@@ -735,11 +809,20 @@ protected:
     /// Pointer to the unique instance of singleton Profiler class.
     static Profiler* _instance;
 
-    /// Vector of all timers. Whole tree is stored in this array.
-    vector<Timer, internal::SimpleAllocator<Timer>> timers_;
+    /// Timer trees of the threads, the first one belongs to the master thread.
+    TimerTree thread_trees_[max_n_threads];
+
+    /// Number of registered thread trees, can exceed @p max_n_threads.
+    std::atomic<unsigned int> n_thread_trees_;
 
-    /// Index of the actual timer node. Negative value means 'unset'.
-    unsigned int actual_node;
+    /// Unique number of the Profiler instance, used to detect threads registered in previous instances.
+    unsigned int generation_;
+
+    /// Vector of all timers of the master thread. Whole tree is stored in this array.
+    vector<Timer, internal::SimpleAllocator<Timer>> &timers_;
+
+    /// Index of the actual timer node of the master thread.
+    std::atomic<unsigned int> &actual_node;
 
     /// MPI communicator used for final reduce of the timer node tree.
     //MPI_Comm communicator_;
@@ -874,6 +957,8 @@ public:
     { return 0; }
     inline double actual_cumulative_time() const
     { return 0.0; }
+    static void exclude_thread()
+    {}
     static void uninitialize();
 private:
     static Profiler* _instance;
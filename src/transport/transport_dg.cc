@@ -16,6 +16,7 @@
 * @author  Jan Stebel
 */
 
+#include <algorithm>
 #include "system/sys_profiler.hh"
 #include "transport/transport_dg.hh"
 
@@ -26,6 +27,7 @@
 #include "fem/fe_p.hh"
 #include "fem/fe_rt.hh"
 #include "fem/dh_cell_accessor.hh"
+#include "fem/fe_values_batch.hh"
 #include "fields/field_fe.hh"
 #include "fields/fe_value_handler.hh"
 #include "la/linsys_PETSC.hh"
@@ -90,6 +92,9 @@ const Record & TransportDG<Model>::get_input_type() {
                 "Variant of the interior penalty discontinuous Galerkin method.")
         .declare_key("dg_order", Integer(0,3), Default("1"),
                 "Polynomial order for the finite element in DG method (order 0 is suitable if there is no diffusion/dispersion).")
+        .declare_key("shared_matrices", Bool(), Default("false"),
+                "If true, substances with the same coefficients use the matrices of the first substance "
+                "and are solved together with it (the preconditioner is set up once for all of them).")
         .declare_key("output",
                 EqData().output_fields.make_output_type(equation_name, ""),
                 IT::Default("{ \"fields\": [ " + Model::ModelEqData::default_output_field() + "] }"),
@@ -165,6 +170,57 @@ template<> MappingP1<3,3> *FEObjects::mapping<3>() { return map3_; }
 std::shared_ptr<DOFHandlerMultiDim> FEObjects::dh() { return dh_; }
 
 
+
+void SubstanceMatrixSharing::initialize(unsigned int n_substances, bool enable, MPI_Comm comm)
+{
+    comm_ = comm;
+    shared_.assign(n_substances, enable);
+    if (n_substances > 0) shared_[0] = false;
+    repaired_.assign(n_substances, false);
+    start_assembly();
+}
+
+
+void SubstanceMatrixSharing::start_assembly()
+{
+    any_shared_ = std::find(shared_.begin(), shared_.end(), true) != shared_.end();
+    repair_pass_ = false;
+}
+
+
+bool SubstanceMatrixSharing::finish_assembly()
+{
+    if (repair_pass_)
+    {
+        std::fill(repaired_.begin(), repaired_.end(), false);
+        repair_pass_ = false;
+        return false;
+    }
+
+    synchronize();
+    repair_pass_ = std::find(repaired_.begin(), repaired_.end(), true) != repaired_.end();
+    return repair_pass_;
+}
+
+
+void SubstanceMatrixSharing::synchronize()
+{
+    if (!any_shared_) return;
+
+    std::vector<int> shared(shared_.begin(), shared_.end());
+    MPI_Allreduce(MPI_IN_PLACE, shared.data(), shared.size(), MPI_INT, MPI_LAND, comm_);
+    for (unsigned int sbi=0; sbi<shared_.size(); sbi++)
+        if (shared_[sbi] && !shared[sbi]) stop_sharing(sbi);
+}
+
+
+void SubstanceMatrixSharing::stop_sharing(unsigned int sbi)
+{
+    shared_[sbi] = false;
+    repaired_[sbi] = true;
+}
+
+
 template<class Model>
 TransportDG<Model>::EqData::EqData() : Model::ModelEqData()
 {
@@ -225,6 +281,7 @@ TransportDG<Model>::TransportDG(Mesh & init_mesh, const Input::Record in_rec)
     // DG variant and order
     dg_variant = in_rec.val<DGVariant>("dg_variant");
     dg_order = in_rec.val<unsigned int>("dg_order");
+    share_matrices_ = in_rec.val<bool>("shared_matrices");
     
     Model::init_from_input(in_rec);
 
@@ -320,6 +377,8 @@ void TransportDG<Model>::initialize()
         
         VecDuplicate(ls[sbi]->get_solution(), &ret_vec[sbi]);
     }
+    stiffness_sharing_.initialize(Model::n_substances(), share_matrices_, feo->dh()->distr()->get_comm());
+    mass_sharing_.initialize(Model::n_substances(), share_matrices_, feo->dh()->distr()->get_comm());
 
 
     // initialization of balance object
@@ -418,8 +477,23 @@ void TransportDG<Model>::preallocate()
         mass_matrix[i] = NULL;
         VecZeroEntries(ret_vec[i]);
     }
+    stiffness_sharing_.start_assembly();
     assemble_stiffness_matrix();
+    // substances that stopped sharing are assembled again, their systems are still in allocation
+    if (stiffness_sharing_.finish_assembly())
+    {
+        assemble_stiffness_matrix();
+        stiffness_sharing_.finish_assembly();
+    }
+    mass_sharing_.start_assembly();
     assemble_mass_matrix();
+    if (mass_sharing_.finish_assembly())
+    {
+        for (unsigned int i=0; i<Model::n_substances(); i++)
+            VecZeroEntries(ret_vec[i]);
+        assemble_mass_matrix();
+        mass_sharing_.finish_assembly();
+    }
     set_sources();
     set_boundary_conditions();
     for (unsigned int i=0; i<Model::n_substances(); i++)
@@ -454,19 +528,26 @@ void TransportDG<Model>::update_solution()
             ls_dt[i]->mat_zero_entries();
             VecZeroEntries(ret_vec[i]);
         }
+        mass_sharing_.start_assembly();
         assemble_mass_matrix();
         for (unsigned int i=0; i<Model::n_substances(); i++)
         {
             ls_dt[i]->finish_assembly();
             VecAssemblyBegin(ret_vec[i]);
             VecAssemblyEnd(ret_vec[i]);
+        }
+        if (mass_sharing_.finish_assembly()) repair_mass_matrix();
+        for (unsigned int i=0; i<Model::n_substances(); i++)
+        {
             // construct mass_vec for initial time
-            if (mass_matrix[i] == NULL)
+            if (mass_vec[i] == nullptr)
             {
                 VecDuplicate(ls[i]->get_solution(), &mass_vec[i]);
-                MatMult(*(ls_dt[i]->get_matrix()), ls[i]->get_solution(), mass_vec[i]);
-                MatConvert(*( ls_dt[i]->get_matrix() ), MATSAME, MAT_INITIAL_MATRIX, &mass_matrix[i]);
+                MatMult(*(ls_dt[mass_owner(i)]->get_matrix()), ls[i]->get_solution(), mass_vec[i]);
             }
+            if (mass_sharing_.shared(i)) continue;
+            if (mass_matrix[i] == NULL)
+                MatConvert(*( ls_dt[i]->get_matrix() ), MATSAME, MAT_INITIAL_MATRIX, &mass_matrix[i]);
             else
                 MatCopy(*( ls_dt[i]->get_matrix() ), mass_matrix[i], DIFFERENT_NONZERO_PATTERN);
         }
@@ -484,10 +565,14 @@ void TransportDG<Model>::update_solution()
             ls[i]->start_add_assembly();
             ls[i]->mat_zero_entries();
         }
+        stiffness_sharing_.start_assembly();
         assemble_stiffness_matrix();
         for (unsigned int i=0; i<Model::n_substances(); i++)
-        {
             ls[i]->finish_assembly();
+        if (stiffness_sharing_.finish_assembly()) repair_stiffness_matrix();
+        for (unsigned int i=0; i<Model::n_substances(); i++)
+        {
+            if (stiffness_sharing_.shared(i)) continue;
 
             if (stiffness_matrix[i] == NULL)
                 MatConvert(*( ls[i]->get_matrix() ), MATSAME, MAT_INITIAL_MATRIX, &stiffness_matrix[i]);
@@ -535,27 +620,40 @@ void TransportDG<Model>::update_solution()
     *
     *   A^k = A + 1/dt M.
     *
+    * Substances sharing both matrices with the first substance have the same A^k, they are solved
+    * together with the first substance, so that the preconditioner is set up only once.
     */
     Mat m;
     START_TIMER("solve");
+    std::vector<LinSys_PETSC *> shared_systems;
     for (unsigned int i=0; i<Model::n_substances(); i++)
     {
-        MatConvert(stiffness_matrix[i], MATSAME, MAT_INITIAL_MATRIX, &m);
-        MatAXPY(m, 1./Model::time_->dt(), mass_matrix[i], SUBSET_NONZERO_PATTERN);
-        ls[i]->set_matrix(m, DIFFERENT_NONZERO_PATTERN);
+        if (! shares_system(i))
+        {
+            MatConvert(stiffness_matrix[stiffness_owner(i)], MATSAME, MAT_INITIAL_MATRIX, &m);
+            MatAXPY(m, 1./Model::time_->dt(), mass_matrix[mass_owner(i)], SUBSET_NONZERO_PATTERN);
+            ls[i]->set_matrix(m, DIFFERENT_NONZERO_PATTERN);
+            chkerr(MatDestroy(&m));
+        }
         Vec w;
         VecDuplicate(rhs[i], &w);
         VecWAXPY(w, 1./Model::time_->dt(), mass_vec[i], rhs[i]);
         ls[i]->set_rhs(w);
-
         VecDestroy(&w);
-        chkerr(MatDestroy(&m));
-
-        ls[i]->solve();
 
-        // update mass_vec due to possible changes in mass matrix
-        MatMult(*(ls_dt[i]->get_matrix()), ls[i]->get_solution(), mass_vec[i]);
+        if (i == 0 || shares_system(i))
+            shared_systems.push_back( (LinSys_PETSC *)ls[i] );
+        else
+            ls[i]->solve();
     }
+    if (shared_systems.size() > 1)
+        ( (LinSys_PETSC *)ls[0] )->solve_shared(shared_systems);
+    else if (shared_systems.size() == 1)
+        ls[0]->solve();
+
+    // update mass_vec due to possible changes in mass matrix
+    for (unsigned int i=0; i<Model::n_substances(); i++)
+        MatMult(*(ls_dt[mass_owner(i)]->get_matrix()), ls[i]->get_solution(), mass_vec[i]);
     END_TIMER("solve");
 
     calculate_cumulative_balance();
@@ -564,6 +662,44 @@ void TransportDG<Model>::update_solution()
 }
 
 
+template<class Model>
+void TransportDG<Model>::repair_stiffness_matrix()
+{
+    START_TIMER("repair_stiffness");
+    for (unsigned int i=1; i<Model::n_substances(); i++)
+        if (stiffness_sharing_.repaired(i))
+            ( (LinSys_PETSC *)ls[i] )->allocate_as( *(LinSys_PETSC *)ls[0] );
+    assemble_stiffness_matrix();
+    for (unsigned int i=1; i<Model::n_substances(); i++)
+        if (stiffness_sharing_.repaired(i))
+            ls[i]->finish_assembly();
+    stiffness_sharing_.finish_assembly();
+}
+
+
+template<class Model>
+void TransportDG<Model>::repair_mass_matrix()
+{
+    START_TIMER("repair_mass");
+    // retardation vectors of all substances are assembled again
+    for (unsigned int i=0; i<Model::n_substances(); i++)
+    {
+        VecZeroEntries(ret_vec[i]);
+        if (mass_sharing_.repaired(i))
+            ( (LinSys_PETSC *)ls_dt[i] )->allocate_as( *(LinSys_PETSC *)ls_dt[0] );
+    }
+    assemble_mass_matrix();
+    for (unsigned int i=0; i<Model::n_substances(); i++)
+    {
+        if (mass_sharing_.repaired(i))
+            ls_dt[i]->finish_assembly();
+        VecAssemblyBegin(ret_vec[i]);
+        VecAssemblyEnd(ret_vec[i]);
+    }
+    mass_sharing_.finish_assembly();
+}
+
+
 template<class Model>
 void TransportDG<Model>::calculate_concentration_matrix()
 {
@@ -668,32 +804,33 @@ void TransportDG<Model>::assemble_mass_matrix()
     FEValues<dim,3> fe_values(*feo->mapping<dim>(), *feo->q<dim>(), *feo->fe<dim>(), update_values | update_JxW_values | update_quadrature_points);
     const unsigned int ndofs = feo->fe<dim>()->n_dofs(), qsize = feo->q<dim>()->size();
     vector<LongIdx> dof_indices(ndofs);
-    PetscScalar local_mass_matrix[ndofs*ndofs], local_retardation_balance_vector[ndofs];
+    vector<PetscScalar> local_mass_matrix(ndofs*ndofs), local_retardation_balance_vector(ndofs);
     vector<PetscScalar> local_mass_balance_vector(ndofs);
 
-    // assemble integral over elements
-    for (auto cell : feo->dh()->own_range() )
+    // assemble integral over elements, geometry of cells is computed in batches
+    for_each_cell_batched<dim>(*feo->dh(), {&fe_values}, [&](DHCellAccessor &cell, ElementAccessor<3> &elm)
     {
-        if (cell.dim() != dim) continue;
-        ElementAccessor<3> elm = cell.elm();
-
-        fe_values.reinit(elm);
         cell.get_dof_indices(dof_indices);
 
         Model::compute_mass_matrix_coefficient(fe_values.point_list(), elm, mm_coef);
         Model::compute_retardation_coefficient(fe_values.point_list(), elm, ret_coef);
+        mass_sharing_.compare_coefficients(ret_coef);
 
         for (unsigned int sbi=0; sbi<Model::n_substances(); ++sbi)
         {
             // assemble the local mass matrix
-            for (unsigned int i=0; i<ndofs; i++)
+            if (mass_sharing_.assembled(sbi))
             {
-                for (unsigned int j=0; j<ndofs; j++)
+                for (unsigned int i=0; i<ndofs; i++)
                 {
-                    local_mass_matrix[i*ndofs+j] = 0;
-                    for (unsigned int k=0; k<qsize; k++)
-                        local_mass_matrix[i*ndofs+j] += (mm_coef[k]+ret_coef[sbi][k])*fe_values.shape_value(j,k)*fe_values.shape_value(i,k)*fe_values.JxW(k);
+                    for (unsigned int j=0; j<ndofs; j++)
+                    {
+                        local_mass_matrix[i*ndofs+j] = 0;
+                        for (unsigned int k=0; k<qsize; k++)
+                            local_mass_matrix[i*ndofs+j] += (mm_coef[k]+ret_coef[sbi][k])*fe_values.shape_value(j,k)*fe_values.shape_value(i,k)*fe_values.JxW(k);
+                    }
                 }
+                ls_dt[sbi]->mat_set_values(ndofs, &(dof_indices[0]), ndofs, &(dof_indices[0]), &(local_mass_matrix[0]));
             }
 
             for (unsigned int i=0; i<ndofs; i++)
@@ -706,12 +843,11 @@ void TransportDG<Model>::assemble_mass_matrix()
                         local_retardation_balance_vector[i] -= ret_coef[sbi][k]*fe_values.shape_value(i,k)*fe_values.JxW(k);
                     }
             }
-            
+        
             Model::balance_->add_mass_matrix_values(Model::subst_idx[sbi], elm.region().bulk_idx(), dof_indices, local_mass_balance_vector);
-            ls_dt[sbi]->mat_set_values(ndofs, &(dof_indices[0]), ndofs, &(dof_indices[0]), local_mass_matrix);
-            VecSetValues(ret_vec[sbi], ndofs, &(dof_indices[0]), local_retardation_balance_vector, ADD_VALUES);
+            VecSetValues(ret_vec[sbi], ndofs, &(dof_indices[0]), &(local_retardation_balance_vector[0]), ADD_VALUES);
         }
-    }
+    });
 }
 
 
@@ -761,26 +897,25 @@ void TransportDG<Model>::assemble_volume_integrals()
     std::vector<LongIdx> dof_indices(ndofs);
     vector<arma::vec3> velocity(qsize);
     vector<vector<double> > sources_sigma(Model::n_substances(), std::vector<double>(qsize));
-    PetscScalar local_matrix[ndofs*ndofs];
+    vector<PetscScalar> local_matrix(ndofs*ndofs);
 
-    // assemble integral over elements
-    for (auto cell : feo->dh()->local_range() )
+    // assemble integral over elements, geometry of cells is computed in batches
+    for_each_cell_batched<dim>(*feo->dh(), {&fe_values, &fv_rt}, [&](DHCellAccessor &cell, ElementAccessor<3> &elm)
     {
-        if (!cell.is_own()) continue;
-        if (cell.dim() != dim) continue;
-        ElementAccessor<3> elm = cell.elm();
-
-        fe_values.reinit(elm);
-        fv_rt.reinit(elm);
         cell.get_dof_indices(dof_indices);
 
         calculate_velocity(elm, velocity, fv_rt);
         Model::compute_advection_diffusion_coefficients(fe_values.point_list(), velocity, elm, ad_coef, dif_coef);
         Model::compute_sources_sigma(fe_values.point_list(), elm, sources_sigma);
+        stiffness_sharing_.compare_coefficients(ad_coef);
+        stiffness_sharing_.compare_coefficients(dif_coef);
+        stiffness_sharing_.compare_coefficients(sources_sigma);
 
         // assemble the local stiffness matrix
         for (unsigned int sbi=0; sbi<Model::n_substances(); sbi++)
         {
+            if (!stiffness_sharing_.assembled(sbi)) continue;
+
             for (unsigned int i=0; i<ndofs; i++)
                 for (unsigned int j=0; j<ndofs; j++)
                     local_matrix[i*ndofs+j] = 0;
@@ -798,9 +933,9 @@ void TransportDG<Model>::assemble_volume_integrals()
                                                   +sources_sigma[sbi][k]*fe_values.shape_value(j,k)*fe_values.shape_value(i,k))*fe_values.JxW(k);
                 }
             }
-			ls[sbi]->mat_set_values(ndofs, &(dof_indices[0]), ndofs, &(dof_indices[0]), local_matrix);
+			ls[sbi]->mat_set_values(ndofs, &(dof_indices[0]), ndofs, &(dof_indices[0]), &(local_matrix[0]));
         }
-    }
+    });
 }
 
 
@@ -828,17 +963,13 @@ void TransportDG<Model>::set_sources()
             sources_sigma(Model::n_substances(), std::vector<double>(qsize));
     vector<LongIdx> dof_indices(ndofs);
     vector<LongIdx> loc_dof_indices(ndofs);
-    PetscScalar local_rhs[ndofs];
+    vector<PetscScalar> local_rhs(ndofs);
     vector<PetscScalar> local_source_balance_vector(ndofs), local_source_balance_rhs(ndofs);
     double source;
 
-    // assemble integral over elements
-    for (auto cell : feo->dh()->own_range() )
+    // assemble integral over elements, geometry of cells is computed in batches
+    for_each_cell_batched<dim>(*feo->dh(), {&fe_values}, [&](DHCellAccessor &cell, ElementAccessor<3> &elm)
     {
-        if (cell.dim() != dim) continue;
-        ElementAccessor<3> elm = cell.elm();
-
-        fe_values.reinit(elm);
         cell.get_dof_indices(dof_indices);
         cell.get_loc_dof_indices(loc_dof_indices);
 
@@ -847,7 +978,7 @@ void TransportDG<Model>::set_sources()
         // assemble the local stiffness matrix
         for (unsigned int sbi=0; sbi<Model::n_substances(); sbi++)
         {
-            fill_n(local_rhs, ndofs, 0);
+            local_rhs.assign(ndofs, 0);
             local_source_balance_vector.assign(ndofs, 0);
             local_source_balance_rhs.assign(ndofs, 0);
 
@@ -859,7 +990,7 @@ void TransportDG<Model>::set_sources()
                 for (unsigned int i=0; i<ndofs; i++)
                     local_rhs[i] += source*fe_values.shape_value(i,k);
             }
-            ls[sbi]->rhs_set_values(ndofs, &(dof_indices[0]), local_rhs);
+            ls[sbi]->rhs_set_values(ndofs, &(dof_indices[0]), &(local_rhs[0]));
 
             for (unsigned int i=0; i<ndofs; i++)
             {
@@ -871,7 +1002,7 @@ void TransportDG<Model>::set_sources()
             Model::balance_->add_source_values(Model::subst_idx[sbi], elm.region().bulk_idx(), loc_dof_indices,
                                                local_source_balance_vector, local_source_balance_rhs);
         }
-    }
+    });
 }
 
 
@@ -939,10 +1070,18 @@ void TransportDG<Model>::assemble_fluxes_element_element()
                 ++sid;
             }
             arma::vec3 normal_vector = fe_values[0]->normal_vector(0);
+            for (sid=0; sid<(int)cell_side.n_edge_sides(); sid++)
+            {
+                stiffness_sharing_.compare_coefficients(ad_coef_edg[sid]);
+                stiffness_sharing_.compare_coefficients(dif_coef_edg[sid]);
+                stiffness_sharing_.compare_coefficients(dg_penalty[sid]);
+            }
 
             // fluxes and penalty
             for (unsigned int sbi=0; sbi<Model::n_substances(); sbi++)
             {
+                if (!stiffness_sharing_.assembled(sbi)) continue;
+
                 vector<double> fluxes(cell_side.n_edge_sides());
                 double pflux = 0, nflux = 0; // calculate the total in- and out-flux through the edge
                 sid=0;
@@ -1088,8 +1227,8 @@ void TransportDG<Model>::assemble_fluxes_boundary()
     std::vector<LongIdx> side_dof_indices(ndofs);
     PetscScalar local_matrix[ndofs*ndofs];
     vector<arma::vec3> side_velocity;
-    vector<double> robin_sigma(qsize);
-    vector<double> csection(qsize);
+    vector<vector<double> > robin_sigma(Model::n_substances(), vector<double>(qsize));
+    vector<double> csection(qsize), dg_penalty(Model::n_substances());
     double gamma_l;
 
     // assemble boundary integral
@@ -1115,9 +1254,31 @@ void TransportDG<Model>::assemble_fluxes_boundary()
             arma::uvec bc_type;
             Model::get_bc_type(side.cond()->element_accessor(), bc_type);
             data_.cross_section.value_list(fe_values_side.point_list(), elm_acc, csection);
+            for (unsigned int sbi=0; sbi<Model::n_substances(); sbi++)
+            {
+                dg_penalty[sbi] = data_.dg_penalty[sbi].value(elm_acc.centre(), elm_acc);
+                if (bc_type[sbi] == AdvectionDiffusionModel::abc_total_flux
+                        || bc_type[sbi] == AdvectionDiffusionModel::abc_diffusive_flux)
+                    Model::get_flux_bc_sigma(sbi, fe_values_side.point_list(), side.cond()->element_accessor(), robin_sigma[sbi]);
+                else
+                    robin_sigma[sbi].assign(qsize, 0);
+            }
+            stiffness_sharing_.compare_coefficients(bc_type);
+            stiffness_sharing_.compare_coefficients(ad_coef);
+            stiffness_sharing_.compare_coefficients(dif_coef);
+            stiffness_sharing_.compare_coefficients(dg_penalty);
+            stiffness_sharing_.compare_coefficients(robin_sigma);
 
             for (unsigned int sbi=0; sbi<Model::n_substances(); sbi++)
             {
+                // substance sharing the matrix has the penalty of the first substance
+                if (!stiffness_sharing_.assembled(sbi))
+                {
+                    if (stiffness_sharing_.shared(sbi))
+                        gamma[sbi][side.cond_idx()] = gamma[0][side.cond_idx()];
+                    continue;
+                }
+
                 for (unsigned int i=0; i<ndofs; i++)
                     for (unsigned int j=0; j<ndofs; j++)
                         local_matrix[i*ndofs+j] = 0;
@@ -1132,7 +1293,7 @@ void TransportDG<Model>::assemble_fluxes_boundary()
                 if (bc_type[sbi] == AdvectionDiffusionModel::abc_dirichlet)
                 {
                     // set up the parameters for DG method
-                    set_DG_parameters_boundary(side, qsize, dif_coef[sbi], transport_flux, fe_values_side.normal_vector(0), data_.dg_penalty[sbi].value(elm_acc.centre(), elm_acc), gamma_l);
+                    set_DG_parameters_boundary(side, qsize, dif_coef[sbi], transport_flux, fe_values_side.normal_vector(0), dg_penalty[sbi], gamma_l);
                     gamma[sbi][side.cond_idx()] = gamma_l;
                     transport_flux += gamma_l;
                 }
@@ -1142,15 +1303,9 @@ void TransportDG<Model>::assemble_fluxes_boundary()
                 {
                     double flux_times_JxW;
                     if (bc_type[sbi] == AdvectionDiffusionModel::abc_total_flux)
-                    {
-                        Model::get_flux_bc_sigma(sbi, fe_values_side.point_list(), side.cond()->element_accessor(), robin_sigma);
-                        flux_times_JxW = csection[k]*robin_sigma[k]*fe_values_side.JxW(k);
-                    }
+                        flux_times_JxW = csection[k]*robin_sigma[sbi][k]*fe_values_side.JxW(k);
                     else if (bc_type[sbi] == AdvectionDiffusionModel::abc_diffusive_flux)
-                    {
-                        Model::get_flux_bc_sigma(sbi, fe_values_side.point_list(), side.cond()->element_accessor(), robin_sigma);
-                        flux_times_JxW = (transport_flux + csection[k]*robin_sigma[k])*fe_values_side.JxW(k);
-                    }
+                        flux_times_JxW = (transport_flux + csection[k]*robin_sigma[sbi][k])*fe_values_side.JxW(k);
                     else if (bc_type[sbi] == AdvectionDiffusionModel::abc_inflow && side_flux < 0)
                         flux_times_JxW = 0;
                     else
@@ -1201,7 +1356,7 @@ void TransportDG<Model>::assemble_fluxes_element_side()
     vector<LongIdx> indices(ndofs);
     unsigned int n_dofs[2], n_indices;
     vector<arma::vec3> velocity_higher, velocity_lower;
-    vector<double> frac_sigma(qsize);
+    vector<vector<double> > frac_sigma(Model::n_substances(), vector<double>(qsize));
     vector<double> csection_lower(qsize), csection_higher(qsize);
     PetscScalar local_matrix[4*ndofs*ndofs];
     double comm_flux[2][2];
@@ -1248,15 +1403,20 @@ void TransportDG<Model>::assemble_fluxes_element_side()
             Model::compute_advection_diffusion_coefficients(fe_values_vb.point_list(), velocity_higher, elm_higher_dim, ad_coef_edg[1], dif_coef_edg[1]);
             data_.cross_section.value_list(fe_values_vb.point_list(), elm_lower_dim, csection_lower);
             data_.cross_section.value_list(fe_values_vb.point_list(), elm_higher_dim, csection_higher);
+            for (unsigned int sbi=0; sbi<Model::n_substances(); sbi++)
+                data_.fracture_sigma[sbi].value_list(fe_values_vb.point_list(), elm_lower_dim, frac_sigma[sbi]);
+            stiffness_sharing_.compare_coefficients(ad_coef_edg[1]);
+            stiffness_sharing_.compare_coefficients(dif_coef_edg[0]);
+            stiffness_sharing_.compare_coefficients(frac_sigma);
 
             for (unsigned int sbi=0; sbi<Model::n_substances(); sbi++) // Optimize: SWAP LOOPS
             {
+                if (!stiffness_sharing_.assembled(sbi)) continue;
+
                 for (unsigned int i=0; i<n_dofs[0]+n_dofs[1]; i++)
                     for (unsigned int j=0; j<n_dofs[0]+n_dofs[1]; j++)
                         local_matrix[i*(n_dofs[0]+n_dofs[1])+j] = 0;
 
-                data_.fracture_sigma[sbi].value_list(fe_values_vb.point_list(), elm_lower_dim, frac_sigma);
-
                 // set transmission conditions
                 for (unsigned int k=0; k<qsize; k++)
                 {
@@ -1268,7 +1428,7 @@ void TransportDG<Model>::assemble_fluxes_element_side()
                     * than b and A in the manual.
                     * In calculation of sigma there appears one more csection_lower in the denominator.
                     */
-                    double sigma = frac_sigma[k]*arma::dot(dif_coef_edg[0][sbi][k]*fe_values_side.normal_vector(k),fe_values_side.normal_vector(k))*
+                    double sigma = frac_sigma[sbi][k]*arma::dot(dif_coef_edg[0][sbi][k]*fe_values_side.normal_vector(k),fe_values_side.normal_vector(k))*
                             2*csection_higher[k]*csection_higher[k]/(csection_lower[k]*csection_lower[k]);
 
                     double transport_flux = arma::dot(ad_coef_edg[1][sbi][k], fe_values_side.normal_vector(k));
@@ -1540,9 +1700,19 @@ void TransportDG<Model>::set_initial_condition()
     prepare_initial_condition<3>();
 
     for (unsigned int sbi=0; sbi<Model::n_substances(); sbi++)
-    {
         ls[sbi]->finish_assembly();
-        ls[sbi]->solve();
+    if (share_matrices_)
+    {
+        // the projection matrix is same for all substances
+        std::vector<LinSys_PETSC *> systems;
+        for (unsigned int sbi=0; sbi<Model::n_substances(); sbi++)
+            systems.push_back( (LinSys_PETSC *)ls[sbi] );
+        ( (LinSys_PETSC *)ls[0] )->solve_shared(systems);
+    }
+    else
+    {
+        for (unsigned int sbi=0; sbi<Model::n_substances(); sbi++)
+            ls[sbi]->solve();
     }
     END_TIMER("set_init_cond");
 }
@@ -1592,7 +1762,10 @@ void TransportDG<Model>::prepare_initial_condition()
                     rhs[i] += fe_values.shape_value(i,k)*rhs_term;
                 }
             }
-    		ls[sbi]->set_values(ndofs, &(dof_indices[0]), ndofs, &(dof_indices[0]), matrix, rhs);
+            if (sbi == 0 || !share_matrices_)
+                ls[sbi]->set_values(ndofs, &(dof_indices[0]), ndofs, &(dof_indices[0]), matrix, rhs);
+            else
+                ls[sbi]->rhs_set_values(ndofs, &(dof_indices[0]), rhs);
         }
     }
 }
@@ -1647,7 +1820,7 @@ void TransportDG<Model>::update_after_reactions(bool solution_changed)
     }
     // update mass_vec for the case that mass matrix changes in next time step
     for (unsigned int sbi=0; sbi<Model::n_substances(); ++sbi)
-        MatMult(*(ls_dt[sbi]->get_matrix()), ls[sbi]->get_solution(), mass_vec[sbi]);
+        MatMult(*(ls_dt[mass_owner(sbi)]->get_matrix()), ls[sbi]->get_solution(), mass_vec[sbi]);
 }
 
 template<class Model>
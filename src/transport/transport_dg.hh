@@ -118,6 +118,105 @@ private:
 
 
 
+/**
+ * Detection of substances whose matrix (stiffness or mass) is same as the matrix of the first substance.
+ *
+ * Such substances share the matrix of the first substance. Before the local matrices of a cell
+ * (side, edge) are integrated, the assembly passes the substance dependent coefficients to
+ * @p compare_coefficients and integrates only the substances for which @p assembled returns true.
+ * A shared substance whose coefficients equal the coefficients of the first substance
+ * is not integrated at all.
+ *
+ * If a difference is found, the substance stops sharing and its matrix has to be assembled
+ * by the repair pass: the whole assembly is repeated, but only the local matrices of the substances
+ * that stopped sharing are integrated.
+ *
+ * Every process compares only the coefficients of its own cells, so the flags are combined over
+ * all processes in @p finish_assembly. A substance stops sharing if it stopped on any process.
+ */
+class SubstanceMatrixSharing {
+public:
+    SubstanceMatrixSharing()
+    : comm_(MPI_COMM_WORLD),
+      repair_pass_(false)
+    {}
+
+    /**
+     * Set number of substances, all substances except the first one share its matrix if @p enable is true.
+     * @p comm is the communicator of the linear systems.
+     */
+    void initialize(unsigned int n_substances, bool enable, MPI_Comm comm);
+
+    /// Returns true if the substance @p sbi uses the matrix of the first substance.
+    inline bool shared(unsigned int sbi) const
+    { return shared_[sbi]; }
+
+    /// Returns true if the substance @p sbi stopped sharing and its matrix is assembled in the repair pass.
+    inline bool repaired(unsigned int sbi) const
+    { return repaired_[sbi]; }
+
+    /// Returns true if the local matrices of the substance @p sbi are integrated in the current pass.
+    inline bool assembled(unsigned int sbi) const
+    { return repair_pass_ ? repaired_[sbi] : !shared_[sbi] && !repaired_[sbi]; }
+
+    /**
+     * Compare coefficients @p coef[sbi] of the shared substances with @p coef[0],
+     * substances with different coefficients stop sharing. Has to be called for every
+     * substance dependent coefficient entering the local matrices, before they are integrated.
+     */
+    template <class Coefs>
+    void compare_coefficients(const Coefs &coef)
+    {
+        if (repair_pass_ || !any_shared_) return;
+        for (unsigned int sbi=1; sbi<shared_.size(); sbi++)
+            if (shared_[sbi] && !same_values(coef[sbi], coef[0])) stop_sharing(sbi);
+    }
+
+    /// Start assembly.
+    void start_assembly();
+
+    /**
+     * Finish the assembly. Returns true if some substances stopped sharing, then the assembly has to be
+     * repeated as the repair pass (without call of @p start_assembly) and finished again.
+     * Collective, the result is same on all processes.
+     */
+    bool finish_assembly();
+
+private:
+    /// Stop sharing of the substance @p sbi.
+    void stop_sharing(unsigned int sbi);
+
+    static bool same_values(double a, double b)
+    { return a == b; }
+
+    static bool same_values(arma::uword a, arma::uword b)
+    { return a == b; }
+
+    static bool same_values(const arma::mat &a, const arma::mat &b)
+    { return a.n_elem == b.n_elem && std::equal(a.begin(), a.end(), b.begin()); }
+
+    template <class T>
+    static bool same_values(const std::vector<T> &a, const std::vector<T> &b)
+    {
+        if (a.size() != b.size()) return false;
+        for (unsigned int i=0; i<a.size(); i++)
+            if (!same_values(a[i], b[i])) return false;
+        return true;
+    }
+
+    /// Combine the flags of sharing over all processes, stop sharing of substances that stopped on any process.
+    void synchronize();
+
+    MPI_Comm comm_;
+    std::vector<char> shared_;
+    std::vector<char> repaired_;
+    /// True if some substance shares the matrix, i.e. the coefficients are compared.
+    bool any_shared_;
+    bool repair_pass_;
+};
+
+
+
 /**
  * @brief Transport with dispersion implemented using discontinuous Galerkin method.
  *
@@ -376,6 +475,24 @@ private:
 	            double &gamma);
 
 
+	/// Index of the substance whose stiffness matrix is used by the substance @p sbi.
+	inline unsigned int stiffness_owner(unsigned int sbi) const
+	{ return stiffness_sharing_.shared(sbi) ? 0 : sbi; }
+
+	/// Index of the substance whose mass matrix is used by the substance @p sbi.
+	inline unsigned int mass_owner(unsigned int sbi) const
+	{ return mass_sharing_.shared(sbi) ? 0 : sbi; }
+
+	/// Returns true if the substance @p sbi is solved with the system matrix of the first substance.
+	inline bool shares_system(unsigned int sbi) const
+	{ return sbi > 0 && stiffness_sharing_.shared(sbi) && mass_sharing_.shared(sbi); }
+
+	/// Assemble stiffness matrices of substances that stopped sharing in the last assembly.
+	void repair_stiffness_matrix();
+
+	/// Assemble mass matrices of substances that stopped sharing in the last assembly.
+	void repair_mass_matrix();
+
 	/**
 	 * @brief Sets the initial condition.
 	 */
@@ -445,6 +562,15 @@ private:
 	/// Element averages of solution (the array is passed to reactions in operator splitting).
 	double **solution_elem_;
 
+	/// Substances with same coefficients share matrices and are solved together.
+	bool share_matrices_;
+
+	/// Detection of substances sharing the stiffness matrix of the first substance.
+	SubstanceMatrixSharing stiffness_sharing_;
+
+	/// Detection of substances sharing the mass matrix of the first substance.
+	SubstanceMatrixSharing mass_sharing_;
+
 	// @}
 
 
@@ -86,6 +86,9 @@ const Record & TransportOperatorSplitting::get_input_type() {
 				"Type of the numerical method for the transport equation.")
 		.declare_key("reaction_term", ReactionTerm::it_abstract_term(), Default::optional(),
 					"Reaction model involved in transport.")
+		.declare_key("element_major_reactions", Bool(), Default("false"),
+					"If true, reactions work with a copy of concentrations stored element by element "
+					"(values of all substances on an element are contiguous in memory).")
 /*
 		.declare_key("output_fields", Array(ConvectionTransport::get_output_selection()),
 				Default("\"conc\""),
@@ -207,9 +210,13 @@ TransportOperatorSplitting::TransportOperatorSplitting(Mesh &init_mesh, const In
         shared_ptr<DiscreteSpace> ds = make_shared<EqualOrderDiscreteSpace>( mesh_, &fe0, &fe1, &fe2, &fe3);
         dof_handler->distribute_dofs(ds);
 
+        if (in_rec.val<bool>("element_major_reactions"))
+            conc_buffer_ = std::make_shared<ConcentrationBuffer>(convection->n_substances(), el_distribution->lsize());
+
         reaction->substances(convection->substances())
                     .concentration_matrix(convection->get_concentration_matrix(),
 						el_distribution, el_4_loc, convection->get_row_4_el())
+				.concentration_buffer(conc_buffer_)
 				.output_stream(convection->output_stream())
 				.set_dh(dof_handler)
 				.set_time_governor((TimeGovernor &)convection->time());
@@ -328,7 +335,9 @@ void TransportOperatorSplitting::update_solution() {
 
         if(reaction) {
         	convection->calculate_concentration_matrix();
+        	if (conc_buffer_) conc_buffer_->gather(convection->get_concentration_matrix());
         	reaction->update_solution();
+        	if (conc_buffer_) conc_buffer_->scatter(convection->get_concentration_matrix());
         	convection->update_after_reactions(true);
         }
         else
@@ -38,6 +38,7 @@
 /// external types:
 class Mesh;
 class ReactionTerm;
+class ConcentrationBuffer;
 class Balance;
 class Distribution;
 class MH_DofHandler;
@@ -247,6 +248,9 @@ private:
     std::shared_ptr<ConcentrationTransportBase> convection;
     std::shared_ptr<ReactionTerm> reaction;
 
+    /// Element-major copy of concentrations used by reactions (optional).
+    std::shared_ptr<ConcentrationBuffer> conc_buffer_;
+
     //double *** semchem_conc_ptr;   //dumb 3-dim array (for phases, which are not supported any more)
     //Semchem_interface *Semchem_reactions;
     
@@ -152,3 +152,94 @@ TEST(ElementMapping, element_map) {
         //EXPECT_ARMA_EQ( arma::vec("0.1 0.2 0.3 0.4"), mapping.project_real_to_unit( arma::vec3("0.1 0.2 0.3"), map ) );
     }
 }
+
+
+template <int dim>
+void test_batch_reinit(Mesh &mesh)
+{
+    FE_P<dim> fe(2);
+    QGauss<dim> quad(2);
+    MappingP1<dim,3> map;
+    UpdateFlags flags = update_values | update_gradients | update_JxW_values | update_quadrature_points;
+    FEValues<dim,3> fe_values(map, quad, fe, flags), fe_values_batch(map, quad, fe, flags);
+
+    std::vector<ElementAccessor<3> > cells;
+    for (unsigned int i=0; i<mesh.n_elements(); i++)
+        cells.push_back(mesh.element_accessor(i));
+
+    fe_values_batch.reinit_batch(cells.data(), cells.size());
+    for (unsigned int i_cell=0; i_cell<cells.size(); i_cell++)
+    {
+        fe_values.reinit(cells[i_cell]);
+        fe_values_batch.reinit_batch_cell(i_cell);
+        for (unsigned int k=0; k<quad.size(); k++)
+        {
+            EXPECT_NEAR( fe_values.JxW(k), fe_values_batch.JxW(k), 1e-12 );
+            EXPECT_LT( arma::norm(fe_values.point(k) - fe_values_batch.point(k)), 1e-12 );
+            for (unsigned int i=0; i<fe.n_dofs(); i++)
+            {
+                EXPECT_DOUBLE_EQ( fe_values.shape_value(i,k), fe_values_batch.shape_value(i,k) );
+                EXPECT_LT( arma::norm(fe_values.shape_grad(i,k) - fe_values_batch.shape_grad(i,k)), 1e-10 );
+            }
+        }
+    }
+}
+
+
+TEST(FeValues, reinit_batch) {
+    armadillo_setup();
+    {
+        // three segments of different directions (pseudoinverse of the Jacobian)
+        Mesh mesh;
+        mesh.init_node_vector(3);
+        mesh.add_node(0, arma::vec3("0 0 0"));
+        mesh.add_node(1, arma::vec3("1 2 3"));
+        mesh.add_node(2, arma::vec3("-1 0.5 2"));
+        mesh.init_element_vector(3);
+        std::vector<unsigned int> node_ids = {0, 1};
+        mesh.add_element(0, 1, 1, 0, node_ids);
+        node_ids = {1, 2};
+        mesh.add_element(1, 1, 1, 0, node_ids);
+        node_ids = {2, 0};
+        mesh.add_element(2, 1, 1, 0, node_ids);
+
+        test_batch_reinit<1>(mesh);
+    }
+
+    {
+        // two triangles in a tilted plane
+        Mesh mesh;
+        mesh.init_node_vector(4);
+        mesh.add_node(0, arma::vec3("0 1 0"));
+        mesh.add_node(1, arma::vec3("2 0 1"));
+        mesh.add_node(2, arma::vec3("3 4 2"));
+        mesh.add_node(3, arma::vec3("-1 3 1"));
+        mesh.init_element_vector(2);
+        std::vector<unsigned int> node_ids = {0, 1, 2};
+        mesh.add_element(0, 2, 1, 0, node_ids);
+        node_ids = {0, 2, 3};
+        mesh.add_element(1, 2, 1, 0, node_ids);
+
+        test_batch_reinit<2>(mesh);
+    }
+
+    {
+        // three tetrahedra of different orientation
+        Mesh mesh;
+        mesh.init_node_vector(5);
+        mesh.add_node(0, arma::vec3("0 0 0"));
+        mesh.add_node(1, arma::vec3("1 0.2 0"));
+        mesh.add_node(2, arma::vec3("0.1 1 0"));
+        mesh.add_node(3, arma::vec3("0 0.3 2"));
+        mesh.add_node(4, arma::vec3("1 1 -1"));
+        mesh.init_element_vector(3);
+        std::vector<unsigned int> node_ids = {0, 1, 2, 3};
+        mesh.add_element(0, 3, 1, 0, node_ids);
+        node_ids = {0, 2, 1, 4};
+        mesh.add_element(1, 3, 1, 0, node_ids);
+        node_ids = {1, 2, 3, 4};
+        mesh.add_element(2, 3, 1, 0, node_ids);
+
+        test_batch_reinit<3>(mesh);
+    }
+}
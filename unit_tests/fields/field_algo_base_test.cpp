@@ -794,6 +794,79 @@ TEST(Field, field_result) {
 
 
 
+string value_cache_input = R"INPUT(
+[
+    { region="1D diagonal", scalar=1 },
+    { region="2D XY diagonal", scalar=2 },
+    { region="3D front", scalar=3 },
+    { region="3D back", scalar={TYPE="FieldFormula", value="x+t"} },
+    { time=1.0, region="1D diagonal", scalar=4 }
+]
+)INPUT";
+
+TEST(Field, value_cache) {
+    Profiler::initialize();
+    FilePath::set_io_dirs(".",UNIT_TESTS_SRC_DIR,"",".");
+
+    TimeGovernor tg(0.0, 0.5);
+    Mesh * mesh = mesh_full_constructor("{mesh_file=\"mesh/simplest_cube.msh\"}");
+
+    it::Array main_array =IT::Array(
+            TestFieldSet().make_field_descriptor_type("TestFieldSet")
+            .close()
+        );
+    Input::ReaderToStorage reader( value_cache_input, main_array, Input::FileFormat::format_JSON );
+    Input::Array array=reader.get_root_interface<Input::Array>();
+
+    TestFieldSet data;
+    data.set_mesh(*mesh);
+    data.set_input_list(array, tg);
+    data.scalar.enable_value_cache();
+
+    auto expected_value = [](const ElementAccessor<3> &elm, const Space<3>::Point &p, double t) -> double {
+        std::string label = elm.region().label();
+        if (label == "1D diagonal") return (t < 1.0) ? 1.0 : 4.0;
+        if (label == "2D XY diagonal") return 2.0;
+        if (label == "3D front") return 3.0;
+        return p(0) + t;
+    };
+
+    std::vector< Space<3>::Point > point_list(2);
+    std::vector<double> value_list(2);
+    for (unsigned int step=0; step<3; step++) {
+        if (step > 0) tg.next_time();
+        data.scalar.set_time(tg.step(), LimitSide::right);
+        double t = tg.t();
+
+        // evaluate twice, the second pass reads cached values
+        for (unsigned int pass=0; pass<2; pass++)
+            for (auto elm : mesh->elements_range()) {
+                Space<3>::Point centre = elm.centre();
+                EXPECT_DOUBLE_EQ( expected_value(elm, centre, t), data.scalar.value(centre, elm) );
+
+                point_list[0] = centre;
+                point_list[1] = elm.node(0)->point();
+                data.scalar.value_list(point_list, elm, value_list);
+                EXPECT_DOUBLE_EQ( expected_value(elm, point_list[0], t), value_list[0] );
+                EXPECT_DOUBLE_EQ( expected_value(elm, point_list[1], t), value_list[1] );
+            }
+
+        // reference to a cached value stays valid while values in new points are stored
+        // (constant regions bypass the cache, use an element of the formula region)
+        ElementAccessor<3> first;
+        for (auto elm : mesh->elements_range())
+            if (elm.region().label() == "3D back") { first = elm; break; }
+        const double &first_value = data.scalar.value(first.centre(), first);
+        for (auto elm : mesh->elements_range())
+            data.scalar.value(elm.node(1)->point(), elm);
+        EXPECT_DOUBLE_EQ( expected_value(first, first.centre(), t), first_value );
+    }
+
+    delete mesh;
+}
+
+
+
 static const it::Selection &get_test_type_selection() {
 	return it::Selection("TestType")
 				.add_value(0, "none")
@@ -243,6 +243,57 @@ TEST(FieldFormula, set_time) {
 }
 
 
+string value_list_input = R"INPUT(
+[
+      { TYPE="FieldFormula",  value=["x", "x*y+t", "sin(x)*cos(y)+exp(-z^2)"] },
+      { TYPE="FieldFormula",  value=["if(x>0.5, x, y)", "min(x,y)+max(y,z)", "sqrt(x*x+y*y)+z%0.3"] },
+      { TYPE="FieldFormula",  value=["1/(x-1)", "log(y)", "(x+y)^(1/3)"], unit="g*cm^-3" }
+]
+
+)INPUT";
+
+
+TEST(FieldFormula, value_list) {
+    typedef FieldAlgorithmBase<3, FieldValue<3>::VectorFixed > VectorField;
+
+    Profiler::initialize();
+
+    // setup FilePath directories
+    FilePath::set_io_dirs(".",UNIT_TESTS_SRC_DIR,"",".");
+
+    Input::Type::Array  input_type(VectorField::get_input_type_instance());
+    input_type.finish();
+
+    // read input string
+    Input::ReaderToStorage reader( value_list_input, input_type, Input::FileFormat::format_JSON );
+    Input::Array in_array=reader.get_root_interface<Input::Array>();
+
+    // more points than one evaluation block, some of them hit the division by zero and log of zero
+    unsigned int n_points = 150;
+    std::vector< Space<3>::Point > point_list(n_points);
+    for (unsigned int i=0; i<n_points; i++) {
+        point_list[i](0) = 0.02 * i - 1.0;
+        point_list[i](1) = (i%10) * 0.1;
+        point_list[i](2) = 0.5 - 0.01 * i;
+    }
+    ElementAccessor<3> elm;
+
+    FieldAlgoBaseInitData init_data("formula", 3, UnitSI().kg().m(-3));
+    for (auto it = in_array.begin<Input::AbstractRecord>(); it != in_array.end(); ++it) {
+        auto field=VectorField::function_factory(*it, init_data);
+        field->set_time(0.5);
+
+        std::vector< arma::vec3 > value_list(n_points);
+        field->value_list(point_list, elm, value_list);
+        for (unsigned int i=0; i<n_points; i++) {
+            arma::vec3 expected = field->value(point_list[i], elm);
+            for (unsigned int j=0; j<3; j++)
+                EXPECT_EQ( expected(j), value_list[i](j) ) << "point: " << i << " component: " << j;
+        }
+    }
+}
+
+
 TEST(SurfaceDepth, base_test) {
     Profiler::initialize();
 	FilePath::set_io_dirs(".",UNIT_TESTS_SRC_DIR,"",".");
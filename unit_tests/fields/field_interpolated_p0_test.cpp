@@ -39,6 +39,7 @@
 #include "input/type_output.hh"
 
 #include "mesh/mesh.h"
+#include "mesh/accessors.hh"
 #include "io/msh_gmshreader.h"
 
 #include "fields/field_interpolated_p0.hh"
@@ -187,6 +188,55 @@ TEST_F(FieldInterpolatedP0Test, 1d_2d_elements_small) {
 
 }
 
+class RemapScalarField : public FieldInterpolatedP0<3, FieldValue<3>::Scalar > {
+public:
+    bool row_computed(const ElementAccessor<3> &elm) const {
+        const std::vector<RemapRow> &rows = remap_rows_[elm.is_boundary()];
+        return elm.idx() < rows.size() && rows[elm.idx()].computed;
+    }
+};
+
+
+TEST_F(FieldInterpolatedP0Test, remapping) {
+    // target mesh with input record, intersection_threads key is used for rows of a region
+    Mesh * target_mesh = new Mesh( Input::Record() );
+    auto mesh_reader = reader_constructor("{mesh_file=\"fields/interpolate_source.msh\"}");
+    mesh_reader->read_physical_names(target_mesh);
+    mesh_reader->read_raw_mesh(target_mesh);
+
+    // remapping matrix computed by regions of the mesh given by set_mesh and row by row in value()
+    RemapScalarField field;
+    ScalarField lazy_field;
+    field.init_from_input(rec.val<Input::Record>("scalar"), init_data("scalar"));
+    lazy_field.init_from_input(rec.val<Input::Record>("scalar"), init_data("scalar"));
+    field.set_mesh(target_mesh, false);
+    field.set_mesh(target_mesh, true);
+
+    unsigned int n_bulk = target_mesh->n_elements(), n_all = n_bulk + target_mesh->n_elements(true);
+
+    // rows are computed only for the region of the evaluated element
+    field.set_time(test_time[0]);
+    field.value(point, target_mesh->element_accessor(0));
+    for (unsigned int i=0; i<n_all; i++) {
+        ElementAccessor<3> elm = target_mesh->element_accessor(i);
+        bool same_region = (elm.region_idx().idx() == target_mesh->element_accessor(0).region_idx().idx());
+        EXPECT_EQ( same_region, field.row_computed(elm) );
+    }
+
+    for (unsigned int j=1; j<3; j++) {
+        field.set_time(test_time[j-1]);
+        lazy_field.set_time(test_time[j-1]);
+        for (unsigned int i=0; i<n_all; i++) {
+            ElementAccessor<3> elm = target_mesh->element_accessor(i);
+            if (elm.dim() == 3) continue;
+            EXPECT_DOUBLE_EQ( lazy_field.value(point, elm), field.value(point, elm) );
+        }
+    }
+    EXPECT_DOUBLE_EQ( 2*0.650, field.value(point, target_mesh->element_accessor(0)) );
+
+    delete target_mesh;
+}
+
 /*TEST_F(FieldInterpolatedP0Test, 1d_2d_elements_unit_conversion) {
     ScalarField field;
     field.init_from_input(rec.val<Input::Record>("scalar_unit_conversion"), init_data("scalar_unit_conversion"));
@@ -47,6 +47,7 @@ using namespace std;
 
 static const int loop_call_count = 100000;
 static const int list_size = 10;
+static const int long_list_size = 100;
 
 
 string field_input = R"JSON(
@@ -383,6 +384,53 @@ TYPED_TEST(FieldSpeed, field_formula_full) {
 }
 
 
+// Same as field_formula_full, values are read from the value cache after the first evaluation.
+TYPED_TEST(FieldSpeed, field_formula_full_cached) {
+	this->set_values();
+	string key_name = "formula_full_" + this->input_type_name_;
+	this->read_input(key_name);
+	this->field_.enable_value_cache();
+
+	START_TIMER("field_formula_full_cached");
+	this->call_test();
+	END_TIMER("field_formula_full_cached");
+
+	this->test_result( this->expect_formula_full_val_, 21 );
+	this->profiler_output();
+}
+
+
+// Compare evaluation of long point list point by point and by blocks of points (value_list).
+TYPED_TEST(FieldSpeed, field_formula_full_long_list) {
+	this->set_values();
+	string key_name = "formula_full_" + this->input_type_name_;
+	this->read_input(key_name);
+	std::vector< typename TestFixture::Point > point_list(long_list_size, this->point_);
+	std::vector< typename TestFixture::ReturnType > value_list(long_list_size);
+
+	START_TIMER("field_formula_full_long_list");
+	START_TIMER("all_values");
+	for (int i=0; i<loop_call_count/long_list_size; i++)
+		for (auto elm : this->mesh_->elements_range())
+			for (int j=0; j<long_list_size; j++) {
+				this->test_result_sum_ += this->field_.value( point_list[j], elm);
+			}
+	END_TIMER("all_values");
+
+	START_TIMER("value_list");
+	for (int i=0; i<loop_call_count/long_list_size; i++)
+		for (auto elm : this->mesh_->elements_range()) {
+			this->field_.value_list( point_list, elm, value_list);
+			for (int j=0; j<long_list_size; j++) this->test_result_sum_ += value_list[j];
+		}
+	END_TIMER("value_list");
+	END_TIMER("field_formula_full_long_list");
+
+	this->test_result( this->expect_formula_full_val_, 2 );
+	this->profiler_output();
+}
+
+
 TYPED_TEST(FieldSpeed, field_formula_depth) {
 	this->set_values("0 0 0");
 	string key_name = "formula_depth_" + this->input_type_name_;
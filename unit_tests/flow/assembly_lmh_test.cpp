@@ -0,0 +1,102 @@
+/*
+ * assembly_lmh_test.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include <flow_gtest.hh>
+
+#include <armadillo>
+#include "flow/richards_lmh.hh"
+#include "flow/assembly_lmh.hh"
+#include "flow/soil_models.hh"
+
+
+class AssemblyLMHJacobianTest : public testing::Test {
+protected:
+    AssemblyLMHJacobianTest()
+    : sides_matrix_base({{2.0, -0.5, 0.3}, {-0.5, 1.5, 0.2}, {0.3, 0.2, 1.0}}),
+      flux({1.0, -2.0, 0.5})
+    {
+        SoilData soil_data;
+        soil_data.n = 1.24;
+        soil_data.alpha = 0.5;
+        soil_data.Qr = 0.04;
+        soil_data.Qs = 0.42;
+        soil_data.Ks = 1.0;
+        soil_data.cut_fraction = 0.999;
+        soil_model.reset(soil_data);
+    }
+
+    /// Mean of the conductivities in the edges, as in AssemblyLMH::assemble_sides.
+    double conductivity(const arma::vec &phead) {
+        double cond = 0;
+        for (unsigned int i=0; i<phead.n_elem; i++) cond += soil_model.conductivity(phead[i]);
+        return cond / phead.n_elem;
+    }
+
+    /// Flux equations, the scaled sides matrix times the fluxes.
+    arma::vec flux_residual(const arma::vec &phead) {
+        return sides_matrix_base * flux / conductivity(phead);
+    }
+
+    arma::mat jacobian(const arma::vec &phead) {
+        double cond = conductivity(phead);
+        return AssemblyLMH<2>::conductivity_jacobian(sides_matrix_base / cond, flux, phead, soil_model, cond);
+    }
+
+    SoilModel_VanGenuchten soil_model;
+    arma::mat sides_matrix_base;
+    arma::vec flux;
+};
+
+
+TEST_F(AssemblyLMHJacobianTest, finite_differences) {
+    arma::vec phead({-0.5, -3.0, -10.0});
+    arma::mat jac = jacobian(phead);
+
+    for (unsigned int j=0; j<phead.n_elem; j++) {
+        double h = 1e-6 * std::abs(phead[j]);
+        arma::vec phead_p = phead, phead_m = phead;
+        phead_p[j] += h;
+        phead_m[j] -= h;
+        arma::vec fd_col = (flux_residual(phead_p) - flux_residual(phead_m)) / (2 * h);
+        for (unsigned int i=0; i<phead.n_elem; i++)
+            EXPECT_NEAR(fd_col[i], jac(i,j), 1e-6 * arma::abs(fd_col).max());
+    }
+
+    // saturated edges do not contribute
+    arma::vec phead_sat({1.0, -3.0, 2.0});
+    arma::mat jac_sat = jacobian(phead_sat);
+    for (unsigned int i=0; i<phead.n_elem; i++) {
+        EXPECT_EQ(0.0, jac_sat(i,0));
+        EXPECT_EQ(0.0, jac_sat(i,2));
+    }
+}
+
+
+TEST_F(AssemblyLMHJacobianTest, newton_convergence) {
+    // find the pressure heads giving the prescribed flux equations
+    arma::vec phead_exact({-0.5, -1.0, -2.0});
+    arma::vec rhs = flux_residual(phead_exact);
+
+    // the flux equations depend on the mean conductivity only,
+    // so keep the differences of the pressure heads and solve for their common shift
+    arma::vec phead({-0.2, -0.7, -1.7});
+    double residual_norm = arma::norm(flux_residual(phead) - rhs);
+    unsigned int n_it = 0;
+    for(; n_it < 20 && residual_norm > 1e-12 * arma::norm(rhs); n_it++) {
+        arma::vec residual = flux_residual(phead) - rhs;
+        arma::vec jac_shift = arma::sum(jacobian(phead), 1);
+        double shift = - arma::dot(jac_shift, residual) / arma::dot(jac_shift, jac_shift);
+        phead += shift;
+        double new_residual_norm = arma::norm(flux_residual(phead) - rhs);
+        // quadratic convergence near the solution
+        if (residual_norm < 1e-3 * arma::norm(rhs))
+            EXPECT_LT(new_residual_norm, 10 * residual_norm * residual_norm / arma::norm(rhs));
+        residual_norm = new_residual_norm;
+    }
+    EXPECT_LT(n_it, 8u);
+    for (unsigned int i=0; i<phead.n_elem; i++)
+        EXPECT_NEAR(phead_exact[i], phead[i], 1e-8);
+}
@@ -0,0 +1,110 @@
+/*
+ * darcy_threaded_assembly_test.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#define TEST_USE_MPI
+#define FEAL_OVERRIDE_ASSERTS
+#include <flow_gtest_mpi.hh>
+#include <mesh_constructor.hh>
+
+#include <string>
+#include "flow/darcy_flow_mh.hh"
+#include "la/linsys.hh"
+#include "input/reader_to_storage.hh"
+#include "input/accessors.hh"
+#include "system/sys_profiler.hh"
+#include "system/file_path.hh"
+#include "mesh/mesh.h"
+
+
+/// Steady flow on the mixed mesh with Dirichlet and Robin conditions, assembled by THREADS threads.
+const string darcy_input = R"INPUT(
+{
+    n_schurs=0,
+    assembly_threads=THREADS,
+    input_fields=[
+        { region="BULK", conductivity=0.5, anisotropy=[[2, 0, 0], [0, 1, 0], [0, 0, 1]], water_source_density=0.1 },
+        { region="1D diagonal", cross_section=0.01, sigma=2.0 },
+        { region="2D XY diagonal", cross_section=0.1, sigma=3.0 },
+        { region=".top side", bc_type="dirichlet", bc_pressure=1.0 },
+        { region=".bottom side", bc_type="total_flux", bc_pressure=-1.0, bc_flux=0.5, bc_robin_sigma=2.0 }
+    ],
+    output_stream={ file="darcy_THREADS.pvd" }
+}
+)INPUT";
+
+
+/// Gives access to the assembled linear system.
+class DarcyMHAssembly : public DarcyMH {
+public:
+    DarcyMHAssembly(Mesh &mesh, const Input::Record in_rec)
+    : DarcyMH(mesh, in_rec) {}
+
+    /// Assemble the system again and store copies of its matrix and right hand side.
+    void copy_system(Mat &matrix, Vec &rhs) {
+        data_changed_ = true;
+        assembly_linear_system();
+        MatDuplicate(*schur0->get_matrix(), MAT_COPY_VALUES, &matrix);
+        VecDuplicate(*schur0->get_rhs(), &rhs);
+        VecCopy(*schur0->get_rhs(), rhs);
+    }
+};
+
+
+class DarcyThreadedAssemblyTest : public testing::Test {
+protected:
+    DarcyThreadedAssemblyTest() {
+        FilePath::set_io_dirs(".",UNIT_TESTS_SRC_DIR,"",".");
+        Profiler::initialize();
+        mesh_ = mesh_full_constructor("{mesh_file=\"mesh/simplest_cube.msh\"}");
+    }
+
+    ~DarcyThreadedAssemblyTest() {
+        delete mesh_;
+    }
+
+    void assemble(unsigned int n_threads, Mat &matrix, Vec &rhs) {
+        std::string input_str = darcy_input;
+        for (size_t pos = input_str.find("THREADS"); pos != std::string::npos; pos = input_str.find("THREADS"))
+            input_str.replace(pos, 7, std::to_string(n_threads));
+        Input::Record in_rec = Input::ReaderToStorage( input_str,
+                const_cast<Input::Type::Record &>(DarcyMH::get_input_type()), Input::FileFormat::format_JSON )
+                .get_root_interface<Input::Record>();
+
+        DarcyMHAssembly flow(*mesh_, in_rec);
+        flow.initialize();
+        flow.zero_time_step();
+        flow.copy_system(matrix, rhs);
+    }
+
+    Mesh *mesh_;
+};
+
+
+TEST_F(DarcyThreadedAssemblyTest, serial_equals_threaded) {
+    Mat serial_matrix, threaded_matrix;
+    Vec serial_rhs, threaded_rhs;
+    assemble(1, serial_matrix, serial_rhs);
+    assemble(4, threaded_matrix, threaded_rhs);
+
+    // buffers of the threads are passed to the system in the element order, so the systems are the same
+    PetscReal norm;
+    MatNorm(serial_matrix, NORM_FROBENIUS, &norm);
+    EXPECT_GT(norm, 0.0);
+    MatAXPY(threaded_matrix, -1.0, serial_matrix, DIFFERENT_NONZERO_PATTERN);
+    MatNorm(threaded_matrix, NORM_FROBENIUS, &norm);
+    EXPECT_EQ(0.0, norm);
+
+    VecNorm(serial_rhs, NORM_2, &norm);
+    EXPECT_GT(norm, 0.0);
+    VecAXPY(threaded_rhs, -1.0, serial_rhs);
+    VecNorm(threaded_rhs, NORM_2, &norm);
+    EXPECT_EQ(0.0, norm);
+
+    MatDestroy(&serial_matrix);
+    MatDestroy(&threaded_matrix);
+    VecDestroy(&serial_rhs);
+    VecDestroy(&threaded_rhs);
+}
@@ -0,0 +1,105 @@
+/*
+ * richards_newton_test.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#define TEST_USE_MPI
+#define FEAL_OVERRIDE_ASSERTS
+#include <flow_gtest_mpi.hh>
+#include <mesh_constructor.hh>
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include "flow/richards_lmh.hh"
+#include "input/reader_to_storage.hh"
+#include "input/accessors.hh"
+#include "system/sys_profiler.hh"
+#include "system/file_path.hh"
+#include "mesh/mesh.h"
+
+
+/// Single unsteady time step of an unsaturated flow, the pressure head is fixed on the top and bottom side.
+const string richards_input = R"INPUT(
+{
+    time={ end_time=1, init_dt=1, min_dt=1, max_dt=1 },
+    n_schurs=2,
+    nonlinear_solver={
+        method="METHOD",
+        tolerance=1e-10,
+        max_it=100,
+        converge_on_stagnation=true,
+        linear_solver={ TYPE="Petsc", r_tol=1e-14, a_tol=1e-14 }
+    },
+    input_fields=[
+        {
+            region="BULK",
+            conductivity=1.0,
+            water_content_saturated=0.42,
+            water_content_residual=0.04,
+            genuchten_n_exponent=1.24,
+            genuchten_p_head_scale=0.5,
+            init_pressure=-2.0
+        },
+        { region=".top side", bc_type="dirichlet", bc_pressure=-5.0 },
+        { region=".bottom side", bc_type="dirichlet", bc_pressure=0.0 }
+    ],
+    output_stream={ file="richards_METHOD.pvd" },
+    balance={ add_output_times=false }
+}
+)INPUT";
+
+
+class RichardsNewtonTest : public testing::Test {
+protected:
+    RichardsNewtonTest() {
+        FilePath::set_io_dirs(".",UNIT_TESTS_SRC_DIR,"",".");
+        Profiler::initialize();
+        mesh_ = mesh_full_constructor("{mesh_file=\"mesh/simplest_cube.msh\"}");
+    }
+
+    ~RichardsNewtonTest() {
+        delete mesh_;
+    }
+
+    /// Solve the time step by the nonlinear @p method, return number of nonlinear iterations.
+    unsigned int solve(const std::string &method, std::vector<double> &solution) {
+        std::string input_str = richards_input;
+        for (size_t pos = input_str.find("METHOD"); pos != std::string::npos; pos = input_str.find("METHOD"))
+            input_str.replace(pos, 6, method);
+        Input::Record in_rec = Input::ReaderToStorage( input_str,
+                const_cast<Input::Type::Record &>(RichardsLMH::get_input_type()), Input::FileFormat::format_JSON )
+                .get_root_interface<Input::Record>();
+
+        RichardsLMH flow(*mesh_, in_rec);
+        flow.initialize();
+        flow.zero_time_step();
+        flow.update_solution();
+
+        double *array;
+        unsigned int size;
+        flow.get_solution_vector(array, size);
+        solution.assign(array, array + size);
+        return flow.n_nonlinear_iterations();
+    }
+
+    Mesh *mesh_;
+};
+
+
+TEST_F(RichardsNewtonTest, newton_schur_complement) {
+    std::vector<double> picard_solution, newton_solution;
+    unsigned int picard_it = solve("picard", picard_solution);
+    unsigned int newton_it = solve("newton", newton_solution);
+
+    // the jacobian is assembled to the first block only, the Schur complements must use the nonsymmetric form
+    EXPECT_LT(newton_it, picard_it);
+    EXPECT_LE(newton_it, 8u);
+
+    ASSERT_EQ(picard_solution.size(), newton_solution.size());
+    double max_value = 0;
+    for (double val : picard_solution) max_value = std::max(max_value, std::abs(val));
+    for (unsigned int i=0; i<picard_solution.size(); i++)
+        EXPECT_NEAR(picard_solution[i], newton_solution[i], 1e-6 * max_value);
+}
@@ -29,6 +29,8 @@ void water_content(Model m, double head, double wc, double cap) {
     EXPECT_NEAR(wc, water_content, 1e-5);
     EXPECT_NEAR(cap, capacity, 1e-5);
 
+    // analytic derivative must agree with the fadbad evaluation
+    EXPECT_NEAR(capacity, m.water_content_derivative(head), 1e-10 * (1 + std::abs(capacity)));
 }
 
 template <class Model>
@@ -44,6 +46,9 @@ void conductivity(Model m, double head, double cond, double d_cond) {
     cout << "p: " << head << " c: " << conductivity_ << " dc: " << d_conductivity << endl << endl;
     EXPECT_NEAR(cond, conductivity_, 1e-14);
     EXPECT_NEAR(d_cond, d_conductivity, 1e-14);
+
+    // analytic derivative must agree with the fadbad evaluation
+    EXPECT_NEAR(d_conductivity, m.conductivity_derivative(head), 1e-10 * std::abs(d_conductivity) + 1e-30);
 }
 
 template <class Model>
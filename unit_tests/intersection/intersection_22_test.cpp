@@ -15,7 +15,9 @@
 
 #include "intersection/mixed_mesh_intersections.hh"
 #include "intersection/intersection_point_aux.hh"
+#include "intersection/intersection_local.hh"
 
+#include <cstdio>
 #include <dirent.h>
 
 using namespace std;
@@ -76,3 +78,64 @@ TEST(intersection_prolongation_23d, all) {
         compute_intersection(mesh, case_result);
     }
 }
+
+
+/// Check that intersections of @p a and @p b are identical.
+template<unsigned int dimA, unsigned int dimB>
+void compare_storages(const std::vector<IntersectionLocal<dimA,dimB>> &a, const std::vector<IntersectionLocal<dimA,dimB>> &b)
+{
+    ASSERT_EQ(a.size(), b.size());
+    for(unsigned int i=0; i < a.size(); i++) {
+        EXPECT_EQ(a[i].component_ele_idx(), b[i].component_ele_idx());
+        EXPECT_EQ(a[i].bulk_ele_idx(), b[i].bulk_ele_idx());
+        ASSERT_EQ(a[i].size(), b[i].size());
+        for(unsigned int j=0; j < a[i].size(); j++) {
+            EXPECT_TRUE(arma::all(a[i][j].comp_coords() == b[i][j].comp_coords()));
+            EXPECT_TRUE(arma::all(a[i][j].bulk_coords() == b[i][j].bulk_coords()));
+        }
+    }
+}
+
+
+TEST(intersection_cache, read_write) {
+    FilePath::set_dirs(UNIT_TESTS_SRC_DIR,"",".");
+    string mesh_file = "intersection/2d-2d/cube_mult_compXincomp_2triangles.msh";
+    // the cache is an output file, its path is given relative to the output directory
+    string cache_name = "intersection_cache_test.bin";
+    string cache_file = FilePath(cache_name, FilePath::output_file);
+    std::remove(cache_file.c_str());
+    IntersectionType d = IntersectionType(IntersectionType::d23 | IntersectionType::d22);
+
+    Mesh *mesh = mesh_full_constructor("{mesh_file=\"" + mesh_file + "\"}");
+    MixedMeshIntersections ie(mesh);
+    ie.compute_intersections(d);
+
+    // first run computes intersections and writes the cache, second run reads it
+    string in_mesh_string = "{mesh_file=\"" + mesh_file + "\", intersection_cache=\"" + cache_name + "\"}";
+    for(unsigned int run=0; run < 2; run++) {
+        Mesh *cached_mesh = mesh_full_constructor(in_mesh_string);
+        MixedMeshIntersections ie_cached(cached_mesh);
+        ie_cached.compute_intersections(d);
+        EXPECT_TRUE(FilePath(cache_file, FilePath::input_file).exists());
+        EXPECT_EQ(run == 1, ie_cached.read_from_cache());
+
+        compare_storages(ie.intersection_storage23_, ie_cached.intersection_storage23_);
+        compare_storages(ie.intersection_storage22_, ie_cached.intersection_storage22_);
+        EXPECT_DOUBLE_EQ(ie.measure_22(), ie_cached.measure_22());
+
+        ASSERT_EQ(ie.element_intersections_.size(), ie_cached.element_intersections_.size());
+        for(unsigned int i=0; i < ie.element_intersections_.size(); i++) {
+            ASSERT_EQ(ie.element_intersections_[i].size(), ie_cached.element_intersections_[i].size());
+            for(unsigned int j=0; j < ie.element_intersections_[i].size(); j++) {
+                EXPECT_EQ(ie.element_intersections_[i][j].first, ie_cached.element_intersections_[i][j].first);
+                EXPECT_EQ(ie.element_intersections_[i][j].second->component_ele_idx(),
+                          ie_cached.element_intersections_[i][j].second->component_ele_idx());
+                EXPECT_EQ(ie.element_intersections_[i][j].second->bulk_ele_idx(),
+                          ie_cached.element_intersections_[i][j].second->bulk_ele_idx());
+            }
+        }
+        delete cached_mesh;
+    }
+    delete mesh;
+    std::remove(cache_file.c_str());
+}
@@ -189,3 +189,57 @@ TEST(intersection_prolongation_23d, all) {
         compute_intersection_23d(mesh, solution[s]);
     }
 }
+
+
+/// Computes 2D-3D intersections on the mesh given by @p in_mesh_string, returns pairs of elements and IP coordinates.
+void compute_intersection_23d_ips(const string &in_mesh_string,
+                                  std::vector<std::pair<unsigned int, unsigned int>> &elm_pairs,
+                                  std::vector<std::vector<arma::vec3>> &ips)
+{
+    Mesh *mesh = mesh_constructor(in_mesh_string);
+    auto reader = reader_constructor(in_mesh_string);
+    reader->read_raw_mesh(mesh);
+    mesh->setup_topology();
+    
+    MixedMeshIntersections ie(mesh);
+    ie.compute_intersections(IntersectionType::d23);
+    
+    elm_pairs.clear();
+    ips.clear();
+    for(IntersectionLocal<2,3> &il : ie.intersection_storage23_) {
+        elm_pairs.push_back(std::make_pair(il.component_ele_idx(), il.bulk_ele_idx()));
+        ips.push_back(std::vector<arma::vec3>());
+        for(unsigned int j=0; j < il.size(); j++)
+            ips.back().push_back(il[j].coords(mesh->element_accessor(il.component_ele_idx())));
+    }
+    delete mesh;
+}
+
+
+TEST(intersection_prolongation_23d, threads) {
+    FilePath::set_dirs(UNIT_TESTS_SRC_DIR,"",".");
+    string dir_name = string(UNIT_TESTS_SRC_DIR) + "/intersection/prolong_meshes_23d/";
+    std::vector<string> filenames;
+    read_files_from_dir(dir_name, "msh", filenames);
+    
+    // threaded computation has to give the same intersections in the same order as the serial one
+    for(string search : {"BIHsearch", "BIHonly"})
+        for(unsigned int s=0; s< filenames.size(); s++)
+        {
+            MessageOut() << "Computing intersection on mesh: " << filenames[s] << ", " << search << "\n";
+            string in_mesh_string = "{mesh_file=\"" + dir_name + filenames[s] + "\", intersection_search=\"" + search + "\"";
+            
+            std::vector<std::pair<unsigned int, unsigned int>> serial_pairs, threaded_pairs;
+            std::vector<std::vector<arma::vec3>> serial_ips, threaded_ips;
+            compute_intersection_23d_ips(in_mesh_string + ", intersection_threads=1}", serial_pairs, serial_ips);
+            compute_intersection_23d_ips(in_mesh_string + ", intersection_threads=3}", threaded_pairs, threaded_ips);
+            
+            ASSERT_EQ(serial_pairs.size(), threaded_pairs.size());
+            for(unsigned int i=0; i < serial_pairs.size(); i++) {
+                EXPECT_EQ(serial_pairs[i], threaded_pairs[i]);
+                ASSERT_EQ(serial_ips[i].size(), threaded_ips[i].size());
+                for(unsigned int j=0; j < serial_ips[i].size(); j++)
+                    EXPECT_ARMA_EQ(serial_ips[i][j], threaded_ips[i][j]);
+            }
+        }
+}
@@ -0,0 +1,112 @@
+#define TEST_USE_MPI
+#define FEAL_OVERRIDE_ASSERTS
+
+#include <flow_gtest_mpi.hh>
+#include <cmath>
+#include "la/anderson_acceleration.hh"
+
+
+/**
+ * Fixed-point iterations of the map G(a, b) = (cos(a), 0.5*b + 1), each component in a separate block,
+ * with the known fixed point (0.739085133215..., 2).
+ */
+class AndersonAccelerationTest : public testing::Test {
+protected:
+    AndersonAccelerationTest() {
+        PetscInitialize(0, PETSC_NULL, PETSC_NULL, PETSC_NULL);
+        VecCreateSeq(PETSC_COMM_SELF, 1, &a);
+        VecCreateSeq(PETSC_COMM_SELF, 1, &b);
+        VecSet(a, 0.0);
+        VecSet(b, 0.0);
+    }
+
+    ~AndersonAccelerationTest() {
+        VecDestroy(&a);
+        VecDestroy(&b);
+    }
+
+    double value(Vec v) {
+        PetscInt idx = 0;
+        PetscScalar val;
+        VecGetValues(v, 1, &idx, &val);
+        return val;
+    }
+
+    /// Apply the map to the actual solutions, the role of the coupled equations.
+    void apply_map() {
+        VecSet(a, std::cos(value(a)));
+        VecSet(b, 0.5 * value(b) + 1);
+    }
+
+    /// Iterate until the residual drops below @p tol, return the number of iterations.
+    unsigned int iterate(AndersonAcceleration &acceleration, double tol) {
+        acceleration.add_block(a);
+        acceleration.add_block(b);
+        acceleration.start_iterations();
+        unsigned int it = 0;
+        while (it < 200) {
+            it++;
+            apply_map();
+            if (acceleration.update_residual() < tol) break;
+            acceleration.accelerate();
+        }
+        return it;
+    }
+
+    Vec a, b;
+    const double a_fixed = 0.7390851332151607;
+    const double b_fixed = 2.0;
+};
+
+
+TEST_F(AndersonAccelerationTest, residual) {
+    AndersonAcceleration acceleration(2);
+    acceleration.add_block(a);
+    acceleration.add_block(b);
+    acceleration.start_iterations();
+
+    // residual of the iterate (0, 0) is G(0,0) - (0,0) = (1, 1)
+    apply_map();
+    EXPECT_DOUBLE_EQ(std::sqrt(2.0), acceleration.update_residual());
+    EXPECT_EQ(0u, acceleration.n_history());
+
+    // no history yet, the next iterate is the value of the map
+    acceleration.accelerate();
+    EXPECT_DOUBLE_EQ(1.0, value(a));
+    EXPECT_DOUBLE_EQ(1.0, value(b));
+
+    apply_map();
+    EXPECT_DOUBLE_EQ(std::sqrt( std::pow(std::cos(1.0) - 1.0, 2) + 0.25 ), acceleration.update_residual());
+    EXPECT_EQ(1u, acceleration.n_history());
+
+    // one difference: x = G(x_1) + gamma * (G(x_1) - G(x_0)), gamma minimizes |r_1 + gamma * (r_1 - r_0)|
+    double r0[2] = {1.0, 1.0};
+    double g0[2] = {1.0, 1.0};
+    double g1[2] = {std::cos(1.0), 1.5};
+    double r1[2] = {g1[0] - 1.0, g1[1] - 1.0};
+    double dr[2] = {r1[0] - r0[0], r1[1] - r0[1]};
+    double gamma = - (dr[0]*r1[0] + dr[1]*r1[1]) / (dr[0]*dr[0] + dr[1]*dr[1]);
+    acceleration.accelerate();
+    EXPECT_NEAR(g1[0] + gamma * (g1[0] - g0[0]), value(a), 1e-14);
+    EXPECT_NEAR(g1[1] + gamma * (g1[1] - g0[1]), value(b), 1e-14);
+}
+
+
+TEST_F(AndersonAccelerationTest, fixed_point) {
+    AndersonAcceleration acceleration(0);
+    unsigned int n_it = iterate(acceleration, 1e-12);
+    EXPECT_NEAR(a_fixed, value(a), 1e-10);
+    EXPECT_NEAR(b_fixed, value(b), 1e-10);
+    EXPECT_EQ(0u, acceleration.n_history());
+    EXPECT_GT(n_it, 50u);
+}
+
+
+TEST_F(AndersonAccelerationTest, accelerated) {
+    AndersonAcceleration acceleration(2);
+    unsigned int n_it = iterate(acceleration, 1e-12);
+    EXPECT_NEAR(a_fixed, value(a), 1e-10);
+    EXPECT_NEAR(b_fixed, value(b), 1e-10);
+    EXPECT_EQ(2u, acceleration.n_history());
+    EXPECT_LT(n_it, 15u);
+}
@@ -12,6 +12,9 @@
 
 #include "flow_gtest_mpi.hh"
 #include "la/linsys.hh"
+#include "la/linsys_PETSC.hh"
+#include "la/distribution.hh"
+#include "system/sys_profiler.hh"
 #include <armadillo>
 #include "mpi.h"
 
@@ -170,3 +173,106 @@ TEST_F(SetValues, dirichlet) {
         this->add( {0,3}, {4,5,} );
     }     
 };
+
+
+
+/// Access to the state of the solver reuse.
+class LinSysPetscReuse : public LinSys_PETSC {
+public:
+    LinSysPetscReuse(Distribution *ds)
+    : LinSys_PETSC(ds)
+    {
+        r_tol_ = 1e-12; a_tol_ = 1e-12;
+        set_solution();
+        set_positive_definite();
+        set_initial_guess_nonzero();
+    }
+
+    unsigned int n_reused() const { return pc_n_reused_; }
+    KSP solver() const { return system; }
+
+    /// Local tridiagonal matrix with the diagonal @p diag, -1 off diagonal, and the RHS @p rhs_scale * (1, 2, ...).
+    void assemble(double diag, double rhs_scale) {
+        if (matrix_ == NULL) {
+            start_allocation();
+            set_values(diag, rhs_scale);
+        }
+        start_add_assembly();
+        mat_zero_entries();
+        rhs_zero_entries();
+        set_values(diag, rhs_scale);
+        finish_assembly();
+    }
+
+    void set_values(double diag, double rhs_scale) {
+        for (unsigned int i=0; i<rows_ds_->lsize(); i++) {
+            int row = rows_ds_->begin() + i;
+            mat_set_value(row, row, diag);
+            if (i > 0) mat_set_value(row, row - 1, -1.0);
+            if (i + 1 < rows_ds_->lsize()) mat_set_value(row, row + 1, -1.0);
+            rhs_set_value(row, rhs_scale * (i + 1));
+        }
+    }
+
+    /// Norm of the residual of the actual solution.
+    double residual_norm() {
+        Vec res;
+        double norm;
+        VecDuplicate(rhs_, &res);
+        MatMult(matrix_, solution_, res);
+        VecAXPY(res, -1.0, rhs_);
+        VecNorm(res, NORM_2, &norm);
+        VecDestroy(&res);
+        return norm;
+    }
+};
+
+
+TEST(linsys_petsc, preconditioner_reuse) {
+    Profiler::initialize();
+
+    Distribution ds(6, MPI_COMM_WORLD);
+    LinSysPetscReuse ls(&ds);
+    // reuse limited only by the number of solutions
+    ls.set_preconditioner_reuse(2, 1000.0);
+
+    unsigned int expected_reused[] = {0, 1, 2, 0, 1};
+    KSP prev_solver = NULL;
+    for (unsigned int step=0; step<5; step++) {
+        ls.assemble(3.0 + 0.5*step, 1.0);
+        ls.solve();
+
+        EXPECT_EQ(expected_reused[step], ls.n_reused());
+        // the solver is kept while its preconditioner is reused
+        if (ls.n_reused() > 0) EXPECT_EQ(prev_solver, ls.solver());
+        prev_solver = ls.solver();
+
+        // the solution must not depend on the reused preconditioner
+        EXPECT_LT(ls.residual_norm(), 1e-8);
+    }
+}
+
+
+TEST(linsys_petsc, extrapolate_initial_guess) {
+    Profiler::initialize();
+
+    Distribution ds(6, MPI_COMM_WORLD);
+    LinSysPetscReuse ls(&ds), ls_plain(&ds);
+    ls.set_extrapolate_initial_guess();
+
+    // solutions linear in the step, the extrapolated guess is exact from the second solution
+    for (unsigned int step=0; step<4; step++) {
+        ls.assemble(3.0, 1.0 + step);
+        ls_plain.assemble(3.0, 1.0 + step);
+        LinSys::SolveInfo si = ls.solve();
+        LinSys::SolveInfo si_plain = ls_plain.solve();
+
+        EXPECT_GT(si.converged_reason, 0);
+        EXPECT_LT(ls.residual_norm(), 1e-8);
+        EXPECT_LT(ls_plain.residual_norm(), 1e-8);
+        if (step > 0) {
+            EXPECT_EQ(0, si.n_iterations);
+            EXPECT_GT(si_plain.n_iterations, 0);
+        }
+    }
+}
@@ -8,6 +8,7 @@
 #include <la/schur.hh>
 #include <la/linsys.hh>
 #include "la/linsys_PETSC.hh"
+#include "la/local_system.hh"
 #include "system/sys_profiler.hh"
 
 #include <petscmat.h>
@@ -80,6 +81,34 @@ public:
 
 		}
 	}
+
+	/**
+	 * Fill the same matrix as fill_matrix, but every block of A is set together with its part of B and C
+	 * as a local system.
+	 */
+	void fill_local_systems(int rank, Distribution &ds, Distribution &block_ds) {
+		int local_idx=0;
+		for (unsigned int i = block_ds.begin(); i < block_ds.end(); i++) {
+			LocalSystem loc(block_size+1, block_size+1);
+			for (unsigned int j=0; j<block_size; j++) {
+				loc.row_dofs[j] = ds.begin() + block_ds.begin() + local_idx;
+				local_idx++;
+			}
+			loc.row_dofs[block_size] = ds.end() + i;
+			loc.col_dofs = loc.row_dofs;
+
+			// keep zero C entry in the matrix
+			arma::umat sp(block_size+1, block_size+1);
+			sp.ones();
+			loc.set_sparsity(sp);
+			for (unsigned int j=0; j<block_size; j++) {
+				loc.add_value(j, j, rank + 2);
+				loc.add_value(j, block_size, 1);
+				loc.add_value(block_size, j, 1);
+			}
+			set_local_system(loc);
+		}
+	}
 };
 
 class LinSysPetscTest : public LinSys_PETSC {
@@ -147,3 +176,56 @@ TEST(schur, complement) {
 		MatRestoreRow(*(schurComplement->get_system()->get_matrix()), rank, &ncols, &cols, &vals);
 	}
 }
+
+
+TEST(schur, direct_assembly) {
+    Profiler::initialize();
+
+	IS set;
+    int np, rank;
+
+    MPI_Comm_size(PETSC_COMM_WORLD, &np);
+    MPI_Comm_rank(PETSC_COMM_WORLD, &rank);
+
+    Distribution ds(block_size, MPI_COMM_WORLD);
+    Distribution block_ds(block_count, MPI_COMM_WORLD);
+    Distribution all_ds(block_size + block_count, MPI_COMM_WORLD);
+
+	ISCreateStride(PETSC_COMM_WORLD, ds.lsize(), all_ds.begin(), 1, &set);
+
+	SchurComplementTest * schurComplement = new SchurComplementTest(set, &all_ds);
+	LinSys * lin_sys = new LinSysPetscTest( schurComplement->make_complement_distribution() );
+	schurComplement->set_complement( (LinSys_PETSC *)lin_sys );
+	schurComplement->set_direct_assembly();
+	schurComplement->set_solution();
+	schurComplement->set_positive_definite();
+	schurComplement->start_allocation();
+	schurComplement->fill_local_systems( rank, ds, block_ds); // preallocate matrix
+	schurComplement->start_add_assembly();
+	schurComplement->fill_local_systems( rank, ds, block_ds); // fill matrix
+	schurComplement->finish_assembly();
+	schurComplement->solve();
+
+	// same values as in the test above
+	{
+		// rows contain explicit zeros of the dense local blocks, find the diagonal entry
+		auto diagonal_value = [](Mat mat, PetscInt row) -> double {
+			PetscInt ncols;
+			const PetscInt *cols;
+			const PetscScalar *vals;
+			double diag = 0.0;
+			MatGetRow(mat, row, &ncols, &cols, &vals);
+			for (PetscInt j=0; j<ncols; j++)
+				if (cols[j] == row) diag = vals[j];
+			MatRestoreRow(mat, row, &ncols, &cols, &vals);
+			return diag;
+		};
+
+		for (unsigned int i=0; i<block_size; i++)
+			EXPECT_FLOAT_EQ( (1.0 / (double)(rank + 2)), diagonal_value(schurComplement->get_a_inv(), i + rank*block_size) );
+		EXPECT_FLOAT_EQ( ((double)block_size / (double)(rank + 2)),
+				diagonal_value(*(schurComplement->get_system()->get_matrix()), rank) );
+	}
+
+	delete schurComplement;
+}
@@ -0,0 +1,111 @@
+/*
+ * bih_tree_speed_test.cpp
+ *
+ *  Search in the flat BIH tree compared with traversal of the tree nodes,
+ *  single searches and batch searches.
+ */
+
+#define TEST_USE_MPI
+#define FEAL_OVERRIDE_ASSERTS
+
+#include <flow_gtest_mpi.hh>
+#include <random>
+#include <vector>
+#include <mesh_constructor.hh>
+
+#include "system/global_defs.h"
+
+
+#ifdef FLOW123D_RUN_UNIT_BENCHMARKS
+
+#include "system/sys_profiler.hh"
+#include "mesh/mesh.h"
+#include "mesh/bih_tree.hh"
+#include "io/msh_gmshreader.h"
+
+static const unsigned int n_searches = 200000;
+
+
+/// Tree with the search by traversal of BIHNode objects and BoundingBox tests one by one.
+class BIHTreeNodes : public BIHTree {
+public:
+	BIHTreeNodes(unsigned int soft_leaf_size_limit)
+	: BIHTree(soft_leaf_size_limit) {}
+
+	void find_bounding_box_nodes(const BoundingBox &box, std::vector<unsigned int> &result_list) const {
+	    std::vector<unsigned int> node_stack;
+	    node_stack.reserve(max_stack_size_);
+	    node_stack.push_back(0);
+		while (! node_stack.empty()) {
+			const BIHNode &node = nodes_[node_stack.back()];
+			node_stack.pop_back();
+			if (node.is_leaf()) {
+				for (unsigned int i=node.leaf_begin(); i<node.leaf_end(); i++)
+					if (elements_[ in_leaves_[i] ].intersect(box)) result_list.push_back(in_leaves_[i]);
+			} else {
+				if ( ! box.projection_gt( node.axis(), nodes_[node.child(0)].bound() ) ) node_stack.push_back( node.child(0) );
+				if ( ! box.projection_lt( node.axis(), nodes_[node.child(1)].bound() ) ) node_stack.push_back( node.child(1) );
+			}
+		}
+	}
+};
+
+
+TEST(BIHTree_speed, find_point) {
+    Profiler::initialize();
+	FilePath::set_io_dirs(".",UNIT_TESTS_SRC_DIR,"",".");
+
+	std::string mesh_in_string = "{mesh_file=\"mesh/test_27936_elem.msh\"}";
+	Mesh * mesh = mesh_constructor(mesh_in_string);
+    auto reader = reader_constructor(mesh_in_string);
+	reader->read_physical_names(mesh);
+	reader->read_raw_mesh(mesh);
+
+	BIHTreeNodes bt(BIHTree::default_leaf_size_limit);
+    bt.add_boxes( mesh->get_element_boxes() );
+    bt.construct();
+
+    std::mt19937 r_gen(123);
+    std::vector<std::uniform_real_distribution<>> r_coord;
+    for (unsigned int axis=0; axis<3; axis++)
+    	r_coord.push_back( std::uniform_real_distribution<>(bt.tree_box().min(axis), bt.tree_box().max(axis)) );
+    std::vector<Space<3>::Point> points(n_searches);
+    for (auto &p : points)
+    	for (unsigned int axis=0; axis<3; axis++) p[axis] = r_coord[axis](r_gen);
+
+    unsigned int n_nodes_found = 0, n_flat_found = 0;
+    std::vector<unsigned int> result;
+    {
+        START_TIMER("tree_nodes");
+        for (auto &p : points) {
+            result.clear();
+            bt.find_bounding_box_nodes(BoundingBox(p), result);
+            n_nodes_found += result.size();
+        }
+        END_TIMER("tree_nodes");
+    }
+    {
+        START_TIMER("flat_tree");
+        BIHTree::SearchBuffer buffer;
+        for (auto &p : points) {
+            result.clear();
+            bt.find_point(p, result, buffer);
+            n_flat_found += result.size();
+        }
+        END_TIMER("flat_tree");
+    }
+    std::vector<unsigned int> result_list, result_offsets;
+    {
+        START_TIMER("flat_tree_batch");
+        bt.find_points(points, result_list, result_offsets);
+        END_TIMER("flat_tree_batch");
+    }
+    EXPECT_EQ(n_nodes_found, n_flat_found);
+    EXPECT_EQ(n_nodes_found, result_list.size());
+
+    Profiler::instance()->output(MPI_COMM_WORLD, cout);
+    Profiler::uninitialize();
+	delete mesh;
+}
+
+#endif // FLOW123D_RUN_UNIT_BENCHMARKS
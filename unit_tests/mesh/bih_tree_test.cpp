@@ -223,6 +223,35 @@ public:
 	}
 
 
+	/// Batch search gives same elements as the searches of individual boxes and points.
+	void test_batch() {
+		std::vector<BoundingBox> boxes;
+		std::vector<BoundingBox::Point> points;
+		for(int i=0; i < 100*n_test_trials; i++) {
+			boxes.push_back( BoundingBox( vector<BoundingBox::Point>({r_point(), r_point()}) ) );
+			points.push_back( r_point() );
+		}
+
+		vector<unsigned int> result_list, result_offsets;
+		bt->find_bounding_boxes(boxes, result_list, result_offsets);
+		ASSERT_EQ(boxes.size()+1, result_offsets.size());
+		BIHTree::SearchBuffer buffer;
+		for(unsigned int i=0; i < boxes.size(); i++) {
+			vector<unsigned int> result_vec;
+			bt->find_bounding_box(boxes[i], result_vec, buffer);
+			EXPECT_EQ(result_vec, vector<unsigned int>(result_list.begin() + result_offsets[i], result_list.begin() + result_offsets[i+1]));
+		}
+
+		bt->find_points(points, result_list, result_offsets);
+		ASSERT_EQ(points.size()+1, result_offsets.size());
+		for(unsigned int i=0; i < points.size(); i++) {
+			vector<unsigned int> result_vec;
+			bt->find_point(points[i], result_vec, buffer);
+			EXPECT_EQ(result_vec, vector<unsigned int>(result_list.begin() + result_offsets[i], result_list.begin() + result_offsets[i+1]));
+		}
+	}
+
+
 	BIH_test()
 	: r_gen(123), mesh(nullptr), bt(nullptr)
 	{
@@ -272,6 +301,11 @@ TEST_F(BIH_test, find_bounding_box_5) {
 	this->test_find_boxes();
 }
 
+TEST_F(BIH_test, find_batch) {
+	this->create_tree("{mesh_file=\"mesh/test_27936_elem.msh\"}");
+	this->test_batch();
+}
+
 /**
  * Unit test of BIH tree on large mesh (111 000 elements).
  *
@@ -11,10 +11,13 @@
 #include <sstream>
 #include <string>
 #include <mesh_constructor.hh>
+#include <arma_expect.hh>
 
 #include "system/sys_profiler.hh"
 
 #include "mesh/mesh.h"
+#include "mesh/accessors.hh"
+#include "mesh/node_accessor.hh"
 #include "io/msh_gmshreader.h"
 
 
@@ -56,3 +59,83 @@ TEST(GMSHReader, read_mesh_from_file) {
 
     delete mesh;
 }
+
+
+TEST(GMSHReader, read_binary_file) {
+    Profiler::initialize();
+    FilePath::set_io_dirs(".",UNIT_TESTS_SRC_DIR,"",".");
+
+    // same mesh and data in ASCII and binary GMSH format
+    std::vector<std::string> mesh_in_strings = { "{mesh_file=\"fields/simplest_cube_data.msh\"}",
+                                                 "{mesh_file=\"mesh/simplest_cube_binary.msh\"}" };
+    std::vector<Mesh *> meshes;
+    std::vector< std::shared_ptr<BaseMeshReader> > readers;
+    for (auto mesh_in_string : mesh_in_strings) {
+        meshes.push_back( mesh_constructor(mesh_in_string) );
+        readers.push_back( reader_constructor(mesh_in_string) );
+        readers.back()->read_physical_names(meshes.back());
+        readers.back()->read_raw_mesh(meshes.back());
+        meshes.back()->setup_topology();
+        meshes.back()->check_and_finish();
+    }
+
+    EXPECT_EQ(8, meshes[1]->n_nodes());
+    EXPECT_EQ(meshes[0]->n_nodes(), meshes[1]->n_nodes());
+    EXPECT_EQ(meshes[0]->n_elements(), meshes[1]->n_elements());
+    EXPECT_EQ(meshes[0]->n_elements(true), meshes[1]->n_elements(true));
+    for (unsigned int i=0; i<meshes[0]->n_nodes(); ++i) {
+        EXPECT_ARMA_EQ( meshes[0]->node_accessor(i)->point(), meshes[1]->node_accessor(i)->point() );
+    }
+    for (unsigned int i=0; i<meshes[0]->n_elements(); ++i) {
+        ElementAccessor<3> ele_ascii = meshes[0]->element_accessor(i);
+        ElementAccessor<3> ele_binary = meshes[1]->element_accessor(i);
+        EXPECT_EQ( ele_ascii.idx(), ele_binary.idx() );
+        EXPECT_EQ( ele_ascii.region().id(), ele_binary.region().id() );
+        for (unsigned int ni=0; ni<ele_ascii->n_nodes(); ++ni)
+            EXPECT_EQ( ele_ascii.node_accessor(ni).idx(), ele_binary.node_accessor(ni).idx() );
+    }
+
+    // element data
+    std::vector< std::vector<double> > scalar_data, vector_data;
+    for (auto reader : readers) {
+        reader->check_compatible_mesh(*meshes[0]);
+        BaseMeshReader::HeaderQuery scalar_params("scalar", 1.0, OutputTime::DiscreteSpace::ELEM_DATA);
+        reader->find_header(scalar_params);
+        scalar_data.push_back( *reader->get_element_data<double>(meshes[0]->n_elements(), 1, false, 0) );
+        BaseMeshReader::HeaderQuery vector_params("vector_fixed", 1.0, OutputTime::DiscreteSpace::ELEM_DATA);
+        reader->find_header(vector_params);
+        vector_data.push_back( *reader->get_element_data<double>(meshes[0]->n_elements(), 3, false, 0) );
+    }
+    EXPECT_DOUBLE_EQ(0.2, scalar_data[1][0]);
+    EXPECT_DOUBLE_EQ(2, vector_data[1][0]);
+    for (unsigned int i=0; i<scalar_data[0].size(); ++i) EXPECT_DOUBLE_EQ(scalar_data[0][i], scalar_data[1][i]);
+    for (unsigned int i=0; i<vector_data[0].size(); ++i) EXPECT_DOUBLE_EQ(vector_data[0][i], vector_data[1][i]);
+
+    for (auto mesh : meshes) delete mesh;
+}
+
+
+TEST(GMSHReader, read_unsorted_element_data) {
+    Profiler::initialize();
+    FilePath::set_io_dirs(".",UNIT_TESTS_SRC_DIR,"",".");
+
+    // rows of element data are not sorted by IDs and the section contains a row over the declared number of rows
+    std::string mesh_in_string = "{mesh_file=\"mesh/simplest_cube_unsorted_data.msh\"}";
+    Mesh * mesh = mesh_constructor(mesh_in_string);
+    auto reader = reader_constructor(mesh_in_string);
+    reader->read_physical_names(mesh);
+    reader->read_raw_mesh(mesh);
+    mesh->setup_topology();
+    mesh->check_and_finish();
+
+    reader->check_compatible_mesh(*mesh);
+    BaseMeshReader::HeaderQuery scalar_params("scalar", 0.0, OutputTime::DiscreteSpace::ELEM_DATA);
+    reader->find_header(scalar_params);
+    std::vector<double> scalar_data = *reader->get_element_data<double>(mesh->n_elements(), 1, false, 0);
+
+    ASSERT_EQ(9, scalar_data.size());
+    for (unsigned int i=0; i<scalar_data.size(); ++i)
+        EXPECT_DOUBLE_EQ(0.5 * mesh->find_elem_id(i), scalar_data[i]);
+
+    delete mesh;
+}
@@ -0,0 +1,96 @@
+/*
+ * mesh_speed_test.cpp
+ *
+ *  Traversal of elements, their sides and sides of edges (pattern of the face assembly)
+ *  with sides of edges in one array compared with an individual allocation per edge.
+ */
+
+#define TEST_USE_MPI
+#define FEAL_OVERRIDE_ASSERTS
+
+#include <flow_gtest_mpi.hh>
+#include <vector>
+#include <mesh_constructor.hh>
+
+#include "system/global_defs.h"
+
+
+#ifdef FLOW123D_RUN_UNIT_BENCHMARKS
+
+#include "system/sys_profiler.hh"
+#include "mesh/mesh.h"
+#include "mesh/side_impl.hh"
+#include "mesh/accessors.hh"
+#include "io/msh_gmshreader.h"
+
+static const unsigned int n_loops = 100;
+
+
+/// Sum of indices of elements neighbouring over sides, @p edge_sides gives sides of the edge.
+template <class EdgeSides>
+unsigned long traverse_edges(Mesh *mesh, EdgeSides edge_sides) {
+    unsigned long sum = 0;
+    for (auto ele : mesh->elements_range())
+        for (unsigned int sid=0; sid<ele->n_sides(); sid++) {
+            unsigned int i_edge = ele->edge_idx(sid);
+            SideIter *sides = edge_sides(i_edge);
+            for (int i=0; i<mesh->edges[i_edge].n_sides; i++)
+                sum += sides[i]->elem_idx();
+        }
+    return sum;
+}
+
+
+TEST(Mesh_speed, edge_sides) {
+    Profiler::initialize();
+	FilePath::set_io_dirs(".",UNIT_TESTS_SRC_DIR,"",".");
+
+	std::string mesh_in_string = "{mesh_file=\"mesh/test_27936_elem.msh\"}";
+	Mesh * mesh = mesh_constructor(mesh_in_string);
+    auto reader = reader_constructor(mesh_in_string);
+	reader->read_physical_names(mesh);
+	reader->read_raw_mesh(mesh);
+	{
+	    START_TIMER("setup_topology");
+	    mesh->setup_topology();
+	    END_TIMER("setup_topology");
+	}
+
+    // sides of every edge in an individual allocation, the layout before the flat array
+    std::vector<SideIter *> edge_allocations(mesh->n_edges());
+    for (unsigned int i=0; i<mesh->n_edges(); i++) {
+        edge_allocations[i] = new SideIter[mesh->edges[i].n_sides];
+        for (int j=0; j<mesh->edges[i].n_sides; j++) edge_allocations[i][j] = mesh->edges[i].side(j);
+    }
+
+    unsigned long sum_allocated = 0, sum_flat = 0;
+    {
+        START_TIMER("edge_allocations");
+        for (unsigned int loop=0; loop<n_loops; loop++)
+            sum_allocated += traverse_edges(mesh, [&edge_allocations](unsigned int i_edge) { return edge_allocations[i_edge]; });
+        END_TIMER("edge_allocations");
+    }
+    {
+        START_TIMER("flat_edge_sides");
+        for (unsigned int loop=0; loop<n_loops; loop++)
+            sum_flat += traverse_edges(mesh, [mesh](unsigned int i_edge) { return mesh->edges[i_edge].side_; });
+        END_TIMER("flat_edge_sides");
+    }
+    EXPECT_EQ(sum_allocated, sum_flat);
+
+    // heap allocations saved by storing the topology in place: two vectors per element and an array per edge
+    std::size_t vector_bytes = 0;
+    for (auto ele : mesh->elements_range())
+        vector_bytes += 2 * (sizeof(std::vector<unsigned int>) + ele->n_sides() * sizeof(unsigned int));
+    cout << "Elements: " << mesh->n_elements() << ", edges: " << mesh->n_edges()
+         << ", sizeof(Element): " << sizeof(Element)
+         << ", bytes of edge_idx and permutation vectors (without allocator overhead): " << vector_bytes
+         << ", heap allocations saved: " << 2 * mesh->n_elements() + mesh->n_edges() << endl;
+
+    for (auto sides : edge_allocations) delete [] sides;
+    Profiler::instance()->output(MPI_COMM_WORLD, cout);
+    Profiler::uninitialize();
+	delete mesh;
+}
+
+#endif // FLOW123D_RUN_UNIT_BENCHMARKS
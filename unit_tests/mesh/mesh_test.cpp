@@ -13,9 +13,15 @@
 #include "mesh/side_impl.hh"
 #include "mesh/mesh.h"
 #include "mesh/bc_mesh.hh"
+#include "mesh/element_geometry_cache.hh"
 #include "io/msh_gmshreader.h"
 #include <iostream>
 #include <vector>
+#include <set>
+#include <random>
+#ifdef FLOW123D_HAVE_OPENMP
+#include <omp.h>
+#endif
 #include "mesh/accessors.hh"
 #include "mesh/partitioning.hh"
 #include "input/reader_to_storage.hh"
@@ -189,6 +195,209 @@ TEST(Mesh, check_compatible_mesh) {
 }
 
 
+TEST(Mesh, edge_sides) {
+	FilePath::set_io_dirs(".",UNIT_TESTS_SRC_DIR,"",".");
+
+	std::string mesh_in_string = "{mesh_file=\"mesh/simplest_cube.msh\"}";
+	Mesh * mesh = mesh_constructor(mesh_in_string);
+    auto reader = reader_constructor(mesh_in_string);
+    reader->read_physical_names(mesh);
+    reader->read_raw_mesh(mesh);
+    mesh->setup_topology();
+
+    // sides of edges are consecutive parts of one array
+    unsigned int n_edge_sides = 0;
+    for (unsigned int i=0; i<mesh->n_edges(); i++) {
+        const Edge &edge = mesh->edges[i];
+        ASSERT_GT(edge.n_sides, 0);
+        if (i+1 < mesh->n_edges())
+            EXPECT_EQ(edge.side_ + edge.n_sides, mesh->edges[i+1].side_);
+        for (int j=0; j<edge.n_sides; j++)
+            EXPECT_EQ(i, edge.side(j)->edge_idx());
+        n_edge_sides += edge.n_sides;
+    }
+
+    // every side of a bulk element is on exactly one edge
+    std::set< std::pair<unsigned int, unsigned int> > element_sides;
+    unsigned int n_sides = 0;
+    for (auto ele : mesh->elements_range()) {
+        for (unsigned int sid=0; sid<ele->n_sides(); sid++) {
+            const Edge *edge = ele.side(sid)->edge();
+            bool found = false;
+            for (int j=0; j<edge->n_sides; j++)
+                if (edge->side(j)->element().idx() == ele.idx() && edge->side(j)->side_idx() == sid) found = true;
+            EXPECT_TRUE(found);
+        }
+        n_sides += ele->n_sides();
+    }
+    for (unsigned int i=0; i<mesh->n_edges(); i++)
+        for (int j=0; j<mesh->edges[i].n_sides; j++) {
+            SideIter side = mesh->edges[i].side(j);
+            EXPECT_TRUE( element_sides.insert( std::make_pair(side->element().idx(), side->side_idx()) ).second );
+        }
+    EXPECT_EQ(n_sides, n_edge_sides);
+
+    delete mesh;
+}
+
+
+TEST(Mesh, find_points) {
+	FilePath::set_io_dirs(".",UNIT_TESTS_SRC_DIR,"",".");
+
+	std::string mesh_in_string = "{mesh_file=\"mesh/test_7590_elem.msh\"}";
+	Mesh * mesh = mesh_constructor(mesh_in_string);
+    auto reader = reader_constructor(mesh_in_string);
+    reader->read_physical_names(mesh);
+    reader->read_raw_mesh(mesh);
+
+    // three points inside of every 3D element, next point is searched from the element of previous one
+    std::mt19937 r_gen(123);
+    std::uniform_real_distribution<double> r_dist(1e-3, 1.0);
+    std::vector<arma::vec3> points;
+    std::vector<unsigned int> point_elements;
+    for (auto ele : mesh->elements_range()) {
+        if (ele.dim() != 3) continue;
+        for (unsigned int i=0; i<3; i++) {
+            arma::vec4 weights;
+            for (unsigned int j=0; j<4; j++) weights[j] = r_dist(r_gen);
+            weights /= arma::sum(weights);
+            arma::vec3 point = arma::zeros(3);
+            for (unsigned int j=0; j<4; j++) point += weights[j] * ele.node(j)->point();
+            points.push_back(point);
+            point_elements.push_back(ele.idx());
+        }
+    }
+    // point out of the mesh
+    points.push_back( mesh->get_bih_tree().tree_box().max() + arma::vec3("1 1 1") );
+
+    std::vector<Mesh::PointLocation> locations;
+    mesh->find_points(points, locations);
+    ASSERT_EQ(points.size(), locations.size());
+    for (unsigned int i=0; i<point_elements.size(); i++) {
+        EXPECT_EQ(point_elements[i], locations[i].elem_idx);
+        ElementAccessor<3> ele = mesh->element_accessor(locations[i].elem_idx);
+        arma::vec3 point = ele.node(0)->point();
+        for (unsigned int j=0; j<3; j++) point += locations[i].local_coords[j] * (ele.node(j+1)->point() - ele.node(0)->point());
+        EXPECT_LT(arma::norm(point - points[i], 2), 1e-10);
+    }
+    EXPECT_EQ(Mesh::undef_idx, locations.back().elem_idx);
+
+    // points in the volume are not located on 2D elements
+    mesh->find_points(points, locations, 2);
+    for (auto &location : locations) EXPECT_EQ(Mesh::undef_idx, location.elem_idx);
+
+    delete mesh;
+}
+
+
+TEST(Mesh, find_points_shared_faces) {
+	FilePath::set_io_dirs(".",UNIT_TESTS_SRC_DIR,"",".");
+
+	std::string mesh_in_string = "{mesh_file=\"mesh/test_7590_elem.msh\"}";
+	Mesh * mesh = mesh_constructor(mesh_in_string);
+    auto reader = reader_constructor(mesh_in_string);
+    reader->read_physical_names(mesh);
+    reader->read_raw_mesh(mesh);
+    mesh->setup_topology();
+
+    // centres of faces shared by two 3D elements and all nodes, enough points to be split among threads
+    std::vector<arma::vec3> points;
+    std::vector<unsigned int> face_elements;
+    for (auto ele : mesh->elements_range()) {
+        if (ele.dim() != 3) continue;
+        for (unsigned int sid=0; sid<ele->n_sides(); sid++) {
+            const Edge *edge = ele.side(sid)->edge();
+            if (edge->n_sides != 2) continue;
+            unsigned int other_idx = edge->side(0)->element().idx();
+            if (other_idx == ele.idx()) other_idx = edge->side(1)->element().idx();
+            if (mesh->element_accessor(other_idx).dim() != 3 || other_idx < ele.idx()) continue;
+            points.push_back(ele.side(sid)->centre());
+            face_elements.push_back(ele.idx());
+        }
+    }
+    unsigned int n_faces = points.size();
+    for (auto node : mesh->node_range()) points.push_back(node->point());
+    ASSERT_GT(points.size(), 1024u);
+
+    // the containing element with the lowest index is returned
+    std::vector<Mesh::PointLocation> locations;
+    mesh->find_points(points, locations);
+    for (unsigned int i=0; i<n_faces; i++)
+        EXPECT_EQ(face_elements[i], locations[i].elem_idx);
+    for (unsigned int i=n_faces; i<points.size(); i++)
+        EXPECT_NE(Mesh::undef_idx, locations[i].elem_idx);
+
+    // the result does not depend on the number of threads and on the order of points
+#ifdef FLOW123D_HAVE_OPENMP
+    int max_threads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    std::vector<Mesh::PointLocation> serial_locations;
+    mesh->find_points(points, serial_locations);
+    omp_set_num_threads(4);
+    std::vector<Mesh::PointLocation> threaded_locations;
+    mesh->find_points(points, threaded_locations);
+    omp_set_num_threads(max_threads);
+    for (unsigned int i=0; i<points.size(); i++) {
+        EXPECT_EQ(serial_locations[i].elem_idx, locations[i].elem_idx);
+        EXPECT_EQ(threaded_locations[i].elem_idx, locations[i].elem_idx);
+    }
+#endif
+    std::vector<arma::vec3> reversed_points(points.rbegin(), points.rend());
+    std::vector<Mesh::PointLocation> reversed_locations;
+    mesh->find_points(reversed_points, reversed_locations);
+    for (unsigned int i=0; i<points.size(); i++)
+        EXPECT_EQ(locations[i].elem_idx, reversed_locations[points.size()-1-i].elem_idx);
+
+    delete mesh;
+}
+
+
+TEST(Mesh, geometry_cache) {
+	FilePath::set_io_dirs(".",UNIT_TESTS_SRC_DIR,"",".");
+
+	std::string mesh_in_string = "{mesh_file=\"mesh/simplest_cube.msh\", geometry_cache=true}";
+	Mesh * mesh = mesh_constructor(mesh_in_string);
+    auto reader = reader_constructor(mesh_in_string);
+    reader->read_physical_names(mesh);
+    reader->read_raw_mesh(mesh);
+    mesh->setup_topology();
+
+    const ElementGeometryCache *geometry = mesh->geometry_cache();
+    ASSERT_TRUE(geometry != nullptr);
+    EXPECT_EQ(mesh->n_elements() + mesh->n_elements(true), geometry->size());
+
+    const double dim_factorial[4] = {1, 1, 2, 6};
+    for (auto ele : mesh->elements_range()) {
+        unsigned int idx = ele.mesh_idx();
+        EXPECT_NEAR(ele.measure(), geometry->determinant(idx) / dim_factorial[ele.dim()], 1e-12);
+
+        // inverse Jacobian, columns of Jacobian are edges from the first node
+        arma::mat jac, inv_jac;
+        switch (ele.dim()) {
+        case 1: jac = geometry->jacobian<1>(idx); inv_jac = geometry->inverse_jacobian<1>(idx); break;
+        case 2: jac = geometry->jacobian<2>(idx); inv_jac = geometry->inverse_jacobian<2>(idx); break;
+        case 3: jac = geometry->jacobian<3>(idx); inv_jac = geometry->inverse_jacobian<3>(idx); break;
+        }
+        for (unsigned int i=0; i<ele.dim(); i++)
+            EXPECT_LT(arma::norm(jac.col(i) - (ele.node(i+1)->point() - ele.node(0)->point()), 2), 1e-12);
+        EXPECT_LT(arma::norm(inv_jac*jac - arma::eye(ele.dim(), ele.dim()), 2), 1e-10);
+
+        // unit outer normals perpendicular to sides
+        for (unsigned int sid=0; sid<ele->n_sides(); sid++) {
+            arma::vec3 normal = geometry->normal_vector(idx, sid);
+            EXPECT_NEAR(1.0, arma::norm(normal, 2), 1e-12);
+            EXPECT_GT(arma::dot(normal, ele.side(sid)->centre() - ele.centre()), 0);
+            for (unsigned int n=1; n<ele.side(sid)->n_nodes(); n++)
+                EXPECT_NEAR(0.0, arma::dot(normal, ele.side(sid)->node(n)->point() - ele.side(sid)->node(0)->point()), 1e-12);
+            if (ele.dim() > 1)
+                EXPECT_NEAR(ele.side(sid)->measure(), geometry->side_determinant(idx, sid) / dim_factorial[ele.dim()-1], 1e-12);
+        }
+    }
+
+    delete mesh;
+}
+
+
 TEST(BCMesh, element_ranges) {
 	FilePath::set_io_dirs(".",UNIT_TESTS_SRC_DIR,"",".");
 
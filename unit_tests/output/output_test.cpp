@@ -231,7 +231,7 @@ public:
 	virtual ~TestOutputTime() {
 	    delete my_mesh;
 	}
-	int write_data(void) override {return 0;};
+	int write_frame(const OutputFrame &frame) override {return 0;};
 	//int write_head(void) override {return 0;};
 	//int write_tail(void) override {return 0;};
 
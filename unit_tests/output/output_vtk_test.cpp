@@ -38,6 +38,13 @@ format: !vtk
   variant: ascii
 )YAML";
 
+const string test_output_time_async = R"YAML(
+file: ./test1.pvd
+format: !vtk
+  variant: ascii
+write_queue: 2
+)YAML";
+
 const string test_output_time_binary = R"YAML(
 file: ./test1.pvd
 format: !vtk
@@ -157,6 +164,13 @@ public:
 		this->current_step = step;
 	}
 
+	// write current data by the background writer
+	void write_data_async() {
+		this->push_frame( this->make_frame() );
+		this->clear_data();
+		this->flush_frames();
+	}
+
 	std::string base_filename() {
 		return string(this->_base_filename);
 	}
@@ -193,6 +207,21 @@ TEST(TestOutputVTK, write_data_ascii) {
 }
 
 
+TEST(TestOutputVTK, write_data_async) {
+	std::shared_ptr<TestOutputVTK> output_vtk = std::make_shared<TestOutputVTK>();
+
+	output_vtk->init_mesh(test_output_time_async);
+	output_vtk->set_current_step(1);
+	output_vtk->set_field_data< Field<3,FieldValue<0>::Scalar> > ("scalar_field", "0.5");
+	output_vtk->set_field_data< Field<3,FieldValue<3>::VectorFixed> > ("vector_field", "[0.5, 1.0, 1.5]");
+	output_vtk->set_field_data< Field<3,FieldValue<3>::TensorFixed> > ("tensor_field", "[[1, 2, 3], [4, 5, 6], [7, 8, 9]]");
+	output_vtk->set_native_field_data< FieldValue<0>::Scalar >("flow_data", 6, 0.2);
+	output_vtk->write_data_async();
+
+    output_vtk->check_result_file("test1/test1-000001.vtu", "test_output_vtk_ascii_ref.vtu");
+}
+
+
 TEST(TestOutputVTK, write_data_binary) {
 	std::shared_ptr<TestOutputVTK> output_vtk = std::make_shared<TestOutputVTK>();
 
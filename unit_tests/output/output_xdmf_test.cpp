@@ -0,0 +1,175 @@
+/*
+ * output_xdmf_test.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#define TEST_USE_PETSC
+#define FEAL_OVERRIDE_ASSERTS
+#include <flow_gtest_mpi.hh>
+#include <mesh_constructor.hh>
+
+#include "config.h"
+
+#ifdef FLOW123D_HAVE_HDF5
+
+#include <hdf5.h>
+
+#include "mesh/mesh.h"
+#include "io/output_time.hh"
+#include "io/output_xdmf.hh"
+#include "io/output_mesh.hh"
+#include "system/sys_profiler.hh"
+#include "fields/field_set.hh"
+#include "fields/field.hh"
+#include "la/distribution.hh"
+
+#include "input/input_type.hh"
+#include "input/accessors.hh"
+#include "input/reader_to_storage.hh"
+
+namespace IT=Input::Type;
+
+
+const string xdmf_data_input = R"YAML(
+data:
+  - region: BULK
+    time: 0.0
+    init_scalar: !FieldFormula
+      value: x
+)YAML";
+
+const string xdmf_output_input = R"YAML(
+file: ./test_output.xdmf
+format: !xdmf
+)YAML";
+
+
+/**
+ * Must run for n_proc=2, every process writes its element to the common HDF5 file.
+ */
+class TestOutputXDMF : public testing::Test {
+protected:
+    class EqData : public FieldSet {
+    public:
+        EqData()
+        {
+            *this += init_scalar.name("init_scalar").description("Initial condition for scalar.").input_default("0.0");
+            init_scalar.units( UnitSI::dimensionless() );
+        }
+
+        Field<3, FieldValue<3>::Scalar > init_scalar;
+    };
+
+    class OutputXDMFTest : public OutputXDMF {
+    public:
+        OutputXDMFTest() : OutputXDMF() {};
+
+        void write_test_frame() {
+            this->gather_output_data();
+            this->write_data();
+        }
+    };
+
+    virtual void SetUp()
+    {
+        Profiler::initialize();
+        FilePath mesh_file( string(UNIT_TESTS_SRC_DIR) + "/mesh/test_2_elem.msh", FilePath::input_file);
+        my_mesh = mesh_full_constructor("{mesh_file=\"" + (string)mesh_file + "\"}");
+        rank = my_mesh->get_el_ds()->myp();
+    }
+    virtual void TearDown() {
+        delete my_mesh;
+    }
+
+    IT::Record & get_input_type() {
+        return IT::Record("SomeEquation","")
+                .declare_key("data", IT::Array(
+                        IT::Record("SomeEquation_Data", FieldCommon::field_descriptor_record_description("SomeEquation_Data") )
+                        .copy_keys( TestOutputXDMF::EqData().make_field_descriptor_type("SomeEquation") )
+                        .declare_key("init_scalar", FieldAlgorithmBase< 3, FieldValue<3>::Scalar >::get_input_type_instance(), "" )
+                        .close()
+                        ), IT::Default::obligatory(), ""  )
+                .close();
+    }
+
+    void read_input(const string &input) {
+        Input::ReaderToStorage reader( input, get_input_type(), Input::FileFormat::format_YAML );
+        Input::Record in_rec=reader.get_root_interface<Input::Record>();
+
+        TimeGovernor tg(0.0, 1.0);
+        static std::vector<Input::Array> inputs;
+        unsigned int input_last = inputs.size(); // position of new item
+        inputs.push_back( in_rec.val<Input::Array>("data") );
+
+        data.set_mesh(*my_mesh);
+        data.set_input_list( inputs[input_last], tg );
+        data.set_time(tg.step(), LimitSide::right);
+    }
+
+    /// Read dimensions and double values of the dataset, called only on the first process.
+    std::vector<double> read_dataset(hid_t file, std::string path, std::vector<hsize_t> &dims) {
+        hid_t dataset = H5Dopen2(file, path.c_str(), H5P_DEFAULT);
+        EXPECT_GE(dataset, 0);
+        hid_t space = H5Dget_space(dataset);
+        dims.resize( H5Sget_simple_extent_ndims(space) );
+        H5Sget_simple_extent_dims(space, dims.data(), NULL);
+        std::vector<double> values( H5Sget_simple_extent_npoints(space) );
+        H5Dread(dataset, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, values.data());
+        H5Sclose(space);
+        H5Dclose(dataset);
+        return values;
+    }
+
+    Mesh * my_mesh;
+    EqData data;
+    int rank;
+};
+
+
+TEST_F(TestOutputXDMF, write_elem_data)
+{
+    read_input(xdmf_data_input);
+    {
+        auto stream = std::make_shared<OutputXDMFTest>();
+        auto in_rec = Input::ReaderToStorage(xdmf_output_input, const_cast<IT::Record &>(OutputTime::get_input_type()), Input::FileFormat::format_YAML)
+                .get_root_interface<Input::Record>();
+        stream->init_from_input("dummy_equation", in_rec, "s");
+
+        auto output_mesh = std::make_shared<OutputMesh>(*my_mesh);
+        output_mesh->create_sub_mesh();
+        output_mesh->make_parallel_master_mesh();
+        stream->set_output_data_caches(output_mesh);
+
+        data.init_scalar.field_output(stream);
+        stream->write_test_frame();
+    } // close the HDF5 file
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    if (rank == 0) {
+        hid_t file = H5Fopen("./test_output.h5", H5F_ACC_RDONLY, H5P_DEFAULT);
+        ASSERT_GE(file, 0);
+        std::vector<hsize_t> dims;
+
+        // every process stores nodes of its triangle
+        read_dataset(file, "/Mesh/Geometry", dims);
+        EXPECT_EQ(2u, dims.size());
+        EXPECT_EQ(6u, dims[0]);
+        EXPECT_EQ(3u, dims[1]);
+
+        // two triangles: type and three nodes
+        read_dataset(file, "/Mesh/Topology", dims);
+        EXPECT_EQ(1u, dims.size());
+        EXPECT_EQ(8u, dims[0]);
+
+        std::vector<double> values = read_dataset(file, "/Fields/init_scalar/000000", dims);
+        EXPECT_EQ(1u, dims.size());
+        std::vector<double> expected_values = { -1, 1 };
+        EXPECT_EQ(expected_values.size(), values.size());
+        for (unsigned int i=0; i<values.size(); ++i) EXPECT_DOUBLE_EQ(expected_values[i], values[i]);
+
+        H5Fclose(file);
+    }
+}
+
+#endif // FLOW123D_HAVE_HDF5
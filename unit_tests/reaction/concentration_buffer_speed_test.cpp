@@ -0,0 +1,116 @@
+/*
+ * concentration_buffer_speed_test.cpp
+ *
+ *  Reaction step of a decay chain with substance-major and element-major concentrations.
+ */
+
+#define FEAL_OVERRIDE_ASSERTS
+
+#include <flow_gtest.hh>
+#include <vector>
+
+#include "system/global_defs.h"
+
+
+#ifdef FLOW123D_RUN_UNIT_BENCHMARKS
+
+#include "system/sys_profiler.hh"
+#include "reaction/concentration_buffer.hh"
+#include "reaction/linear_ode_solver.hh"
+#include "substance_major_conc.hh"
+
+static const unsigned int n_chain = 20;
+static const unsigned int n_elements = 100000;
+static const unsigned int n_steps = 10;
+
+
+/// Decay chain of @p n substances, i-th substance decays to (i+1)-th.
+arma::mat decay_chain_matrix(unsigned int n)
+{
+    arma::mat m(n, n, arma::fill::zeros);
+    for (unsigned int i=0; i<n; i++)
+    {
+        double rate = 1.0 / (i+1);
+        m(i,i) = -rate;
+        if (i+1 < n) m(i+1,i) = rate;
+    }
+    return m;
+}
+
+
+TEST(ConcentrationBuffer_speed, decay_chain) {
+    Profiler::initialize();
+
+    LinearODESolver ode_solver;
+    ode_solver.set_system_matrix(decay_chain_matrix(n_chain));
+    ode_solver.set_step(0.1);
+
+    SubstanceMajorConc conc_subst(n_chain, n_elements), conc_elem(n_chain, n_elements),
+            conc_rows(n_chain, n_elements), conc_cols(n_chain, n_elements);
+    ConcentrationBuffer buffer(n_chain, n_elements);
+    arma::vec prev_conc(n_chain), new_conc;
+
+    {
+        // access of FirstOrderReactionBase without the buffer
+        START_TIMER("substance_major");
+        double **conc = conc_subst.matrix();
+        for (unsigned int step=0; step<n_steps; step++)
+            for (unsigned int el=0; el<n_elements; el++)
+            {
+                for (unsigned int sbi=0; sbi<n_chain; sbi++) prev_conc(sbi) = conc[sbi][el];
+                ode_solver.update_solution(prev_conc, new_conc);
+                for (unsigned int sbi=0; sbi<n_chain; sbi++) conc[sbi][el] = new_conc(sbi);
+            }
+        END_TIMER("substance_major");
+    }
+    {
+        // copy to the buffer and back in every step, as TransportOperatorSplitting does
+        START_TIMER("element_major");
+        for (unsigned int step=0; step<n_steps; step++)
+        {
+            buffer.gather(conc_elem.matrix());
+            for (unsigned int el=0; el<n_elements; el++)
+            {
+                double *elem_conc = buffer.element(el);
+                std::copy(elem_conc, elem_conc + n_chain, prev_conc.memptr());
+                ode_solver.update_solution(prev_conc, new_conc);
+                std::copy(new_conc.memptr(), new_conc.memptr() + n_chain, elem_conc);
+            }
+            buffer.scatter(conc_elem.matrix());
+        }
+        END_TIMER("element_major");
+    }
+
+    {
+        // batched kernel on the substance-major concentrations
+        START_TIMER("substance_major_batch");
+        for (unsigned int step=0; step<n_steps; step++)
+            ode_solver.update_solution_rows(conc_rows.matrix(), 0, n_elements);
+        END_TIMER("substance_major_batch");
+    }
+    {
+        // batched kernel on the buffer
+        START_TIMER("element_major_batch");
+        for (unsigned int step=0; step<n_steps; step++)
+        {
+            buffer.gather(conc_cols.matrix());
+            ode_solver.update_solution_columns(buffer.data(), n_elements);
+            buffer.scatter(conc_cols.matrix());
+        }
+        END_TIMER("element_major_batch");
+    }
+
+    for (unsigned int sbi=0; sbi<n_chain; sbi++)
+        for (unsigned int el=0; el<n_elements; el+=997)
+        {
+            double ref = conc_subst.matrix()[sbi][el];
+            EXPECT_DOUBLE_EQ(ref, conc_elem.matrix()[sbi][el]);
+            EXPECT_NEAR(ref, conc_rows.matrix()[sbi][el], 1e-12 * std::abs(ref));
+            EXPECT_NEAR(ref, conc_cols.matrix()[sbi][el], 1e-12 * std::abs(ref));
+        }
+
+    Profiler::instance()->output(cout);
+    Profiler::uninitialize();
+}
+
+#endif // FLOW123D_RUN_UNIT_BENCHMARKS
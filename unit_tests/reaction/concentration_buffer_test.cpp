@@ -0,0 +1,35 @@
+/*
+ * concentration_buffer_test.cpp
+ *
+ *  Element-major concentration buffer.
+ */
+
+#define FEAL_OVERRIDE_ASSERTS
+
+#include <flow_gtest.hh>
+#include <vector>
+
+#include "system/global_defs.h"
+#include "reaction/concentration_buffer.hh"
+#include "substance_major_conc.hh"
+
+
+TEST(ConcentrationBuffer, gather_scatter) {
+    // number of elements is not multiple of the block size
+    const unsigned int n_subst = 3, n_el = 2*ConcentrationBuffer::block_size + 5;
+    SubstanceMajorConc conc(n_subst, n_el);
+    ConcentrationBuffer buffer(n_subst, n_el);
+
+    buffer.gather(conc.matrix());
+    for (unsigned int el=0; el<n_el; el++)
+        for (unsigned int sbi=0; sbi<n_subst; sbi++)
+            EXPECT_EQ(1000*sbi + el, buffer.element(el)[sbi]);
+
+    for (unsigned int el=0; el<n_el; el++)
+        for (unsigned int sbi=0; sbi<n_subst; sbi++)
+            buffer.element(el)[sbi] *= 2;
+    buffer.scatter(conc.matrix());
+    for (unsigned int sbi=0; sbi<n_subst; sbi++)
+        for (unsigned int el=0; el<n_el; el++)
+            EXPECT_EQ(2*(1000*sbi + el), conc.matrix()[sbi][el]);
+}
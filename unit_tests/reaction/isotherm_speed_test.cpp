@@ -0,0 +1,113 @@
+/*
+ * isotherm_speed_test.cpp
+ *
+ *  Interpolation of isotherms point by point and in blocks, linear and cubic tables.
+ */
+
+#define FEAL_OVERRIDE_ASSERTS
+
+#include <flow_gtest.hh>
+#include <vector>
+
+#include "system/global_defs.h"
+
+
+#ifdef FLOW123D_RUN_UNIT_BENCHMARKS
+
+#include "system/sys_profiler.hh"
+#include "reaction/isotherm.hh"
+
+static const unsigned int n_points = 1000000;
+static const unsigned int n_repeats = 10;
+static const unsigned int block_size = 256;
+
+
+TEST(Isotherm_speed, compute_block) {
+    Profiler::initialize();
+
+    Isotherm isotherm;
+    isotherm.reinit(Isotherm::langmuir, false, 1.0, 0.25, 0.75, 0.0, 0.6, 0.4);
+    isotherm.make_table(1000u, 2.0);
+
+    std::vector<double> aqua(n_points), sorbed(n_points);
+    for (unsigned int i=0; i<n_points; i++)
+    {
+        aqua[i] = (i % 997) / 997.0;
+        sorbed[i] = 0.1 * (i % 7);
+    }
+    std::vector<double> block_aqua(aqua), block_sorbed(sorbed);
+
+    {
+        START_TIMER("interpolate");
+        for (unsigned int r=0; r<n_repeats; r++)
+            for (unsigned int i=0; i<n_points; i++)
+                isotherm.interpolate(aqua[i], sorbed[i]);
+        END_TIMER("interpolate");
+    }
+    {
+        START_TIMER("compute_block");
+        for (unsigned int r=0; r<n_repeats; r++)
+            for (unsigned int begin=0; begin<n_points; begin+=block_size)
+                isotherm.compute_block(&(block_aqua[begin]), &(block_sorbed[begin]),
+                                       std::min(block_size, n_points-begin));
+        END_TIMER("compute_block");
+    }
+
+    for (unsigned int i=0; i<n_points; i+=997)
+        EXPECT_DOUBLE_EQ(aqua[i], block_aqua[i]);
+
+    Profiler::instance()->output(cout);
+    Profiler::uninitialize();
+}
+
+
+TEST(Isotherm_speed, cubic_table) {
+    Profiler::initialize();
+
+    Isotherm linear, cubic;
+    linear.reinit(Isotherm::langmuir, false, 1.0, 0.25, 0.75, 0.0, 0.6, 0.4);
+    cubic.reinit(Isotherm::langmuir, false, 1.0, 0.25, 0.75, 0.0, 0.6, 0.4);
+    {
+        START_TIMER("make_table_linear");
+        linear.make_table(1000u, 2.0);
+        END_TIMER("make_table_linear");
+    }
+    {
+        START_TIMER("make_table_cubic");
+        cubic.make_table(1000u, 2.0, 1e-8);
+        END_TIMER("make_table_cubic");
+    }
+    cout << "intervals: linear " << linear.table()->n_intervals
+         << ", cubic " << cubic.table()->n_intervals << endl;
+
+    std::vector<double> aqua(n_points), sorbed(n_points);
+    for (unsigned int i=0; i<n_points; i++)
+    {
+        aqua[i] = (i % 997) / 997.0;
+        sorbed[i] = 0.1 * (i % 7);
+    }
+    std::vector<double> cubic_aqua(aqua), cubic_sorbed(sorbed);
+
+    {
+        START_TIMER("linear_block");
+        for (unsigned int r=0; r<n_repeats; r++)
+            for (unsigned int begin=0; begin<n_points; begin+=block_size)
+                linear.compute_block(&(aqua[begin]), &(sorbed[begin]), std::min(block_size, n_points-begin));
+        END_TIMER("linear_block");
+    }
+    {
+        START_TIMER("cubic_block");
+        for (unsigned int r=0; r<n_repeats; r++)
+            for (unsigned int begin=0; begin<n_points; begin+=block_size)
+                cubic.compute_block(&(cubic_aqua[begin]), &(cubic_sorbed[begin]), std::min(block_size, n_points-begin));
+        END_TIMER("cubic_block");
+    }
+
+    for (unsigned int i=0; i<n_points; i+=997)
+        EXPECT_NEAR(aqua[i], cubic_aqua[i], 1e-6);
+
+    Profiler::instance()->output(cout);
+    Profiler::uninitialize();
+}
+
+#endif // FLOW123D_RUN_UNIT_BENCHMARKS
@@ -0,0 +1,110 @@
+/*
+ * isotherm_test.cpp
+ *
+ *  Block evaluation of isotherms compared with evaluation point by point.
+ */
+
+#define FEAL_OVERRIDE_ASSERTS
+
+#include <flow_gtest.hh>
+#include <vector>
+
+#include "system/global_defs.h"
+#include "reaction/isotherm.hh"
+
+
+/// Compare Isotherm::compute_block with Isotherm::interpolate on points in and out of the table.
+void check_block(Isotherm &isotherm)
+{
+    const unsigned int n = 300;
+    std::vector<double> aqua(n), sorbed(n), block_aqua(n), block_sorbed(n);
+    for (unsigned int i=0; i<n; i++)
+    {
+        // table limit is 1.0, last third of points is over the limit
+        aqua[i] = block_aqua[i] = 1.5 * i / n;
+        sorbed[i] = block_sorbed[i] = 0.1 * (i % 7);
+    }
+
+    for (unsigned int i=0; i<n; i++)
+    {
+        if (isotherm.is_precomputed()) isotherm.interpolate(aqua[i], sorbed[i]);
+        else isotherm.compute(aqua[i], sorbed[i]);
+    }
+    isotherm.compute_block(&(block_aqua[0]), &(block_sorbed[0]), n);
+
+    for (unsigned int i=0; i<n; i++)
+    {
+        EXPECT_DOUBLE_EQ(aqua[i], block_aqua[i]);
+        EXPECT_DOUBLE_EQ(sorbed[i], block_sorbed[i]);
+    }
+}
+
+
+TEST(Isotherm, compute_block) {
+    Isotherm isotherm;
+
+    // Langmuir isotherm with the table
+    isotherm.reinit(Isotherm::langmuir, false, 1.0, 0.25, 0.75, 0.0, 0.6, 0.4);
+    isotherm.make_table(100u, 1.0);
+    ASSERT_TRUE(isotherm.is_precomputed());
+    check_block(isotherm);
+
+    // Freundlich isotherm with limited solubility
+    isotherm.reinit(Isotherm::freundlich, true, 1.0, 0.25, 0.75, 1.2, 0.6, 0.5);
+    isotherm.make_table(100u, 1.0);
+    check_block(isotherm);
+
+    // Linear isotherm without the table
+    isotherm.reinit(Isotherm::linear, false, 1.0, 0.25, 0.75, 0.0, 0.6, 0.0);
+    isotherm.clear_table();
+    check_block(isotherm);
+}
+
+
+TEST(Isotherm, cubic_table) {
+    Isotherm isotherm, exact;
+    isotherm.reinit(Isotherm::langmuir, false, 1.0, 0.25, 0.75, 0.0, 0.6, 0.4);
+    exact.reinit(Isotherm::langmuir, false, 1.0, 0.25, 0.75, 0.0, 0.6, 0.4);
+
+    // cubic table reaches the tolerance with much less intervals than the limit
+    isotherm.make_table(1000u, 1.0, 1e-8);
+    ASSERT_TRUE(isotherm.is_precomputed());
+    EXPECT_EQ(4u, isotherm.table()->n_coefs);
+    EXPECT_LT(isotherm.table()->n_intervals, 100u);
+
+    for (unsigned int i=0; i<100; i++)
+    {
+        double aqua = 0.01 * i, sorbed = 0.1 * (i % 5);
+        double exact_aqua = aqua, exact_sorbed = sorbed;
+        isotherm.interpolate(aqua, sorbed);
+        exact.compute(exact_aqua, exact_sorbed);
+        EXPECT_NEAR(exact_aqua, aqua, 1e-7);
+        EXPECT_NEAR(exact_sorbed, sorbed, 1e-7);
+    }
+    check_block(isotherm);
+
+    // the number of intervals is limited by n_points
+    isotherm.make_table(8u, 1.0, 1e-14);
+    EXPECT_EQ(8u, isotherm.table()->n_intervals);
+    check_block(isotherm);
+}
+
+
+TEST(Isotherm, shared_table) {
+    std::vector<Isotherm::TablePtr> cache;
+    Isotherm a, b, c;
+    a.reinit(Isotherm::freundlich, false, 1.0, 0.25, 0.75, 0.0, 0.6, 0.5);
+    b.reinit(Isotherm::freundlich, false, 1.0, 0.25, 0.75, 0.0, 0.6, 0.5);
+    c.reinit(Isotherm::freundlich, false, 1.0, 0.3, 0.7, 0.0, 0.6, 0.5);
+    a.make_table(100u, 1.0, 0.0, &cache);
+    b.make_table(100u, 1.0, 0.0, &cache);
+    c.make_table(100u, 1.0, 0.0, &cache);
+
+    EXPECT_EQ(a.table(), b.table());
+    EXPECT_NE(a.table(), c.table());
+    EXPECT_EQ(2u, cache.size());
+
+    // different table limit
+    b.make_table(100u, 2.0, 0.0, &cache);
+    EXPECT_NE(a.table(), b.table());
+}
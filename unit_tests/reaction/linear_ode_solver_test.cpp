@@ -0,0 +1,101 @@
+/*
+ * linear_ode_solver_test.cpp
+ *
+ *  Batched updates of LinearODESolver compared with the update of single vectors.
+ */
+
+#define FEAL_OVERRIDE_ASSERTS
+
+#include <flow_gtest.hh>
+#include <vector>
+
+#include "system/global_defs.h"
+#include "reaction/concentration_buffer.hh"
+#include "reaction/linear_ode_solver.hh"
+#include "substance_major_conc.hh"
+
+
+class LinearODESolverTest : public testing::Test {
+protected:
+    /// Number of elements is not multiple of the block size.
+    LinearODESolverTest()
+    : n_elements(2*LinearODESolver::block_size + 17)
+    {}
+
+    /// Update all elements of @p conc one by one, as FirstOrderReactionBase did.
+    void update_elements(LinearODESolver &ode_solver, double **conc, unsigned int n_subst,
+            unsigned int begin, unsigned int end)
+    {
+        arma::vec prev_conc(n_subst), new_conc;
+        for (unsigned int el=begin; el<end; el++)
+        {
+            for (unsigned int sbi=0; sbi<n_subst; sbi++) prev_conc(sbi) = conc[sbi][el];
+            ode_solver.update_solution(prev_conc, new_conc);
+            for (unsigned int sbi=0; sbi<n_subst; sbi++) conc[sbi][el] = new_conc(sbi);
+        }
+    }
+
+    /// Compare single, row and column updates of the system given by @p matrix.
+    void check_batched(const arma::mat &matrix)
+    {
+        unsigned int n_subst = matrix.n_rows;
+        LinearODESolver ode_solver;
+        ode_solver.set_system_matrix(matrix);
+        ode_solver.set_step(0.1);
+
+        SubstanceMajorConc conc_ref(n_subst, n_elements), conc_rows(n_subst, n_elements),
+                conc_cols(n_subst, n_elements), conc_part(n_subst, n_elements);
+        ConcentrationBuffer buffer(n_subst, n_elements);
+        for (unsigned int step=0; step<2; step++)
+        {
+            update_elements(ode_solver, conc_ref.matrix(), n_subst, 0, n_elements);
+            ode_solver.update_solution_rows(conc_rows.matrix(), 0, n_elements);
+            buffer.gather(conc_cols.matrix());
+            ode_solver.update_solution_columns(buffer.data(), n_elements);
+            buffer.scatter(conc_cols.matrix());
+        }
+
+        // update of a part of elements does not touch the others
+        unsigned int begin = 3, end = LinearODESolver::block_size + 5;
+        ode_solver.update_solution_rows(conc_part.matrix(), begin, end);
+        SubstanceMajorConc conc_part_ref(n_subst, n_elements);
+        update_elements(ode_solver, conc_part_ref.matrix(), n_subst, begin, end);
+
+        for (unsigned int sbi=0; sbi<n_subst; sbi++)
+            for (unsigned int el=0; el<n_elements; el++)
+            {
+                double ref = conc_ref.matrix()[sbi][el];
+                EXPECT_NEAR(ref, conc_rows.matrix()[sbi][el], 1e-12 * (std::abs(ref) + 1.0));
+                EXPECT_NEAR(ref, conc_cols.matrix()[sbi][el], 1e-12 * (std::abs(ref) + 1.0));
+
+                double ref_part = conc_part_ref.matrix()[sbi][el];
+                EXPECT_NEAR(ref_part, conc_part.matrix()[sbi][el], 1e-12 * (std::abs(ref_part) + 1.0));
+                if (el < begin || el >= end) EXPECT_EQ(1000*sbi + el, conc_part.matrix()[sbi][el]);
+            }
+    }
+
+    unsigned int n_elements;
+};
+
+
+TEST_F(LinearODESolverTest, first_order_reaction) {
+    // A -> B (rate 0.5), A -> C (rate 0.2), B -> C (rate 1.0); C is stable
+    arma::mat matrix = {{-0.7,  0.0, 0.0},
+                        { 0.5, -1.0, 0.0},
+                        { 0.2,  1.0, 0.0}};
+    check_batched(matrix);
+}
+
+
+TEST_F(LinearODESolverTest, decay_chain) {
+    // i-th substance decays to (i+1)-th, the last one is stable
+    const unsigned int n_chain = 6;
+    arma::mat matrix(n_chain, n_chain, arma::fill::zeros);
+    for (unsigned int i=0; i+1<n_chain; i++)
+    {
+        double rate = 1.0 / (i+1);
+        matrix(i,i) = -rate;
+        matrix(i+1,i) = rate;
+    }
+    check_batched(matrix);
+}
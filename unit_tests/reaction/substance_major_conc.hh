@@ -0,0 +1,35 @@
+/*
+ * substance_major_conc.hh
+ *
+ *  Concentration matrix of the reaction tests.
+ */
+
+#ifndef SUBSTANCE_MAJOR_CONC_HH_
+#define SUBSTANCE_MAJOR_CONC_HH_
+
+#include <vector>
+
+
+/// Substance-major concentration matrix conc[sbi][loc_el] with distinct values.
+class SubstanceMajorConc {
+public:
+    SubstanceMajorConc(unsigned int n_substances, unsigned int n_elements)
+    : data_(n_substances, std::vector<double>(n_elements)), ptrs_(n_substances)
+    {
+        for (unsigned int sbi=0; sbi<n_substances; sbi++)
+        {
+            ptrs_[sbi] = &(data_[sbi][0]);
+            for (unsigned int el=0; el<n_elements; el++) data_[sbi][el] = 1000*sbi + el;
+        }
+    }
+
+    double **matrix()
+    { return &(ptrs_[0]); }
+
+private:
+    std::vector< std::vector<double> > data_;
+    std::vector<double *> ptrs_;
+};
+
+
+#endif /* SUBSTANCE_MAJOR_CONC_HH_ */
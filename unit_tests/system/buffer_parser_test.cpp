@@ -0,0 +1,73 @@
+/*
+ * buffer_parser_test.cpp
+ *
+ *  Parsing of values from a character buffer, splitting of the buffer to parts.
+ */
+
+#include <flow_gtest.hh>
+#include <string>
+#include <vector>
+#include "system/buffer_parser.hh"
+
+using namespace std;
+
+
+TEST(BufferParser, read_value) {
+    string line = " 12 -3 4.5e1 +7 x1 ";
+    const char *pos = line.c_str(), *eol = pos + line.size();
+    unsigned int u;
+    int i;
+    double d;
+
+    EXPECT_TRUE( buffer_parser::read_value(pos, eol, u) );
+    EXPECT_EQ(12u, u);
+    EXPECT_FALSE( buffer_parser::read_value(pos, eol, u) ); // negative unsigned value
+    pos = line.c_str() + 4;
+    EXPECT_TRUE( buffer_parser::read_value(pos, eol, i) );
+    EXPECT_EQ(-3, i);
+    EXPECT_FALSE( buffer_parser::read_value(pos, eol, i) ); // decimal point in integer
+    pos = line.c_str() + 7;
+    EXPECT_TRUE( buffer_parser::read_value(pos, eol, d) );
+    EXPECT_DOUBLE_EQ(45.0, d);
+    EXPECT_TRUE( buffer_parser::read_value(pos, eol, i) );
+    EXPECT_EQ(7, i);
+    EXPECT_FALSE( buffer_parser::read_value(pos, eol, d) );
+}
+
+
+TEST(BufferParser, count_tokens) {
+    string data = " 1 2\n3   4 \n\n 5\t6\n";
+    const char *begin = data.c_str(), *end = begin + data.size();
+    EXPECT_EQ(6u, buffer_parser::count_tokens(begin, end));
+    EXPECT_EQ(0u, buffer_parser::count_tokens(begin, begin + 1));
+    EXPECT_EQ(0u, buffer_parser::count_tokens(end, end));
+}
+
+
+TEST(BufferParser, split_tokens) {
+    // single long line of values
+    string data;
+    for (unsigned int i=0; i<1000; i++) data += to_string(i) + " ";
+    const char *begin = data.c_str(), *end = begin + data.size();
+
+    for (unsigned int n_parts : {1u, 3u, 7u, 2000u}) {
+        vector<const char *> bounds = buffer_parser::split_tokens(begin, end, n_parts);
+        ASSERT_GE(bounds.size(), 2u);
+        EXPECT_LE(bounds.size(), n_parts+1);
+        EXPECT_EQ(begin, bounds.front());
+        EXPECT_EQ(end, bounds.back());
+
+        // no token is split and all values are read in order
+        unsigned int n_values = 0;
+        for (unsigned int i_part=0; i_part+1<bounds.size(); i_part++) {
+            if (i_part > 0) EXPECT_TRUE( buffer_parser::is_space(*(bounds[i_part]-1)) );
+            const char *pos = bounds[i_part];
+            unsigned int val;
+            while (buffer_parser::read_value(pos, bounds[i_part+1], val)) {
+                EXPECT_EQ(n_values, val);
+                n_values++;
+            }
+        }
+        EXPECT_EQ(1000u, n_values);
+    }
+}
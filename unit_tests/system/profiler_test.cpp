@@ -8,6 +8,7 @@
 #include <ctime>
 #include <cstdlib>
 #include <sstream>
+#include <thread>
 
 #define TEST_USE_MPI
 #define TEST_USE_PETSC
@@ -40,6 +41,7 @@ class ProfilerTest: public testing::Test {
         void test_petsc_memory_monitor();
         void test_multiple_instances();
         void test_propagate_values();
+        void test_threads();
         // void test_inconsistent_tree();
 };
 
@@ -515,6 +517,37 @@ void ProfilerTest::test_propagate_values() {
     Profiler::uninitialize();
 }
 
+// testing merging of timers started by other threads
+TEST_F(ProfilerTest, test_threads) {test_threads();}
+void ProfilerTest::test_threads() {
+    Profiler::initialize(); {
+            START_TIMER("A");
+                auto thread_work = [] () {
+                    START_TIMER("B");
+                    ADD_CALLS(2);
+                };
+                std::thread t1(thread_work), t2(thread_work);
+                t1.join();
+                t2.join();
+
+                PI->merge_thread_trees();
+                EXPECT_EQ(3, PI->n_thread_trees());
+
+                // timer of other threads is placed below actual timer of the master thread
+                int b_idx = PI->find_child(PI->thread_trees_[0], PI->actual_node, CODE_POINT("B"));
+                ASSERT_GE(b_idx, 0);
+                Timer &b = PI->timers_[b_idx];
+                EXPECT_EQ(0, b.call_count);
+                EXPECT_EQ(2, b.thread_count_);
+                EXPECT_EQ(4, b.thread_call_count_);
+                EXPECT_LE(b.thread_min_time_, b.thread_max_time_);
+                EXPECT_EQ(1, AN.thread_count_);
+            END_TIMER("A");
+    }
+    PI->output(MPI_COMM_WORLD, cout);
+    Profiler::uninitialize();
+}
+
 // optional test only for testing merging of inconsistent profiler trees
 // TEST_F(ProfilerTest, test_inconsistent_tree) {test_inconsistent_tree();}
 // void ProfilerTest::test_inconsistent_tree() {
@@ -15,8 +15,11 @@
 #ifdef FLOW123D_RUN_UNIT_BENCHMARKS
 
 #include <fstream>
+#include <iomanip>
+#include <vector>
 
 #include "system/tokenizer.hh"
+#include "system/buffer_parser.hh"
 #include "system/file_path.hh"
 #include "system/sys_profiler.hh"
 
@@ -98,4 +101,80 @@ TEST(TokenizerPosition, compare_speed) {
 	Profiler::uninitialize();
 }
 
+
+static const unsigned int n_line_values = 2000000;
+
+// Single line of values, i.e. ascii DataArray of VTK file written by Flow123d.
+TEST(TokenizerValues, compare_speed) {
+	FilePath::set_io_dirs(".", UNIT_TESTS_SRC_DIR, "", ".");
+	{
+		ofstream fout( FilePath("system/tokenizer_values.txt", FilePath::output_file) );
+		fout << std::setprecision(17);
+		for (unsigned int i=0; i<n_line_values; i++) fout << 0.001*i << " ";
+		fout << std::endl;
+	}
+
+	Profiler::initialize();
+	FilePath in_file("./system/tokenizer_values.txt", FilePath::input_file);
+	std::vector<double> tok_values(n_line_values), values(n_line_values), parallel_values(n_line_values);
+
+	// read values by tokenizer
+	{
+		START_TIMER("tokenizer");
+		Tokenizer tok(in_file);
+		tok.next_line();
+		for (unsigned int i=0; i<n_line_values; i++) {
+			tok_values[i] = boost::lexical_cast<double>(*tok); ++tok;
+		}
+		END_TIMER("tokenizer");
+	}
+
+	// read file to buffer
+	std::string data;
+	{
+		START_TIMER("read_buffer");
+		std::ifstream in( string(in_file).c_str() );
+		std::getline(in, data, '<');
+		END_TIMER("read_buffer");
+	}
+	const char *begin = data.c_str(), *end = begin + data.size();
+
+	// parse buffer sequentially
+	{
+		START_TIMER("buffer_parser");
+		const char *pos = begin;
+		const char *eol = buffer_parser::line_end(pos, end);
+		for (unsigned int i=0; i<n_line_values; i++)
+			EXPECT_TRUE( buffer_parser::read_value(pos, eol, values[i]) );
+		END_TIMER("buffer_parser");
+	}
+
+	// parse parts of buffer in parallel
+	{
+		START_TIMER("buffer_parser_parts");
+		std::vector<const char *> bounds = buffer_parser::split_tokens(begin, end, buffer_parser::n_read_parts(begin, end));
+		unsigned int n_parts = bounds.size() - 1;
+		std::vector<std::size_t> first_value(n_parts + 1, 0);
+		buffer_parser::read_parts(n_parts, [&](unsigned int i_part) {
+			first_value[i_part + 1] = buffer_parser::count_tokens(bounds[i_part], bounds[i_part + 1]);
+		});
+		for (unsigned int i_part = 0; i_part < n_parts; ++i_part) first_value[i_part + 1] += first_value[i_part];
+		buffer_parser::read_parts(n_parts, [&](unsigned int i_part) {
+			const char *pos = bounds[i_part];
+			const char *eol = buffer_parser::line_end(pos, bounds[i_part + 1]);
+			for (std::size_t i = first_value[i_part]; i < first_value[i_part + 1]; i++)
+				buffer_parser::read_value(pos, eol, parallel_values[i]);
+		});
+		END_TIMER("buffer_parser_parts");
+	}
+
+	for (unsigned int i=0; i<n_line_values; i+=1001) {
+		EXPECT_EQ(tok_values[i], values[i]);
+		EXPECT_EQ(tok_values[i], parallel_values[i]);
+	}
+
+	Profiler::instance()->output(cout);
+	Profiler::uninitialize();
+}
+
 #endif // FLOW123D_RUN_UNIT_BENCHMARKS
@@ -0,0 +1,125 @@
+/*
+ * substance_matrix_sharing_test.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#define TEST_USE_MPI
+#include <flow_gtest_mpi.hh>
+
+#include <vector>
+#include "transport/transport_dg.hh"
+
+
+/**
+ * Mimics the assembly of TransportDG: every process compares the coefficients of its cells
+ * and integrates the substances returned by SubstanceMatrixSharing::assembled.
+ */
+class SubstanceMatrixSharingTest : public testing::Test {
+protected:
+    SubstanceMatrixSharingTest()
+    : n_substances(3)
+    {
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        MPI_Comm_size(MPI_COMM_WORLD, &np);
+        sharing.initialize(n_substances, true, MPI_COMM_WORLD);
+    }
+
+    /**
+     * One pass of the assembly over @p n_cells cells, the coefficient of the substance @p sbi_diff
+     * differs from the first substance on the last cell of the process @p rank_diff.
+     * Returns number of cells integrated for every substance.
+     */
+    std::vector<unsigned int> assembly_pass(unsigned int sbi_diff, int rank_diff, unsigned int n_cells = 4) {
+        std::vector<unsigned int> n_integrated(n_substances, 0);
+        for (unsigned int cell=0; cell<n_cells; cell++) {
+            std::vector<double> coef(n_substances, 1.0);
+            if (rank == rank_diff && cell == n_cells-1 && sbi_diff < n_substances) coef[sbi_diff] = 2.0;
+            sharing.compare_coefficients(coef);
+            for (unsigned int sbi=0; sbi<n_substances; sbi++)
+                if (sharing.assembled(sbi)) n_integrated[sbi]++;
+        }
+        return n_integrated;
+    }
+
+    /// Returns true if @p value is same on all processes.
+    bool same_on_all(int value) {
+        int min, max;
+        MPI_Allreduce(&value, &min, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+        MPI_Allreduce(&value, &max, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+        return min == max;
+    }
+
+    unsigned int n_substances;
+    int rank, np;
+    SubstanceMatrixSharing sharing;
+};
+
+
+TEST_F(SubstanceMatrixSharingTest, equal_coefficients) {
+    for (unsigned int step=0; step<2; step++) {
+        sharing.start_assembly();
+        std::vector<unsigned int> n_integrated = assembly_pass(n_substances, 0);
+        EXPECT_EQ(4u, n_integrated[0]);
+        EXPECT_EQ(0u, n_integrated[1]);
+        EXPECT_EQ(0u, n_integrated[2]);
+
+        EXPECT_FALSE(sharing.finish_assembly());
+        EXPECT_TRUE(sharing.shared(1));
+        EXPECT_TRUE(sharing.shared(2));
+    }
+}
+
+
+TEST_F(SubstanceMatrixSharingTest, differing_coefficients) {
+    // substance 2 differs on the last process only, the other processes keep sharing locally
+    int rank_diff = np - 1;
+    sharing.start_assembly();
+    assembly_pass(2, rank_diff);
+
+    // all processes must agree on the repair pass
+    bool repair = sharing.finish_assembly();
+    EXPECT_TRUE(repair);
+    EXPECT_TRUE(same_on_all(repair));
+    EXPECT_TRUE(sharing.shared(1));
+    EXPECT_FALSE(sharing.shared(2));
+    EXPECT_FALSE(sharing.repaired(1));
+    EXPECT_TRUE(sharing.repaired(2));
+
+    // the repair pass integrates all cells of the substance that stopped sharing, on every process
+    std::vector<unsigned int> n_integrated = assembly_pass(2, rank_diff);
+    EXPECT_EQ(0u, n_integrated[0]);
+    EXPECT_EQ(0u, n_integrated[1]);
+    EXPECT_EQ(4u, n_integrated[2]);
+    EXPECT_FALSE(sharing.finish_assembly());
+    EXPECT_FALSE(sharing.repaired(2));
+
+    // the substance does not share in the next assembly, even if the coefficients are equal again
+    sharing.start_assembly();
+    n_integrated = assembly_pass(n_substances, 0);
+    EXPECT_EQ(4u, n_integrated[0]);
+    EXPECT_EQ(0u, n_integrated[1]);
+    EXPECT_EQ(4u, n_integrated[2]);
+    EXPECT_FALSE(sharing.finish_assembly());
+    EXPECT_FALSE(sharing.shared(2));
+}
+
+
+TEST_F(SubstanceMatrixSharingTest, processes_without_cells) {
+    // the first process has no cells, its flags are changed only by the other processes
+    unsigned int n_cells = (rank == 0 && np > 1) ? 0 : 4;
+    int rank_diff = np - 1;
+    sharing.start_assembly();
+    assembly_pass(1, rank_diff, n_cells);
+
+    bool repair = sharing.finish_assembly();
+    EXPECT_TRUE(repair);
+    EXPECT_TRUE(same_on_all(repair));
+    EXPECT_FALSE(sharing.shared(1));
+    EXPECT_TRUE(sharing.shared(2));
+    EXPECT_TRUE(same_on_all(sharing.repaired(1)));
+
+    std::vector<unsigned int> n_integrated = assembly_pass(1, rank_diff, n_cells);
+    EXPECT_EQ(n_cells, n_integrated[1]);
+    EXPECT_FALSE(sharing.finish_assembly());
+}